@@ -29,6 +29,9 @@ ifdef BUILD_TERMINAL
 	CFLAGS += -DCC_WIN_BACKEND=CC_WIN_BACKEND_TERMINAL -DCC_GFX_BACKEND=CC_GFX_BACKEND_SOFTGPU
 	LDFLAGS := $(subst mwindows,mconsole,$(LDFLAGS))
 endif
+ifdef BUILD_BENCHMARK
+	CFLAGS += -DCC_BUILD_BENCHMARK
+endif
 
 ifdef RELEASE
 	CFLAGS  += -O$(OPT_LEVEL)
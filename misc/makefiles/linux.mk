@@ -12,6 +12,10 @@ CFLAGS  := -fvisibility=hidden -fno-ident
 LDFLAGS	:= -rdynamic
 # -lm may be needed for __builtin_sqrtf (in cases where it isn't replaced by a CPU instruction intrinsic)
 LIBS 	:= -lX11 -lXi -lpthread -lGL -ldl -lm
+ifdef BUILD_TERMINAL
+	# Terminal window and software renderer backends don't need X11 or OpenGL
+	LIBS := -lpthread -ldl -lm
+endif
 include misc/makefiles/common_config.mk
 
 
@@ -254,9 +254,16 @@ static void Animations_Update(int texLoc, struct Bitmap* bmp, int stride) {
 	int dstX = Atlas1D_Index(texLoc);
 	int dstY = Atlas1D_RowId(texLoc) * Atlas2D.TileSize;
 	GfxResourceID tex;
+	int i;
 
 	tex = Atlas1D.TexIds[dstX];
-	if (tex) Gfx_UpdateTexture(tex, 0, dstY, bmp, stride, Gfx.Mipmaps);
+	if (!tex) return;
+
+	/* Update every copy of the tile (see Atlas1D.TileRepeats) */
+	for (i = 0; i < Atlas1D.TileRepeats; i++, dstY += Atlas2D.TileSize)
+	{
+		Gfx_UpdateTexture(tex, 0, dstY, bmp, stride, Gfx.Mipmaps);
+	}
 }
 
 static void Animations_Apply(struct AnimationData* data) {
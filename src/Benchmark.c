@@ -0,0 +1,255 @@
+#include "Core.h"
+#ifdef CC_BUILD_BENCHMARK
+#include "Benchmark.h"
+#include "Game.h"
+#include "Window.h"
+#include "World.h"
+#include "Entity.h"
+#include "ExtMath.h"
+#include "Platform.h"
+#include "Profiler.h"
+#include "Builder.h"
+#include "Stream.h"
+#include "String_.h"
+#include "Logger.h"
+#include "Funcs.h"
+#include "Generator.h"
+
+/* View distance is fixed, so the same chunks are always built */
+#define BENCHMARK_VIEW_DISTANCE 128
+/* Number of frames taken for the camera to orbit once around the map */
+#define BENCHMARK_PATH_FRAMES   600
+/* Initial build is considered finished after no chunks are built for this many frames */
+#define BENCHMARK_IDLE_FRAMES   60
+/* Upper limit on number of frames waiting for map generation or the initial build */
+#define BENCHMARK_MAX_FRAMES    100000
+
+static int frameTimes[BENCHMARK_PATH_FRAMES];
+
+static struct BenchmarkResults {
+	int genMs, initialChunks, initialMs, initialFrames;
+	int pathChunks, maxVertices, peakMemoryKB;
+	float avgVertices, avgFrameMs, p50FrameMs, p99FrameMs, maxFrameMs;
+	double stageTimes[PROFILER_STAGE_COUNT];
+	int stageCounts[PROFILER_STAGE_COUNT];
+} results;
+
+
+/*########################################################################################################################*
+*--------------------------------------------------------Measuring--------------------------------------------------------*
+*#########################################################################################################################*/
+/* Moves the camera to the given point along a circle around the map, looking towards the middle of the map */
+static void Benchmark_MoveCamera(int frame) {
+	struct LocalPlayer* p = Entities.CurPlayer;
+	struct LocationUpdate update;
+	float angle  = frame * (2 * MATH_PI / BENCHMARK_PATH_FRAMES);
+	float radius = World.Width / 3.0f;
+
+	update.flags = LU_HAS_POS | LU_HAS_PITCH | LU_HAS_YAW | LU_POS_ABSOLUTE_INSTANT;
+	update.pos.x = World.Width  / 2.0f + radius * Math_CosF(angle);
+	update.pos.y = World.Height + 8.0f;
+	update.pos.z = World.Length / 2.0f + radius * Math_SinF(angle);
+	update.pitch = 30.0f;
+	update.yaw   = angle * MATH_RAD2DEG + 270.0f;
+
+	p->Hacks.Flying = true;
+	p->Hacks.Noclip = true;
+	p->Base.VTABLE->SetLocation(&p->Base, &update);
+}
+
+/* Returns the peak resident memory of the process in kilobytes, or -1 if unknown */
+static int Benchmark_PeakMemory(void) {
+#ifdef CC_BUILD_LINUX
+	static const cc_string path   = String_FromConst("/proc/self/status");
+	static const cc_string prefix = String_FromConst("VmHWM:");
+	cc_string line; char lineBuffer[STRING_SIZE];
+	struct Stream stream, buffered;
+	cc_uint8 buffer[1024];
+	int value = -1, i;
+	cc_string str;
+
+	if (Stream_OpenFile(&stream, &path)) return -1;
+	Stream_ReadonlyBuffered(&buffered, &stream, buffer, sizeof(buffer));
+	String_InitArray(line, lineBuffer);
+
+	while (!Stream_ReadLine(&buffered, &line)) {
+		if (!String_CaselessStarts(&line, &prefix)) continue;
+		/* e.g. "VmHWM:    123456 kB" */
+		str = String_UNSAFE_SubstringAt(&line, prefix.length);
+		while (str.length && (str.buffer[0] < '0' || str.buffer[0] > '9')) {
+			str.buffer++; str.length--;
+		}
+
+		for (i = 0; i < str.length && str.buffer[i] >= '0' && str.buffer[i] <= '9'; i++) { }
+		str.length = i;
+		if (!Convert_ParseInt(&str, &value)) value = -1;
+		break;
+	}
+	stream.Close(&stream);
+	return value;
+#else
+	return -1;
+#endif
+}
+
+static void Benchmark_SortFrameTimes(int count) {
+	int i, j, value;
+	/* Only a few hundred frames, so insertion sort is fine */
+	for (i = 1; i < count; i++)
+	{
+		value = frameTimes[i];
+		for (j = i - 1; j >= 0 && frameTimes[j] > value; j--)
+		{
+			frameTimes[j + 1] = frameTimes[j];
+		}
+		frameTimes[j + 1] = value;
+	}
+}
+
+static void Benchmark_GenerateMap(void) {
+	cc_uint64 beg = Stopwatch_Measure();
+	int frames;
+
+	for (frames = 0; frames < BENCHMARK_MAX_FRAMES && !World.Loaded; frames++)
+	{
+		if (!Game_Running) return;
+		/* Wait for the generator, so the map is always loaded on the same frame */
+		while (!Gen_IsDone()) { Thread_Sleep(1); }
+		Game_RenderFrame();
+	}
+	results.genMs = Stopwatch_ElapsedMS(beg, Stopwatch_Measure());
+}
+
+static void Benchmark_BuildInitial(void) {
+	cc_uint64 beg = Stopwatch_Measure();
+	cc_uint64 lastBuild = beg;
+	int frames, idle = 0, built;
+	int startCount = Profiler_TotalCounts[PROFILER_CHUNK_BUILD];
+
+	Benchmark_MoveCamera(0);
+	for (frames = 0; frames < BENCHMARK_MAX_FRAMES && idle < BENCHMARK_IDLE_FRAMES; frames++)
+	{
+		if (!Game_Running) return;
+		built = Profiler_TotalCounts[PROFILER_CHUNK_BUILD];
+		Game_RenderFrame();
+
+		if (built == Profiler_TotalCounts[PROFILER_CHUNK_BUILD]) {
+			idle++;
+		} else {
+			idle = 0;
+			lastBuild = Stopwatch_Measure();
+			results.initialFrames = frames + 1;
+		}
+	}
+
+	results.initialChunks = Profiler_TotalCounts[PROFILER_CHUNK_BUILD] - startCount;
+	results.initialMs     = Stopwatch_ElapsedMS(beg, lastBuild);
+}
+
+static void Benchmark_FollowPath(void) {
+	double totalVertices = 0, totalTime = 0;
+	cc_uint64 beg, end;
+	int i;
+
+	/* Restart profiling, so that stage timings only cover the camera path */
+	Profiler_SetEnabled(false);
+	Profiler_SetEnabled(true);
+
+	for (i = 0; i < BENCHMARK_PATH_FRAMES; i++)
+	{
+		if (!Game_Running) return;
+		Benchmark_MoveCamera(i);
+
+		beg = Stopwatch_Measure();
+		Game_RenderFrame();
+		end = Stopwatch_Measure();
+
+		frameTimes[i]  = (int)Stopwatch_ElapsedMicroseconds(beg, end);
+		totalTime     += frameTimes[i];
+		totalVertices += Game_Vertices;
+		results.maxVertices = max(results.maxVertices, Game_Vertices);
+	}
+	results.pathChunks = Profiler_TotalCounts[PROFILER_CHUNK_BUILD];
+
+	Benchmark_SortFrameTimes(BENCHMARK_PATH_FRAMES);
+	results.avgVertices = (float)(totalVertices / BENCHMARK_PATH_FRAMES);
+	results.avgFrameMs  = (float)(totalTime / BENCHMARK_PATH_FRAMES / 1000.0);
+	results.p50FrameMs  = frameTimes[BENCHMARK_PATH_FRAMES * 50 / 100] / 1000.0f;
+	results.p99FrameMs  = frameTimes[BENCHMARK_PATH_FRAMES * 99 / 100] / 1000.0f;
+	results.maxFrameMs  = frameTimes[BENCHMARK_PATH_FRAMES - 1]        / 1000.0f;
+
+	for (i = 0; i < PROFILER_STAGE_COUNT; i++)
+	{
+		results.stageTimes[i]  = Profiler_TotalTimes[i];
+		results.stageCounts[i] = Profiler_TotalCounts[i];
+	}
+}
+
+
+/*########################################################################################################################*
+*---------------------------------------------------------Reporting-------------------------------------------------------*
+*#########################################################################################################################*/
+static void Benchmark_FormatResults(cc_string* str) {
+	int seed = BENCHMARK_MAP_SEED, viewDist = BENCHMARK_VIEW_DISTANCE, frames = BENCHMARK_PATH_FRAMES;
+	float chunksPerSec, time;
+	int i;
+
+	String_Format4(str, "{\"map\":{\"seed\":%i,\"width\":%i,\"height\":%i,\"length\":%i},",
+					&seed, &World.Width, &World.Height, &World.Length);
+	String_Format3(str, "\"viewDistance\":%i,\"builderWorkers\":%i,\"generateMs\":%i,",
+					&viewDist, &Builder_Workers, &results.genMs);
+
+	chunksPerSec = results.initialMs ? results.initialChunks * 1000.0f / results.initialMs : 0.0f;
+	String_Format4(str, "\"initialBuild\":{\"chunks\":%i,\"ms\":%i,\"frames\":%i,\"chunksPerSec\":%f1},",
+					&results.initialChunks, &results.initialMs, &results.initialFrames, &chunksPerSec);
+
+	String_Format2(str, "\"path\":{\"frames\":%i,\"chunks\":%i,", &frames, &results.pathChunks);
+	String_Format4(str, "\"frameMs\":{\"avg\":%f3,\"p50\":%f3,\"p99\":%f3,\"max\":%f3},",
+					&results.avgFrameMs, &results.p50FrameMs, &results.p99FrameMs, &results.maxFrameMs);
+	String_Format2(str, "\"vertices\":{\"avg\":%f1,\"max\":%i},\"stages\":{",
+					&results.avgVertices, &results.maxVertices);
+
+	for (i = 0; i < PROFILER_STAGE_COUNT; i++)
+	{
+		time = (float)results.stageTimes[i];
+		String_Format4(str, "\"%c\":{\"count\":%i,\"totalMs\":%f3}%c",
+						Profiler_StageNames[i], &results.stageCounts[i], &time,
+						i < PROFILER_STAGE_COUNT - 1 ? "," : "");
+	}
+	String_Format1(str, "}},\"peakMemoryKB\":%i}", &results.peakMemoryKB);
+}
+
+static void Benchmark_Report(void) {
+	static const cc_string path = String_FromConst("benchmark.json");
+	cc_string str; char strBuffer[4096];
+	cc_result res;
+
+	String_InitArray(str, strBuffer);
+	Benchmark_FormatResults(&str);
+	Platform_Log(str.buffer, str.length);
+
+	res = Stream_WriteAllTo(&path, (const cc_uint8*)str.buffer, str.length);
+	if (res) Logger_SysWarn2(res, "saving", &path);
+}
+
+void Benchmark_Run(void) {
+	Game_Setup();
+	Game_SetFpsLimit(FPS_LIMIT_NONE);
+	Game_SetViewDistance(BENCHMARK_VIEW_DISTANCE);
+	Profiler_SetEnabled(true);
+
+	Benchmark_GenerateMap();
+	Benchmark_BuildInitial();
+	Benchmark_FollowPath();
+	results.peakMemoryKB = Benchmark_PeakMemory();
+
+	if (Game_Running && World.Loaded) {
+		Benchmark_Report();
+	} else {
+		Platform_LogConst("Benchmark was interrupted before it could finish");
+	}
+
+	Game_Free();
+	Window_Destroy();
+}
+#endif
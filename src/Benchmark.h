@@ -0,0 +1,25 @@
+#ifndef CC_BENCHMARK_H
+#define CC_BENCHMARK_H
+#include "Core.h"
+CC_BEGIN_HEADER
+
+/*
+Deterministic headless benchmark of chunk building and rendering (see 'make bench')
+  Generates a fixed map, waits for all nearby chunks to be built, then moves the camera along a fixed path
+  Results are written as JSON to benchmark.json and also printed to stdout
+Copyright 2014-2025 ClassiCube | Licensed under BSD-3
+*/
+
+#define BENCHMARK_ARG "--benchmark"
+/* Seed and dimensions of the map that is always generated in benchmark builds */
+#define BENCHMARK_MAP_SEED   20140601
+#define BENCHMARK_MAP_SIZE   256
+#define BENCHMARK_MAP_HEIGHT 64
+/* Fixed time between frames in microseconds, so entities and chunk updates are the same every run */
+#define BENCHMARK_FRAME_TIME (1000 * 1000 / 60)
+
+/* Sets up the game, runs the benchmark, and then frees the game */
+void Benchmark_Run(void);
+
+CC_END_HEADER
+#endif
@@ -608,6 +608,11 @@ cc_result Png_Encode(struct Bitmap* bmp, struct Stream* stream,
 					Png_RowGetter getRow, cc_bool alpha, void* ctx) {
 	return ERR_NOT_SUPPORTED;
 }
+
+cc_result Png_EncodeLevel(struct Bitmap* bmp, struct Stream* stream, 
+					Png_RowGetter getRow, cc_bool alpha, void* ctx, int level) {
+	return ERR_NOT_SUPPORTED;
+}
 #else
 static void Png_Filter(cc_uint8 filter, const cc_uint8* cur, const cc_uint8* prior, cc_uint8* best, int lineLen, int bpp) {
 	/* 3 bytes per pixel constant */
@@ -710,7 +715,7 @@ static void Png_EncodeRow(const cc_uint8* cur, const cc_uint8* prior, cc_uint8*
 
 static BitmapCol* DefaultGetRow(struct Bitmap* bmp, int y, void* ctx) { return Bitmap_GetRow(bmp, y); }
 static cc_result Png_EncodeCore(struct Bitmap* bmp, struct Stream* stream, cc_uint8* buffer,
-					Png_RowGetter getRow, cc_bool alpha, void* ctx) {
+					Png_RowGetter getRow, cc_bool alpha, void* ctx, int level) {
 	cc_uint8 tmp[32];
 	cc_uint8* prevLine = buffer;
 	cc_uint8*  curLine = buffer + (bmp->width * 4) * 1;
@@ -756,6 +761,7 @@ static cc_result Png_EncodeCore(struct Bitmap* bmp, struct Stream* stream, cc_ui
 	if ((res = Stream_Write(&chunk, tmp, 4))) return res;
 
 	ZLib_MakeStream(&zlStream, zlState, &chunk); 
+	Deflate_SetLevel(&zlStream, level);
 	lineSize = bmp->width * (alpha ? 4 : 3);
 	Mem_Set(prevLine, 0, lineSize);
 
@@ -788,16 +794,21 @@ static cc_result Png_EncodeCore(struct Bitmap* bmp, struct Stream* stream, cc_ui
 	return stream->Seek(stream, stream_end);
 }
 
-cc_result Png_Encode(struct Bitmap* bmp, struct Stream* stream, 
-					Png_RowGetter getRow, cc_bool alpha, void* ctx) {
+cc_result Png_EncodeLevel(struct Bitmap* bmp, struct Stream* stream, 
+					Png_RowGetter getRow, cc_bool alpha, void* ctx, int level) {
 	cc_result res;
 	/* Add 1 for scanline filter type byter */
 	cc_uint8* buffer = (cc_uint8*)Mem_TryAlloc(3, bmp->width * 4 + 1);
 	if (!buffer) return ERR_NOT_SUPPORTED;
 
-	res = Png_EncodeCore(bmp, stream, buffer, getRow, alpha, ctx);
+	res = Png_EncodeCore(bmp, stream, buffer, getRow, alpha, ctx, level);
 	Mem_Free(buffer);
 	return res;
 }
+
+cc_result Png_Encode(struct Bitmap* bmp, struct Stream* stream, 
+					Png_RowGetter getRow, cc_bool alpha, void* ctx) {
+	return Png_EncodeLevel(bmp, stream, getRow, alpha, ctx, DEFLATE_LEVEL_NORMAL);
+}
 #endif
 
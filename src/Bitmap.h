@@ -144,6 +144,9 @@ CC_API cc_result Png_Decode(struct Bitmap* bmp, struct Stream* stream);
 /* if alpha is non-zero, RGBA channels are saved, otherwise only RGB channels are. */
 cc_result Png_Encode(struct Bitmap* bmp, struct Stream* stream, 
 						Png_RowGetter getRow, cc_bool alpha, void* ctx);
+/* Same as Png_Encode, but compresses pixel data using the given level. (see enum DeflateLevel) */
+cc_result Png_EncodeLevel(struct Bitmap* bmp, struct Stream* stream, 
+						Png_RowGetter getRow, cc_bool alpha, void* ctx, int level);
 
 CC_END_HEADER
 #endif
@@ -15,7 +15,14 @@
 #include "Chat.h"
 #include "Audio.h"
 
-/* Data for a resizable queue, used for liquid physic tick entries. */
+/* NOTE: Physics only uses the lower 8 bits of blocks */
+#ifdef CC_BUILD_COMPACTWORLD
+#define Physics_GetBlock(index) ((BlockRaw)World_GetRawBlock(index))
+#else
+#define Physics_GetBlock(index) World.Blocks[index]
+#endif
+
+/* Data for a resizable queue, used for the liquid physics tick entries due on a particular tick. */
 struct TickQueue {
 	cc_uint32* entries; /* Buffer holding the items in the tick queue */
 	int capacity; /* Max number of elements in the buffer */
@@ -87,22 +94,53 @@ static cc_uint32 TickQueue_Dequeue(struct TickQueue* queue) {
 }
 
 
+/* Number of ticks in a TickWheel, must be a power of two and greater than the longest delay + 1 */
+#define TICKWHEEL_SIZE 32
+#define TICKWHEEL_MASK (TICKWHEEL_SIZE - 1)
+
+/* Schedules liquid physics tick entries by the tick they are due on, with one queue per tick */
+/*  (so entries waiting on a delay are never touched until they are due) */
+struct TickWheel {
+	struct TickQueue slots[TICKWHEEL_SIZE];
+	cc_uint32 time; /* Number of ticks run so far, i.e. the next tick to be run */
+};
+
+static void TickWheel_Init(struct TickWheel* wheel) {
+	int i;
+	for (i = 0; i < TICKWHEEL_SIZE; i++) TickQueue_Init(&wheel->slots[i]);
+	wheel->time = 0;
+}
+
+static void TickWheel_Clear(struct TickWheel* wheel) {
+	int i;
+	for (i = 0; i < TICKWHEEL_SIZE; i++) TickQueue_Clear(&wheel->slots[i]);
+	wheel->time = 0;
+}
+
+/* Schedules the given block index to be processed once the given number of ticks have passed */
+/* NOTE: While a tick is being run, the delay is counted from the tick after it */
+static void TickWheel_Schedule(struct TickWheel* wheel, int index, int delay) {
+	TickQueue_Enqueue(&wheel->slots[(wheel->time + delay) & TICKWHEEL_MASK], (cc_uint32)index);
+}
+
+/* Advances to the next tick and returns the queue of entries due on that tick */
+static struct TickQueue* TickWheel_Advance(struct TickWheel* wheel) {
+	return &wheel->slots[wheel->time++ & TICKWHEEL_MASK];
+}
+
+
 struct Physics_ Physics;
 static RNGState physics_rnd;
 static int physics_tickCount;
 static int physics_maxWaterX, physics_maxWaterY, physics_maxWaterZ;
-static struct TickQueue lavaQ, waterQ;
+static struct TickWheel lavaQ, waterQ;
 
-#define PHYSICS_DELAY_MASK 0xF8000000UL
-#define PHYSICS_POS_MASK   0x07FFFFFFUL
-#define PHYSICS_DELAY_SHIFT 27
-#define PHYSICS_ONE_DELAY   (1U << PHYSICS_DELAY_SHIFT)
-#define PHYSICS_LAVA_DELAY (30U << PHYSICS_DELAY_SHIFT)
-#define PHYSICS_WATER_DELAY (5U << PHYSICS_DELAY_SHIFT)
+#define PHYSICS_LAVA_DELAY  30
+#define PHYSICS_WATER_DELAY 5
 
 static void Physics_OnNewMapLoaded(void* obj) {
-	TickQueue_Clear(&lavaQ);
-	TickQueue_Clear(&waterQ);
+	TickWheel_Clear(&lavaQ);
+	TickWheel_Clear(&waterQ);
 
 	physics_maxWaterX = World.MaxX - 2;
 	physics_maxWaterY = World.MaxY - 2;
@@ -119,7 +157,7 @@ void Physics_SetEnabled(cc_bool enabled) {
 }
 
 static void Physics_Activate(int index) {
-	BlockID block = World.Blocks[index];
+	BlockID block = Physics_GetBlock(index);
 	PhysicsHandler activate = Physics.OnActivate[block];
 	if (activate) activate(index, block);
 }
@@ -181,17 +219,17 @@ static void Physics_TickRandomBlocks(void) {
 				hi = World_Pack(x2, y2, z2);
 				
 				index = Random_Range(&physics_rnd, lo, hi);
-				block = World.Blocks[index];
+				block = Physics_GetBlock(index);
 				tick = Physics.OnRandomTick[block];
 				if (tick) tick(index, block);
 
 				index = Random_Range(&physics_rnd, lo, hi);
-				block = World.Blocks[index];
+				block = Physics_GetBlock(index);
 				tick = Physics.OnRandomTick[block];
 				if (tick) tick(index, block);
 
 				index = Random_Range(&physics_rnd, lo, hi);
-				block = World.Blocks[index];
+				block = Physics_GetBlock(index);
 				tick = Physics.OnRandomTick[block];
 				if (tick) tick(index, block);
 			}
@@ -208,7 +246,7 @@ static void Physics_DoFalling(int index, BlockID block) {
 	/* Find lowest block can fall into */
 	while (index >= World.OneY) {
 		index -= World.OneY;
-		other  = World.Blocks[index];
+		other  = Physics_GetBlock(index);
 
 		if (other == BLOCK_AIR || (other >= BLOCK_WATER && other <= BLOCK_STILL_LAVA))
 			found = index;
@@ -225,19 +263,6 @@ static void Physics_DoFalling(int index, BlockID block) {
 	Physics_ActivateNeighbours(x, y, z, start);
 }
 
-static cc_bool Physics_CheckItem(struct TickQueue* queue, int* posIndex) {
-	cc_uint32 item = TickQueue_Dequeue(queue);
-	*posIndex     = (int)(item & PHYSICS_POS_MASK);
-
-	if (item >= PHYSICS_ONE_DELAY) {
-		item -= PHYSICS_ONE_DELAY;
-		TickQueue_Enqueue(queue, item);
-		return false;
-	}
-	return true;
-}
-
-
 static void Physics_HandleSapling(int index, BlockID block) {
 	IVec3 coords[TREE_MAX_COUNT];
 	BlockRaw blocks[TREE_MAX_COUNT];
@@ -248,7 +273,7 @@ static void Physics_HandleSapling(int index, BlockID block) {
 	World_Unpack(index, x, y, z);
 
 	below = BLOCK_AIR;
-	if (y > 0) below = World.Blocks[index - World.OneY];
+	if (y > 0) below = Physics_GetBlock(index - World.OneY);
 	/* Saplings stay alive on dirt */
 	if (below == BLOCK_DIRT) return;
 
@@ -298,7 +323,7 @@ static void Physics_HandleFlower(int index, BlockID block) {
 	}
 
 	below = BLOCK_DIRT;
-	if (y > 0) below = World.Blocks[index - World.OneY];
+	if (y > 0) below = Physics_GetBlock(index - World.OneY);
 	if (!(below == BLOCK_DIRT || below == BLOCK_GRASS)) {
 		Game_UpdateBlock(x, y, z, BLOCK_AIR);
 		Physics_ActivateNeighbours(x, y, z, index);
@@ -317,7 +342,7 @@ static void Physics_HandleMushroom(int index, BlockID block) {
 	}
 
 	below = BLOCK_STONE;
-	if (y > 0) below = World.Blocks[index - World.OneY];
+	if (y > 0) below = Physics_GetBlock(index - World.OneY);
 	if (!(below == BLOCK_STONE || below == BLOCK_COBBLE)) {
 		Game_UpdateBlock(x, y, z, BLOCK_AIR);
 		Physics_ActivateNeighbours(x, y, z, index);
@@ -326,11 +351,11 @@ static void Physics_HandleMushroom(int index, BlockID block) {
 
 
 static void Physics_PlaceLava(int index, BlockID block) {
-	TickQueue_Enqueue(&lavaQ, PHYSICS_LAVA_DELAY | index);
+	TickWheel_Schedule(&lavaQ, index, PHYSICS_LAVA_DELAY);
 }
 
 static void Physics_PropagateLava(int posIndex, int x, int y, int z) {
-	BlockID block = World.Blocks[posIndex];
+	BlockID block = Physics_GetBlock(posIndex);
 
 	if (block >= BLOCK_WATER && block <= BLOCK_STILL_LAVA) {
 		/* Lava spreading into water turns the water solid */
@@ -338,7 +363,7 @@ static void Physics_PropagateLava(int posIndex, int x, int y, int z) {
 			Game_UpdateBlock(x, y, z, BLOCK_STONE);
 		}
 	} else if (Blocks.Draw[block] == DRAW_GAS) {
-		TickQueue_Enqueue(&lavaQ, PHYSICS_LAVA_DELAY | posIndex);
+		TickWheel_Schedule(&lavaQ, posIndex, PHYSICS_LAVA_DELAY);
 		Game_UpdateBlock(x, y, z, BLOCK_LAVA);
 	}
 }
@@ -355,24 +380,23 @@ static void Physics_ActivateLava(int index, BlockID block) {
 }
 
 static void Physics_TickLava(void) {
-	int i, count = lavaQ.count;
+	struct TickQueue* due = TickWheel_Advance(&lavaQ);
+	int i, count = due->count;
 	for (i = 0; i < count; i++) {
-		int index;
-		if (Physics_CheckItem(&lavaQ, &index)) {
-			BlockID block = World.Blocks[index];
-			if (!(block == BLOCK_LAVA || block == BLOCK_STILL_LAVA)) continue;
-			Physics_ActivateLava(index, block);
-		}
+		int index = (int)TickQueue_Dequeue(due);
+		BlockID block = Physics_GetBlock(index);
+		if (!(block == BLOCK_LAVA || block == BLOCK_STILL_LAVA)) continue;
+		Physics_ActivateLava(index, block);
 	}
 }
 
 
 static void Physics_PlaceWater(int index, BlockID block) {
-	TickQueue_Enqueue(&waterQ, PHYSICS_WATER_DELAY | index);
+	TickWheel_Schedule(&waterQ, index, PHYSICS_WATER_DELAY);
 }
 
 static void Physics_PropagateWater(int posIndex, int x, int y, int z) {
-	BlockID block = World.Blocks[posIndex];
+	BlockID block = Physics_GetBlock(posIndex);
 	int xx, yy, zz;
 
 	if (block >= BLOCK_WATER && block <= BLOCK_STILL_LAVA) {
@@ -391,7 +415,7 @@ static void Physics_PropagateWater(int posIndex, int x, int y, int z) {
 			}
 		}
 
-		TickQueue_Enqueue(&waterQ, PHYSICS_WATER_DELAY | posIndex);
+		TickWheel_Schedule(&waterQ, posIndex, PHYSICS_WATER_DELAY);
 		Game_UpdateBlock(x, y, z, BLOCK_WATER);
 	}
 }
@@ -408,14 +432,13 @@ static void Physics_ActivateWater(int index, BlockID block) {
 }
 
 static void Physics_TickWater(void) {
-	int i, count = waterQ.count;
+	struct TickQueue* due = TickWheel_Advance(&waterQ);
+	int i, count = due->count;
 	for (i = 0; i < count; i++) {
-		int index;
-		if (Physics_CheckItem(&waterQ, &index)) {
-			BlockID block = World.Blocks[index];
-			if (!(block == BLOCK_WATER || block == BLOCK_STILL_WATER)) continue;
-			Physics_ActivateWater(index, block);
-		}
+		int index = (int)TickQueue_Dequeue(due);
+		BlockID block = Physics_GetBlock(index);
+		if (!(block == BLOCK_WATER || block == BLOCK_STILL_WATER)) continue;
+		Physics_ActivateWater(index, block);
 	}
 }
 
@@ -449,9 +472,9 @@ static void Physics_DeleteSponge(int index, BlockID block) {
 					if (!World_Contains(xx, yy, zz)) continue;
 
 					index = World_Pack(xx, yy, zz);
-					block = World.Blocks[index];
+					block = Physics_GetBlock(index);
 					if (block == BLOCK_WATER || block == BLOCK_STILL_WATER) {
-						TickQueue_Enqueue(&waterQ, index | PHYSICS_ONE_DELAY);
+						TickWheel_Schedule(&waterQ, index, 1);
 					}
 				}
 			}
@@ -465,7 +488,7 @@ static void Physics_HandleSlab(int index, BlockID block) {
 	World_Unpack(index, x, y, z);
 	if (index < World.OneY) return;
 
-	if (World.Blocks[index - World.OneY] != BLOCK_SLAB) return;
+	if (Physics_GetBlock(index - World.OneY) != BLOCK_SLAB) return;
 	Game_UpdateBlock(x, y,     z, BLOCK_AIR);
 	Game_UpdateBlock(x, y - 1, z, BLOCK_DOUBLE_SLAB);
 }
@@ -475,7 +498,7 @@ static void Physics_HandleCobblestoneSlab(int index, BlockID block) {
 	World_Unpack(index, x, y, z);
 	if (index < World.OneY) return;
 
-	if (World.Blocks[index - World.OneY] != BLOCK_COBBLE_SLAB) return;
+	if (Physics_GetBlock(index - World.OneY) != BLOCK_COBBLE_SLAB) return;
 	Game_UpdateBlock(x, y,     z, BLOCK_AIR);
 	Game_UpdateBlock(x, y - 1, z, BLOCK_COBBLE);
 }
@@ -508,7 +531,7 @@ static void Physics_HandleTnt(int index, BlockID block) {
 				if (!World_Contains(xx, yy, zz)) continue;
 				index = World_Pack(xx, yy, zz);
 
-				block = World.Blocks[index];
+				block = Physics_GetBlock(index);
 				if (BlocksTNT(block)) continue;
 
 				Game_UpdateBlock(xx, yy, zz, BLOCK_AIR);
@@ -521,8 +544,8 @@ static void Physics_HandleTnt(int index, BlockID block) {
 void Physics_Init(void) {
 	Event_Register_(&WorldEvents.MapLoaded,    NULL, Physics_OnNewMapLoaded);
 	Physics.Enabled = Options_GetBool(OPT_BLOCK_PHYSICS, true);
-	TickQueue_Init(&lavaQ);
-	TickQueue_Init(&waterQ);
+	TickWheel_Init(&lavaQ);
+	TickWheel_Init(&waterQ);
 
 	Physics.OnPlace[BLOCK_SAND]        = Physics_DoFalling;
 	Physics.OnPlace[BLOCK_GRAVEL]      = Physics_DoFalling;
@@ -563,10 +586,12 @@ void Physics_Init(void) {
 
 void Physics_Free(void) {
 	Event_Unregister_(&WorldEvents.MapLoaded,    NULL, Physics_OnNewMapLoaded);
+	TickWheel_Clear(&lavaQ);
+	TickWheel_Clear(&waterQ);
 }
 
 void Physics_Tick(void) {
-	if (!Physics.Enabled || !World.Blocks) return;
+	if (!Physics.Enabled || !World_HasBlocks()) return;
 
 	/*if ((tickCount % 5) == 0) {*/
 	Physics_TickLava();
@@ -13,6 +13,7 @@
 #include "TexturePack.h"
 #include "Game.h"
 #include "Options.h"
+#include "Profiler.h"
 
 int Builder_SidesLevel, Builder_EdgeLevel;
 /* Packs an index into the 16x16x16 count array. Coordinates range from 0 to 15. */
@@ -20,22 +21,12 @@ int Builder_SidesLevel, Builder_EdgeLevel;
 /* Packs an index into the 18x18x18 chunk array. Coordinates range from -1 to 16. */
 #define Builder_PackChunk(xx, yy, zz) (((yy) + 1) * EXTCHUNK_SIZE_2 + ((zz) + 1) * EXTCHUNK_SIZE + ((xx) + 1))
 
-static BlockID* Builder_Chunk;
-static cc_uint8* Builder_Counts;
-static int* Builder_BitFlags;
-static int Builder_X, Builder_Y, Builder_Z;
-static BlockID Builder_Block;
-static int Builder_ChunkIndex;
-static cc_bool Builder_FullBright;
-static int Builder_ChunkEndX, Builder_ChunkEndZ;
-static int Builder_Offsets[FACE_COUNT] = { -1,1, -EXTCHUNK_SIZE,EXTCHUNK_SIZE, -EXTCHUNK_SIZE_2,EXTCHUNK_SIZE_2 };
+/* Greedy mesh builder needs an extra per face array, which is too large for low memory systems */
+#if !defined CC_BUILD_LOWMEM && CC_BUILD_MAXSTACK > (64 * 1024)
+	#define BUILDER_GREEDY_MESHING
+#endif
 
-static int (*Builder_StretchXLiquid)(int countIndex, int x, int y, int z, int chunkIndex, BlockID block);
-static int (*Builder_StretchX)(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face);
-static int (*Builder_StretchZ)(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face);
-static void (*Builder_RenderBlock)(int countsIndex, int x, int y, int z);
-static void (*Builder_PrePrepareChunk)(void);
-static void (*Builder_PostPrepareChunk)(void);
+static int Builder_Offsets[FACE_COUNT] = { -1,1, -EXTCHUNK_SIZE,EXTCHUNK_SIZE, -EXTCHUNK_SIZE_2,EXTCHUNK_SIZE_2 };
 
 /* Contains state for vertices for a portion of a chunk mesh (vertices that are in a 1D atlas) */
 struct Builder1DPart {
@@ -47,10 +38,44 @@ struct Builder1DPart {
 	int sCount, sOffset;
 };
 
-/* Part builder data, for both normal and translucent parts.
-The first ATLAS1D_MAX_ATLASES parts are for normal parts, remainder are for translucent parts. */
-static CC_BIG_VAR struct Builder1DPart Builder_Parts[ATLAS1D_MAX_ATLASES * 2];
-static struct VertexTextured* Builder_Vertices;
+/* Contains all the state needed while building the mesh for a single chunk */
+/*  (kept separate per chunk, so that multiple chunks can be built at the same time) */
+struct BuilderContext {
+	BlockID* chunk;
+	cc_uint8* counts;
+	int* bitFlags;
+	/* Number of rows each face was merged across (greedy mesh builder only) */
+	cc_uint8* spans;
+	int x, y, z;
+	BlockID block;
+	int chunkIndex;
+	cc_bool fullBright;
+	/* Level of detail the chunk is being built at (0 for full detail) */
+	int lod;
+	int chunkEndX, chunkEndY, chunkEndZ;
+	struct VertexTextured* vertices;
+	RNGState spriteRng;
+	/* Cuboid state for the block currently being drawn */
+	struct _DrawerData drawer;
+	/* State for advanced/modern mesh builders */
+	int initBitFlags, baseOffset;
+	PackedCol lerp[5], lerpX[5], lerpZ[5], lerpY[5];
+	/* Light color of each block in the chunk and its neighbours, or 0 if not looked up yet (modern mesh builder only) */
+	/*  (shares storage with bitFlags, as the advanced and modern mesh builders are never active at the same time) */
+	PackedCol* light;
+	/* Part builder data, for both normal and translucent parts.
+	The first ATLAS1D_MAX_ATLASES parts are for normal parts, remainder are for translucent parts. */
+	struct Builder1DPart parts[ATLAS1D_MAX_ATLASES * 2];
+};
+
+static int (*Builder_StretchXLiquid)(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block);
+static int (*Builder_StretchX)(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face);
+static int (*Builder_StretchZ)(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face);
+static void (*Builder_RenderBlock)(struct BuilderContext* ctx, int countsIndex, int x, int y, int z);
+static void (*Builder_PrePrepareChunk)(struct BuilderContext* ctx);
+static void (*Builder_PostPrepareChunk)(struct BuilderContext* ctx);
+/* Builder context used when building chunks on the main thread */
+static CC_BIG_VAR struct BuilderContext Builder_MainCtx;
 
 static int Builder1DPart_VerticesCount(struct Builder1DPart* part) {
 	int i, count = part->sCount;
@@ -58,7 +83,7 @@ static int Builder1DPart_VerticesCount(struct Builder1DPart* part) {
 	return count;
 }
 
-static int Builder1DPart_CalcOffsets(struct Builder1DPart* part, int offset) {
+static int Builder1DPart_CalcOffsets(struct BuilderContext* ctx, struct Builder1DPart* part, int offset) {
 	int i, counts[FACE_COUNT];
 	part->sOffset = offset;
 
@@ -71,16 +96,16 @@ static int Builder1DPart_CalcOffsets(struct Builder1DPart* part, int offset) {
 	offset += part->sCount;
 	for (i = 0; i < FACE_COUNT; i++) 
 	{
-		part->faces.vertices[i] = &Builder_Vertices[offset];
+		part->faces.vertices[i] = &ctx->vertices[offset];
 		offset += counts[i];
 	}
 	return offset;
 }
 
-static int Builder_TotalVerticesCount(void) {
+static int Builder_TotalVerticesCount(struct BuilderContext* ctx) {
 	int i, count = 0;
 	for (i = 0; i < ATLAS1D_MAX_ATLASES * 2; i++) {
-		count += Builder1DPart_VerticesCount(&Builder_Parts[i]);
+		count += Builder1DPart_VerticesCount(&ctx->parts[i]);
 	}
 	return count;
 }
@@ -89,28 +114,28 @@ static int Builder_TotalVerticesCount(void) {
 /*########################################################################################################################*
 *----------------------------------------------------Base mesh builder----------------------------------------------------*
 *#########################################################################################################################*/
-static void AddSpriteVertices(BlockID block) {
+static void AddSpriteVertices(struct BuilderContext* ctx, BlockID block) {
 	int i = Atlas1D_Index(Block_Tex(block, FACE_XMAX));
-	struct Builder1DPart* part = &Builder_Parts[i];
+	struct Builder1DPart* part = &ctx->parts[i];
 	part->sCount += 4 * 4;
 }
 
-static void AddVertices(BlockID block, Face face) {
+static void AddVertices(struct BuilderContext* ctx, BlockID block, Face face) {
 	int baseOffset = (Blocks.Draw[block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
 	int i = Atlas1D_Index(Block_Tex(block, face));
-	struct Builder1DPart* part = &Builder_Parts[baseOffset + i];
+	struct Builder1DPart* part = &ctx->parts[baseOffset + i];
 	part->faces.count[face] += 4;
 }
 
 #if CC_GFX_BACKEND == CC_GFX_BACKEND_GL11
-static void BuildPartVbs(struct ChunkPartInfo* info) {
+static void BuildPartVbs(struct BuilderContext* ctx, struct ChunkPartInfo* info) {
 	/* Sprites vertices are stored before chunk face sides */
 	int i, count, offset = info->offset + info->spriteCount;
 	for (i = 0; i < FACE_COUNT; i++) {
 		count = info->counts[i];
 
 		if (count) {
-			info->vbs[i] = Gfx_CreateVb2(&Builder_Vertices[offset], VERTEX_FORMAT_TEXTURED, count);
+			info->vbs[i] = Gfx_CreateVb2(&ctx->vertices[offset], VERTEX_FORMAT_TEXTURED, count);
 			offset += count;
 		} else {
 			info->vbs[i] = 0;
@@ -120,11 +145,22 @@ static void BuildPartVbs(struct ChunkPartInfo* info) {
 	count  = info->spriteCount;
 	offset = info->offset;
 	if (count) {
-		info->vbs[i] = Gfx_CreateVb2(&Builder_Vertices[offset], VERTEX_FORMAT_TEXTURED, count);
+		info->vbs[i] = Gfx_CreateVb2(&ctx->vertices[offset], VERTEX_FORMAT_TEXTURED, count);
 	} else {
 		info->vbs[i] = 0;
 	}
 }
+
+static void BuildChunkPartVbs(struct BuilderContext* ctx, int partsIndex) {
+	int i, curIdx;
+
+	for (i = 0; i < MapRenderer_1DUsedCount; i++) {
+		curIdx = partsIndex + i * World.ChunksCount;
+
+		BuildPartVbs(ctx, &MapRenderer_PartsNormal[curIdx]);
+		BuildPartVbs(ctx, &MapRenderer_PartsTranslucent[curIdx]);
+	}
+}
 #endif
 
 static cc_bool SetPartInfo(struct Builder1DPart* part, int* offset, struct ChunkPartInfo* info) {
@@ -146,7 +182,7 @@ static cc_bool SetPartInfo(struct Builder1DPart* part, int* offset, struct Chunk
 }
 
 
-static void PrepareChunk(int x1, int y1, int z1) {
+static void PrepareChunk(struct BuilderContext* ctx, int x1, int y1, int z1) {
 	int xMax = min(World.Width,  x1 + CHUNK_SIZE);
 	int yMax = min(World.Height, y1 + CHUNK_SIZE);
 	int zMax = min(World.Length, z1 + CHUNK_SIZE);
@@ -154,135 +190,153 @@ static void PrepareChunk(int x1, int y1, int z1) {
 	int cIndex, index, tileIdx;
 	BlockID b;
 	int x, y, z, xx, yy, zz;
-
-#ifdef OCCLUSION
-	int flags = ComputeOcclusion();
-#endif
-#ifdef DEBUG_OCCLUSION
-	FastColour col = new FastColour(60, 60, 60, 255);
-	if (flags & 1) col.R = 255; /* x */
-	if (flags & 4) col.G = 255; /* y */
-	if (flags & 2) col.B = 255; /* z */
-	map.Sunlight = map.Shadowlight = col;
-	map.SunlightXSide = map.ShadowlightXSide = col;
-	map.SunlightZSide = map.ShadowlightZSide = col;
-	map.SunlightYBottom = map.ShadowlightYBottom = col;
-#endif
 	
 	for (y = y1, yy = 0; y < yMax; y++, yy++) {
 		for (z = z1, zz = 0; z < zMax; z++, zz++) {
 			cIndex = Builder_PackChunk(0, yy, zz);
 
 			for (x = x1, xx = 0; x < xMax; x++, xx++, cIndex++) {
-				b = Builder_Chunk[cIndex];
+				b = ctx->chunk[cIndex];
 				if (Blocks.Draw[b] == DRAW_GAS) continue;
 				index = Builder_PackCount(xx, yy, zz);
 
 				/* Sprites can't be stretched, nor can then be they hidden by other blocks. */
 				/* Note sprites are drawn using DrawSprite and not with any of the DrawXFace. */
-				if (Blocks.Draw[b] == DRAW_SPRITE) { AddSpriteVertices(b); continue; }
+				if (Blocks.Draw[b] == DRAW_SPRITE) { AddSpriteVertices(ctx, b); continue; }
 
-				Builder_X = x; Builder_Y = y; Builder_Z = z;
-				Builder_FullBright = Blocks.Brightness[b];
+				ctx->x = x; ctx->y = y; ctx->z = z;
+				ctx->fullBright = Blocks.Brightness[b];
 				tileIdx = b * BLOCK_COUNT;
 				/* All of these function calls are inlined as they can be called tens of millions to hundreds of millions of times. */
 
-				if (Builder_Counts[index] == 0 ||
+				if (ctx->counts[index] == 0 ||
 					(x == 0 && (y < Builder_SidesLevel || (b >= BLOCK_WATER && b <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
-					(x != 0 && (Blocks.Hidden[tileIdx + Builder_Chunk[cIndex - 1]] & FACE_BIT_XMIN) != 0)) {
-					Builder_Counts[index] = 0;
+					(x != 0 && (Blocks.Hidden[tileIdx + ctx->chunk[cIndex - 1]] & FACE_BIT_XMIN) != 0)) {
+					ctx->counts[index] = 0;
 				} else {
-					Builder_Counts[index] = Builder_StretchZ(index, x, y, z, cIndex, b, FACE_XMIN);
+					ctx->counts[index] = Builder_StretchZ(ctx, index, x, y, z, cIndex, b, FACE_XMIN);
 				}
 
 				index++;
-				if (Builder_Counts[index] == 0 ||
+				if (ctx->counts[index] == 0 ||
 					(x == World.MaxX && (y < Builder_SidesLevel || (b >= BLOCK_WATER && b <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
-					(x != World.MaxX && (Blocks.Hidden[tileIdx + Builder_Chunk[cIndex + 1]] & FACE_BIT_XMAX) != 0)) {
-					Builder_Counts[index] = 0;
+					(x != World.MaxX && (Blocks.Hidden[tileIdx + ctx->chunk[cIndex + 1]] & FACE_BIT_XMAX) != 0)) {
+					ctx->counts[index] = 0;
 				} else {
-					Builder_Counts[index] = Builder_StretchZ(index, x, y, z, cIndex, b, FACE_XMAX);
+					ctx->counts[index] = Builder_StretchZ(ctx, index, x, y, z, cIndex, b, FACE_XMAX);
 				}
 
 				index++;
-				if (Builder_Counts[index] == 0 ||
+				if (ctx->counts[index] == 0 ||
 					(z == 0 && (y < Builder_SidesLevel || (b >= BLOCK_WATER && b <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
-					(z != 0 && (Blocks.Hidden[tileIdx + Builder_Chunk[cIndex - EXTCHUNK_SIZE]] & FACE_BIT_ZMIN) != 0)) {
-					Builder_Counts[index] = 0;
+					(z != 0 && (Blocks.Hidden[tileIdx + ctx->chunk[cIndex - EXTCHUNK_SIZE]] & FACE_BIT_ZMIN) != 0)) {
+					ctx->counts[index] = 0;
 				} else {
-					Builder_Counts[index] = Builder_StretchX(index, x, y, z, cIndex, b, FACE_ZMIN);
+					ctx->counts[index] = Builder_StretchX(ctx, index, x, y, z, cIndex, b, FACE_ZMIN);
 				}
 
 				index++;
-				if (Builder_Counts[index] == 0 ||
+				if (ctx->counts[index] == 0 ||
 					(z == World.MaxZ && (y < Builder_SidesLevel || (b >= BLOCK_WATER && b <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
-					(z != World.MaxZ && (Blocks.Hidden[tileIdx + Builder_Chunk[cIndex + EXTCHUNK_SIZE]] & FACE_BIT_ZMAX) != 0)) {
-					Builder_Counts[index] = 0;
+					(z != World.MaxZ && (Blocks.Hidden[tileIdx + ctx->chunk[cIndex + EXTCHUNK_SIZE]] & FACE_BIT_ZMAX) != 0)) {
+					ctx->counts[index] = 0;
 				} else {
-					Builder_Counts[index] = Builder_StretchX(index, x, y, z, cIndex, b, FACE_ZMAX);
+					ctx->counts[index] = Builder_StretchX(ctx, index, x, y, z, cIndex, b, FACE_ZMAX);
 				}
 
 				index++;
-				if (Builder_Counts[index] == 0 || y == 0 ||
-					(Blocks.Hidden[tileIdx + Builder_Chunk[cIndex - EXTCHUNK_SIZE_2]] & FACE_BIT_YMIN) != 0) {
-					Builder_Counts[index] = 0;
+				if (ctx->counts[index] == 0 || y == 0 ||
+					(Blocks.Hidden[tileIdx + ctx->chunk[cIndex - EXTCHUNK_SIZE_2]] & FACE_BIT_YMIN) != 0) {
+					ctx->counts[index] = 0;
 				} else {
-					Builder_Counts[index] = Builder_StretchX(index, x, y, z, cIndex, b, FACE_YMIN);
+					ctx->counts[index] = Builder_StretchX(ctx, index, x, y, z, cIndex, b, FACE_YMIN);
 				}
 
 				index++;
-				if (Builder_Counts[index] == 0 ||
-					(Blocks.Hidden[tileIdx + Builder_Chunk[cIndex + EXTCHUNK_SIZE_2]] & FACE_BIT_YMAX) != 0) {
-					Builder_Counts[index] = 0;
+				if (ctx->counts[index] == 0 ||
+					(Blocks.Hidden[tileIdx + ctx->chunk[cIndex + EXTCHUNK_SIZE_2]] & FACE_BIT_YMAX) != 0) {
+					ctx->counts[index] = 0;
 				} else if (b < BLOCK_WATER || b > BLOCK_STILL_LAVA) {
-					Builder_Counts[index] = Builder_StretchX(index, x, y, z, cIndex, b, FACE_YMAX);
+					ctx->counts[index] = Builder_StretchX(ctx, index, x, y, z, cIndex, b, FACE_YMAX);
 				} else {
-					Builder_Counts[index] = Builder_StretchXLiquid(index, x, y, z, cIndex, b);
+					ctx->counts[index] = Builder_StretchXLiquid(ctx, index, x, y, z, cIndex, b);
 				}
 			}
 		}
 	}
 }
 
+#ifdef CC_BUILD_COMPACTWORLD
+/* Blocks are looked up by coordinates instead, as there is no flat blocks array */
+#define ReadChunkRowIndex()
+#else
+#define ReadChunkRowIndex() index = World_Pack(x1 - 1, y, z1 + zz);
+#endif
+
+/* Rows are copied without any per block lookups, so that compilers can vectorise the copying */
 #define ReadChunkBody(get_block)\
 for (yy = -1; yy < 17; ++yy) {\
 	y = yy + y1;\
 	for (zz = -1; zz < 17; ++zz) {\
 \
-		index  = World_Pack(x1 - 1, y, z1 + zz);\
+		ReadChunkRowIndex();\
 		cIndex = Builder_PackChunk(-1, yy, zz);\
-		for (xx = -1; xx < 17; ++xx, ++index, ++cIndex) {\
+		for (xx = 0; xx < EXTCHUNK_SIZE; ++xx) {\
 \
-			block    = get_block;\
-			allAir   = allAir   && Blocks.Draw[block] == DRAW_GAS;\
-			allSolid = allSolid && Blocks.FullOpaque[block];\
-			Builder_Chunk[cIndex] = block;\
+			block = get_block;\
+			chunk[cIndex + xx] = block;\
+			anyBlocks |= block;\
 		}\
 	}\
 }
 
-static cc_bool ReadChunkData(int x1, int y1, int z1, cc_bool* outAllAir) {
+/* Returns whether every block in the given chunk array does not show */
+static cc_bool Builder_AllGas(const BlockID* chunk) {
+	int i;
+	for (i = 0; i < EXTCHUNK_SIZE_3; i++) {
+		if (Blocks.Draw[chunk[i]] != DRAW_GAS) return false;
+	}
+	return true;
+}
+
+/* Returns whether every block in the given chunk array completely covers blocks behind it */
+static cc_bool Builder_AllOpaque(const BlockID* chunk) {
+	int i;
+	for (i = 0; i < EXTCHUNK_SIZE_3; i++) {
+		if (!Blocks.FullOpaque[chunk[i]]) return false;
+	}
+	return true;
+}
+
+static cc_bool ReadChunkData(struct BuilderContext* ctx, int x1, int y1, int z1, cc_bool* outAllAir) {
+#ifndef CC_BUILD_COMPACTWORLD
 	BlockRaw* blocks = World.Blocks;
-	cc_bool allAir = true, allSolid = true;
-	int index, cIndex;
+	int index;
+#endif
+	BlockID* chunk   = ctx->chunk;
+	int anyBlocks    = 0;
+	int cIndex;
 	BlockID block;
 	int xx, yy, zz, y;
 
-#ifndef EXTENDED_BLOCKS
-	ReadChunkBody(blocks[index]);
+#if defined CC_BUILD_COMPACTWORLD
+	ReadChunkBody(World_GetBlock(x1 - 1 + xx, y, z1 + zz));
+#elif !defined EXTENDED_BLOCKS
+	ReadChunkBody(blocks[index + xx]);
 #else
 	BlockRaw* blocks2;
 
 	if (World.IDMask <= 0xFF) {
-		ReadChunkBody(blocks[index]);
+		ReadChunkBody(blocks[index + xx]);
 	} else {
 		blocks2 = World.Blocks2;
-		ReadChunkBody(blocks[index] | (blocks2[index] << 8));
+		ReadChunkBody(blocks[index + xx] | (blocks2[index + xx] << 8));
 	}
 #endif
 
-	*outAllAir = allAir;
-	return allSolid;
+	/* Usually a block that isn't gas (or isn't opaque) is found within the first few blocks checked */
+	*outAllAir = !anyBlocks || Builder_AllGas(chunk);
+	return !(*outAllAir) && Builder_AllOpaque(chunk);
 }
 
 #define ReadBorderChunkBody(get_block)\
@@ -306,20 +360,26 @@ for (yy = -1; yy < 17; ++yy) {\
 \
 			block  = get_block;\
 			allAir = allAir && Blocks.Draw[block] == DRAW_GAS;\
-			Builder_Chunk[cIndex] = block;\
+			ctx->chunk[cIndex] = block;\
 		}\
 	}\
 }
 
-static cc_bool ReadBorderChunkData(int x1, int y1, int z1, cc_bool* outAllAir) {
+static cc_bool ReadBorderChunkData(struct BuilderContext* ctx, int x1, int y1, int z1, cc_bool* outAllAir) {
+#ifndef CC_BUILD_COMPACTWORLD
 	BlockRaw* blocks = World.Blocks;
+#endif
+#if !defined CC_BUILD_COMPACTWORLD && defined EXTENDED_BLOCKS
 	BlockRaw* blocks2;
+#endif
 	cc_bool allAir = true;
 	int index, cIndex;
 	BlockID block;
 	int xx, yy, zz, x, y, z;
 
-#ifndef EXTENDED_BLOCKS
+#if defined CC_BUILD_COMPACTWORLD
+	ReadBorderChunkBody(World_GetBlock(x, y, z));
+#elif !defined EXTENDED_BLOCKS
 	ReadBorderChunkBody(blocks[index]);
 #else
 	if (World.IDMask <= 0xFF) {
@@ -334,33 +394,394 @@ static cc_bool ReadBorderChunkData(int x1, int y1, int z1, cc_bool* outAllAir) {
 	return false;
 }
 
-static void OutputChunkPartsMeta(int x, int y, int z, struct ChunkInfo* info) {
-	cc_bool hasNorm, hasTran;
-	int partsIndex;
+/* Outputs metadata for each part of the chunk mesh, where the parts for the i'th atlas are stored at [i * stride] */
+static int OutputChunkPartsMeta(struct BuilderContext* ctx, struct ChunkPartInfo* normal, struct ChunkPartInfo* translucent, 
+								int stride, int usedAtlases, cc_bool* hasNorm, cc_bool* hasTran) {
 	int i, j, curIdx, offset;
-	
-	partsIndex = World_ChunkPack(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT);
-	offset  = 0;
-	hasNorm = false;
-	hasTran = false;
+	offset   = 0;
+	*hasNorm = false;
+	*hasTran = false;
 
-	for (i = 0; i < MapRenderer_1DUsedCount; i++) {
+	for (i = 0; i < usedAtlases; i++) {
 		j = i + ATLAS1D_MAX_ATLASES;
-		curIdx = partsIndex + i * World.ChunksCount;
+		curIdx = i * stride;
+
+		*hasNorm |= SetPartInfo(&ctx->parts[i], &offset, &normal[curIdx]);
+		*hasTran |= SetPartInfo(&ctx->parts[j], &offset, &translucent[curIdx]);
+	}
+	return offset;
+}
+
+/* Sets the bits for every pair of faces in the given faces mask */
+static int Builder_ConnectFaces(int faces) {
+	int a, b, connectivity = 0;
+	for (a = 0; a < FACE_COUNT; a++) {
+		if (!(faces & (1 << a))) continue;
+
+		for (b = a + 1; b < FACE_COUNT; b++) {
+			if (faces & (1 << b)) connectivity |= ChunkInfo_FacesBit(a, b);
+		}
+	}
+	return connectivity;
+}
+
+#define Builder_ConnectCell(xx, yy, zz) \
+	index = ((yy) << 8) | ((zz) << 4) | (xx); \
+	if (!visited[index] && !Blocks.FullOpaque[ctx->chunk[Builder_PackChunk(xx, yy, zz)]]) { \
+		visited[index] = true; queue[tail++] = index; \
+	}
+
+/* Calculates which faces of the given chunk can be seen from each other through non-opaque blocks, */
+/*  by flood filling each separate region of non-opaque blocks in the chunk */
+static int Builder_CalcConnectivity(struct BuilderContext* ctx, int x1, int y1, int z1) {
+	/* counts isn't used until Builder_CountChunk, so reuse it for temp storage */
+	cc_uint16* queue  = (cc_uint16*)ctx->counts;
+	cc_uint8* visited = ctx->counts + CHUNK_SIZE_3 * sizeof(cc_uint16);
+	int maxX = min(World.Width  - x1, CHUNK_SIZE) - 1;
+	int maxY = min(World.Height - y1, CHUNK_SIZE) - 1;
+	int maxZ = min(World.Length - z1, CHUNK_SIZE) - 1;
+
+	int x, y, z, xx, yy, zz, index;
+	int head, tail, faces, connectivity = 0;
+	Mem_Set(visited, 0, CHUNK_SIZE_3);
+
+	for (y = 0; y <= maxY; y++) {
+		for (z = 0; z <= maxZ; z++) {
+			for (x = 0; x <= maxX; x++) {
+				head = 0; tail = 0; faces = 0;
+				Builder_ConnectCell(x, y, z);
+				if (!tail) continue;
+
+				while (head < tail) {
+					index = queue[head++];
+					xx = index & 0x0F; zz = (index >> 4) & 0x0F; yy = index >> 8;
+
+					if (xx == 0)    { faces |= FACE_BIT_XMIN; } else { Builder_ConnectCell(xx - 1, yy, zz); }
+					if (xx == maxX) { faces |= FACE_BIT_XMAX; } else { Builder_ConnectCell(xx + 1, yy, zz); }
+					if (zz == 0)    { faces |= FACE_BIT_ZMIN; } else { Builder_ConnectCell(xx, yy, zz - 1); }
+					if (zz == maxZ) { faces |= FACE_BIT_ZMAX; } else { Builder_ConnectCell(xx, yy, zz + 1); }
+					if (yy == 0)    { faces |= FACE_BIT_YMIN; } else { Builder_ConnectCell(xx, yy - 1, zz); }
+					if (yy == maxY) { faces |= FACE_BIT_YMAX; } else { Builder_ConnectCell(xx, yy + 1, zz); }
+				}
+
+				connectivity |= Builder_ConnectFaces(faces);
+				if (connectivity == CHUNK_ALL_CONNECTED) return connectivity;
+			}
+		}
+	}
+	return connectivity;
+}
+
+/*########################################################################################################################*
+*---------------------------------------------------LOD mesh builder------------------------------------------------------*
+*#########################################################################################################################*/
+/* Builds coarse meshes for far away chunks, where each cell of (2^lod x 2^lod x 2^lod) blocks is drawn as one cuboid */
+/* Cells are stored in the chunk/counts arrays the same way blocks are, just with fewer cells along each axis */
+#define LOD_EXTCELLS ((CHUNK_SIZE >> 1) + 2)
+#define Lod_PackCell(cx, cy, cz) ((((cy) + 1) * LOD_EXTCELLS + ((cz) + 1)) * LOD_EXTCELLS + ((cx) + 1))
+
+static void (*const Lod_Drawers[FACE_COUNT])(const struct _DrawerData* d, int count, PackedCol col, 
+											TextureLoc texLoc, struct VertexTextured** vertices) = {
+	Drawer_XMin2, Drawer_XMax2, Drawer_ZMin2, Drawer_ZMax2, Drawer_YMin2, Drawer_YMax2
+};
+
+/* Returns the block that the given cell of blocks is drawn as */
+/* The highest fully opaque block is preferred, so the coarse mesh always covers the */
+/*  full detail mesh of neighbouring chunks. Otherwise the highest non-sprite block is used. */
+static BlockID Lod_CellBlock(struct BuilderContext* ctx, int x1, int y1, int z1, int x2, int y2, int z2) {
+	BlockID block, best = BLOCK_AIR;
+	int x, y, z;
+
+	for (y = y2; y >= y1; y--) {
+		for (z = z1; z <= z2; z++) {
+			for (x = x1; x <= x2; x++) {
+				block = ctx->chunk[Builder_PackChunk(x, y, z)];
+				if (Blocks.FullOpaque[block]) return block;
+
+				if (best == BLOCK_AIR && Blocks.Draw[block] != DRAW_GAS && Blocks.Draw[block] != DRAW_SPRITE) best = block;
+			}
+		}
+	}
+	return best;
+}
+
+/* Returns the block that a cell bordering the chunk is treated as, when hiding faces of cells in the chunk */
+/* Only the layer of blocks directly touching the chunk is checked, so that a face is only hidden */
+/*  when the neighbouring chunk would not be visible through it at any level of detail */
+static BlockID Lod_BorderBlock(struct BuilderContext* ctx, int x1, int y1, int z1, int x2, int y2, int z2) {
+	BlockID block, first = ctx->chunk[Builder_PackChunk(x1, y1, z1)];
+	cc_bool same = true, opaque = Blocks.FullOpaque[first];
+	int x, y, z;
+
+	for (y = y1; y <= y2; y++) {
+		for (z = z1; z <= z2; z++) {
+			for (x = x1; x <= x2; x++) {
+				block   = ctx->chunk[Builder_PackChunk(x, y, z)];
+				same   &= block == first;
+				opaque &= Blocks.FullOpaque[block];
+				if (!same && !opaque) return BLOCK_AIR;
+			}
+		}
+	}
+	return first;
+}
+
+/* Replaces the blocks read by ReadChunkData with the blocks that each cell of the chunk is drawn as */
+static void Lod_ReadChunk(struct BuilderContext* ctx, int x1, int y1, int z1) {
+	BlockID cells[LOD_EXTCELLS * LOD_EXTCELLS * LOD_EXTCELLS];
+	int lod   = ctx->lod, scale = 1 << lod;
+	int maxX  = min(World.Width  - x1, CHUNK_SIZE) - 1;
+	int maxY  = min(World.Height - y1, CHUNK_SIZE) - 1;
+	int maxZ  = min(World.Length - z1, CHUNK_SIZE) - 1;
+	int cellsX = (maxX >> lod) + 1, cellsY = (maxY >> lod) + 1, cellsZ = (maxZ >> lod) + 1;
+	int cx, cy, cz, x, y, z, xx, yy, zz;
+	Mem_Set(cells, BLOCK_AIR, sizeof(cells));
+
+	for (cy = 0; cy < cellsY; cy++) {
+		y = cy << lod; yy = min(y + scale - 1, maxY);
+
+		for (cz = 0; cz < cellsZ; cz++) {
+			z = cz << lod; zz = min(z + scale - 1, maxZ);
+
+			for (cx = 0; cx < cellsX; cx++) {
+				x = cx << lod; xx = min(x + scale - 1, maxX);
+				cells[Lod_PackCell(cx, cy, cz)] = Lod_CellBlock(ctx, x, y, z, xx, yy, zz);
+			}
+			cells[Lod_PackCell(-1,     cy, cz)] = Lod_BorderBlock(ctx, -1,       y, z, -1,       yy, zz);
+			cells[Lod_PackCell(cellsX, cy, cz)] = Lod_BorderBlock(ctx, maxX + 1, y, z, maxX + 1, yy, zz);
+		}
 
-		hasNorm |= SetPartInfo(&Builder_Parts[i], &offset, &MapRenderer_PartsNormal[curIdx]);
-		hasTran |= SetPartInfo(&Builder_Parts[j], &offset, &MapRenderer_PartsTranslucent[curIdx]);
+		for (cx = 0; cx < cellsX; cx++) {
+			x = cx << lod; xx = min(x + scale - 1, maxX);
+			cells[Lod_PackCell(cx, cy, -1)]     = Lod_BorderBlock(ctx, x, y, -1,       xx, yy, -1);
+			cells[Lod_PackCell(cx, cy, cellsZ)] = Lod_BorderBlock(ctx, x, y, maxZ + 1, xx, yy, maxZ + 1);
+		}
 	}
 
-	if (hasNorm) {
-		info->normalParts      = &MapRenderer_PartsNormal[partsIndex];
+	for (cz = 0; cz < cellsZ; cz++) {
+		z = cz << lod; zz = min(z + scale - 1, maxZ);
+
+		for (cx = 0; cx < cellsX; cx++) {
+			x = cx << lod; xx = min(x + scale - 1, maxX);
+			cells[Lod_PackCell(cx, -1,     cz)] = Lod_BorderBlock(ctx, x, -1,       z, xx, -1,       zz);
+			cells[Lod_PackCell(cx, cellsY, cz)] = Lod_BorderBlock(ctx, x, maxY + 1, z, xx, maxY + 1, zz);
+		}
 	}
-	if (hasTran) {
-		info->translucentParts = &MapRenderer_PartsTranslucent[partsIndex];
+
+	/* Cells are calculated separately first, as they overwrite the blocks they are calculated from */
+	for (cy = -1; cy <= cellsY; cy++) {
+		for (cz = -1; cz <= cellsZ; cz++) {
+			for (cx = -1; cx <= cellsX; cx++) {
+				ctx->chunk[Builder_PackChunk(cx, cy, cz)] = cells[Lod_PackCell(cx, cy, cz)];
+			}
+		}
+	}
+}
+
+/* Whether the faces of a block on the outside of the map are hidden by the map's sides/edge (see PrepareChunk) */
+static cc_bool Lod_HiddenByEdge(BlockID block, int y) {
+	return y < Builder_SidesLevel || (block >= BLOCK_WATER && block <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel);
+}
+
+static int Lod_CountChunk(struct BuilderContext* ctx, int x1, int y1, int z1) {
+	int lod = ctx->lod, scale = 1 << lod;
+	int cx, cy, cz, x, y, z, yTop;
+	int cIndex, index, face, hidden;
+	BlockID b;
+
+	Mem_Set(ctx->counts, 0, CHUNK_SIZE_3 * FACE_COUNT);
+	ctx->chunkEndX = min(World.Width,  x1 + CHUNK_SIZE);
+	ctx->chunkEndY = min(World.Height, y1 + CHUNK_SIZE);
+	ctx->chunkEndZ = min(World.Length, z1 + CHUNK_SIZE);
+
+	for (y = y1, cy = 0; y < ctx->chunkEndY; y += scale, cy++) {
+		yTop = min(y + scale, ctx->chunkEndY) - 1;
+
+		for (z = z1, cz = 0; z < ctx->chunkEndZ; z += scale, cz++) {
+			for (x = x1, cx = 0; x < ctx->chunkEndX; x += scale, cx++) {
+				cIndex = Builder_PackChunk(cx, cy, cz);
+				b      = ctx->chunk[cIndex];
+				if (Blocks.Draw[b] == DRAW_GAS) continue;
+
+				index  = Builder_PackCount(cx, cy, cz);
+				hidden = y == 0 ? FACE_BIT_YMIN : 0;
+
+				if (Lod_HiddenByEdge(b, yTop)) {
+					if (x == 0)                  hidden |= FACE_BIT_XMIN;
+					if (x + scale > World.MaxX)  hidden |= FACE_BIT_XMAX;
+					if (z == 0)                  hidden |= FACE_BIT_ZMIN;
+					if (z + scale > World.MaxZ)  hidden |= FACE_BIT_ZMAX;
+				}
+
+				for (face = 0; face < FACE_COUNT; face++) {
+					if ((hidden & (1 << face)) || Block_IsFaceHidden(b, ctx->chunk[cIndex + Builder_Offsets[face]], face)) continue;
+
+					ctx->counts[index + face] = 1;
+					AddVertices(ctx, b, face);
+				}
+			}
+		}
+	}
+	return Builder_TotalVerticesCount(ctx);
+}
+
+static PackedCol Lod_LightColor(int x1, int y1, int z1, int x2, int y2, int z2, int face) {
+	/* Sides use the light of the topmost blocks in the cell, as lower blocks are more likely to be in shadow */
+	switch (face) {
+	case FACE_XMIN:
+		return x1 == 0          ? Env.SunXSide : Lighting.Color_XSide_Fast(x1 - 1, y2 - 1, z1);
+	case FACE_XMAX:
+		return x2 > World.MaxX  ? Env.SunXSide : Lighting.Color_XSide_Fast(x2,     y2 - 1, z1);
+	case FACE_ZMIN:
+		return z1 == 0          ? Env.SunZSide : Lighting.Color_ZSide_Fast(x1, y2 - 1, z1 - 1);
+	case FACE_ZMAX:
+		return z2 > World.MaxZ  ? Env.SunZSide : Lighting.Color_ZSide_Fast(x1, y2 - 1, z2);
+
+	case FACE_YMIN:
+		return Lighting.Color_YMin_Fast(x1, y1 - 1, z1);
+	case FACE_YMAX:
+		return Lighting.Color_YMax_Fast(x1, y2,     z1);
+	}
+	return 0; /* should never happen */
+}
+
+static void Lod_RenderCell(struct BuilderContext* ctx, int index, BlockID block, int x, int y, int z) {
+	struct _DrawerData* d = &ctx->drawer;
+	int scale      = 1 << ctx->lod;
+	int baseOffset = (Blocks.Draw[block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
+	cc_bool fullBright = Blocks.Brightness[block];
+	int x2, y2, z2, face;
+
+	struct Builder1DPart* part;
+	TextureLoc loc;
+	PackedCol col;
+
+	x2 = min(x + scale, ctx->chunkEndX);
+	y2 = min(y + scale, ctx->chunkEndY);
+	z2 = min(z + scale, ctx->chunkEndZ);
+	d->X1 = x;  d->Y1 = y;  d->Z1 = z;
+	d->X2 = x2; d->Y2 = y2; d->Z2 = z2;
+
+	/* Texture is stretched across the whole cell, instead of repeated for each block */
+	Vec3_Set(d->MinBB, 0.0f, 1.0f, 0.0f);
+	Vec3_Set(d->MaxBB, 1.0f, 0.0f, 1.0f);
+	d->Tinted  = Blocks.Tinted[block];
+	d->TintCol = Blocks.FogCol[block];
+
+	for (face = 0; face < FACE_COUNT; face++) {
+		if (!ctx->counts[index + face]) continue;
+
+		loc  = Block_Tex(block, face);
+		part = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
+		col  = fullBright ? PACKEDCOL_WHITE : Lod_LightColor(x, y, z, x2, y2, z2, face);
+		Lod_Drawers[face](d, 1, col, loc, &part->faces.vertices[face]);
+	}
+}
+
+static void Lod_RenderChunk(struct BuilderContext* ctx, int x1, int y1, int z1) {
+	int scale = 1 << ctx->lod;
+	int cx, cy, cz, x, y, z;
+	BlockID b;
+	Builder_PostPrepareChunk(ctx);
+
+	for (y = y1, cy = 0; y < ctx->chunkEndY; y += scale, cy++) {
+		for (z = z1, cz = 0; z < ctx->chunkEndZ; z += scale, cz++) {
+			for (x = x1, cx = 0; x < ctx->chunkEndX; x += scale, cx++) {
+				b = ctx->chunk[Builder_PackChunk(cx, cy, cz)];
+				if (Blocks.Draw[b] == DRAW_GAS) continue;
+
+				Lod_RenderCell(ctx, Builder_PackCount(cx, cy, cz), b, x, y, z);
+			}
+		}
+	}
+}
+
+
+/* Reads the blocks in the given chunk (and the blocks immediately bordering it), */
+/*  and calculates which faces of the chunk are connected to each other */
+/* When building at a coarser level of detail, the blocks are then replaced with cells of blocks */
+/* Returns false if the chunk does not need a mesh (i.e. it is all air or all solid) */
+static cc_bool Builder_ReadChunk(struct BuilderContext* ctx, int x1, int y1, int z1, cc_bool* allAir, cc_uint16* connectivity) {
+	cc_bool allSolid, onBorder;
+
+	/* Chunks known to be completely air never need a mesh, so don't bother reading them */
+	if (World_IsAirChunk(x1 >> CHUNK_SHIFT, y1 >> CHUNK_SHIFT, z1 >> CHUNK_SHIFT)) {
+		*allAir       = true;
+		*connectivity = CHUNK_ALL_CONNECTED;
+		return false;
+	}
+	Builder_PrePrepareChunk(ctx);
+
+	onBorder = 
+		x1 == 0 || y1 == 0 || z1 == 0   || x1 + CHUNK_SIZE >= World.Width ||
+		y1 + CHUNK_SIZE >= World.Height || z1 + CHUNK_SIZE >= World.Length;
+
+	if (onBorder) {
+		/* less optimal case here */
+		Mem_Set(ctx->chunk, BLOCK_AIR, EXTCHUNK_SIZE_3 * sizeof(BlockID));
+		allSolid = ReadBorderChunkData(ctx, x1, y1, z1, allAir);
+	} else {
+		allSolid = ReadChunkData(ctx, x1, y1, z1, allAir);
+	}
+
+	if (*allAir) {
+		*connectivity = CHUNK_ALL_CONNECTED;
+	} else if (allSolid) {
+		*connectivity = 0;
+	} else {
+		*connectivity = Builder_CalcConnectivity(ctx, x1, y1, z1);
+	}
+
+	if (*allAir || allSolid) return false;
+	if (ctx->lod) Lod_ReadChunk(ctx, x1, y1, z1);
+	return true;
+}
+
+/* Calculates which faces of the blocks in the given chunk need to be drawn */
+/* Returns total number of vertices in the chunk's mesh */
+/* NOTE: Lighting.LightHint must have been called for the chunk beforehand */
+static int Builder_CountChunk(struct BuilderContext* ctx, int x1, int y1, int z1) {
+	if (ctx->lod) return Lod_CountChunk(ctx, x1, y1, z1);
+
+	Mem_Set(ctx->counts, 1, CHUNK_SIZE_3 * FACE_COUNT);
+	ctx->chunkEndX = min(World.Width,  x1 + CHUNK_SIZE);
+	ctx->chunkEndY = min(World.Height, y1 + CHUNK_SIZE);
+	ctx->chunkEndZ = min(World.Length, z1 + CHUNK_SIZE);
+
+	PrepareChunk(ctx, x1, y1, z1);
+	return Builder_TotalVerticesCount(ctx);
+}
+
+/* Generates the vertices for all the visible block faces in the given chunk */
+static void Builder_RenderChunk(struct BuilderContext* ctx, int x1, int y1, int z1) {
+	int xMax, yMax, zMax;
+	int cIndex, index;
+	int x, y, z, xx, yy, zz;
+	if (ctx->lod) { Lod_RenderChunk(ctx, x1, y1, z1); return; }
+
+	xMax = min(World.Width,  x1 + CHUNK_SIZE);
+	yMax = min(World.Height, y1 + CHUNK_SIZE);
+	zMax = min(World.Length, z1 + CHUNK_SIZE);
+	Builder_PostPrepareChunk(ctx);
+
+	for (y = y1, yy = 0; y < yMax; y++, yy++) {
+		for (z = z1, zz = 0; z < zMax; z++, zz++) {
+			cIndex = Builder_PackChunk(0, yy, zz);
+
+			for (x = x1, xx = 0; x < xMax; x++, xx++, cIndex++) {
+				ctx->block = ctx->chunk[cIndex];
+				if (Blocks.Draw[ctx->block] == DRAW_GAS) continue;
+
+				index = Builder_PackCount(xx, yy, zz);
+				ctx->chunkIndex = cIndex;
+				Builder_RenderBlock(ctx, index, x, y, z);
+			}
+		}
 	}
 }
 
 cc_bool Builder_MakeChunk(struct ChunkInfo* info) {
+	struct BuilderContext* ctx = &Builder_MainCtx;
 #if CC_BUILD_MAXSTACK <= (32 * 1024)
 	void* mem        = TempMem_Alloc((EXTCHUNK_SIZE_3 * sizeof(BlockID)) + (CHUNK_SIZE_3 * FACE_COUNT));
 	BlockID* chunk   = (BlockID*)mem;
@@ -375,125 +796,90 @@ cc_bool Builder_MakeChunk(struct ChunkInfo* info) {
 #else
 	int bitFlags[1];
 #endif
+#ifdef BUILDER_GREEDY_MESHING
+	cc_uint8 spans[CHUNK_SIZE_3 * FACE_COUNT];
+#else
+	cc_uint8 spans[1];
+#endif
 
-	cc_bool allAir, allSolid, onBorder;
-	int xMax, yMax, zMax, totalVerts;
-	int cIndex, index;
-	int x, y, z, xx, yy, zz;
+	cc_bool allAir, needsMesh, hasNorm, hasTran;
+	cc_uint16 connectivity;
+	int partsIndex, totalVerts;
 	int x1 = info->centreX - HALF_CHUNK_SIZE;
 	int y1 = info->centreY - HALF_CHUNK_SIZE;
 	int z1 = info->centreZ - HALF_CHUNK_SIZE;
 
-	Builder_Chunk  = chunk;
-	Builder_Counts = counts;
-	Builder_BitFlags = bitFlags;
-	Builder_PrePrepareChunk();
-	
-	onBorder = 
-		x1 == 0 || y1 == 0 || z1 == 0   || x1 + CHUNK_SIZE >= World.Width ||
-		y1 + CHUNK_SIZE >= World.Height || z1 + CHUNK_SIZE >= World.Length;
-
-	if (onBorder) {
-		/* less optimal case here */
-		Mem_Set(chunk, BLOCK_AIR, EXTCHUNK_SIZE_3 * sizeof(BlockID));
-		allSolid = ReadBorderChunkData(x1, y1, z1, &allAir);
-	} else {
-		allSolid = ReadChunkData(x1, y1, z1, &allAir);
-	}
-
-	info->allAir = allAir;
-	if (allAir || allSolid) return true;
+	ctx->chunk    = chunk;
+	ctx->counts   = counts;
+	ctx->bitFlags = bitFlags;
+	ctx->light    = (PackedCol*)bitFlags;
+	ctx->spans    = spans;
+	ctx->lod      = info->lod;
+	needsMesh     = Builder_ReadChunk(ctx, x1, y1, z1, &allAir, &connectivity);
+
+	info->allAir       = allAir;
+	info->connectivity = connectivity;
+	if (!needsMesh) return true;
 	Lighting.LightHint(x1 - 1, y1 - 1, z1 - 1);
 
-	Mem_Set(counts, 1, CHUNK_SIZE_3 * FACE_COUNT);
-	xMax = min(World.Width,  x1 + CHUNK_SIZE);
-	yMax = min(World.Height, y1 + CHUNK_SIZE);
-	zMax = min(World.Length, z1 + CHUNK_SIZE);
-
-	Builder_ChunkEndX = xMax; Builder_ChunkEndZ = zMax;
-	PrepareChunk(x1, y1, z1);
-
-	totalVerts = Builder_TotalVerticesCount();
+	totalVerts = Builder_CountChunk(ctx, x1, y1, z1);
 	if (!totalVerts) return true;
-	
-	OutputChunkPartsMeta(x1, y1, z1, info);
-#ifdef OCCLUSION
-	if (info.NormalParts != null || info.TranslucentParts != null)
-		info.occlusionFlags = (cc_uint8)ComputeOcclusion();
-#endif
 
+	partsIndex = World_ChunkPack(x1 >> CHUNK_SHIFT, y1 >> CHUNK_SHIFT, z1 >> CHUNK_SHIFT);
+	OutputChunkPartsMeta(ctx, &MapRenderer_PartsNormal[partsIndex], &MapRenderer_PartsTranslucent[partsIndex],
+						World.ChunksCount, MapRenderer_1DUsedCount, &hasNorm, &hasTran);
+
+	if (hasNorm) info->normalParts      = &MapRenderer_PartsNormal[partsIndex];
+	if (hasTran) info->translucentParts = &MapRenderer_PartsTranslucent[partsIndex];
 #if CC_GFX_BACKEND != CC_GFX_BACKEND_GL11
 	/* add an extra element to fix crashing on some GPUs */
 	info->vb = Gfx_TryCreateStaticVb(VERTEX_FORMAT_TEXTURED, totalVerts + 1);
 	if (!info->vb) return false;
 
-	Builder_Vertices = (struct VertexTextured*)Gfx_LockVb(info->vb,
+	ctx->vertices = (struct VertexTextured*)Gfx_LockVb(info->vb,
 													VERTEX_FORMAT_TEXTURED, totalVerts + 1);
 #else
 	/* NOTE: Relies on assumption vb is ignored by GL11 Gfx_LockVb implementation */
-	Builder_Vertices = (struct VertexTextured*)Gfx_LockVb(0, 
+	ctx->vertices = (struct VertexTextured*)Gfx_LockVb(0, 
 													VERTEX_FORMAT_TEXTURED, totalVerts + 1);
 #endif
-	Builder_PostPrepareChunk();
 	/* now render the chunk */
-
-	for (y = y1, yy = 0; y < yMax; y++, yy++) {
-		for (z = z1, zz = 0; z < zMax; z++, zz++) {
-			cIndex = Builder_PackChunk(0, yy, zz);
-
-			for (x = x1, xx = 0; x < xMax; x++, xx++, cIndex++) {
-				Builder_Block = chunk[cIndex];
-				if (Blocks.Draw[Builder_Block] == DRAW_GAS) continue;
-
-				index = Builder_PackCount(xx, yy, zz);
-				Builder_ChunkIndex = cIndex;
-				Builder_RenderBlock(index, x, y, z);
-			}
-		}
-	}
+	Builder_RenderChunk(ctx, x1, y1, z1);
 
 #if CC_GFX_BACKEND == CC_GFX_BACKEND_GL11
-	cIndex = World_ChunkPack(x1 >> CHUNK_SHIFT, y1 >> CHUNK_SHIFT, z1 >> CHUNK_SHIFT);
-
-	for (index = 0; index < MapRenderer_1DUsedCount; index++) {
-		int curIdx = cIndex + index * World.ChunksCount;
-
-		BuildPartVbs(&MapRenderer_PartsNormal[curIdx]);
-		BuildPartVbs(&MapRenderer_PartsTranslucent[curIdx]);
-	}
+	BuildChunkPartVbs(ctx, partsIndex);
 #else
 	Gfx_UnlockVb(info->vb);
 #endif
 	return true;
 }
 
-static cc_bool Builder_OccludedLiquid(int chunkIndex) {
+static cc_bool Builder_OccludedLiquid(struct BuilderContext* ctx, int chunkIndex) {
 	chunkIndex += EXTCHUNK_SIZE_2; /* Checking y above */
 	return
-		Blocks.FullOpaque[Builder_Chunk[chunkIndex]]
-		&& Blocks.Draw[Builder_Chunk[chunkIndex - EXTCHUNK_SIZE]] != DRAW_GAS
-		&& Blocks.Draw[Builder_Chunk[chunkIndex - 1]] != DRAW_GAS
-		&& Blocks.Draw[Builder_Chunk[chunkIndex + 1]] != DRAW_GAS
-		&& Blocks.Draw[Builder_Chunk[chunkIndex + EXTCHUNK_SIZE]] != DRAW_GAS;
+		Blocks.FullOpaque[ctx->chunk[chunkIndex]]
+		&& Blocks.Draw[ctx->chunk[chunkIndex - EXTCHUNK_SIZE]] != DRAW_GAS
+		&& Blocks.Draw[ctx->chunk[chunkIndex - 1]] != DRAW_GAS
+		&& Blocks.Draw[ctx->chunk[chunkIndex + 1]] != DRAW_GAS
+		&& Blocks.Draw[ctx->chunk[chunkIndex + EXTCHUNK_SIZE]] != DRAW_GAS;
 }
 
-static void DefaultPrePrepateChunk(void) {
-	Mem_Set(Builder_Parts, 0, sizeof(Builder_Parts));
+static void DefaultPrePrepateChunk(struct BuilderContext* ctx) {
+	Mem_Set(ctx->parts, 0, sizeof(ctx->parts));
 }
 
-static void DefaultPostStretchChunk(void) {
+static void DefaultPostStretchChunk(struct BuilderContext* ctx) {
 	int i, j, offset;
 	offset = 0;
 	for (i = 0; i < ATLAS1D_MAX_ATLASES; i++) {
 		j = i + ATLAS1D_MAX_ATLASES;
 
-		offset = Builder1DPart_CalcOffsets(&Builder_Parts[i], offset);
-		offset = Builder1DPart_CalcOffsets(&Builder_Parts[j], offset);
+		offset = Builder1DPart_CalcOffsets(ctx, &ctx->parts[i], offset);
+		offset = Builder1DPart_CalcOffsets(ctx, &ctx->parts[j], offset);
 	}
 }
 
-static RNGState spriteRng;
-static void Builder_DrawSprite(int x, int y, int z) {
+static void Builder_DrawSprite(struct BuilderContext* ctx, int x, int y, int z) {
 	struct Builder1DPart* part;
 	struct VertexTextured* v;
 	cc_uint8 offsetType;
@@ -512,29 +898,29 @@ static void Builder_DrawSprite(int x, int y, int z) {
 
 #define s_u1 0.0f
 #define s_u2 UV2_Scale
-	loc = Block_Tex(Builder_Block, FACE_XMAX);
+	loc = Block_Tex(ctx->block, FACE_XMAX);
 	v1  = Atlas1D_RowId(loc) * Atlas1D.InvTileSize;
 	v2  = v1 + Atlas1D.InvTileSize * UV2_Scale;
 
-	offsetType = Blocks.SpriteOffset[Builder_Block];
+	offsetType = Blocks.SpriteOffset[ctx->block];
 	if (offsetType >= 6 && offsetType <= 7) {
-		Random_Seed(&spriteRng, (x + 1217 * z) & 0x7fffffff);
-		valX = Random_Range(&spriteRng, -3, 3 + 1) / 16.0f;
-		valY = Random_Range(&spriteRng, 0,  3 + 1) / 16.0f;
-		valZ = Random_Range(&spriteRng, -3, 3 + 1) / 16.0f;
+		Random_Seed(&ctx->spriteRng, (x + 1217 * z) & 0x7fffffff);
+		valX = Random_Range(&ctx->spriteRng, -3, 3 + 1) / 16.0f;
+		valY = Random_Range(&ctx->spriteRng, 0,  3 + 1) / 16.0f;
+		valZ = Random_Range(&ctx->spriteRng, -3, 3 + 1) / 16.0f;
 
 		x1 += valX - 1.7f/16.0f; x2 += valX + 1.7f/16.0f;
 		z1 += valZ - 1.7f/16.0f; z2 += valZ + 1.7f/16.0f;
 		if (offsetType == 7) { y1 -= valY; y2 -= valY; }
 	}
 	
-	bright = Blocks.Brightness[Builder_Block];
-	part   = &Builder_Parts[Atlas1D_Index(loc)];
+	bright = Blocks.Brightness[ctx->block];
+	part   = &ctx->parts[Atlas1D_Index(loc)];
 	color  = bright ? PACKEDCOL_WHITE : Lighting.Color_Sprite_Fast(x, y, z);
-	Block_Tint(color, Builder_Block);
+	Block_Tint(color, ctx->block);
 
 	/* Draw Z axis */
-	v = &Builder_Vertices[part->sOffset];
+	v = &ctx->vertices[part->sOffset];
 	v->x = x1; v->y = y1; v->z = z1; v->Col = color; v->U = s_u2; v->V = v2; v++;
 	v->x = x1; v->y = y2; v->z = z1; v->Col = color; v->U = s_u2; v->V = v1; v++;
 	v->x = x2; v->y = y2; v->z = z2; v->Col = color; v->U = s_u1; v->V = v1; v++;
@@ -589,72 +975,89 @@ static PackedCol Normal_LightColor(int x, int y, int z, Face face, BlockID block
 	return 0; /* should never happen */
 }
 
-static cc_bool Normal_CanStretch(BlockID initial, int chunkIndex, int x, int y, int z, Face face) {
-	BlockID cur = Builder_Chunk[chunkIndex];
+static cc_bool Normal_CanStretch(struct BuilderContext* ctx, BlockID initial, int chunkIndex, int x, int y, int z, Face face) {
+	BlockID cur = ctx->chunk[chunkIndex];
 
-	if (cur != initial || Block_IsFaceHidden(cur, Builder_Chunk[chunkIndex + Builder_Offsets[face]], face)) return false;
-	if (Builder_FullBright) return true;
+	if (cur != initial || Block_IsFaceHidden(cur, ctx->chunk[chunkIndex + Builder_Offsets[face]], face)) return false;
+	if (ctx->fullBright) return true;
 
-	return Normal_LightColor(Builder_X, Builder_Y, Builder_Z, face, initial) == Normal_LightColor(x, y, z, face, cur);
+	return Normal_LightColor(ctx->x, ctx->y, ctx->z, face, initial) == Normal_LightColor(x, y, z, face, cur);
 }
 
-static int NormalBuilder_StretchXLiquid(int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
+static int NormalBuilder_StretchXLiquid(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
 	int count = 1; cc_bool stretchTile;
-	if (Builder_OccludedLiquid(chunkIndex)) return 0;
+	if (Builder_OccludedLiquid(ctx, chunkIndex)) return 0;
 	
 	x++;
 	chunkIndex++;
 	countIndex += FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << FACE_YMAX)) != 0;
 
-	while (x < Builder_ChunkEndX && stretchTile && Normal_CanStretch(block, chunkIndex, x, y, z, FACE_YMAX) && !Builder_OccludedLiquid(chunkIndex)) {
-		Builder_Counts[countIndex] = 0;
+	while (x < ctx->chunkEndX && stretchTile && Normal_CanStretch(ctx, block, chunkIndex, x, y, z, FACE_YMAX) && !Builder_OccludedLiquid(ctx, chunkIndex)) {
+		ctx->counts[countIndex] = 0;
 		count++;
 		x++;
 		chunkIndex++;
 		countIndex += FACE_COUNT;
 	}
-	AddVertices(block, FACE_YMAX);
+	AddVertices(ctx, block, FACE_YMAX);
 	return count;
 }
 
-static int NormalBuilder_StretchX(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+static int NormalBuilder_StretchX(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
 	int count = 1; cc_bool stretchTile;
 	x++;
 	chunkIndex++;
 	countIndex += FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << face)) != 0;
 
-	while (x < Builder_ChunkEndX && stretchTile && Normal_CanStretch(block, chunkIndex, x, y, z, face)) {
-		Builder_Counts[countIndex] = 0;
+	while (x < ctx->chunkEndX && stretchTile && Normal_CanStretch(ctx, block, chunkIndex, x, y, z, face)) {
+		ctx->counts[countIndex] = 0;
 		count++;
 		x++;
 		chunkIndex++;
 		countIndex += FACE_COUNT;
 	}
-	AddVertices(block, face);
+	AddVertices(ctx, block, face);
 	return count;
 }
 
-static int NormalBuilder_StretchZ(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+static int NormalBuilder_StretchZ(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
 	int count = 1; cc_bool stretchTile;
 	z++;
 	chunkIndex += EXTCHUNK_SIZE;
 	countIndex += CHUNK_SIZE * FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << face)) != 0;
 
-	while (z < Builder_ChunkEndZ && stretchTile && Normal_CanStretch(block, chunkIndex, x, y, z, face)) {
-		Builder_Counts[countIndex] = 0;
+	while (z < ctx->chunkEndZ && stretchTile && Normal_CanStretch(ctx, block, chunkIndex, x, y, z, face)) {
+		ctx->counts[countIndex] = 0;
 		count++;
 		z++;
 		chunkIndex += EXTCHUNK_SIZE;
 		countIndex += CHUNK_SIZE * FACE_COUNT;
 	}
-	AddVertices(block, face);
+	AddVertices(ctx, block, face);
 	return count;
 }
 
-static void NormalBuilder_RenderBlock(int index, int x, int y, int z) {	
+/* Returns cuboid state for drawing a face that was merged across the given number of rows */
+/*  (rows are along Y axis for side faces, and along Z axis for top and bottom faces) */
+static const struct _DrawerData* Normal_RowsDrawer(struct BuilderContext* ctx, struct _DrawerData* tmp, int rows, Face face) {
+	if (rows <= 1) return &ctx->drawer;
+	*tmp = ctx->drawer;
+	rows--;
+
+	/* NOTE: Drawer multiplies V2 by UV2_Scale, so undo that for the extra rows */
+	if (face >= FACE_YMIN) {
+		tmp->Z2 += rows; tmp->MaxBB.z += rows / UV2_Scale;
+	} else {
+		tmp->Y2 += rows; tmp->MinBB.y += rows / UV2_Scale;
+	}
+	return tmp;
+}
+#define Normal_FaceDrawer(face) (spans ? Normal_RowsDrawer(ctx, &rowsDrawer, spans[index + face], face) : &ctx->drawer)
+
+static void Normal_RenderBlock(struct BuilderContext* ctx, int index, int x, int y, int z, const cc_uint8* spans) {
 	/* counters */
 	int count_XMin, count_XMax, count_ZMin;
 	int count_ZMax, count_YMin, count_YMax;
@@ -666,97 +1069,102 @@ static void NormalBuilder_RenderBlock(int index, int x, int y, int z) {
 
 	/* per-face state */
 	struct Builder1DPart* part;
+	struct _DrawerData rowsDrawer;
 	TextureLoc loc;
 	PackedCol col;
 	int offset;
 
-	if (Blocks.Draw[Builder_Block] == DRAW_SPRITE) {
-		Builder_DrawSprite(x, y, z); return;
+	if (Blocks.Draw[ctx->block] == DRAW_SPRITE) {
+		Builder_DrawSprite(ctx, x, y, z); return;
 	}
 
-	count_XMin = Builder_Counts[index + FACE_XMIN];
-	count_XMax = Builder_Counts[index + FACE_XMAX];
-	count_ZMin = Builder_Counts[index + FACE_ZMIN];
-	count_ZMax = Builder_Counts[index + FACE_ZMAX];
-	count_YMin = Builder_Counts[index + FACE_YMIN];
-	count_YMax = Builder_Counts[index + FACE_YMAX];
+	count_XMin = ctx->counts[index + FACE_XMIN];
+	count_XMax = ctx->counts[index + FACE_XMAX];
+	count_ZMin = ctx->counts[index + FACE_ZMIN];
+	count_ZMax = ctx->counts[index + FACE_ZMAX];
+	count_YMin = ctx->counts[index + FACE_YMIN];
+	count_YMax = ctx->counts[index + FACE_YMAX];
 
 	if (!count_XMin && !count_XMax && !count_ZMin &&
 		!count_ZMax && !count_YMin && !count_YMax) return;
 
-	fullBright = Blocks.Brightness[Builder_Block];
-	baseOffset = (Blocks.Draw[Builder_Block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
-	lightFlags = Blocks.LightOffset[Builder_Block];
+	fullBright = Blocks.Brightness[ctx->block];
+	baseOffset = (Blocks.Draw[ctx->block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
+	lightFlags = Blocks.LightOffset[ctx->block];
 
-	Drawer.MinBB = Blocks.MinBB[Builder_Block]; Drawer.MinBB.y = 1.0f - Drawer.MinBB.y;
-	Drawer.MaxBB = Blocks.MaxBB[Builder_Block]; Drawer.MaxBB.y = 1.0f - Drawer.MaxBB.y;
+	ctx->drawer.MinBB = Blocks.MinBB[ctx->block]; ctx->drawer.MinBB.y = 1.0f - ctx->drawer.MinBB.y;
+	ctx->drawer.MaxBB = Blocks.MaxBB[ctx->block]; ctx->drawer.MaxBB.y = 1.0f - ctx->drawer.MaxBB.y;
 
-	min = Blocks.RenderMinBB[Builder_Block]; max = Blocks.RenderMaxBB[Builder_Block];
-	Drawer.X1 = x + min.x; Drawer.Y1 = y + min.y; Drawer.Z1 = z + min.z;
-	Drawer.X2 = x + max.x; Drawer.Y2 = y + max.y; Drawer.Z2 = z + max.z;
+	min = Blocks.RenderMinBB[ctx->block]; max = Blocks.RenderMaxBB[ctx->block];
+	ctx->drawer.X1 = x + min.x; ctx->drawer.Y1 = y + min.y; ctx->drawer.Z1 = z + min.z;
+	ctx->drawer.X2 = x + max.x; ctx->drawer.Y2 = y + max.y; ctx->drawer.Z2 = z + max.z;
 
-	Drawer.Tinted  = Blocks.Tinted[Builder_Block];
-	Drawer.TintCol = Blocks.FogCol[Builder_Block];
+	ctx->drawer.Tinted  = Blocks.Tinted[ctx->block];
+	ctx->drawer.TintCol = Blocks.FogCol[ctx->block];
 
 	if (count_XMin) {
-		loc    = Block_Tex(Builder_Block, FACE_XMIN);
+		loc    = Block_Tex(ctx->block, FACE_XMIN);
 		offset = (lightFlags >> FACE_XMIN) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		part   = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
 
 		col = fullBright ? PACKEDCOL_WHITE :
 			x >= offset ? Lighting.Color_XSide_Fast(x - offset, y, z) : Env.SunXSide;
-		Drawer_XMin(count_XMin, col, loc, &part->faces.vertices[FACE_XMIN]);
+		Drawer_XMin2(Normal_FaceDrawer(FACE_XMIN), count_XMin, col, loc, &part->faces.vertices[FACE_XMIN]);
 	}
 
 	if (count_XMax) {
-		loc    = Block_Tex(Builder_Block, FACE_XMAX);
+		loc    = Block_Tex(ctx->block, FACE_XMAX);
 		offset = (lightFlags >> FACE_XMAX) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		part   = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
 
 		col = fullBright ? PACKEDCOL_WHITE :
 			x <= (World.MaxX - offset) ? Lighting.Color_XSide_Fast(x + offset, y, z) : Env.SunXSide;
-		Drawer_XMax(count_XMax, col, loc, &part->faces.vertices[FACE_XMAX]);
+		Drawer_XMax2(Normal_FaceDrawer(FACE_XMAX), count_XMax, col, loc, &part->faces.vertices[FACE_XMAX]);
 	}
 
 	if (count_ZMin) {
-		loc    = Block_Tex(Builder_Block, FACE_ZMIN);
+		loc    = Block_Tex(ctx->block, FACE_ZMIN);
 		offset = (lightFlags >> FACE_ZMIN) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		part   = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
 
 		col = fullBright ? PACKEDCOL_WHITE :
 			z >= offset ? Lighting.Color_ZSide_Fast(x, y, z - offset) : Env.SunZSide;
-		Drawer_ZMin(count_ZMin, col, loc, &part->faces.vertices[FACE_ZMIN]);
+		Drawer_ZMin2(Normal_FaceDrawer(FACE_ZMIN), count_ZMin, col, loc, &part->faces.vertices[FACE_ZMIN]);
 	}
 
 	if (count_ZMax) {
-		loc    = Block_Tex(Builder_Block, FACE_ZMAX);
+		loc    = Block_Tex(ctx->block, FACE_ZMAX);
 		offset = (lightFlags >> FACE_ZMAX) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		part   = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
 
 		col = fullBright ? PACKEDCOL_WHITE :
 			z <= (World.MaxZ - offset) ? Lighting.Color_ZSide_Fast(x, y, z + offset) : Env.SunZSide;
-		Drawer_ZMax(count_ZMax, col, loc, &part->faces.vertices[FACE_ZMAX]);
+		Drawer_ZMax2(Normal_FaceDrawer(FACE_ZMAX), count_ZMax, col, loc, &part->faces.vertices[FACE_ZMAX]);
 	}
 
 	if (count_YMin) {
-		loc    = Block_Tex(Builder_Block, FACE_YMIN);
+		loc    = Block_Tex(ctx->block, FACE_YMIN);
 		offset = (lightFlags >> FACE_YMIN) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		part   = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
 
 		col = fullBright ? PACKEDCOL_WHITE : Lighting.Color_YMin_Fast(x, y - offset, z);
-		Drawer_YMin(count_YMin, col, loc, &part->faces.vertices[FACE_YMIN]);
+		Drawer_YMin2(Normal_FaceDrawer(FACE_YMIN), count_YMin, col, loc, &part->faces.vertices[FACE_YMIN]);
 	}
 
 	if (count_YMax) {
-		loc    = Block_Tex(Builder_Block, FACE_YMAX);
+		loc    = Block_Tex(ctx->block, FACE_YMAX);
 		offset = (lightFlags >> FACE_YMAX) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		part   = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
 
 		col = fullBright ? PACKEDCOL_WHITE : Lighting.Color_YMax_Fast(x, y + offset, z);
-		Drawer_YMax(count_YMax, col, loc, &part->faces.vertices[FACE_YMAX]);
+		Drawer_YMax2(Normal_FaceDrawer(FACE_YMAX), count_YMax, col, loc, &part->faces.vertices[FACE_YMAX]);
 	}
 }
 
+static void NormalBuilder_RenderBlock(struct BuilderContext* ctx, int index, int x, int y, int z) {
+	Normal_RenderBlock(ctx, index, x, y, z, NULL);
+}
+
 static void Builder_SetDefault(void) {
 	Builder_StretchXLiquid = NULL;
 	Builder_StretchX       = NULL;
@@ -776,16 +1184,115 @@ static void NormalBuilder_SetActive(void) {
 }
 
 
+/*########################################################################################################################*
+*--------------------------------------------------Greedy mesh builder----------------------------------------------------*
+*#########################################################################################################################*/
+#ifdef BUILDER_GREEDY_MESHING
+/* Whether faces of the given block can be merged along the face's V axis */
+static cc_bool Greedy_CanStretchV(BlockID block, Face face) {
+	if (face >= FACE_YMIN) {
+		return Blocks.MinBB[block].z == 0.0f && Blocks.MaxBB[block].z == 1.0f;
+	}
+	return Blocks.MinBB[block].y == 0.0f && Blocks.MaxBB[block].y == 1.0f;
+}
+
+static cc_bool Greedy_CanMerge(struct BuilderContext* ctx, BlockID initial, int countIndex, int chunkIndex, int x, int y, int z, Face face, cc_bool liquid) {
+	/* Face may have already been merged into a face from a previous row */
+	if (!ctx->counts[countIndex]) return false;
+	if (!Normal_CanStretch(ctx, initial, chunkIndex, x, y, z, face)) return false;
+	return !liquid || !Builder_OccludedLiquid(ctx, chunkIndex);
+}
+
+/* Merges faces along the face's U axis (same as normal mesh builder), */
+/*  then keeps merging further rows of faces along the face's V axis */
+static int Greedy_Stretch(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face, cc_bool liquid) {
+	int uX, uZ, uChunk, uCount; /* step along U axis */
+	int vY, vZ, vChunk, vCount; /* step along V axis */
+	int count = 1, rows = 1, maxCount, maxRows;
+	int i, cIndex, index;
+
+	if (face <= FACE_XMAX) {
+		uX = 0; uZ = 1; uChunk = EXTCHUNK_SIZE; uCount = CHUNK_SIZE * FACE_COUNT;
+		maxCount = ctx->chunkEndZ - z;
+	} else {
+		uX = 1; uZ = 0; uChunk = 1;             uCount = FACE_COUNT;
+		maxCount = ctx->chunkEndX - x;
+	}
+
+	if (face >= FACE_YMIN) {
+		vY = 0; vZ = 1; vChunk = EXTCHUNK_SIZE;   vCount = CHUNK_SIZE   * FACE_COUNT;
+		maxRows = ctx->chunkEndZ - z;
+	} else {
+		vY = 1; vZ = 0; vChunk = EXTCHUNK_SIZE_2; vCount = CHUNK_SIZE_2 * FACE_COUNT;
+		maxRows = ctx->chunkEndY - y;
+	}
+	/* Merged face's V coords must stay within the tile's strip of copies in the 1D atlas */
+	maxRows = min(maxRows, Atlas1D.TileRepeats);
+
+	if (Blocks.CanStretch[block] & (1 << face)) {
+		cIndex = chunkIndex + uChunk;
+		index  = countIndex + uCount;
+
+		while (count < maxCount && Greedy_CanMerge(ctx, block, index, cIndex,
+				x + count * uX, y, z + count * uZ, face, liquid)) {
+			ctx->counts[index] = 0;
+			count++;
+			cIndex += uChunk;
+			index  += uCount;
+		}
+	}
+
+	if (Greedy_CanStretchV(block, face)) {
+		for (; rows < maxRows; rows++) {
+			cIndex = chunkIndex + rows * vChunk;
+			index  = countIndex + rows * vCount;
+
+			for (i = 0; i < count; i++, cIndex += uChunk, index += uCount) {
+				if (!Greedy_CanMerge(ctx, block, index, cIndex,
+						x + i * uX, y + rows * vY, z + i * uZ + rows * vZ, face, liquid)) break;
+			}
+			if (i < count) break;
+
+			index = countIndex + rows * vCount;
+			for (i = 0; i < count; i++, index += uCount) { ctx->counts[index] = 0; }
+		}
+	}
+
+	ctx->spans[countIndex] = rows;
+	AddVertices(ctx, block, face);
+	return count;
+}
+
+static int GreedyBuilder_StretchXLiquid(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
+	if (Builder_OccludedLiquid(ctx, chunkIndex)) return 0;
+	return Greedy_Stretch(ctx, countIndex, x, y, z, chunkIndex, block, FACE_YMAX, true);
+}
+
+static int GreedyBuilder_StretchX(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+	return Greedy_Stretch(ctx, countIndex, x, y, z, chunkIndex, block, face, false);
+}
+
+static void GreedyBuilder_RenderBlock(struct BuilderContext* ctx, int index, int x, int y, int z) {
+	Normal_RenderBlock(ctx, index, x, y, z, ctx->spans);
+}
+
+static void GreedyBuilder_SetActive(void) {
+	Builder_SetDefault();
+	Builder_StretchXLiquid = GreedyBuilder_StretchXLiquid;
+	/* Greedy_Stretch works out which axes to merge along from the face */
+	Builder_StretchX       = GreedyBuilder_StretchX;
+	Builder_StretchZ       = GreedyBuilder_StretchX;
+	Builder_RenderBlock    = GreedyBuilder_RenderBlock;
+}
+#else
+static void GreedyBuilder_SetActive(void) { NormalBuilder_SetActive(); }
+#endif
+
+
 /*########################################################################################################################*
 *-------------------------------------------------Advanced mesh builder---------------------------------------------------*
 *#########################################################################################################################*/
 #ifdef CC_BUILD_ADVLIGHTING
-static Vec3 adv_minBB, adv_maxBB;
-static int adv_initBitFlags, adv_baseOffset;
-static int* adv_bitFlags;
-static float adv_x1, adv_y1, adv_z1, adv_x2, adv_y2, adv_z2;
-static PackedCol adv_lerp[5], adv_lerpX[5], adv_lerpZ[5], adv_lerpY[5];
-static cc_bool adv_tinted;
 
 enum ADV_MASK {
 	/* z-1 cube points */
@@ -810,7 +1317,7 @@ enum ADV_MASK {
 /* - bit 0 set: Y-1 is in light */
 /* - bit 1 set: Y   is in light */
 /* - bit 2 set: Y+1 is in light */
-static int Adv_Lit(int x, int y, int z, int cIndex) {
+static int Adv_Lit(struct BuilderContext* ctx, int x, int y, int z, int cIndex) {
 	int flags, offset, lightFlags;
 	BlockID block;
 	if (y < 0 || y >= World.Height) return LIT_M1 | LIT_CC | LIT_P1; /* all faces lit */
@@ -821,7 +1328,7 @@ static int Adv_Lit(int x, int y, int z, int cIndex) {
 	}
 
 	flags = 0;
-	block = Builder_Chunk[cIndex];
+	block = ctx->chunk[cIndex];
 	lightFlags = Blocks.LightOffset[block];
 
 	/* TODO using LIGHT_FLAG_SHADES_FROM_BELOW is wrong here, */
@@ -839,26 +1346,26 @@ static int Adv_Lit(int x, int y, int z, int cIndex) {
 	flags |= Lighting.IsLit_Fast(x, (y + 1) - offset, z) ? LIT_P1 : 0;
 
 	/* If a block is fullbright, it should also look as if that spot is lit */
-	if (Blocks.Brightness[Builder_Chunk[cIndex - 324]]) flags |= LIT_M1;
+	if (Blocks.Brightness[ctx->chunk[cIndex - 324]]) flags |= LIT_M1;
 	if (Blocks.Brightness[block])                       flags |= LIT_CC;
-	if (Blocks.Brightness[Builder_Chunk[cIndex + 324]]) flags |= LIT_P1;
+	if (Blocks.Brightness[ctx->chunk[cIndex + 324]]) flags |= LIT_P1;
 	
 	return flags;
 }
 
-static int Adv_ComputeLightFlags(int x, int y, int z, int cIndex) {
-	if (Builder_FullBright) return (1 << xP1_yP1_zP1) - 1; /* all faces fully bright */
+static int Adv_ComputeLightFlags(struct BuilderContext* ctx, int x, int y, int z, int cIndex) {
+	if (ctx->fullBright) return (1 << xP1_yP1_zP1) - 1; /* all faces fully bright */
 
 	return
-		Adv_Lit(x - 1, y, z - 1, cIndex - 1 - 18) << xM1_yM1_zM1 |
-		Adv_Lit(x - 1, y, z,     cIndex - 1)      << xM1_yM1_zCC |
-		Adv_Lit(x - 1, y, z + 1, cIndex - 1 + 18) << xM1_yM1_zP1 |
-		Adv_Lit(x,     y, z - 1, cIndex + 0 - 18) << xCC_yM1_zM1 |
-		Adv_Lit(x,     y, z,     cIndex + 0)      << xCC_yM1_zCC |
-		Adv_Lit(x,     y, z + 1, cIndex + 0 + 18) << xCC_yM1_zP1 |
-		Adv_Lit(x + 1, y, z - 1, cIndex + 1 - 18) << xP1_yM1_zM1 |
-		Adv_Lit(x + 1, y, z,     cIndex + 1)      << xP1_yM1_zCC |
-		Adv_Lit(x + 1, y, z + 1, cIndex + 1 + 18) << xP1_yM1_zP1;
+		Adv_Lit(ctx, x - 1, y, z - 1, cIndex - 1 - 18) << xM1_yM1_zM1 |
+		Adv_Lit(ctx, x - 1, y, z,     cIndex - 1)      << xM1_yM1_zCC |
+		Adv_Lit(ctx, x - 1, y, z + 1, cIndex - 1 + 18) << xM1_yM1_zP1 |
+		Adv_Lit(ctx, x,     y, z - 1, cIndex + 0 - 18) << xCC_yM1_zM1 |
+		Adv_Lit(ctx, x,     y, z,     cIndex + 0)      << xCC_yM1_zCC |
+		Adv_Lit(ctx, x,     y, z + 1, cIndex + 0 + 18) << xCC_yM1_zP1 |
+		Adv_Lit(ctx, x + 1, y, z - 1, cIndex + 1 - 18) << xP1_yM1_zM1 |
+		Adv_Lit(ctx, x + 1, y, z,     cIndex + 1)      << xP1_yM1_zCC |
+		Adv_Lit(ctx, x + 1, y, z + 1, cIndex + 1 + 18) << xP1_yM1_zP1;
 }
 
 static int adv_masks[FACE_COUNT] = {
@@ -889,384 +1396,383 @@ static int adv_masks[FACE_COUNT] = {
 };
 
 
-static cc_bool Adv_CanStretch(BlockID initial, int chunkIndex, int x, int y, int z, Face face) {
-	BlockID cur = Builder_Chunk[chunkIndex];
-	adv_bitFlags[chunkIndex] = Adv_ComputeLightFlags(x, y, z, chunkIndex);
+static cc_bool Adv_CanStretch(struct BuilderContext* ctx, BlockID initial, int chunkIndex, int x, int y, int z, Face face) {
+	BlockID cur = ctx->chunk[chunkIndex];
+	ctx->bitFlags[chunkIndex] = Adv_ComputeLightFlags(ctx, x, y, z, chunkIndex);
 
 	return cur == initial
-		&& !Block_IsFaceHidden(cur, Builder_Chunk[chunkIndex + Builder_Offsets[face]], face)
-		&& (adv_initBitFlags == adv_bitFlags[chunkIndex]
+		&& !Block_IsFaceHidden(cur, ctx->chunk[chunkIndex + Builder_Offsets[face]], face)
+		&& (ctx->initBitFlags == ctx->bitFlags[chunkIndex]
 		/* Check that this face is either fully bright or fully in shadow */
-		&& (adv_initBitFlags == 0 || (adv_initBitFlags & adv_masks[face]) == adv_masks[face]));
+		&& (ctx->initBitFlags == 0 || (ctx->initBitFlags & adv_masks[face]) == adv_masks[face]));
 }
 
-static int Adv_StretchXLiquid(int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
+static int Adv_StretchXLiquid(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
 	int count = 1; cc_bool stretchTile;
-	if (Builder_OccludedLiquid(chunkIndex)) return 0;
-	adv_initBitFlags = Adv_ComputeLightFlags(x, y, z, chunkIndex);
-	adv_bitFlags[chunkIndex] = adv_initBitFlags;
+	if (Builder_OccludedLiquid(ctx, chunkIndex)) return 0;
+	ctx->initBitFlags = Adv_ComputeLightFlags(ctx, x, y, z, chunkIndex);
+	ctx->bitFlags[chunkIndex] = ctx->initBitFlags;
 
 	x++;
 	chunkIndex++;
 	countIndex += FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << FACE_YMAX)) != 0;
 
-	while (x < Builder_ChunkEndX && stretchTile && Adv_CanStretch(block, chunkIndex, x, y, z, FACE_YMAX) && !Builder_OccludedLiquid(chunkIndex)) {
-		Builder_Counts[countIndex] = 0;
+	while (x < ctx->chunkEndX && stretchTile && Adv_CanStretch(ctx, block, chunkIndex, x, y, z, FACE_YMAX) && !Builder_OccludedLiquid(ctx, chunkIndex)) {
+		ctx->counts[countIndex] = 0;
 		count++;
 		x++;
 		chunkIndex++;
 		countIndex += FACE_COUNT;
 	}
-	AddVertices(block, FACE_YMAX);
+	AddVertices(ctx, block, FACE_YMAX);
 	return count;
 }
 
-static int Adv_StretchX(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+static int Adv_StretchX(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
 	int count = 1; cc_bool stretchTile;
-	adv_initBitFlags = Adv_ComputeLightFlags(x, y, z, chunkIndex);
-	adv_bitFlags[chunkIndex] = adv_initBitFlags;
+	ctx->initBitFlags = Adv_ComputeLightFlags(ctx, x, y, z, chunkIndex);
+	ctx->bitFlags[chunkIndex] = ctx->initBitFlags;
 	
 	x++;
 	chunkIndex++;
 	countIndex += FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << face)) != 0;
 
-	while (x < Builder_ChunkEndX && stretchTile && Adv_CanStretch(block, chunkIndex, x, y, z, face)) {
-		Builder_Counts[countIndex] = 0;
+	while (x < ctx->chunkEndX && stretchTile && Adv_CanStretch(ctx, block, chunkIndex, x, y, z, face)) {
+		ctx->counts[countIndex] = 0;
 		count++;
 		x++;
 		chunkIndex++;
 		countIndex += FACE_COUNT;
 	}
-	AddVertices(block, face);
+	AddVertices(ctx, block, face);
 	return count;
 }
 
-static int Adv_StretchZ(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+static int Adv_StretchZ(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
 	int count = 1; cc_bool stretchTile;
-	adv_initBitFlags = Adv_ComputeLightFlags(x, y, z, chunkIndex);
-	adv_bitFlags[chunkIndex] = adv_initBitFlags;
+	ctx->initBitFlags = Adv_ComputeLightFlags(ctx, x, y, z, chunkIndex);
+	ctx->bitFlags[chunkIndex] = ctx->initBitFlags;
 
 	z++;
 	chunkIndex += EXTCHUNK_SIZE;
 	countIndex += CHUNK_SIZE * FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << face)) != 0;
 
-	while (z < Builder_ChunkEndZ && stretchTile && Adv_CanStretch(block, chunkIndex, x, y, z, face)) {
-		Builder_Counts[countIndex] = 0;
+	while (z < ctx->chunkEndZ && stretchTile && Adv_CanStretch(ctx, block, chunkIndex, x, y, z, face)) {
+		ctx->counts[countIndex] = 0;
 		count++;
 		z++;
 		chunkIndex += EXTCHUNK_SIZE;
 		countIndex += CHUNK_SIZE * FACE_COUNT;
 	}
-	AddVertices(block, face);
+	AddVertices(ctx, block, face);
 	return count;
 }
 
 
 #define Adv_CountBits(F, a, b, c, d) (((F >> a) & 1) + ((F >> b) & 1) + ((F >> c) & 1) + ((F >> d) & 1))
 
-static void Adv_DrawXMin(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_XMIN);
+static void Adv_DrawXMin(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_XMIN);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.z, u2 = (count - 1) + adv_maxBB.z * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = ctx->drawer.MinBB.z, u2 = (count - 1) + ctx->drawer.MaxBB.z * UV2_Scale;
+	float v1 = vOrigin + ctx->drawer.MaxBB.y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->drawer.MinBB.y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
+	int F = ctx->bitFlags[ctx->chunkIndex];
 	int aY0_Z0 = Adv_CountBits(F, xM1_yM1_zM1, xM1_yCC_zM1, xM1_yM1_zCC, xM1_yCC_zCC);
 	int aY0_Z1 = Adv_CountBits(F, xM1_yM1_zP1, xM1_yCC_zP1, xM1_yM1_zCC, xM1_yCC_zCC);
 	int aY1_Z0 = Adv_CountBits(F, xM1_yP1_zM1, xM1_yCC_zM1, xM1_yP1_zCC, xM1_yCC_zCC);
 	int aY1_Z1 = Adv_CountBits(F, xM1_yP1_zP1, xM1_yCC_zP1, xM1_yP1_zCC, xM1_yCC_zCC);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col0_0 = Builder_FullBright ? white : adv_lerpX[aY0_Z0], col1_0 = Builder_FullBright ? white : adv_lerpX[aY1_Z0];
-	PackedCol col1_1 = Builder_FullBright ? white : adv_lerpX[aY1_Z1], col0_1 = Builder_FullBright ? white : adv_lerpX[aY0_Z1];
+	PackedCol col0_0 = ctx->fullBright ? white : ctx->lerpX[aY0_Z0], col1_0 = ctx->fullBright ? white : ctx->lerpX[aY1_Z0];
+	PackedCol col1_1 = ctx->fullBright ? white : ctx->lerpX[aY1_Z1], col0_1 = ctx->fullBright ? white : ctx->lerpX[aY0_Z1];
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->drawer.Tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_XMIN];
-	v.x = adv_x1;
+	v.x = ctx->drawer.X1;
 	if (aY0_Z0 + aY1_Z1 > aY0_Z1 + aY1_Z0) {
-		v.y = adv_y2; v.z = adv_z1;               v.U = u1; v.V = v1; v.Col = col1_0; *vertices++ = v;
-		v.y = adv_y1;                                       v.V = v2; v.Col = col0_0; *vertices++ = v;
-		              v.z = adv_z2 + (count - 1); v.U = u2;           v.Col = col0_1; *vertices++ = v;
-		v.y = adv_y2;                                       v.V = v1; v.Col = col1_1; *vertices++ = v;
+		v.y = ctx->drawer.Y2; v.z = ctx->drawer.Z1;               v.U = u1; v.V = v1; v.Col = col1_0; *vertices++ = v;
+		v.y = ctx->drawer.Y1;                                       v.V = v2; v.Col = col0_0; *vertices++ = v;
+		              v.z = ctx->drawer.Z2 + (count - 1); v.U = u2;           v.Col = col0_1; *vertices++ = v;
+		v.y = ctx->drawer.Y2;                                       v.V = v1; v.Col = col1_1; *vertices++ = v;
 	} else {
-		v.y = adv_y2; v.z = adv_z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
-		              v.z = adv_z1;               v.U = u1;           v.Col = col1_0; *vertices++ = v;
-		v.y = adv_y1;                                       v.V = v2; v.Col = col0_0; *vertices++ = v;
-		              v.z = adv_z2 + (count - 1); v.U = u2;           v.Col = col0_1; *vertices++ = v;
+		v.y = ctx->drawer.Y2; v.z = ctx->drawer.Z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
+		              v.z = ctx->drawer.Z1;               v.U = u1;           v.Col = col1_0; *vertices++ = v;
+		v.y = ctx->drawer.Y1;                                       v.V = v2; v.Col = col0_0; *vertices++ = v;
+		              v.z = ctx->drawer.Z2 + (count - 1); v.U = u2;           v.Col = col0_1; *vertices++ = v;
 	}
 	part->faces.vertices[FACE_XMIN] = vertices;
 }
 
-static void Adv_DrawXMax(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_XMAX);
+static void Adv_DrawXMax(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_XMAX);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = (count - adv_minBB.z), u2 = (1 - adv_maxBB.z) * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = (count - ctx->drawer.MinBB.z), u2 = (1 - ctx->drawer.MaxBB.z) * UV2_Scale;
+	float v1 = vOrigin + ctx->drawer.MaxBB.y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->drawer.MinBB.y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
+	int F = ctx->bitFlags[ctx->chunkIndex];
 	int aY0_Z0 = Adv_CountBits(F, xP1_yM1_zM1, xP1_yCC_zM1, xP1_yM1_zCC, xP1_yCC_zCC);
 	int aY0_Z1 = Adv_CountBits(F, xP1_yM1_zP1, xP1_yCC_zP1, xP1_yM1_zCC, xP1_yCC_zCC);
 	int aY1_Z0 = Adv_CountBits(F, xP1_yP1_zM1, xP1_yCC_zM1, xP1_yP1_zCC, xP1_yCC_zCC);
 	int aY1_Z1 = Adv_CountBits(F, xP1_yP1_zP1, xP1_yCC_zP1, xP1_yP1_zCC, xP1_yCC_zCC);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col0_0 = Builder_FullBright ? white : adv_lerpX[aY0_Z0], col1_0 = Builder_FullBright ? white : adv_lerpX[aY1_Z0];
-	PackedCol col1_1 = Builder_FullBright ? white : adv_lerpX[aY1_Z1], col0_1 = Builder_FullBright ? white : adv_lerpX[aY0_Z1];
+	PackedCol col0_0 = ctx->fullBright ? white : ctx->lerpX[aY0_Z0], col1_0 = ctx->fullBright ? white : ctx->lerpX[aY1_Z0];
+	PackedCol col1_1 = ctx->fullBright ? white : ctx->lerpX[aY1_Z1], col0_1 = ctx->fullBright ? white : ctx->lerpX[aY0_Z1];
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->drawer.Tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_XMAX];
-	v.x = adv_x2;
+	v.x = ctx->drawer.X2;
 	if (aY0_Z0 + aY1_Z1 > aY0_Z1 + aY1_Z0) {
-		v.y = adv_y2; v.z = adv_z1;               v.U = u1; v.V = v1; v.Col = col1_0; *vertices++ = v;
-		              v.z = adv_z2 + (count - 1); v.U = u2;           v.Col = col1_1; *vertices++ = v;
-		v.y = adv_y1;                                       v.V = v2; v.Col = col0_1; *vertices++ = v;
-		              v.z = adv_z1;               v.U = u1;           v.Col = col0_0; *vertices++ = v;
+		v.y = ctx->drawer.Y2; v.z = ctx->drawer.Z1;               v.U = u1; v.V = v1; v.Col = col1_0; *vertices++ = v;
+		              v.z = ctx->drawer.Z2 + (count - 1); v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		v.y = ctx->drawer.Y1;                                       v.V = v2; v.Col = col0_1; *vertices++ = v;
+		              v.z = ctx->drawer.Z1;               v.U = u1;           v.Col = col0_0; *vertices++ = v;
 	} else {
-		v.y = adv_y2; v.z = adv_z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
-		v.y = adv_y1;                                       v.V = v2; v.Col = col0_1; *vertices++ = v;
-		              v.z = adv_z1;               v.U = u1;           v.Col = col0_0; *vertices++ = v;
-		v.y = adv_y2;                                       v.V = v1; v.Col = col1_0; *vertices++ = v;
+		v.y = ctx->drawer.Y2; v.z = ctx->drawer.Z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
+		v.y = ctx->drawer.Y1;                                       v.V = v2; v.Col = col0_1; *vertices++ = v;
+		              v.z = ctx->drawer.Z1;               v.U = u1;           v.Col = col0_0; *vertices++ = v;
+		v.y = ctx->drawer.Y2;                                       v.V = v1; v.Col = col1_0; *vertices++ = v;
 	}
 	part->faces.vertices[FACE_XMAX] = vertices;
 }
 
-static void Adv_DrawZMin(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_ZMIN);
+static void Adv_DrawZMin(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_ZMIN);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = (count - adv_minBB.x), u2 = (1 - adv_maxBB.x) * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = (count - ctx->drawer.MinBB.x), u2 = (1 - ctx->drawer.MaxBB.x) * UV2_Scale;
+	float v1 = vOrigin + ctx->drawer.MaxBB.y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->drawer.MinBB.y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
+	int F = ctx->bitFlags[ctx->chunkIndex];
 	int aX0_Y0 = Adv_CountBits(F, xM1_yM1_zM1, xM1_yCC_zM1, xCC_yM1_zM1, xCC_yCC_zM1);
 	int aX0_Y1 = Adv_CountBits(F, xM1_yP1_zM1, xM1_yCC_zM1, xCC_yP1_zM1, xCC_yCC_zM1);
 	int aX1_Y0 = Adv_CountBits(F, xP1_yM1_zM1, xP1_yCC_zM1, xCC_yM1_zM1, xCC_yCC_zM1);
 	int aX1_Y1 = Adv_CountBits(F, xP1_yP1_zM1, xP1_yCC_zM1, xCC_yP1_zM1, xCC_yCC_zM1);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col0_0 = Builder_FullBright ? white : adv_lerpZ[aX0_Y0], col1_0 = Builder_FullBright ? white : adv_lerpZ[aX1_Y0];
-	PackedCol col1_1 = Builder_FullBright ? white : adv_lerpZ[aX1_Y1], col0_1 = Builder_FullBright ? white : adv_lerpZ[aX0_Y1];
+	PackedCol col0_0 = ctx->fullBright ? white : ctx->lerpZ[aX0_Y0], col1_0 = ctx->fullBright ? white : ctx->lerpZ[aX1_Y0];
+	PackedCol col1_1 = ctx->fullBright ? white : ctx->lerpZ[aX1_Y1], col0_1 = ctx->fullBright ? white : ctx->lerpZ[aX0_Y1];
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->drawer.Tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_ZMIN];
-	v.z = adv_z1;
+	v.z = ctx->drawer.Z1;
 	if (aX1_Y1 + aX0_Y0 > aX0_Y1 + aX1_Y0) {
-		v.x = adv_x2 + (count - 1); v.y = adv_y1; v.U = u2; v.V = v2; v.Col = col1_0; *vertices++ = v;
-		v.x = adv_x1;                             v.U = u1;           v.Col = col0_0; *vertices++ = v;
-		                            v.y = adv_y2;           v.V = v1; v.Col = col0_1; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		v.x = ctx->drawer.X2 + (count - 1); v.y = ctx->drawer.Y1; v.U = u2; v.V = v2; v.Col = col1_0; *vertices++ = v;
+		v.x = ctx->drawer.X1;                             v.U = u1;           v.Col = col0_0; *vertices++ = v;
+		                            v.y = ctx->drawer.Y2;           v.V = v1; v.Col = col0_1; *vertices++ = v;
+		v.x = ctx->drawer.X2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
 	} else {
-		v.x = adv_x1;               v.y = adv_y1; v.U = u1; v.V = v2; v.Col = col0_0; *vertices++ = v;
-		                            v.y = adv_y2;           v.V = v1; v.Col = col0_1; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
-		                            v.y = adv_y1;           v.V = v2; v.Col = col1_0; *vertices++ = v;
+		v.x = ctx->drawer.X1;               v.y = ctx->drawer.Y1; v.U = u1; v.V = v2; v.Col = col0_0; *vertices++ = v;
+		                            v.y = ctx->drawer.Y2;           v.V = v1; v.Col = col0_1; *vertices++ = v;
+		v.x = ctx->drawer.X2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		                            v.y = ctx->drawer.Y1;           v.V = v2; v.Col = col1_0; *vertices++ = v;
 	}
 	part->faces.vertices[FACE_ZMIN] = vertices;
 }
 
-static void Adv_DrawZMax(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_ZMAX);
+static void Adv_DrawZMax(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_ZMAX);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.x, u2 = (count - 1) + adv_maxBB.x * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = ctx->drawer.MinBB.x, u2 = (count - 1) + ctx->drawer.MaxBB.x * UV2_Scale;
+	float v1 = vOrigin + ctx->drawer.MaxBB.y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->drawer.MinBB.y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
+	int F = ctx->bitFlags[ctx->chunkIndex];
 	int aX0_Y0 = Adv_CountBits(F, xM1_yM1_zP1, xM1_yCC_zP1, xCC_yM1_zP1, xCC_yCC_zP1);
 	int aX1_Y0 = Adv_CountBits(F, xP1_yM1_zP1, xP1_yCC_zP1, xCC_yM1_zP1, xCC_yCC_zP1);
 	int aX0_Y1 = Adv_CountBits(F, xM1_yP1_zP1, xM1_yCC_zP1, xCC_yP1_zP1, xCC_yCC_zP1);
 	int aX1_Y1 = Adv_CountBits(F, xP1_yP1_zP1, xP1_yCC_zP1, xCC_yP1_zP1, xCC_yCC_zP1);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col1_1 = Builder_FullBright ? white : adv_lerpZ[aX1_Y1], col1_0 = Builder_FullBright ? white : adv_lerpZ[aX1_Y0];
-	PackedCol col0_0 = Builder_FullBright ? white : adv_lerpZ[aX0_Y0], col0_1 = Builder_FullBright ? white : adv_lerpZ[aX0_Y1];
+	PackedCol col1_1 = ctx->fullBright ? white : ctx->lerpZ[aX1_Y1], col1_0 = ctx->fullBright ? white : ctx->lerpZ[aX1_Y0];
+	PackedCol col0_0 = ctx->fullBright ? white : ctx->lerpZ[aX0_Y0], col0_1 = ctx->fullBright ? white : ctx->lerpZ[aX0_Y1];
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->drawer.Tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_ZMAX];
-	v.z = adv_z2;
+	v.z = ctx->drawer.Z2;
 	if (aX1_Y1 + aX0_Y0 > aX0_Y1 + aX1_Y0) {
-		v.x = adv_x1;               v.y = adv_y2; v.U = u1; v.V = v1; v.Col = col0_1; *vertices++ = v;
-		                            v.y = adv_y1;           v.V = v2; v.Col = col0_0; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
-		                            v.y = adv_y2;           v.V = v1; v.Col = col1_1; *vertices++ = v;
+		v.x = ctx->drawer.X1;               v.y = ctx->drawer.Y2; v.U = u1; v.V = v1; v.Col = col0_1; *vertices++ = v;
+		                            v.y = ctx->drawer.Y1;           v.V = v2; v.Col = col0_0; *vertices++ = v;
+		v.x = ctx->drawer.X2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
+		                            v.y = ctx->drawer.Y2;           v.V = v1; v.Col = col1_1; *vertices++ = v;
 	} else {
-		v.x = adv_x2 + (count - 1); v.y = adv_y2; v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
-		v.x = adv_x1;                             v.U = u1;           v.Col = col0_1; *vertices++ = v;
-		                            v.y = adv_y1;           v.V = v2; v.Col = col0_0; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
+		v.x = ctx->drawer.X2 + (count - 1); v.y = ctx->drawer.Y2; v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
+		v.x = ctx->drawer.X1;                             v.U = u1;           v.Col = col0_1; *vertices++ = v;
+		                            v.y = ctx->drawer.Y1;           v.V = v2; v.Col = col0_0; *vertices++ = v;
+		v.x = ctx->drawer.X2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
 	}
 	part->faces.vertices[FACE_ZMAX] = vertices;
 }
 
-static void Adv_DrawYMin(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_YMIN);
+static void Adv_DrawYMin(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_YMIN);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.x, u2 = (count - 1) + adv_maxBB.x * UV2_Scale;
-	float v1 = vOrigin + adv_minBB.z * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_maxBB.z * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = ctx->drawer.MinBB.x, u2 = (count - 1) + ctx->drawer.MaxBB.x * UV2_Scale;
+	float v1 = vOrigin + ctx->drawer.MinBB.z * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->drawer.MaxBB.z * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
+	int F = ctx->bitFlags[ctx->chunkIndex];
 	int aX0_Z0 = Adv_CountBits(F, xM1_yM1_zM1, xM1_yM1_zCC, xCC_yM1_zM1, xCC_yM1_zCC);
 	int aX1_Z0 = Adv_CountBits(F, xP1_yM1_zM1, xP1_yM1_zCC, xCC_yM1_zM1, xCC_yM1_zCC);
 	int aX0_Z1 = Adv_CountBits(F, xM1_yM1_zP1, xM1_yM1_zCC, xCC_yM1_zP1, xCC_yM1_zCC);
 	int aX1_Z1 = Adv_CountBits(F, xP1_yM1_zP1, xP1_yM1_zCC, xCC_yM1_zP1, xCC_yM1_zCC);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col0_1 = Builder_FullBright ? white : adv_lerpY[aX0_Z1], col1_1 = Builder_FullBright ? white : adv_lerpY[aX1_Z1];
-	PackedCol col1_0 = Builder_FullBright ? white : adv_lerpY[aX1_Z0], col0_0 = Builder_FullBright ? white : adv_lerpY[aX0_Z0];
+	PackedCol col0_1 = ctx->fullBright ? white : ctx->lerpY[aX0_Z1], col1_1 = ctx->fullBright ? white : ctx->lerpY[aX1_Z1];
+	PackedCol col1_0 = ctx->fullBright ? white : ctx->lerpY[aX1_Z0], col0_0 = ctx->fullBright ? white : ctx->lerpY[aX0_Z0];
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->drawer.Tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_YMIN];
-	v.y = adv_y1;
+	v.y = ctx->drawer.Y1;
 	if (aX0_Z1 + aX1_Z0 > aX0_Z0 + aX1_Z1) {
-		v.x = adv_x2 + (count - 1); v.z = adv_z2; v.U = u2; v.V = v2; v.Col = col1_1; *vertices++ = v;
-		v.x = adv_x1;                             v.U = u1;           v.Col = col0_1; *vertices++ = v;
-		                            v.z = adv_z1;           v.V = v1; v.Col = col0_0; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
+		v.x = ctx->drawer.X2 + (count - 1); v.z = ctx->drawer.Z2; v.U = u2; v.V = v2; v.Col = col1_1; *vertices++ = v;
+		v.x = ctx->drawer.X1;                             v.U = u1;           v.Col = col0_1; *vertices++ = v;
+		                            v.z = ctx->drawer.Z1;           v.V = v1; v.Col = col0_0; *vertices++ = v;
+		v.x = ctx->drawer.X2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
 	} else {
-		v.x = adv_x1;               v.z = adv_z2; v.U = u1; v.V = v2; v.Col = col0_1; *vertices++ = v;
-		                            v.z = adv_z1;           v.V = v1; v.Col = col0_0; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
-		                            v.z = adv_z2;           v.V = v2; v.Col = col1_1; *vertices++ = v;
+		v.x = ctx->drawer.X1;               v.z = ctx->drawer.Z2; v.U = u1; v.V = v2; v.Col = col0_1; *vertices++ = v;
+		                            v.z = ctx->drawer.Z1;           v.V = v1; v.Col = col0_0; *vertices++ = v;
+		v.x = ctx->drawer.X2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
+		                            v.z = ctx->drawer.Z2;           v.V = v2; v.Col = col1_1; *vertices++ = v;
 	}
 	part->faces.vertices[FACE_YMIN] = vertices;
 }
 
-static void Adv_DrawYMax(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_YMAX);
+static void Adv_DrawYMax(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_YMAX);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.x, u2 = (count - 1) + adv_maxBB.x * UV2_Scale;
-	float v1 = vOrigin + adv_minBB.z * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_maxBB.z * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = ctx->drawer.MinBB.x, u2 = (count - 1) + ctx->drawer.MaxBB.x * UV2_Scale;
+	float v1 = vOrigin + ctx->drawer.MinBB.z * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->drawer.MaxBB.z * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
+	int F = ctx->bitFlags[ctx->chunkIndex];
 	int aX0_Z0 = Adv_CountBits(F, xM1_yP1_zM1, xM1_yP1_zCC, xCC_yP1_zM1, xCC_yP1_zCC);
 	int aX1_Z0 = Adv_CountBits(F, xP1_yP1_zM1, xP1_yP1_zCC, xCC_yP1_zM1, xCC_yP1_zCC);
 	int aX0_Z1 = Adv_CountBits(F, xM1_yP1_zP1, xM1_yP1_zCC, xCC_yP1_zP1, xCC_yP1_zCC);
 	int aX1_Z1 = Adv_CountBits(F, xP1_yP1_zP1, xP1_yP1_zCC, xCC_yP1_zP1, xCC_yP1_zCC);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col0_0 = Builder_FullBright ? white : adv_lerp[aX0_Z0], col1_0 = Builder_FullBright ? white : adv_lerp[aX1_Z0];
-	PackedCol col1_1 = Builder_FullBright ? white : adv_lerp[aX1_Z1], col0_1 = Builder_FullBright ? white : adv_lerp[aX0_Z1];
+	PackedCol col0_0 = ctx->fullBright ? white : ctx->lerp[aX0_Z0], col1_0 = ctx->fullBright ? white : ctx->lerp[aX1_Z0];
+	PackedCol col1_1 = ctx->fullBright ? white : ctx->lerp[aX1_Z1], col0_1 = ctx->fullBright ? white : ctx->lerp[aX0_Z1];
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->drawer.Tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_YMAX];
-	v.y = adv_y2;
+	v.y = ctx->drawer.Y2;
 	if (aX0_Z0 + aX1_Z1 > aX0_Z1 + aX1_Z0) {
-		v.x = adv_x2 + (count - 1); v.z = adv_z1; v.U = u2; v.V = v1; v.Col = col1_0; *vertices++ = v;
-		v.x = adv_x1;                             v.U = u1;           v.Col = col0_0; *vertices++ = v;
-		                            v.z = adv_z2;           v.V = v2; v.Col = col0_1; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		v.x = ctx->drawer.X2 + (count - 1); v.z = ctx->drawer.Z1; v.U = u2; v.V = v1; v.Col = col1_0; *vertices++ = v;
+		v.x = ctx->drawer.X1;                             v.U = u1;           v.Col = col0_0; *vertices++ = v;
+		                            v.z = ctx->drawer.Z2;           v.V = v2; v.Col = col0_1; *vertices++ = v;
+		v.x = ctx->drawer.X2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
 	} else {
-		v.x = adv_x1;               v.z = adv_z1; v.U = u1; v.V = v1; v.Col = col0_0; *vertices++ = v;
-		                            v.z = adv_z2;           v.V = v2; v.Col = col0_1; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
-		                            v.z = adv_z1;           v.V = v1; v.Col = col1_0; *vertices++ = v;
+		v.x = ctx->drawer.X1;               v.z = ctx->drawer.Z1; v.U = u1; v.V = v1; v.Col = col0_0; *vertices++ = v;
+		                            v.z = ctx->drawer.Z2;           v.V = v2; v.Col = col0_1; *vertices++ = v;
+		v.x = ctx->drawer.X2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		                            v.z = ctx->drawer.Z1;           v.V = v1; v.Col = col1_0; *vertices++ = v;
 	}
 	part->faces.vertices[FACE_YMAX] = vertices;
 }
 
-static void Adv_RenderBlock(int index, int x, int y, int z) {
+static void Adv_RenderBlock(struct BuilderContext* ctx, int index, int x, int y, int z) {
 	Vec3 min, max;
 	int count_XMin, count_XMax, count_ZMin;
 	int count_ZMax, count_YMin, count_YMax;
 
-	if (Blocks.Draw[Builder_Block] == DRAW_SPRITE) {
-		Builder_DrawSprite(x, y, z); return;
+	if (Blocks.Draw[ctx->block] == DRAW_SPRITE) {
+		Builder_DrawSprite(ctx, x, y, z); return;
 	}
 
-	count_XMin = Builder_Counts[index + FACE_XMIN];
-	count_XMax = Builder_Counts[index + FACE_XMAX];
-	count_ZMin = Builder_Counts[index + FACE_ZMIN];
-	count_ZMax = Builder_Counts[index + FACE_ZMAX];
-	count_YMin = Builder_Counts[index + FACE_YMIN];
-	count_YMax = Builder_Counts[index + FACE_YMAX];
+	count_XMin = ctx->counts[index + FACE_XMIN];
+	count_XMax = ctx->counts[index + FACE_XMAX];
+	count_ZMin = ctx->counts[index + FACE_ZMIN];
+	count_ZMax = ctx->counts[index + FACE_ZMAX];
+	count_YMin = ctx->counts[index + FACE_YMIN];
+	count_YMax = ctx->counts[index + FACE_YMAX];
 
 	if (!count_XMin && !count_XMax && !count_ZMin &&
 		!count_ZMax && !count_YMin && !count_YMax) return;
 
-	Builder_FullBright = Blocks.Brightness[Builder_Block];
-	adv_baseOffset = (Blocks.Draw[Builder_Block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
-	adv_tinted     = Blocks.Tinted[Builder_Block];
+	ctx->fullBright = Blocks.Brightness[ctx->block];
+	ctx->baseOffset = (Blocks.Draw[ctx->block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
+	ctx->drawer.Tinted     = Blocks.Tinted[ctx->block];
 
-	min = Blocks.RenderMinBB[Builder_Block]; max = Blocks.RenderMaxBB[Builder_Block];
-	adv_x1 = x + min.x; adv_y1 = y + min.y; adv_z1 = z + min.z;
-	adv_x2 = x + max.x; adv_y2 = y + max.y; adv_z2 = z + max.z;
+	min = Blocks.RenderMinBB[ctx->block]; max = Blocks.RenderMaxBB[ctx->block];
+	ctx->drawer.X1 = x + min.x; ctx->drawer.Y1 = y + min.y; ctx->drawer.Z1 = z + min.z;
+	ctx->drawer.X2 = x + max.x; ctx->drawer.Y2 = y + max.y; ctx->drawer.Z2 = z + max.z;
 
-	adv_minBB = Blocks.MinBB[Builder_Block]; adv_maxBB = Blocks.MaxBB[Builder_Block];
-	adv_minBB.y = 1.0f - adv_minBB.y; adv_maxBB.y = 1.0f - adv_maxBB.y;
+	ctx->drawer.MinBB = Blocks.MinBB[ctx->block]; ctx->drawer.MaxBB = Blocks.MaxBB[ctx->block];
+	ctx->drawer.MinBB.y = 1.0f - ctx->drawer.MinBB.y; ctx->drawer.MaxBB.y = 1.0f - ctx->drawer.MaxBB.y;
 
-	if (count_XMin) Adv_DrawXMin(count_XMin);
-	if (count_XMax) Adv_DrawXMax(count_XMax);
-	if (count_ZMin) Adv_DrawZMin(count_ZMin);
-	if (count_ZMax) Adv_DrawZMax(count_ZMax);
-	if (count_YMin) Adv_DrawYMin(count_YMin);
-	if (count_YMax) Adv_DrawYMax(count_YMax);
+	if (count_XMin) Adv_DrawXMin(ctx, count_XMin);
+	if (count_XMax) Adv_DrawXMax(ctx, count_XMax);
+	if (count_ZMin) Adv_DrawZMin(ctx, count_ZMin);
+	if (count_ZMax) Adv_DrawZMax(ctx, count_ZMax);
+	if (count_YMin) Adv_DrawYMin(ctx, count_YMin);
+	if (count_YMax) Adv_DrawYMax(ctx, count_YMax);
 }
 
-static void Adv_PrePrepareChunk(void) {
+static void Adv_PrePrepareChunk(struct BuilderContext* ctx) {
 	int i;
-	DefaultPrePrepateChunk();
-	adv_bitFlags = Builder_BitFlags;
+	DefaultPrePrepateChunk(ctx);
 
 	for (i = 0; i <= 4; i++) {
-		adv_lerp[i]  = PackedCol_Lerp(Env.ShadowCol,   Env.SunCol,   i / 4.0f);
-		adv_lerpX[i] = PackedCol_Lerp(Env.ShadowXSide, Env.SunXSide, i / 4.0f);
-		adv_lerpZ[i] = PackedCol_Lerp(Env.ShadowZSide, Env.SunZSide, i / 4.0f);
-		adv_lerpY[i] = PackedCol_Lerp(Env.ShadowYMin,  Env.SunYMin,  i / 4.0f);
+		ctx->lerp[i]  = PackedCol_Lerp(Env.ShadowCol,   Env.SunCol,   i / 4.0f);
+		ctx->lerpX[i] = PackedCol_Lerp(Env.ShadowXSide, Env.SunXSide, i / 4.0f);
+		ctx->lerpZ[i] = PackedCol_Lerp(Env.ShadowZSide, Env.SunZSide, i / 4.0f);
+		ctx->lerpY[i] = PackedCol_Lerp(Env.ShadowYMin,  Env.SunYMin,  i / 4.0f);
 	}
 }
 
@@ -1291,8 +1797,26 @@ static void AdvBuilder_SetActive(void) { NormalBuilder_SetActive(); }
 /* Fast color averaging wizardy from https://stackoverflow.com/questions/8440631/how-would-you-average-two-32-bit-colors-packed-into-an-integer */
 #define AVERAGE(a, b)   ( ((((a) ^ (b)) & 0xfefefefe) >> 1) + ((a) & (b)) )
 
-static cc_bool Modern_IsOccluded(int x, int y, int z) {
-	BlockID block = World_SafeGetBlock(x, y, z);
+/* Returns the index in the chunk volume of the block at the given offset from the block being drawn */
+#define Modern_Pack(ctx, x, y, z) ((ctx)->chunkIndex + (x) + (z) * EXTCHUNK_SIZE + (y) * EXTCHUNK_SIZE_2)
+
+/* Returns the light color of the block at the given offset from the block being drawn */
+/* NOTE: Colors are only looked up from Lighting the first time a block is used while building the chunk, */
+/*  as adjacent faces and vertices mostly sample the same blocks (light colors always have an alpha of 255, so are never 0) */
+/* NOTE: Side and bottom faces also sample Lighting.Color and shade the averaged result, rather than using the *_Fast side colors */
+/*  (so with smooth lighting, blocks with Brightness light adjacent side faces as if in sunlight, same as for top faces) */
+static PackedCol Modern_Light(struct BuilderContext* ctx, int x, int y, int z) {
+	int index = Modern_Pack(ctx, x, y, z);
+	PackedCol col = ctx->light[index];
+	if (col) return col;
+
+	col = Lighting.Color(ctx->x + x, ctx->y + y, ctx->z + z);
+	ctx->light[index] = col;
+	return col;
+}
+
+static cc_bool Modern_IsOccluded(struct BuilderContext* ctx, int x, int y, int z) {
+	BlockID block = ctx->chunk[Modern_Pack(ctx, x, y, z)];
 	if (Blocks.Brightness[block] > 0) { return false; }
 	/* If the block we're pulling colors from is solid, return a darker version of original and increment how many are like this */
 	if (Blocks.FullOpaque[block] || (Blocks.Draw[block] == DRAW_TRANSPARENT && Blocks.BlocksLight[block] && Blocks.LightOffset[block] == 0xFF)) {
@@ -1301,321 +1825,358 @@ static cc_bool Modern_IsOccluded(int x, int y, int z) {
 	return false;
 }
 
-static cc_bool Modern_CanStretch(BlockID initial, int chunkIndex, int x, int y, int z, Face face) {
+static cc_bool Modern_CanStretch(struct BuilderContext* ctx, BlockID initial, int chunkIndex, int x, int y, int z, Face face) {
 	return false;
 }
 
-static int Modern_StretchXLiquid(int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
+static int Modern_StretchXLiquid(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
 	int count = 1;
-	if (Builder_OccludedLiquid(chunkIndex)) return 0;
-	AddVertices(block, FACE_YMAX);
+	if (Builder_OccludedLiquid(ctx, chunkIndex)) return 0;
+	AddVertices(ctx, block, FACE_YMAX);
 	return count;
 }
 
-static int Modern_StretchX(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+static int Modern_StretchX(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
 	int count = 1;
-	AddVertices(block, face);
+	AddVertices(ctx, block, face);
 	return count;
 }
 
-static int Modern_StretchZ(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+static int Modern_StretchZ(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
 	int count = 1;
-	AddVertices(block, face);
+	AddVertices(ctx, block, face);
 	return count;
 }
 
-static PackedCol Modern_GetColorX(PackedCol orig, int x, int y, int z, int oY, int oZ) {
-	cc_bool xOccluded =  Modern_IsOccluded(x, y + oY, z     );
-	cc_bool zOccluded =  Modern_IsOccluded(x, y     , z + oZ);
-	cc_bool xzOccluded = Modern_IsOccluded(x, y + oY, z + oZ);
+static PackedCol Modern_GetColorX(struct BuilderContext* ctx, PackedCol orig, int x, int y, int z, int oY, int oZ) {
+	cc_bool xOccluded  = Modern_IsOccluded(ctx, x, y + oY, z     );
+	cc_bool zOccluded  = Modern_IsOccluded(ctx, x, y     , z + oZ);
+	cc_bool xzOccluded = Modern_IsOccluded(ctx, x, y + oY, z + oZ);
 
-	PackedCol CoX = xOccluded ? PackedCol_Scale(orig, FANCY_AO) : Lighting.Color_XSide_Fast(x, y + oY, z     );
-	PackedCol CoZ = zOccluded ? PackedCol_Scale(orig, FANCY_AO) : Lighting.Color_XSide_Fast(x, y     , z + oZ);
-	PackedCol CoXoZ = (xzOccluded || (xOccluded && zOccluded)) ? PackedCol_Scale(orig, FANCY_AO) : Lighting.Color_XSide_Fast(x, y + oY, z + oZ);
+	PackedCol CoX   =                                xOccluded ? PackedCol_Scale(orig, FANCY_AO) : Modern_Light(ctx, x, y + oY, z     );
+	PackedCol CoZ   =                                zOccluded ? PackedCol_Scale(orig, FANCY_AO) : Modern_Light(ctx, x, y     , z + oZ);
+	PackedCol CoXoZ = (xzOccluded || (xOccluded && zOccluded)) ? PackedCol_Scale(orig, FANCY_AO) : Modern_Light(ctx, x, y + oY, z + oZ);
 
 	PackedCol ab = AVERAGE(CoX, CoZ);
 	PackedCol cd = AVERAGE(CoXoZ, orig);
-	return AVERAGE(ab, cd);
+	return PackedCol_Scale(AVERAGE(ab, cd), PACKEDCOL_SHADE_X);
 }
-static void Modern_DrawXMin(int count, int x, int y, int z) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_XMIN);
+static void Modern_DrawXMin(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_XMIN);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.z, u2 = (count - 1) + adv_maxBB.z * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = ctx->drawer.MinBB.z, u2 = (count - 1) + ctx->drawer.MaxBB.z * UV2_Scale;
+	float v1 = vOrigin + ctx->drawer.MaxBB.y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->drawer.MinBB.y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	int offset = 1;// (Blocks.LightOffset[Builder_Block] >> FACE_XMIN) & 1;
-	PackedCol orig = Lighting.Color_XSide_Fast(x-offset, y, z);
-	PackedCol col0_0 = Builder_FullBright ? white : Modern_GetColorX(orig, x-offset, y, z, -1, -1);
-	PackedCol col1_0 = Builder_FullBright ? white : Modern_GetColorX(orig, x-offset, y, z, 1, -1);
-	PackedCol col1_1 = Builder_FullBright ? white : Modern_GetColorX(orig, x-offset, y, z, 1, 1);
-	PackedCol col0_1 = Builder_FullBright ? white : Modern_GetColorX(orig, x-offset, y, z, -1, 1);
+	int offset = 1;// (Blocks.LightOffset[ctx->block] >> FACE_XMIN) & 1;
+	PackedCol orig, col0_0, col1_0, col1_1, col0_1;
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->fullBright) {
+		col0_0 = white; col1_0 = white; col1_1 = white; col0_1 = white;
+	} else {
+		orig   = Modern_Light(ctx, -offset, 0, 0);
+		col0_0 = Modern_GetColorX(ctx, orig, -offset, 0, 0, -1, -1);
+		col1_0 = Modern_GetColorX(ctx, orig, -offset, 0, 0,  1, -1);
+		col1_1 = Modern_GetColorX(ctx, orig, -offset, 0, 0,  1,  1);
+		col0_1 = Modern_GetColorX(ctx, orig, -offset, 0, 0, -1,  1);
+	}
+
+	if (ctx->drawer.Tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_XMIN];
-	v.x = adv_x1;
-		v.y = adv_y2; v.z = adv_z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
-		              v.z = adv_z1;               v.U = u1;           v.Col = col1_0; *vertices++ = v;
-		v.y = adv_y1;                                       v.V = v2; v.Col = col0_0; *vertices++ = v;
-		              v.z = adv_z2 + (count - 1); v.U = u2;           v.Col = col0_1; *vertices++ = v;
+	v.x = ctx->drawer.X1;
+		v.y = ctx->drawer.Y2; v.z = ctx->drawer.Z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
+		              v.z = ctx->drawer.Z1;               v.U = u1;           v.Col = col1_0; *vertices++ = v;
+		v.y = ctx->drawer.Y1;                                       v.V = v2; v.Col = col0_0; *vertices++ = v;
+		              v.z = ctx->drawer.Z2 + (count - 1); v.U = u2;           v.Col = col0_1; *vertices++ = v;
 	part->faces.vertices[FACE_XMIN] = vertices;
 }
 
-static void Modern_DrawXMax(int count, int x, int y, int z) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_XMAX);
+static void Modern_DrawXMax(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_XMAX);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = (count - adv_minBB.z), u2 = (1 - adv_maxBB.z) * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = (count - ctx->drawer.MinBB.z), u2 = (1 - ctx->drawer.MaxBB.z) * UV2_Scale;
+	float v1 = vOrigin + ctx->drawer.MaxBB.y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->drawer.MinBB.y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	int offset = 1;// (Blocks.LightOffset[Builder_Block] >> FACE_XMAX) & 1;
-	PackedCol orig = Lighting.Color_XSide_Fast(x+offset, y, z);
-	PackedCol col0_0 = Builder_FullBright ? white : Modern_GetColorX(orig, x+offset, y, z, -1, -1);
-	PackedCol col1_0 = Builder_FullBright ? white : Modern_GetColorX(orig, x+offset, y, z, 1, -1);
-	PackedCol col1_1 = Builder_FullBright ? white : Modern_GetColorX(orig, x+offset, y, z, 1, 1);
-	PackedCol col0_1 = Builder_FullBright ? white : Modern_GetColorX(orig, x+offset, y, z, -1, 1);
+	int offset = 1;// (Blocks.LightOffset[ctx->block] >> FACE_XMAX) & 1;
+	PackedCol orig, col0_0, col1_0, col1_1, col0_1;
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->fullBright) {
+		col0_0 = white; col1_0 = white; col1_1 = white; col0_1 = white;
+	} else {
+		orig   = Modern_Light(ctx, offset, 0, 0);
+		col0_0 = Modern_GetColorX(ctx, orig, offset, 0, 0, -1, -1);
+		col1_0 = Modern_GetColorX(ctx, orig, offset, 0, 0,  1, -1);
+		col1_1 = Modern_GetColorX(ctx, orig, offset, 0, 0,  1,  1);
+		col0_1 = Modern_GetColorX(ctx, orig, offset, 0, 0, -1,  1);
+	}
+
+	if (ctx->drawer.Tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_XMAX];
-	v.x = adv_x2;
-		v.y = adv_y2; v.z = adv_z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
-		v.y = adv_y1;                                       v.V = v2; v.Col = col0_1; *vertices++ = v;
-		              v.z = adv_z1;               v.U = u1;           v.Col = col0_0; *vertices++ = v;
-		v.y = adv_y2;                                       v.V = v1; v.Col = col1_0; *vertices++ = v;
+	v.x = ctx->drawer.X2;
+		v.y = ctx->drawer.Y2; v.z = ctx->drawer.Z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
+		v.y = ctx->drawer.Y1;                                       v.V = v2; v.Col = col0_1; *vertices++ = v;
+		              v.z = ctx->drawer.Z1;               v.U = u1;           v.Col = col0_0; *vertices++ = v;
+		v.y = ctx->drawer.Y2;                                       v.V = v1; v.Col = col1_0; *vertices++ = v;
 	part->faces.vertices[FACE_XMAX] = vertices;
 }
 
-static PackedCol Modern_GetColorZ(PackedCol orig, int x, int y, int z, int oX, int oY) {
-	cc_bool xOccluded  = Modern_IsOccluded(x + oX, y     , z);
-	cc_bool zOccluded  = Modern_IsOccluded(x,      y + oY, z);
-	cc_bool xzOccluded = Modern_IsOccluded(x + oX, y + oY, z);
+static PackedCol Modern_GetColorZ(struct BuilderContext* ctx, PackedCol orig, int x, int y, int z, int oX, int oY) {
+	cc_bool xOccluded  = Modern_IsOccluded(ctx, x + oX, y     , z);
+	cc_bool zOccluded  = Modern_IsOccluded(ctx, x     , y + oY, z);
+	cc_bool xzOccluded = Modern_IsOccluded(ctx, x + oX, y + oY, z);
 
-	PackedCol CoX   =                                xOccluded ? PackedCol_Scale(orig, FANCY_AO) : Lighting.Color_ZSide_Fast(x + oX, y     , z);
-	PackedCol CoZ   =                                zOccluded ? PackedCol_Scale(orig, FANCY_AO) : Lighting.Color_ZSide_Fast(x     , y + oY, z);
-	PackedCol CoXoZ = (xzOccluded || (xOccluded && zOccluded)) ? PackedCol_Scale(orig, FANCY_AO) : Lighting.Color_ZSide_Fast(x + oX, y + oY, z);
+	PackedCol CoX   =                                xOccluded ? PackedCol_Scale(orig, FANCY_AO) : Modern_Light(ctx, x + oX, y     , z);
+	PackedCol CoZ   =                                zOccluded ? PackedCol_Scale(orig, FANCY_AO) : Modern_Light(ctx, x     , y + oY, z);
+	PackedCol CoXoZ = (xzOccluded || (xOccluded && zOccluded)) ? PackedCol_Scale(orig, FANCY_AO) : Modern_Light(ctx, x + oX, y + oY, z);
 
 	PackedCol ab = AVERAGE(CoX, CoZ);
 	PackedCol cd = AVERAGE(CoXoZ, orig);
-	return AVERAGE(ab, cd);
+	return PackedCol_Scale(AVERAGE(ab, cd), PACKEDCOL_SHADE_Z);
 }
-static void Modern_DrawZMin(int count, int x, int y, int z) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_ZMIN);
+static void Modern_DrawZMin(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_ZMIN);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = (count - adv_minBB.x), u2 = (1 - adv_maxBB.x) * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = (count - ctx->drawer.MinBB.x), u2 = (1 - ctx->drawer.MaxBB.x) * UV2_Scale;
+	float v1 = vOrigin + ctx->drawer.MaxBB.y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->drawer.MinBB.y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	int offset = 1;// (Blocks.LightOffset[Builder_Block] >> FACE_ZMIN) & 1;
-	PackedCol orig = Lighting.Color_ZSide_Fast(x, y, z-offset);
-	PackedCol col0_0 = Builder_FullBright ? white : Modern_GetColorZ(orig, x, y, z-offset, -1, -1);
-	PackedCol col1_0 = Builder_FullBright ? white : Modern_GetColorZ(orig, x, y, z-offset, 1, -1);
-	PackedCol col1_1 = Builder_FullBright ? white : Modern_GetColorZ(orig, x, y, z-offset, 1, 1);
-	PackedCol col0_1 = Builder_FullBright ? white : Modern_GetColorZ(orig, x, y, z-offset, -1, 1);
+	int offset = 1;// (Blocks.LightOffset[ctx->block] >> FACE_ZMIN) & 1;
+	PackedCol orig, col0_0, col1_0, col1_1, col0_1;
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->fullBright) {
+		col0_0 = white; col1_0 = white; col1_1 = white; col0_1 = white;
+	} else {
+		orig   = Modern_Light(ctx, 0, 0, -offset);
+		col0_0 = Modern_GetColorZ(ctx, orig, 0, 0, -offset, -1, -1);
+		col1_0 = Modern_GetColorZ(ctx, orig, 0, 0, -offset,  1, -1);
+		col1_1 = Modern_GetColorZ(ctx, orig, 0, 0, -offset,  1,  1);
+		col0_1 = Modern_GetColorZ(ctx, orig, 0, 0, -offset, -1,  1);
+	}
+
+	if (ctx->drawer.Tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_ZMIN];
-	v.z = adv_z1;
-		v.x = adv_x1;               v.y = adv_y1; v.U = u1; v.V = v2; v.Col = col0_0; *vertices++ = v;
-		                            v.y = adv_y2;           v.V = v1; v.Col = col0_1; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
-		                            v.y = adv_y1;           v.V = v2; v.Col = col1_0; *vertices++ = v;
+	v.z = ctx->drawer.Z1;
+		v.x = ctx->drawer.X1;               v.y = ctx->drawer.Y1; v.U = u1; v.V = v2; v.Col = col0_0; *vertices++ = v;
+		                            v.y = ctx->drawer.Y2;           v.V = v1; v.Col = col0_1; *vertices++ = v;
+		v.x = ctx->drawer.X2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		                            v.y = ctx->drawer.Y1;           v.V = v2; v.Col = col1_0; *vertices++ = v;
 	part->faces.vertices[FACE_ZMIN] = vertices;
 }
 
-static void Modern_DrawZMax(int count, int x, int y, int z) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_ZMAX);
+static void Modern_DrawZMax(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_ZMAX);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.x, u2 = (count - 1) + adv_maxBB.x * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = ctx->drawer.MinBB.x, u2 = (count - 1) + ctx->drawer.MaxBB.x * UV2_Scale;
+	float v1 = vOrigin + ctx->drawer.MaxBB.y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->drawer.MinBB.y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	int offset = 1;// (Blocks.LightOffset[Builder_Block] >> FACE_ZMAX) & 1;
-	PackedCol orig = Lighting.Color_ZSide_Fast(x, y, z+offset);
-	PackedCol col0_0 = Builder_FullBright ? white : Modern_GetColorZ(orig, x, y, z+offset, -1, -1);
-	PackedCol col1_0 = Builder_FullBright ? white : Modern_GetColorZ(orig, x, y, z+offset, 1, -1);
-	PackedCol col1_1 = Builder_FullBright ? white : Modern_GetColorZ(orig, x, y, z+offset, 1, 1);
-	PackedCol col0_1 = Builder_FullBright ? white : Modern_GetColorZ(orig, x, y, z+offset, -1, 1);
+	int offset = 1;// (Blocks.LightOffset[ctx->block] >> FACE_ZMAX) & 1;
+	PackedCol orig, col0_0, col1_0, col1_1, col0_1;
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->fullBright) {
+		col0_0 = white; col1_0 = white; col1_1 = white; col0_1 = white;
+	} else {
+		orig   = Modern_Light(ctx, 0, 0, offset);
+		col0_0 = Modern_GetColorZ(ctx, orig, 0, 0, offset, -1, -1);
+		col1_0 = Modern_GetColorZ(ctx, orig, 0, 0, offset,  1, -1);
+		col1_1 = Modern_GetColorZ(ctx, orig, 0, 0, offset,  1,  1);
+		col0_1 = Modern_GetColorZ(ctx, orig, 0, 0, offset, -1,  1);
+	}
+
+	if (ctx->drawer.Tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_ZMAX];
-	v.z = adv_z2;
-		v.x = adv_x2 + (count - 1); v.y = adv_y2; v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
-		v.x = adv_x1;                             v.U = u1;           v.Col = col0_1; *vertices++ = v;
-		                            v.y = adv_y1;           v.V = v2; v.Col = col0_0; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
+	v.z = ctx->drawer.Z2;
+		v.x = ctx->drawer.X2 + (count - 1); v.y = ctx->drawer.Y2; v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
+		v.x = ctx->drawer.X1;                             v.U = u1;           v.Col = col0_1; *vertices++ = v;
+		                            v.y = ctx->drawer.Y1;           v.V = v2; v.Col = col0_0; *vertices++ = v;
+		v.x = ctx->drawer.X2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
 	part->faces.vertices[FACE_ZMAX] = vertices;
 }
 
-static PackedCol Modern_GetColorYMin(PackedCol orig, int x, int y, int z, int oX, int oZ) {
-	cc_bool xOccluded  = Modern_IsOccluded(x + oX, y, z     );
-	cc_bool zOccluded  = Modern_IsOccluded(x,      y, z + oZ);
-	cc_bool xzOccluded = Modern_IsOccluded(x + oX, y, z + oZ);
+static PackedCol Modern_GetColorYMin(struct BuilderContext* ctx, PackedCol orig, int x, int y, int z, int oX, int oZ) {
+	cc_bool xOccluded  = Modern_IsOccluded(ctx, x + oX, y, z     );
+	cc_bool zOccluded  = Modern_IsOccluded(ctx, x     , y, z + oZ);
+	cc_bool xzOccluded = Modern_IsOccluded(ctx, x + oX, y, z + oZ);
 
-	PackedCol CoX   =                                xOccluded ? PackedCol_Scale(orig, FANCY_AO) : Lighting.Color_YMin_Fast(x + oX, y, z     );
-	PackedCol CoZ   =                                zOccluded ? PackedCol_Scale(orig, FANCY_AO) : Lighting.Color_YMin_Fast(x     , y, z + oZ);
-	PackedCol CoXoZ = (xzOccluded || (xOccluded && zOccluded)) ? PackedCol_Scale(orig, FANCY_AO) : Lighting.Color_YMin_Fast(x + oX, y, z + oZ);
+	PackedCol CoX   =                                xOccluded ? PackedCol_Scale(orig, FANCY_AO) : Modern_Light(ctx, x + oX, y, z     );
+	PackedCol CoZ   =                                zOccluded ? PackedCol_Scale(orig, FANCY_AO) : Modern_Light(ctx, x     , y, z + oZ);
+	PackedCol CoXoZ = (xzOccluded || (xOccluded && zOccluded)) ? PackedCol_Scale(orig, FANCY_AO) : Modern_Light(ctx, x + oX, y, z + oZ);
 
 	PackedCol ab = AVERAGE(CoX, CoZ);
 	PackedCol cd = AVERAGE(CoXoZ, orig);
-	return AVERAGE(ab, cd);
+	return PackedCol_Scale(AVERAGE(ab, cd), PACKEDCOL_SHADE_YMIN);
 }
-static void Modern_DrawYMin(int count, int x, int y, int z) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_YMIN);
+static void Modern_DrawYMin(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_YMIN);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.x, u2 = (count - 1) + adv_maxBB.x * UV2_Scale;
-	float v1 = vOrigin + adv_minBB.z * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_maxBB.z * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = ctx->drawer.MinBB.x, u2 = (count - 1) + ctx->drawer.MaxBB.x * UV2_Scale;
+	float v1 = vOrigin + ctx->drawer.MinBB.z * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->drawer.MaxBB.z * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	int offset = 1;// (Blocks.LightOffset[Builder_Block] >> FACE_YMIN) & 1;
-	PackedCol orig = Lighting.Color_YMin_Fast(x, y-offset, z);
-	PackedCol col0_0 = Builder_FullBright ? white : Modern_GetColorYMin(orig, x, y-offset, z, -1, -1);
-	PackedCol col1_0 = Builder_FullBright ? white : Modern_GetColorYMin(orig, x, y-offset, z,  1, -1);
-	PackedCol col1_1 = Builder_FullBright ? white : Modern_GetColorYMin(orig, x, y-offset, z,  1,  1);
-	PackedCol col0_1 = Builder_FullBright ? white : Modern_GetColorYMin(orig, x, y-offset, z, -1,  1);
+	int offset = 1;// (Blocks.LightOffset[ctx->block] >> FACE_YMIN) & 1;
+	PackedCol orig, col0_0, col1_0, col1_1, col0_1;
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->fullBright) {
+		col0_0 = white; col1_0 = white; col1_1 = white; col0_1 = white;
+	} else {
+		orig   = Modern_Light(ctx, 0, -offset, 0);
+		col0_0 = Modern_GetColorYMin(ctx, orig, 0, -offset, 0, -1, -1);
+		col1_0 = Modern_GetColorYMin(ctx, orig, 0, -offset, 0,  1, -1);
+		col1_1 = Modern_GetColorYMin(ctx, orig, 0, -offset, 0,  1,  1);
+		col0_1 = Modern_GetColorYMin(ctx, orig, 0, -offset, 0, -1,  1);
+	}
+
+	if (ctx->drawer.Tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_YMIN];
-	v.y = adv_y1;
-		v.x = adv_x1;               v.z = adv_z2; v.U = u1; v.V = v2; v.Col = col0_1; *vertices++ = v;
-		                            v.z = adv_z1;           v.V = v1; v.Col = col0_0; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
-		                            v.z = adv_z2;           v.V = v2; v.Col = col1_1; *vertices++ = v;
+	v.y = ctx->drawer.Y1;
+		v.x = ctx->drawer.X1;               v.z = ctx->drawer.Z2; v.U = u1; v.V = v2; v.Col = col0_1; *vertices++ = v;
+		                            v.z = ctx->drawer.Z1;           v.V = v1; v.Col = col0_0; *vertices++ = v;
+		v.x = ctx->drawer.X2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
+		                            v.z = ctx->drawer.Z2;           v.V = v2; v.Col = col1_1; *vertices++ = v;
 	part->faces.vertices[FACE_YMIN] = vertices;
 }
 
-static PackedCol Modern_GetColorYMax(PackedCol orig, int x, int y, int z, int oX, int oZ) {
-	cc_bool xOccluded  = Modern_IsOccluded(x + oX, y, z     );
-	cc_bool zOccluded  = Modern_IsOccluded(x,      y, z + oZ);
-	cc_bool xzOccluded = Modern_IsOccluded(x + oX, y, z + oZ);
+static PackedCol Modern_GetColorYMax(struct BuilderContext* ctx, PackedCol orig, int x, int y, int z, int oX, int oZ) {
+	cc_bool xOccluded  = Modern_IsOccluded(ctx, x + oX, y, z     );
+	cc_bool zOccluded  = Modern_IsOccluded(ctx, x     , y, z + oZ);
+	cc_bool xzOccluded = Modern_IsOccluded(ctx, x + oX, y, z + oZ);
 
-	PackedCol CoX   =                                xOccluded ? PackedCol_Scale(orig, FANCY_AO) : Lighting.Color(x + oX, y, z     );
-	PackedCol CoZ   =                                zOccluded ? PackedCol_Scale(orig, FANCY_AO) : Lighting.Color(x     , y, z + oZ);
-	PackedCol CoXoZ = (xzOccluded || (xOccluded && zOccluded)) ? PackedCol_Scale(orig, FANCY_AO) : Lighting.Color(x + oX, y, z + oZ);
+	PackedCol CoX   =                                xOccluded ? PackedCol_Scale(orig, FANCY_AO) : Modern_Light(ctx, x + oX, y, z     );
+	PackedCol CoZ   =                                zOccluded ? PackedCol_Scale(orig, FANCY_AO) : Modern_Light(ctx, x     , y, z + oZ);
+	PackedCol CoXoZ = (xzOccluded || (xOccluded && zOccluded)) ? PackedCol_Scale(orig, FANCY_AO) : Modern_Light(ctx, x + oX, y, z + oZ);
 
 	PackedCol ab = AVERAGE(CoX, CoZ);
 	PackedCol cd = AVERAGE(CoXoZ, orig);
 	return AVERAGE(ab, cd);
 }
-static void Modern_DrawYMax(int count, int x, int y, int z) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_YMAX);
+static void Modern_DrawYMax(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_YMAX);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.x, u2 = (count - 1) + adv_maxBB.x * UV2_Scale;
-	float v1 = vOrigin + adv_minBB.z * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_maxBB.z * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = ctx->drawer.MinBB.x, u2 = (count - 1) + ctx->drawer.MaxBB.x * UV2_Scale;
+	float v1 = vOrigin + ctx->drawer.MinBB.z * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->drawer.MaxBB.z * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	int offset = 1;// (Blocks.LightOffset[Builder_Block] >> FACE_YMAX) & 1;
-	PackedCol orig = Lighting.Color(x, y+offset, z);
-	PackedCol col0_0 = Builder_FullBright ? white : Modern_GetColorYMax(orig, x, y+offset, z, -1, -1);
-	PackedCol col1_0 = Builder_FullBright ? white : Modern_GetColorYMax(orig, x, y+offset, z,  1, -1);
-	PackedCol col1_1 = Builder_FullBright ? white : Modern_GetColorYMax(orig, x, y+offset, z,  1,  1);
-	PackedCol col0_1 = Builder_FullBright ? white : Modern_GetColorYMax(orig, x, y+offset, z, -1,  1);
-
+	int offset = 1;// (Blocks.LightOffset[ctx->block] >> FACE_YMAX) & 1;
+	PackedCol orig, col0_0, col1_0, col1_1, col0_1;
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->fullBright) {
+		col0_0 = white; col1_0 = white; col1_1 = white; col0_1 = white;
+	} else {
+		orig   = Modern_Light(ctx, 0, offset, 0);
+		col0_0 = Modern_GetColorYMax(ctx, orig, 0, offset, 0, -1, -1);
+		col1_0 = Modern_GetColorYMax(ctx, orig, 0, offset, 0,  1, -1);
+		col1_1 = Modern_GetColorYMax(ctx, orig, 0, offset, 0,  1,  1);
+		col0_1 = Modern_GetColorYMax(ctx, orig, 0, offset, 0, -1,  1);
+	}
+
+	if (ctx->drawer.Tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_YMAX];
-	v.y = adv_y2;
-		v.x = adv_x1;               v.z = adv_z1; v.U = u1; v.V = v1; v.Col = col0_0; *vertices++ = v;
-		                            v.z = adv_z2;           v.V = v2; v.Col = col0_1; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
-		                            v.z = adv_z1;           v.V = v1; v.Col = col1_0; *vertices++ = v;
+	v.y = ctx->drawer.Y2;
+		v.x = ctx->drawer.X1;               v.z = ctx->drawer.Z1; v.U = u1; v.V = v1; v.Col = col0_0; *vertices++ = v;
+		                            v.z = ctx->drawer.Z2;           v.V = v2; v.Col = col0_1; *vertices++ = v;
+		v.x = ctx->drawer.X2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		                            v.z = ctx->drawer.Z1;           v.V = v1; v.Col = col1_0; *vertices++ = v;
 	part->faces.vertices[FACE_YMAX] = vertices;
 }
 
-static void Modern_RenderBlock(int index, int x, int y, int z) {
+static void Modern_RenderBlock(struct BuilderContext* ctx, int index, int x, int y, int z) {
 	Vec3 min, max;
 	int count_XMin, count_XMax, count_ZMin;
 	int count_ZMax, count_YMin, count_YMax;
 
-	if (Blocks.Draw[Builder_Block] == DRAW_SPRITE) {
-		Builder_DrawSprite(x, y, z); return;
+	if (Blocks.Draw[ctx->block] == DRAW_SPRITE) {
+		Builder_DrawSprite(ctx, x, y, z); return;
 	}
 
-	count_XMin = Builder_Counts[index + FACE_XMIN];
-	count_XMax = Builder_Counts[index + FACE_XMAX];
-	count_ZMin = Builder_Counts[index + FACE_ZMIN];
-	count_ZMax = Builder_Counts[index + FACE_ZMAX];
-	count_YMin = Builder_Counts[index + FACE_YMIN];
-	count_YMax = Builder_Counts[index + FACE_YMAX];
+	count_XMin = ctx->counts[index + FACE_XMIN];
+	count_XMax = ctx->counts[index + FACE_XMAX];
+	count_ZMin = ctx->counts[index + FACE_ZMIN];
+	count_ZMax = ctx->counts[index + FACE_ZMAX];
+	count_YMin = ctx->counts[index + FACE_YMIN];
+	count_YMax = ctx->counts[index + FACE_YMAX];
 
 	if (!count_XMin && !count_XMax && !count_ZMin &&
 		!count_ZMax && !count_YMin && !count_YMax) return;
 
-	Builder_FullBright = Blocks.Brightness[Builder_Block];
-	adv_baseOffset = (Blocks.Draw[Builder_Block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
-	adv_tinted = Blocks.Tinted[Builder_Block];
+	ctx->fullBright = Blocks.Brightness[ctx->block];
+	ctx->baseOffset = (Blocks.Draw[ctx->block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
+	ctx->drawer.Tinted = Blocks.Tinted[ctx->block];
 
-	min = Blocks.RenderMinBB[Builder_Block]; max = Blocks.RenderMaxBB[Builder_Block];
-	adv_x1 = x + min.x; adv_y1 = y + min.y; adv_z1 = z + min.z;
-	adv_x2 = x + max.x; adv_y2 = y + max.y; adv_z2 = z + max.z;
+	min = Blocks.RenderMinBB[ctx->block]; max = Blocks.RenderMaxBB[ctx->block];
+	ctx->drawer.X1 = x + min.x; ctx->drawer.Y1 = y + min.y; ctx->drawer.Z1 = z + min.z;
+	ctx->drawer.X2 = x + max.x; ctx->drawer.Y2 = y + max.y; ctx->drawer.Z2 = z + max.z;
 
-	adv_minBB = Blocks.MinBB[Builder_Block]; adv_maxBB = Blocks.MaxBB[Builder_Block];
-	adv_minBB.y = 1.0f - adv_minBB.y; adv_maxBB.y = 1.0f - adv_maxBB.y;
+	ctx->drawer.MinBB = Blocks.MinBB[ctx->block]; ctx->drawer.MaxBB = Blocks.MaxBB[ctx->block];
+	ctx->drawer.MinBB.y = 1.0f - ctx->drawer.MinBB.y; ctx->drawer.MaxBB.y = 1.0f - ctx->drawer.MaxBB.y;
+	ctx->x = x; ctx->y = y; ctx->z = z;
 
-	if (count_XMin) Modern_DrawXMin(count_XMin, x, y, z);
-	if (count_XMax) Modern_DrawXMax(count_XMax, x, y, z);
-	if (count_ZMin) Modern_DrawZMin(count_ZMin, x, y, z);
-	if (count_ZMax) Modern_DrawZMax(count_ZMax, x, y, z);
-	if (count_YMin) Modern_DrawYMin(count_YMin, x, y, z);
-	if (count_YMax) Modern_DrawYMax(count_YMax, x, y, z);
+	if (count_XMin) Modern_DrawXMin(ctx, count_XMin);
+	if (count_XMax) Modern_DrawXMax(ctx, count_XMax);
+	if (count_ZMin) Modern_DrawZMin(ctx, count_ZMin);
+	if (count_ZMax) Modern_DrawZMax(ctx, count_ZMax);
+	if (count_YMin) Modern_DrawYMin(ctx, count_YMin);
+	if (count_YMax) Modern_DrawYMax(ctx, count_YMax);
 }
 
-static void Modern_PrePrepareChunk(void) {
-	DefaultPrePrepateChunk();
-	adv_bitFlags = Builder_BitFlags;
+static void Modern_PostPrepareChunk(struct BuilderContext* ctx) {
+	DefaultPostStretchChunk(ctx);
+	/* Light colors are then looked up as the chunk's blocks are drawn */
+	Mem_Set(ctx->light, 0, EXTCHUNK_SIZE_3 * sizeof(PackedCol));
 }
 
 static void ModernBuilder_SetActive(void) {
@@ -1624,17 +2185,361 @@ static void ModernBuilder_SetActive(void) {
 	Builder_StretchX =        Modern_StretchX;
 	Builder_StretchZ =        Modern_StretchZ;
 	Builder_RenderBlock =     Modern_RenderBlock;
-	Builder_PrePrepareChunk = Modern_PrePrepareChunk;
+	Builder_PostPrepareChunk = Modern_PostPrepareChunk;
 }
 #else
 static void ModernBuilder_SetActive(void) { NormalBuilder_SetActive(); }
 #endif
 
+/*########################################################################################################################*
+*-------------------------------------------------Background mesh building------------------------------------------------*
+*#########################################################################################################################*/
+int Builder_Workers;
+/* NOTE: Compact world sections can be reallocated when a block changes, so can't be read from other threads */
+#if !defined CC_BUILD_COOPTHREADED && !defined CC_BUILD_LOWMEM && !defined CC_BUILD_PSP && !defined CC_BUILD_NDS && !defined CC_BUILD_COMPACTWORLD
+#define BUILDER_MAX_WORKERS 8
+/* Background building is opt-in (see OPT_BUILDER_THREADS) */
+#define BUILDER_DEFAULT_WORKERS 0
+/* Maximum number of chunks that can be queued for/built by worker threads at once */
+#define BUILDER_MAX_JOBS (BUILDER_MAX_WORKERS * 4)
+
+/* State for building the mesh of a chunk on a worker thread */
+struct BuilderJob {
+	struct BuilderContext ctx;
+	struct ChunkInfo* info;
+	int x1, y1, z1;
+	/* Value of MapRenderer_1DUsedCount when the job was queued */
+	int usedAtlases;
+	/* Number of vertices in the built mesh, or -1 if out of memory */
+	int totalVerts, vertsCapacity;
+	/* Whether the chunk has any blocks which might need to be drawn */
+	cc_bool hasBlocks;
+	cc_bool allAir, hasNorm, hasTran;
+	cc_uint16 connectivity;
+	struct ChunkPartInfo normalParts[ATLAS1D_MAX_ATLASES];
+	struct ChunkPartInfo translucentParts[ATLAS1D_MAX_ATLASES];
+	BlockID chunk[EXTCHUNK_SIZE_3];
+	cc_uint8 counts[CHUNK_SIZE_3 * FACE_COUNT];
+#ifdef CC_BUILD_ADVLIGHTING
+	int bitFlags[EXTCHUNK_SIZE_3];
+#else
+	int bitFlags[1];
+#endif
+#ifdef BUILDER_GREEDY_MESHING
+	cc_uint8 spans[CHUNK_SIZE_3 * FACE_COUNT];
+#else
+	cc_uint8 spans[1];
+#endif
+};
+
+struct BuilderJobList { int count; struct BuilderJob* entries[BUILDER_MAX_JOBS]; };
+static void BuilderJobList_Add(struct BuilderJobList* list, struct BuilderJob* job) {
+	list->entries[list->count++] = job;
+}
+
+static struct BuilderJob* BuilderJobList_Take(struct BuilderJobList* list) {
+	struct BuilderJob* job = list->entries[0];
+	list->count--;
+	Mem_Move(&list->entries[0], &list->entries[1], list->count * sizeof(struct BuilderJob*));
+	return job;
+}
+
+/* Jobs not currently in use (only accessed by main thread) */
+static struct BuilderJobList freeJobs;
+/* Jobs waiting to be picked up by a worker thread, ordered from nearest to furthest chunk */
+static struct BuilderJobList pendingJobs;
+/* Jobs whose chunk meshes have been built and are waiting to be uploaded */
+static struct BuilderJobList builtJobs;
+static int busyJobs, allocatedJobs;
+static struct BuilderJob* allJobs[BUILDER_MAX_JOBS];
+
+static void* workerThreads[BUILDER_MAX_WORKERS];
+static void* jobsMutex;
+static void* jobsWaitable;
+/* Signalled whenever worker threads have finished building all the chunks they were building */
+static void* jobsIdleWaitable;
+static volatile cc_bool workersQuit;
+static int workersStarted;
+
+static void BuilderJob_Build(struct BuilderJob* job) {
+	struct BuilderContext* ctx = &job->ctx;
+	struct VertexTextured* verts;
+	int totalVerts;
+
+	job->totalVerts = 0;
+	if (!job->hasBlocks) return;
+
+	totalVerts = Builder_CountChunk(ctx, job->x1, job->y1, job->z1);
+	if (!totalVerts) return;
+
+	OutputChunkPartsMeta(ctx, job->normalParts, job->translucentParts,
+						1, job->usedAtlases, &job->hasNorm, &job->hasTran);
+
+	if (totalVerts > job->vertsCapacity) {
+		verts = (struct VertexTextured*)Mem_TryRealloc(ctx->vertices, totalVerts, SIZEOF_VERTEX_TEXTURED);
+		if (!verts) { job->totalVerts = -1; return; }
+
+		ctx->vertices      = verts;
+		job->vertsCapacity = totalVerts;
+	}
+
+	Builder_RenderChunk(ctx, job->x1, job->y1, job->z1);
+	job->totalVerts = totalVerts;
+}
+
+static void BuilderWorker_Loop(void) {
+	struct BuilderJob* job;
+	cc_bool moreJobs, idle;
+	cc_uint64 beg;
+	int workerID;
+
+	/* Only used to distinguish between workers in profiler traces */
+	Mutex_Lock(jobsMutex);
+	workerID = ++workersStarted;
+	Mutex_Unlock(jobsMutex);
+
+	while (!workersQuit) {
+		job      = NULL;
+		moreJobs = false;
+
+		Mutex_Lock(jobsMutex);
+		{
+			if (pendingJobs.count) {
+				job = BuilderJobList_Take(&pendingJobs);
+				busyJobs++;
+				moreJobs = pendingJobs.count > 0;
+			}
+		}
+		Mutex_Unlock(jobsMutex);
+
+		if (!job) {
+			/* Block until main thread queues more chunks to build */
+			Waitable_Wait(jobsWaitable); continue;
+		}
+		/* Wake up another worker thread to build the next chunk */
+		if (moreJobs) Waitable_Signal(jobsWaitable);
+
+		beg = Profiler_Begin();
+		BuilderJob_Build(job);
+		if (beg) Profiler_Record(PROFILER_CHUNK_BUILD, workerID, beg);
+
+		Mutex_Lock(jobsMutex);
+		{
+			BuilderJobList_Add(&builtJobs, job);
+			idle = --busyJobs == 0;
+		}
+		Mutex_Unlock(jobsMutex);
+		if (idle) Waitable_Signal(jobsIdleWaitable);
+	}
+	/* Wake up another worker thread so it also sees that it needs to quit */
+	Waitable_Signal(jobsWaitable);
+}
+
+static void BuilderJob_Discard(struct BuilderJob* job) {
+	job->info->building = false;
+	job->info->dirty    = true;
+	BuilderJobList_Add(&freeJobs, job);
+}
+
+static struct BuilderJob* BuilderJob_Get(void) {
+	struct BuilderJob* job;
+	if (freeJobs.count) return BuilderJobList_Take(&freeJobs);
+	if (allocatedJobs == BUILDER_MAX_JOBS) return NULL;
+
+	job = (struct BuilderJob*)Mem_TryAllocCleared(1, sizeof(struct BuilderJob));
+	if (!job) return NULL;
+
+	job->ctx.chunk    = job->chunk;
+	job->ctx.counts   = job->counts;
+	job->ctx.bitFlags = job->bitFlags;
+	job->ctx.light    = (PackedCol*)job->bitFlags;
+	job->ctx.spans    = job->spans;
+	allJobs[allocatedJobs++] = job;
+	return job;
+}
+
+cc_bool Builder_QueueChunk(struct ChunkInfo* info) {
+	struct BuilderJob* job;
+	if (!Builder_Workers || !(job = BuilderJob_Get())) return false;
+
+	job->info = info;
+	job->x1   = info->centreX - HALF_CHUNK_SIZE;
+	job->y1   = info->centreY - HALF_CHUNK_SIZE;
+	job->z1   = info->centreZ - HALF_CHUNK_SIZE;
+	job->usedAtlases = MapRenderer_1DUsedCount;
+	job->ctx.lod     = info->lod;
+
+	/* Worker threads never read world blocks, as the main thread may change them at any time */
+	/*  (instead the chunk's blocks are copied here, and blocks changed afterwards mark it dirty again) */
+	job->hasBlocks = Builder_ReadChunk(&job->ctx, job->x1, job->y1, job->z1, &job->allAir, &job->connectivity);
+	/* Lighting must be calculated on the main thread, so worker threads only ever read it */
+	if (job->hasBlocks) Lighting.LightHint(job->x1 - 1, job->y1 - 1, job->z1 - 1);
+	info->dirty    = false;
+	info->building = true;
+
+	Mutex_Lock(jobsMutex);
+	{
+		BuilderJobList_Add(&pendingJobs, job);
+	}
+	Mutex_Unlock(jobsMutex);
+	Waitable_Signal(jobsWaitable);
+	return true;
+}
+
+struct ChunkInfo* Builder_NextBuiltChunk(void) {
+	struct ChunkInfo* info = NULL;
+	if (!Builder_Workers) return NULL;
+
+	Mutex_Lock(jobsMutex);
+	{
+		if (builtJobs.count) info = builtJobs.entries[0]->info;
+	}
+	Mutex_Unlock(jobsMutex);
+	return info;
+}
+
+cc_bool Builder_UploadChunk(struct ChunkInfo* info) {
+	struct BuilderJob* job;
+	struct BuilderContext* ctx;
+	int i, partsIndex, curIdx, totalVerts;
+	cc_bool success = true;
+	void* data;
+
+	Mutex_Lock(jobsMutex);
+	{
+		job = BuilderJobList_Take(&builtJobs);
+	}
+	Mutex_Unlock(jobsMutex);
+
+	ctx        = &job->ctx;
+	totalVerts = job->totalVerts;
+	info->building     = false;
+	info->allAir       = job->allAir;
+	info->connectivity = job->connectivity;
+
+	/* Parts layout may have changed since chunk was queued */
+	if (totalVerts < 0 || job->usedAtlases != MapRenderer_1DUsedCount) {
+		info->allAir = false;
+		success      = false;
+	} else if (totalVerts) {
+		partsIndex = World_ChunkPack(job->x1 >> CHUNK_SHIFT, job->y1 >> CHUNK_SHIFT, job->z1 >> CHUNK_SHIFT);
+
+		for (i = 0; i < job->usedAtlases; i++) {
+			curIdx = partsIndex + i * World.ChunksCount;
+			MapRenderer_PartsNormal[curIdx]      = job->normalParts[i];
+			MapRenderer_PartsTranslucent[curIdx] = job->translucentParts[i];
+		}
+
+		if (job->hasNorm) info->normalParts      = &MapRenderer_PartsNormal[partsIndex];
+		if (job->hasTran) info->translucentParts = &MapRenderer_PartsTranslucent[partsIndex];
+
+#if CC_GFX_BACKEND != CC_GFX_BACKEND_GL11
+		/* add an extra element to fix crashing on some GPUs */
+		info->vb = Gfx_TryCreateStaticVb(VERTEX_FORMAT_TEXTURED, totalVerts + 1);
+
+		if (info->vb) {
+			data = Gfx_LockVb(info->vb, VERTEX_FORMAT_TEXTURED, totalVerts + 1);
+			Mem_Copy(data, ctx->vertices, totalVerts * SIZEOF_VERTEX_TEXTURED);
+			Gfx_UnlockVb(info->vb);
+		} else {
+			success = false;
+		}
+#else
+		BuildChunkPartVbs(ctx, partsIndex);
+#endif
+	}
+
+	BuilderJobList_Add(&freeJobs, job);
+	return success;
+}
+
+void Builder_CancelAll(void) {
+	int busy;
+	if (!Builder_Workers) return;
+
+	Mutex_Lock(jobsMutex);
+	{
+		while (pendingJobs.count) BuilderJob_Discard(BuilderJobList_Take(&pendingJobs));
+	}
+	Mutex_Unlock(jobsMutex);
+
+	/* Wait for worker threads to finish the chunks they are currently building */
+	/*  (jobsIdleWaitable may also still be signalled from earlier, hence the loop) */
+	for (;;) {
+		Mutex_Lock(jobsMutex);
+		busy = busyJobs;
+		Mutex_Unlock(jobsMutex);
+
+		if (!busy) break;
+		Waitable_Wait(jobsIdleWaitable);
+	}
+
+	Mutex_Lock(jobsMutex);
+	{
+		while (builtJobs.count) BuilderJob_Discard(BuilderJobList_Take(&builtJobs));
+	}
+	Mutex_Unlock(jobsMutex);
+}
+
+static void BuilderWorkers_Start(int count) {
+	int i;
+	count = min(count, BUILDER_MAX_WORKERS);
+	if (count <= 0) return;
+
+	jobsMutex      = Mutex_Create("Builder jobs");
+	jobsWaitable   = Waitable_Create("Builder wakeup");
+	jobsIdleWaitable = Waitable_Create("Builder idle");
+	workersQuit    = false;
+	workersStarted = 0;
+
+	for (i = 0; i < count; i++) {
+		Thread_Run(&workerThreads[i], BuilderWorker_Loop, 64 * 1024, "Chunk builder");
+	}
+	Builder_Workers = count;
+}
+
+static void BuilderWorkers_Stop(void) {
+	int i;
+	if (!Builder_Workers) return;
+	Builder_CancelAll();
+
+	workersQuit = true;
+	Waitable_Signal(jobsWaitable);
+	for (i = 0; i < Builder_Workers; i++) {
+		Thread_Join(workerThreads[i]);
+	}
+
+	for (i = 0; i < allocatedJobs; i++) {
+		Mem_Free(allJobs[i]->ctx.vertices);
+		Mem_Free(allJobs[i]);
+	}
+	allocatedJobs   = 0;
+	freeJobs.count  = 0;
+	Builder_Workers = 0;
+
+	Mutex_Free(jobsMutex);
+	Waitable_Free(jobsWaitable);
+	Waitable_Free(jobsIdleWaitable);
+}
+#else
+#define BUILDER_MAX_WORKERS     0
+#define BUILDER_DEFAULT_WORKERS 0
+cc_bool Builder_QueueChunk(struct ChunkInfo* info) { return false; }
+struct ChunkInfo* Builder_NextBuiltChunk(void) { return NULL; }
+cc_bool Builder_UploadChunk(struct ChunkInfo* info) { return false; }
+void Builder_CancelAll(void) { }
+
+static void BuilderWorkers_Start(int count) { }
+static void BuilderWorkers_Stop(void) { }
+#endif
+
+
 /*########################################################################################################################*
 *---------------------------------------------------Builder interface-----------------------------------------------------*
 *#########################################################################################################################*/
-cc_bool Builder_SmoothLighting;
+cc_bool Builder_SmoothLighting, Builder_GreedyMeshing;
 void Builder_ApplyActive(void) {
+	Builder_CancelAll();
 	if (Builder_SmoothLighting) {
 		if (Lighting_Mode != LIGHTING_MODE_CLASSIC) {
 			ModernBuilder_SetActive();
@@ -1642,6 +2547,8 @@ void Builder_ApplyActive(void) {
 		else {
 			AdvBuilder_SetActive();
 		}
+	} else if (Builder_GreedyMeshing) {
+		GreedyBuilder_SetActive();
 	} else {
 		NormalBuilder_SetActive();
 	}
@@ -1656,7 +2563,15 @@ static void OnInit(void) {
 	Builder_Offsets[FACE_YMAX] =  EXTCHUNK_SIZE_2;
 
 	if (!Game_ClassicMode) Builder_SmoothLighting = Options_GetBool(OPT_SMOOTH_LIGHTING, false);
+#ifdef BUILDER_GREEDY_MESHING
+	Builder_GreedyMeshing = Options_GetBool(OPT_GREEDY_MESHING, false);
+#endif
 	Builder_ApplyActive();
+	BuilderWorkers_Start(Options_GetInt(OPT_BUILDER_THREADS, 0, BUILDER_MAX_WORKERS, BUILDER_DEFAULT_WORKERS));
+}
+
+static void OnFree(void) {
+	BuilderWorkers_Stop();
 }
 
 static void OnNewMapLoaded(void) {
@@ -1666,7 +2581,7 @@ static void OnNewMapLoaded(void) {
 
 struct IGameComponent Builder_Component = {
 	OnInit, /* Init */
-	NULL, /* Free */
+	OnFree, /* Free */
 	NULL, /* Reset */
 	NULL, /* OnNewMap */
 	OnNewMapLoaded /* OnNewMapLoaded */
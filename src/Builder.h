@@ -8,6 +8,13 @@ Converts a 16x16x16 chunk into a mesh of vertices
   NormalMeshBuilder:
     Implements a simple chunk mesh builder, where each block face is a single colour
     (whatever lighting engine returns as light colour for given block face at given coordinates)
+  GreedyMeshBuilder:
+    Same as NormalMeshBuilder, but also merges faces into rectangles along both axes of the face
+    (1D terrain atlases then store each tile as a strip of Atlas1D.TileRepeats copies, so faces are
+     only merged up to that many rows along the V axis, while U wraps around the atlas as normal)
+  LodMeshBuilder:
+    Builds a coarse mesh for far away chunks, where each 2x2x2 or 4x4x4 cell of blocks is drawn
+    as a single cuboid (used instead of the other builders when a chunk's lod is not 0)
 
 Copyright 2014-2025 ClassiCube | Licensed under BSD-3
 */
@@ -18,12 +25,33 @@ extern struct IGameComponent Builder_Component;
 extern int Builder_SidesLevel, Builder_EdgeLevel;
 /* Whether smooth/advanced lighting mesh builder is used. */
 extern cc_bool Builder_SmoothLighting;
+/* Whether greedy mesh builder is used when smooth lighting is off. */
+/* NOTE: Terrain atlas must be reloaded for changes to this to take full effect */
+extern cc_bool Builder_GreedyMeshing;
 
-/* Builds the mesh of vertices for the given chunk. */
+/* Builds the mesh of vertices for the given chunk, at the chunk's level of detail. */
 /* Returns false if vertex buffer allocation fails */
 cc_bool Builder_MakeChunk(struct ChunkInfo* info);
 
 void Builder_ApplyActive(void);
 
+/* Number of background threads that build chunk meshes (0 if meshes are only built on main thread) */
+/* NOTE: Background threads only read the copy of the chunk's blocks made by Builder_QueueChunk, */
+/*  block properties, Env colours, and lighting data which Lighting.LightHint calculated for the chunk */
+extern int Builder_Workers;
+/* Queues the given chunk to have its mesh built on a background thread. */
+/* Returns false if the chunk could not be queued (e.g. too many chunks already queued) */
+/* NOTE: Chunks are built in the same order that they are queued in */
+cc_bool Builder_QueueChunk(struct ChunkInfo* info);
+/* Returns the next chunk whose mesh has been built on a background thread, or NULL if none */
+struct ChunkInfo* Builder_NextBuiltChunk(void);
+/* Creates the vertex buffer for the mesh of the chunk returned by Builder_NextBuiltChunk */
+/* Returns false if vertex buffer allocation fails */
+cc_bool Builder_UploadChunk(struct ChunkInfo* info);
+/* Discards all chunks queued for or being built on background threads, */
+/*  and waits until background threads are no longer reading any world state */
+/* NOTE: Must be called before freeing any state that background threads read from */
+void Builder_CancelAll(void);
+
 CC_END_HEADER
 #endif
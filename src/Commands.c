@@ -18,6 +18,8 @@
 #include "Options.h"
 #include "Drawer2D.h"
 #include "Audio.h"
+#include "Profiler.h"
+#include "Screens.h"
 
 #define COMMANDS_PREFIX "/client"
 #define COMMANDS_PREFIX_SPACE "/client "
@@ -310,6 +312,38 @@ static struct ChatCommand MotdCommand = {
 	}
 };
 
+static void ProfilerCommand_Execute(const cc_string* args, int argsCount) {
+	if (!argsCount) {
+		Chat_Add1("&e/client: &fFrame profiler is currently %c.", Profiler_Enabled ? "on" : "off");
+	} else if (String_CaselessEqualsConst(args, "on")) {
+		if (!Profiler_SetEnabled(true)) {
+			Chat_AddRaw("&e/client: &cOut of memory starting frame profiler."); return;
+		}
+		ProfilerOverlay_Show();
+		Chat_AddRaw("&e/client: &fFrame profiler is now on.");
+	} else if (String_CaselessEqualsConst(args, "off")) {
+		Profiler_SetEnabled(false);
+		ProfilerOverlay_Hide();
+		Chat_AddRaw("&e/client: &fFrame profiler is now off.");
+	} else if (String_CaselessEqualsConst(args, "export")) {
+		Profiler_ExportTrace();
+	} else {
+		Chat_Add1("&e/client: &cUnrecognised profiler option &f\"%s\"&c.", args);
+	}
+}
+
+static struct ChatCommand ProfilerCommand = {
+	"Profiler", ProfilerCommand_Execute,
+	COMMAND_FLAG_UNSPLIT_ARGS,
+	{
+		"&a/client profiler [on/off/export]",
+		"&bon: &eRecords how long each stage of a frame takes, and shows the timings",
+		"&boff: &eStops recording timings and hides them",
+		"&bexport: &eSaves the recorded timings to a Chrome trace file in the traces folder",
+		"   &eTraces can be viewed using chrome://tracing or ui.perfetto.dev",
+	}
+};
+
 /*#######################################################################################################################*
 *-------------------------------------------------------PlaceCommand-----------------------------------------------------*
 *########################################################################################################################*/
@@ -811,6 +845,7 @@ static void OnInit(void) {
 	Commands_Register(&TeleportCommand);
 	Commands_Register(&ClearDeniedCommand);
 	Commands_Register(&MotdCommand);
+	Commands_Register(&ProfilerCommand);
 	Commands_Register(&PlaceCommand);
 	Commands_Register(&BlockEditCommand);
 	Commands_Register(&CuboidCommand);
@@ -158,6 +158,22 @@ enum INFLATE_STATE_ {
 /* The most input bytes required for huffman codes and extra data is 16 + 5 + 16 + 13 bits. Add 3 extra bytes to account for putting data into the bit buffer. */
 #define INFLATE_FASTINF_IN 10
 
+/* Minimum output space for decoding directly into the output buffer, instead of via the window */
+#define INFLATE_FASTDIRECT_OUT 1024
+/* Direct decoding refills a register sized bit buffer, which may read up to 12 bytes per entry */
+#define INFLATE_FASTDIRECT_IN  16
+/* Match copies may write up to this many bytes past the end of the match */
+#define INFLATE_FASTDIRECT_SLACK 8
+
+/* Whether unaligned 8 byte loads/stores are cheap, and the bit buffer can be refilled a word at a time */
+#if defined __GNUC__ && !defined CC_BIG_ENDIAN && (defined __x86_64__ || defined __aarch64__)
+	#define INFLATE_FAST_WORDS
+	#define Inflate_CopyWord(dst, src) __builtin_memcpy(dst, src, 8)
+#elif defined _MSC_VER && (defined _M_X64 || defined _M_ARM64)
+	#define INFLATE_FAST_WORDS
+	#define Inflate_CopyWord(dst, src) *((cc_uint64*)(dst)) = *((const cc_uint64*)(src))
+#endif
+
 static cc_uint32 Huffman_ReverseBits(cc_uint32 n, cc_uint8 bits) {
 	n = ((n & 0xAAAA) >> 1) | ((n & 0x5555) << 1);
 	n = ((n & 0xCCCC) >> 2) | ((n & 0x3333) << 2);
@@ -327,6 +343,24 @@ static int Huffman_UNSAFE_Decode_Slow(struct InflateState* state, struct Huffman
 	return 0;
 }
 
+/* Slow, bit by bit lookup of a codeword longer than INFLATE_FAST_BITS, from the given buffered bits */
+/* Returns the length and value packed like the fast table, or -1 if the codeword is invalid */
+static int Huffman_DecodeSlowBits(const struct HuffmanTable* table, cc_uint32 bits) {
+	cc_uint32 i, codeword;
+	int offset;
+
+	codeword = Huffman_ReverseBits(bits & INFLATE_FAST_VAL_MASK, INFLATE_FAST_BITS);
+	for (i = INFLATE_FAST_BITS + 1; i < INFLATE_MAX_BITS; i++) {
+		codeword = (codeword << 1) | ((bits >> (i - 1)) & 1);
+
+		if (codeword < table->endCodewords[i]) {
+			offset = table->firstOffsets[i] + (codeword - table->firstCodewords[i]);
+			return (i << INFLATE_FAST_LEN_SHIFT) | table->values[offset];
+		}
+	}
+	return -1;
+}
+
 void Inflate_Init2(struct InflateState* state, struct Stream* source) {
 	state->State = INFLATE_STATE_HEADER;
 	state->LastBlock = false;
@@ -356,21 +390,35 @@ static const cc_uint8 fixed_dists[INFLATE_MAX_DISTS] = {
 	5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5, 5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5
 };
 
-static const cc_uint16 len_base[31] = { 
-	3,4,5,6,7,8,9,10,11,13,
-	15,17,19,23,27,31,35,43,51,59,
-	67,83,99,115,131,163,195,227,258,0,0 
+/* Packed base lengths and number of extra bits (base | extra bits << 16) for each length code */
+#define LEN_(base, bits) ((base) | ((cc_uint32)(bits) << 16))
+static const cc_uint32 len_codes[31] = {
+	LEN_(3,0),   LEN_(4,0),   LEN_(5,0),   LEN_(6,0),   LEN_(7,0),
+	LEN_(8,0),   LEN_(9,0),   LEN_(10,0),  LEN_(11,1),  LEN_(13,1),
+	LEN_(15,1),  LEN_(17,1),  LEN_(19,2),  LEN_(23,2),  LEN_(27,2),
+	LEN_(31,2),  LEN_(35,3),  LEN_(43,3),  LEN_(51,3),  LEN_(59,3),
+	LEN_(67,4),  LEN_(83,4),  LEN_(99,4),  LEN_(115,4), LEN_(131,5),
+	LEN_(163,5), LEN_(195,5), LEN_(227,5), LEN_(258,0), 0, 0
+};
+/* Packed base distances and number of extra bits (base | extra bits << 16) for each distance code */
+static const cc_uint32 dist_codes[32] = {
+	LEN_(1,0),     LEN_(2,0),     LEN_(3,0),     LEN_(4,0),     LEN_(5,1),
+	LEN_(7,1),     LEN_(9,2),     LEN_(13,2),    LEN_(17,3),    LEN_(25,3),
+	LEN_(33,4),    LEN_(49,4),    LEN_(65,5),    LEN_(97,5),    LEN_(129,6),
+	LEN_(193,6),   LEN_(257,7),   LEN_(385,7),   LEN_(513,8),   LEN_(769,8),
+	LEN_(1025,9),  LEN_(1537,9),  LEN_(2049,10), LEN_(3073,10), LEN_(4097,11),
+	LEN_(6145,11), LEN_(8193,12), LEN_(12289,12),LEN_(16385,13),LEN_(24577,13), 0, 0
 };
+#define Inflate_CodeBase(code) ((code) & 0xFFFF)
+#define Inflate_CodeBits(code) ((code) >> 16)
+
+/* Extra bits per length code, used by the compressor */
 static const cc_uint8 len_bits[31] = { 
 	0,0,0,0,0,0,0,0,1,1,
 	1,1,2,2,2,2,3,3,3,3,
 	4,4,4,4,5,5,5,5,0,0,0 
 };
-static const cc_uint16 dist_base[32] = {
-	1,2,3,4,5,7,9,13,17,25,
-	33,49,65,97,129,193,257,385,513,769,
-	1025,1537,2049,3073,4097,6145,8193,12289,16385,24577,0,0 
-};
+/* Extra bits per distance code, used by the compressor */
 static const cc_uint8 dist_bits[32] = {
 	0,0,0,0,1,1,2,2,3,3,
 	4,4,5,5,6,6,7,7,8,8,
@@ -383,7 +431,7 @@ static const cc_uint8 codelens_order[INFLATE_MAX_CODELENS] = {
 static void Inflate_InflateFast(struct InflateState* s) {
 	/* huffman variables */
 	cc_uint32 lit, len, dist;
-	cc_uint32 bits, lenIdx, distIdx;
+	cc_uint32 bits, code, distIdx;
 	int packed, consumedBits;
 
 	/* window variables */
@@ -410,15 +458,16 @@ static void Inflate_InflateFast(struct InflateState* s) {
 				break;
 			}
 		} else {
-			lenIdx = lit - 257;
-			bits = len_bits[lenIdx];
+			code = len_codes[lit - 257];
+			bits = Inflate_CodeBits(code);
 			Inflate_UNSAFE_EnsureBits(s, bits);
-			len  = len_base[lenIdx] + Inflate_ReadBits(s, bits);
+			len  = Inflate_CodeBase(code) + Inflate_ReadBits(s, bits);
 
 			Huffman_UNSAFE_Decode(s, s->TableDists, distIdx);
-			bits = dist_bits[distIdx];
+			code = dist_codes[distIdx];
+			bits = Inflate_CodeBits(code);
 			Inflate_UNSAFE_EnsureBits(s, bits);
-			dist = dist_base[distIdx] + Inflate_ReadBits(s, bits);
+			dist = Inflate_CodeBase(code) + Inflate_ReadBits(s, bits);
 	
 			/* Window infinitely repeats like ...xyz|uvwxyz|uvwxyz|uvw... */
 			/* If start and end don't cross a boundary, can avoid masking index */
@@ -456,6 +505,170 @@ static void Inflate_InflateFast(struct InflateState* s) {
 	}
 }
 
+/* Appends data that was written to the output to the end of the window */
+static void Inflate_AppendWindow(struct InflateState* s, const cc_uint8* data, cc_uint32 len) {
+	cc_uint32 partLen;
+	/* Only the most recent data can ever be referenced */
+	if (len > INFLATE_WINDOW_SIZE) {
+		s->WindowIndex = (s->WindowIndex + (len - INFLATE_WINDOW_SIZE)) & INFLATE_WINDOW_MASK;
+		data += len - INFLATE_WINDOW_SIZE;
+		len   = INFLATE_WINDOW_SIZE;
+	}
+
+	partLen = INFLATE_WINDOW_SIZE - s->WindowIndex;
+	partLen = min(partLen, len);
+	Mem_Copy(&s->Window[s->WindowIndex], data, partLen);
+	/* Wrap around remainder of copy to start from beginning of window */
+	if (partLen < len) {
+		Mem_Copy(s->Window, data + partLen, len - partLen);
+	}
+	s->WindowIndex = (s->WindowIndex + len) & INFLATE_WINDOW_MASK;
+}
+
+#define INFLATE_FAST_BUFFER_BITS (sizeof(cc_uintptr) * 8)
+/* Refills the local bit buffer with as many whole bytes as will fit */
+#ifdef INFLATE_FAST_WORDS
+#define Inflate_FastRefill() \
+	Inflate_CopyWord(&word, in);\
+	bitbuf  |= word << numBits;\
+	in      += (63 - numBits) >> 3;\
+	numBits |= 56;
+#else
+#define Inflate_FastRefill() \
+	while (numBits <= INFLATE_FAST_BUFFER_BITS - 8) {\
+		bitbuf  |= (cc_uintptr)(*in++) << numBits;\
+		numBits += 8;\
+	}
+#endif
+#define Inflate_FastEnsure(bits) if (numBits < (bits)) { Inflate_FastRefill(); }
+#define Inflate_FastConsume(bits) bitbuf >>= (bits); numBits -= (bits);
+
+/* Decodes a huffman codeword from the local bit buffer, exiting the decode loop if invalid */
+#define Inflate_FastDecode(table, result) \
+	packed = table->fast[bitbuf & INFLATE_FAST_VAL_MASK];\
+	if (packed < 0) packed = Huffman_DecodeSlowBits(table, (cc_uint32)bitbuf);\
+	if (packed < 0) { Inflate_Fail(s, INF_ERR_INVALID_CODE); break; }\
+	Inflate_FastConsume(packed >> INFLATE_FAST_LEN_SHIFT);\
+	result = packed & INFLATE_FAST_VAL_MASK;
+
+/* Like Inflate_InflateFast, but decodes straight into the output buffer instead of into the window */
+/* (so decompressed data is only written once), and buffers a register's worth of input bits at a time */
+static void Inflate_InflateFastDirect(struct InflateState* s) {
+	const struct HuffmanTable* lits  = &s->Table.Lits;
+	const struct HuffmanTable* dists = &s->TableDists;
+	/* bit buffer variables */
+	cc_uintptr bitbuf;
+	cc_uint32 numBits;
+#ifdef INFLATE_FAST_WORDS
+	cc_uint64 word;
+#endif
+	/* huffman variables */
+	cc_uint32 lit, len, dist, code, bits;
+	int packed;
+
+	/* input/output variables */
+	const cc_uint8* inBeg = s->NextIn;
+	const cc_uint8* inEnd = inBeg + (s->AvailIn - INFLATE_FASTDIRECT_IN);
+	const cc_uint8* in    = inBeg;
+	cc_uint8* outBeg = s->Output;
+	cc_uint8* outEnd = outBeg + (s->AvailOut - INFLATE_FASTINF_OUT - INFLATE_FASTDIRECT_SLACK);
+	cc_uint8* out    = outBeg;
+	const cc_uint8* src;
+	cc_uint8* end;
+	cc_uint32 i, need, winIdx, copyLen;
+
+	bitbuf  = s->Bits;
+	numBits = s->NumBits;
+
+	while (out <= outEnd && in <= inEnd) {
+		Inflate_FastRefill();
+		Inflate_FastDecode(lits, lit);
+
+		if (lit < 256) {
+			*out++ = (cc_uint8)lit;
+			continue;
+		} else if (lit == 256) {
+			s->State = Inflate_NextBlockState(s);
+			break;
+		}
+
+		/* Codeword and extra bits are at most 15 + 5 bits, so are always present after refill */
+		code = len_codes[lit - 257];
+		bits = Inflate_CodeBits(code);
+		len  = Inflate_CodeBase(code) + (cc_uint32)(bitbuf & ((1UL << bits) - 1));
+		Inflate_FastConsume(bits);
+
+		Inflate_FastEnsure(INFLATE_MAX_BITS - 1);
+		Inflate_FastDecode(dists, dist);
+		code = dist_codes[dist];
+		bits = Inflate_CodeBits(code);
+		Inflate_FastEnsure(bits);
+		dist = Inflate_CodeBase(code) + (cc_uint32)(bitbuf & ((1UL << bits) - 1));
+		Inflate_FastConsume(bits);
+
+		copyLen = (cc_uint32)(out - outBeg);
+		if (dist > copyLen) {
+			/* Match starts before the data output by this call, so need to copy from the window */
+			need   = dist - copyLen;
+			winIdx = (s->WindowIndex - need) & INFLATE_WINDOW_MASK;
+			for (i = 0; i < len && i < need; i++) {
+				out[i] = s->Window[(winIdx + i) & INFLATE_WINDOW_MASK];
+			}
+			for (; i < len; i++) { out[i] = outBeg[i - need]; }
+
+			out += len;
+			continue;
+		}
+
+		src = out - dist;
+		end = out + len;
+#ifdef INFLATE_FAST_WORDS
+		if (dist >= 8) {
+			/* Each word is only read after it was completely written, so overlapping is fine */
+			/* Overshooting the end of the match is also fine, as it is later overwritten */
+			do {
+				Inflate_CopyWord(out, src);
+				out += 8; src += 8;
+			} while (out < end);
+		} else if (dist == 1) {
+			/* Run of the same byte */
+			word  = *src;
+			word |= word <<  8;
+			word |= word << 16;
+			word |= word << 32;
+			do {
+				Inflate_CopyWord(out, &word);
+				out += 8;
+			} while (out < end);
+		} else {
+			while (out < end) { *out++ = *src++; }
+		}
+#else
+		for (i = 0; i < (len & ~0x3); i += 4) {
+			*out++ = *src++; *out++ = *src++; *out++ = *src++; *out++ = *src++;
+		}
+		while (out < end) { *out++ = *src++; }
+#endif
+		out = end;
+	}
+
+	/* State bit buffer is only 32 bits, so give back any whole bytes that are still buffered */
+	copyLen  = min(numBits >> 3, (cc_uint32)(in - inBeg));
+	in      -= copyLen;
+	numBits -= copyLen << 3;
+	if (numBits < 32) bitbuf &= ((cc_uintptr)1 << numBits) - 1;
+
+	s->Bits     = (cc_uint32)bitbuf;
+	s->NumBits  = numBits;
+	s->AvailIn -= (cc_uint32)(in - inBeg);
+	s->NextIn  += (cc_uint32)(in - inBeg);
+
+	copyLen      = (cc_uint32)(out - outBeg);
+	s->Output   += copyLen;
+	s->AvailOut -= copyLen;
+	Inflate_AppendWindow(s, outBeg, copyLen);
+}
+
 void Inflate_Process(struct InflateState* s) {
 	cc_uint32 len, dist, nlen;
 	cc_uint32 i, bits;
@@ -463,14 +676,14 @@ void Inflate_Process(struct InflateState* s) {
 	cc_result res;
 
 	/* len/dist table variables */
-	cc_uint32 distIdx, lenIdx;
+	cc_uint32 code;
 	int lit;
 	/* code lens table variables */
 	cc_uint32 count, repeatCount;
 	cc_uint8  repeatValue;
 	/* window variables */
 	cc_uint32 startIdx, curIdx;
-	cc_uint32 copyLen, windowCopyLen;
+	cc_uint32 copyLen;
 
 	for (;;) {
 		switch (s->State) {
@@ -531,16 +744,8 @@ void Inflate_Process(struct InflateState* s) {
 			copyLen = min(copyLen, s->Index);
 			if (copyLen > 0) {
 				Mem_Copy(s->Output, s->NextIn, copyLen);
-				windowCopyLen = INFLATE_WINDOW_SIZE - s->WindowIndex;
-				windowCopyLen = min(windowCopyLen, copyLen);
+				Inflate_AppendWindow(s, s->Output, copyLen);
 
-				Mem_Copy(&s->Window[s->WindowIndex], s->Output, windowCopyLen);
-				/* Wrap around remainder of copy to start from beginning of window */
-				if (windowCopyLen < copyLen) {
-					Mem_Copy(s->Window, &s->Output[windowCopyLen], copyLen - windowCopyLen);
-				}
-
-				s->WindowIndex = (s->WindowIndex + copyLen) & INFLATE_WINDOW_MASK;
 				s->Output += copyLen; s->AvailOut -= copyLen; s->Index -= copyLen;
 				s->NextIn += copyLen; s->AvailIn  -= copyLen;		
 			}
@@ -662,10 +867,10 @@ void Inflate_Process(struct InflateState* s) {
 		}
 
 		case INFLATE_STATE_COMPRESSED_LITEXTRA: {
-			lenIdx = s->TmpLit;
-			bits   = len_bits[lenIdx];
+			code = len_codes[s->TmpLit];
+			bits = Inflate_CodeBits(code);
 			Inflate_EnsureBits(s, bits);
-			s->TmpLit = len_base[lenIdx] + Inflate_ReadBits(s, bits);
+			s->TmpLit = Inflate_CodeBase(code) + Inflate_ReadBits(s, bits);
 			s->State  = INFLATE_STATE_COMPRESSED_DIST;
 		}
 		
@@ -678,10 +883,10 @@ void Inflate_Process(struct InflateState* s) {
 		
 		/* FALLTHRU */		
 		case INFLATE_STATE_COMPRESSED_DISTEXTRA: {
-			distIdx = s->TmpDist;
-			bits    = dist_bits[distIdx];
+			code = dist_codes[s->TmpDist];
+			bits = Inflate_CodeBits(code);
 			Inflate_EnsureBits(s, bits);
-			s->TmpDist = dist_base[distIdx] + Inflate_ReadBits(s, bits);
+			s->TmpDist = Inflate_CodeBase(code) + Inflate_ReadBits(s, bits);
 			s->State   = INFLATE_STATE_COMPRESSED_DATA;
 		}
 		
@@ -709,7 +914,11 @@ void Inflate_Process(struct InflateState* s) {
 		}
 
 		case INFLATE_STATE_FASTCOMPRESSED: {
-			Inflate_InflateFast(s);
+			if (s->AvailOut >= INFLATE_FASTDIRECT_OUT && s->AvailIn >= INFLATE_FASTDIRECT_IN) {
+				Inflate_InflateFastDirect(s);
+			} else {
+				Inflate_InflateFast(s);
+			}
 			if (s->State == INFLATE_STATE_FASTCOMPRESSED) {
 				s->State = Inflate_NextCompressState(s);
 			}
@@ -778,9 +987,11 @@ void Inflate_MakeStream2(struct Stream* stream, struct InflateState* state, stru
 void GZip_MakeStream(struct Stream* stream, struct GZipState* state, struct Stream* underlying) { 
 	Process_Abort("Should never be called");
 }
+
+void Deflate_SetLevel(struct Stream* stream, int level) { }
 #else
 
-/* these are copies of len_base and dist_base, with UINT16_MAX instead of 0 for sentinel cutoff */
+/* these are copies of the base lengths and distances, with UINT16_MAX instead of 0 for sentinel cutoff */
 static const cc_uint16 deflate_len[30] = {
 	3,4,5,6,7,8,9,10,11,13,
 	15,17,19,23,27,31,35,43,51,59,
@@ -805,11 +1016,39 @@ static const cc_uint16 deflate_dist[31] = {
 
 #define MIN_MATCH_LEN 3
 #define MAX_MATCH_LEN 258
+/* Max bit length of literal/length and distance codewords */
+#define DEFLATE_MAX_CODE_BITS 15
+/* Max bit length of code length codewords */
+#define DEFLATE_MAX_CODELEN_BITS 7
+
+/* How much effort is spent at each compression level */
+static const struct DeflateConfig {
+	cc_uint16 maxChain;  /* Max number of previous positions checked when looking for a match */
+	cc_uint16 lazyChain; /* Max number of previous positions checked for a longer match at next byte (0 = no lazy matching) */
+	cc_uint16 niceLen;   /* Match length that is considered good enough to stop searching at */
+	cc_bool insertAll;   /* Whether every position within a match is inserted into the hash chains */
+	cc_bool dynamic;     /* Whether dynamic huffman codes are used when they are smaller */
+} deflate_configs[] = {
+	{   1,   0,  32, false, false }, /* DEFLATE_LEVEL_FAST   */
+	{   5,   5, 258, false, true  }, /* DEFLATE_LEVEL_NORMAL */
+	{ 128, 128, 258, true,  true  }  /* DEFLATE_LEVEL_BEST   */
+};
+
+/* Temp data for compressing a single block */
+/* NOTE: Allocated separately, so that struct DeflateState keeps its public layout */
+struct DeflateBlock {
+	cc_uint16 Syms[DEFLATE_BLOCK_SIZE];   /* Literals, or match length + 256 */
+	cc_uint16 Dists[DEFLATE_MAX_MATCHES]; /* Distances of the matches */
+	cc_uint16 DistsCodewords[INFLATE_MAX_DISTS];
+	cc_uint8 DistsLens[INFLATE_MAX_DISTS];
+};
 
 /* Number of bytes that match (are the same) from a and b */
 static int Deflate_MatchLen(cc_uint8* a, cc_uint8* b, int maxLen) {
 	int i = 0;
-	while (i < maxLen && *a == *b) { i++; a++; b++; }
+	/* Compare 4 bytes per iteration, as most matches are at least a few bytes long */
+	while (i + 4 <= maxLen && a[i] == b[i] && a[i + 1] == b[i + 1] && a[i + 2] == b[i + 2] && a[i + 3] == b[i + 3]) { i += 4; }
+	while (i < maxLen && a[i] == b[i]) { i++; }
 	return i;
 }
 
@@ -818,30 +1057,67 @@ static cc_uint32 Deflate_Hash(cc_uint8* src) {
 	return (cc_uint32)((src[0] << 8) ^ (src[1] << 4) ^ (src[2])) & DEFLATE_HASH_MASK;
 }
 
-/* Writes a literal to state->Output */
-static void Deflate_Lit(struct DeflateState* state, int lit) {
-	Deflate_PushLit(state, lit);
-	Deflate_FlushBits(state);
+/* Inserts the given position into the hash chains */
+#define Deflate_Insert(state, pos, hash) state->Prev[pos] = state->Head[hash]; state->Head[hash] = pos;
+
+/* Finds the longest match (that is longer than bestLen) for the data at cur */
+/* Returns the position of the match, or 0 if no such match was found */
+static int Deflate_FindMatch(struct DeflateState* state, cc_uint8* cur, cc_uint32 hash, int maxLen, int maxChain, int niceLen, int* bestLen) {
+	cc_uint8* input = state->Input;
+	int pos, bestPos = 0, matchLen, depth;
+	int len = *bestLen;
+
+	/* Can't find a longer match when current best match is already as long as possible */
+	if (len >= maxLen) return 0;
+
+	pos = state->Head[hash];
+	for (depth = 0; pos != 0 && depth < maxChain; depth++, pos = state->Prev[pos]) {
+		/* Can't be longer than current best match if the byte at the end of it doesn't match */
+		if (input[pos + len] != cur[len] || input[pos] != cur[0]) continue;
+
+		matchLen = Deflate_MatchLen(&input[pos], cur, maxLen);
+		if (matchLen <= len) continue;
+
+		len = matchLen; bestPos = pos;
+		if (len >= niceLen || len >= maxLen) break;
+	}
+
+	*bestLen = len;
+	return bestPos;
 }
 
-/* Writes a length-distance pair to state->Output */
-static void Deflate_LenDist(struct DeflateState* state, int len, int dist) {
-	int j;
-	/* TODO: Do we actually need the if (len_bits[j]) ????????? does writing 0 bits matter??? */
+static cc_uint8 deflate_lenCodes[MAX_MATCH_LEN - MIN_MATCH_LEN + 1]; /* Code for each (length - 3) */
+static cc_uint8 deflate_distCodes[512]; /* Code for each (distance - 1), see Deflate_DistCode */
+static cc_bool deflate_codesInited;
 
-	for (j = 0; len >= deflate_len[j + 1]; j++);
-	Deflate_PushLit(state, j + 257);
-	if (len_bits[j]) { Deflate_PushBits(state, len - deflate_len[j], len_bits[j]); }
-	Deflate_FlushBits(state);
+#define Deflate_LenCode(len) deflate_lenCodes[(len) - MIN_MATCH_LEN]
+/* Distance codes 16 and above all start at (multiple of 128) + 1 */
+#define Deflate_DistCode(dist) ((dist) <= 256 ? deflate_distCodes[(dist) - 1] : deflate_distCodes[256 + (((dist) - 1) >> 7)])
 
-	for (j = 0; dist >= deflate_dist[j + 1]; j++);
-	Deflate_PushHuff(state, j, 5);
-	if (dist_bits[j]) { Deflate_PushBits(state, dist - deflate_dist[j], dist_bits[j]); }
-	Deflate_FlushBits(state);
+static void Deflate_InitCodes(void) {
+	int i, j;
+	if (deflate_codesInited) return;
+
+	for (i = MIN_MATCH_LEN; i <= MAX_MATCH_LEN; i++) {
+		for (j = 0; i >= deflate_len[j + 1]; j++);
+		deflate_lenCodes[i - MIN_MATCH_LEN] = j;
+	}
+
+	for (i = 1; i <= 32768; i++) {
+		for (j = 0; i >= deflate_dist[j + 1]; j++);
+
+		if (i <= 256) { 
+			deflate_distCodes[i - 1] = j; 
+		} else {
+			deflate_distCodes[256 + ((i - 1) >> 7)] = j;
+		}
+	}
+	deflate_codesInited = true;
 }
 
 /* Moves "current block" to "previous block", adjusting state if needed. */
 static void Deflate_MoveBlock(struct DeflateState* state) {
+	cc_uint16* prev;
 	int i;
 	Mem_Copy(state->Input, state->Input + DEFLATE_BLOCK_SIZE, DEFLATE_BLOCK_SIZE);
 	state->InputPosition = DEFLATE_BLOCK_SIZE;
@@ -850,92 +1126,334 @@ static void Deflate_MoveBlock(struct DeflateState* state) {
 	for (i = 0; i < Array_Elems(state->Head); i++) {
 		state->Head[i] = state->Head[i] < DEFLATE_BLOCK_SIZE ? 0 : (state->Head[i] - DEFLATE_BLOCK_SIZE);
 	}
-	for (i = 0; i < Array_Elems(state->Prev); i++) {
-		state->Prev[i] = state->Prev[i] < DEFLATE_BLOCK_SIZE ? 0 : (state->Prev[i] - DEFLATE_BLOCK_SIZE);
+
+	/* Chains for positions in the previous block are never followed again, */
+	/*  so only need to move the chains for the current block down */
+	prev = state->Prev;
+	for (i = 0; i < DEFLATE_BLOCK_SIZE; i++) {
+		prev[i] = prev[i + DEFLATE_BLOCK_SIZE] < DEFLATE_BLOCK_SIZE ? 0 : (prev[i + DEFLATE_BLOCK_SIZE] - DEFLATE_BLOCK_SIZE);
 	}
 }
 
-/* Compresses current block of data */
-static cc_result Deflate_FlushBlock(struct DeflateState* state, int len) {
-	cc_uint32 hash, nextHash;
-	int bestLen, maxLen, matchLen, depth;
-	int bestPos, pos, nextPos;
-	cc_uint16 oldHead;
+/* Finds literals and length-distance pairs for the current block */
+/* Returns the number of symbols in Syms */
+static int Deflate_FindSymbols(struct DeflateState* state, struct DeflateBlock* block, const struct DeflateConfig* cfg, int len) {
+	int bestLen, nextLen, maxLen;
+	int bestPos, pos, end;
+	cc_uint32 hash;
+	int numSyms = 0, numDists = 0;
 	cc_uint8* input;
 	cc_uint8* cur;
-	cc_result res;
-
-	if (!state->WroteHeader) {
-		state->WroteHeader = true;
-		Deflate_PushBits(state, 3, 3); /* final block TRUE, block type FIXED */
-	}
 
 	/* Based off descriptions from http://www.gzip.org/algorithm.txt and
 	https://github.com/nothings/stb/blob/master/stb_image_write.h */
 	input = state->Input;
 	cur   = input + DEFLATE_BLOCK_SIZE;
 
-	/* Compress current block of data */
 	/* Use > instead of >=, because also try match at one byte after current */
 	while (len > MIN_MATCH_LEN) {
-		hash   = Deflate_Hash(cur);
-		maxLen = min(len, MAX_MATCH_LEN);
-
+		maxLen  = min(len, MAX_MATCH_LEN);
 		bestLen = MIN_MATCH_LEN - 1; /* Match must be at least 3 bytes */
-		bestPos = 0;
-
-		/* Find longest match starting at this byte */
-		/* Only explore up to 5 previous matches, to avoid slow performance */
-		/* (i.e prefer quickly saving maps/screenshots to completely optimal filesize) */
-		pos = state->Head[hash];
-		for (depth = 0; pos != 0 && depth < 5; depth++) {
-			matchLen = Deflate_MatchLen(&input[pos], cur, maxLen);
-			if (matchLen > bestLen) { bestLen = matchLen; bestPos = pos; }
-			pos = state->Prev[pos];
-		}
+		hash    = Deflate_Hash(cur);
+		bestPos = Deflate_FindMatch(state, cur, hash, maxLen, cfg->maxChain, cfg->niceLen, &bestLen);
 
 		/* Insert this entry into the hash chain */
 		pos = (int)(cur - input);
-		oldHead = state->Head[hash];
-		state->Head[hash] = pos;
-		state->Prev[pos]  = oldHead;
+		Deflate_Insert(state, pos, hash);
 
 		/* Lazy evaluation: Find longest match starting at next byte */
 		/* If that's longer than the longest match at current byte, throwaway this match */
-		if (bestPos) {
-			nextHash = Deflate_Hash(cur + 1);
-			nextPos  = state->Head[nextHash];
-			maxLen   = min(len - 1, MAX_MATCH_LEN);
-
-			for (depth = 0; nextPos != 0 && depth < 5; depth++) {
-				matchLen = Deflate_MatchLen(&input[nextPos], cur + 1, maxLen);
-				if (matchLen > bestLen) { bestPos = 0; break; }
-				nextPos = state->Prev[nextPos];
-			}
+		if (bestPos && cfg->lazyChain && bestLen < cfg->niceLen) {
+			nextLen = bestLen;
+			maxLen  = min(len - 1, MAX_MATCH_LEN);
+			hash    = Deflate_Hash(cur + 1);
+			if (Deflate_FindMatch(state, cur + 1, hash, maxLen, cfg->lazyChain, cfg->niceLen, &nextLen)) bestPos = 0;
 		}
 
 		if (bestPos) {
-			Deflate_LenDist(state, bestLen, pos - bestPos);
+			block->Syms[numSyms++]   = 256 + bestLen;
+			block->Dists[numDists++] = pos - bestPos;
+
+			if (cfg->insertAll) {
+				/* Positions near the end of the data can't be hashed, as there aren't 3 bytes left */
+				end = pos + min(bestLen, len - MIN_MATCH_LEN);
+				for (pos++; pos < end; pos++) {
+					hash = Deflate_Hash(&input[pos]);
+					Deflate_Insert(state, pos, hash);
+				}
+			}
 			len -= bestLen; cur += bestLen;
 		} else {
-			Deflate_Lit(state, *cur);
+			block->Syms[numSyms++] = *cur;
 			len--; cur++;
 		}
-
-		/* leave room for a few bytes and literals at end */
-		if (state->AvailOut >= 20) continue;
-		res = Stream_Write(state->Dest, state->Output, DEFLATE_OUT_SIZE - state->AvailOut);
-		state->NextOut  = state->Output;
-		state->AvailOut = DEFLATE_OUT_SIZE;
-		if (res) return res;
 	}
 
 	/* literals for last few bytes */
 	while (len > 0) {
-		Deflate_Lit(state, *cur);
+		block->Syms[numSyms++] = *cur;
 		len--; cur++;
 	}
+	return numSyms;
+}
+
+/* Calculates huffman codeword lengths for the given symbol frequencies, with no length longer than maxBits */
+static void Deflate_BuildLengths(const cc_uint32* freqs, int count, int maxBits, cc_uint8* lens) {
+	cc_uint32 weights[INFLATE_MAX_LITS * 2];
+	cc_uint16 parents[INFLATE_MAX_LITS * 2];
+	cc_uint8  depths[INFLATE_MAX_LITS * 2];
+	cc_uint16 symbols[INFLATE_MAX_LITS];
+	cc_uint32 scale = 0, weight;
+	int numLeaves, numNodes, leaf, node, maxDepth;
+	int i, j, a, b;
+
+	for (;;) {
+		/* Sort used symbols by frequency (insertion sort, as there are only a few hundred symbols at most) */
+		numLeaves = 0;
+		for (i = 0; i < count; i++) {
+			lens[i] = 0;
+			if (!freqs[i]) continue;
+
+			weight = ((freqs[i] - 1) >> scale) + 1;
+			for (j = numLeaves; j > 0 && weights[j - 1] > weight; j--) {
+				weights[j] = weights[j - 1]; symbols[j] = symbols[j - 1];
+			}
+			weights[j] = weight; symbols[j] = i;
+			numLeaves++;
+		}
+
+		if (numLeaves == 0) return;
+		if (numLeaves == 1) { lens[symbols[0]] = 1; return; }
+
+		/* Build the tree, by repeatedly combining the two lowest weight nodes */
+		/* As leaves are sorted, and combined nodes are created in increasing weight order, */
+		/*  the lowest weight nodes are always at the start of one of the two lists */
+		leaf = 0; node = numLeaves; numNodes = numLeaves;
+		for (i = 0; i < numLeaves - 1; i++) {
+			a = (leaf < numLeaves && (node >= numNodes || weights[leaf] <= weights[node])) ? leaf++ : node++;
+			b = (leaf < numLeaves && (node >= numNodes || weights[leaf] <= weights[node])) ? leaf++ : node++;
+
+			weights[numNodes] = weights[a] + weights[b];
+			parents[a] = numNodes; parents[b] = numNodes;
+			numNodes++;
+		}
+
+		/* Root is always the last node created */
+		depths[numNodes - 1] = 0;
+		maxDepth = 0;
+		for (i = numNodes - 2; i >= 0; i--) {
+			depths[i] = depths[parents[i]] + 1;
+			if (i < numLeaves) maxDepth = max(maxDepth, depths[i]);
+		}
+
+		if (maxDepth <= maxBits) break;
+		/* Flatten the tree by reducing differences between frequencies, then try again */
+		scale++;
+	}
+
+	for (i = 0; i < numLeaves; i++) {
+		lens[symbols[i]] = depths[i];
+	}
+}
+
+/* Constructs a huffman encoding table (for values to codewords) */
+static void Deflate_BuildTable(const cc_uint8* lens, int count, cc_uint16* codewords, cc_uint8* bitlens) {
+	int i, j, offset, codeword;
+	struct HuffmanTable table;
+
+	/* NOTE: Can ignore since lens table is not user controlled */
+	(void)Huffman_Build(&table, lens, count);
+	for (i = 0; i < INFLATE_MAX_BITS; i++) {
+		if (!table.endCodewords[i]) continue;
+		count = table.endCodewords[i] - table.firstCodewords[i];
+
+		for (j = 0; j < count; j++) {
+			offset   = table.values[table.firstOffsets[i] + j];
+			codeword = table.firstCodewords[i] + j;
+			bitlens[offset]   = i;
+			codewords[offset] = Huffman_ReverseBits(codeword, i);
+		}
+	}
+}
+
+/* Writes out the Output buffer, if less than the given number of bytes are free in it */
+static cc_result Deflate_ReserveOut(struct DeflateState* state, cc_uint32 required) {
+	cc_result res;
+	if (state->AvailOut >= required) return 0;
 
+	res = Stream_Write(state->Dest, state->Output, DEFLATE_OUT_SIZE - state->AvailOut);
+	state->NextOut  = state->Output;
+	state->AvailOut = DEFLATE_OUT_SIZE;
+	return res;
+}
+
+/* Symbols used to run length encode the codeword lengths of a dynamic block */
+#define CODELEN_COPY_PREV 16 /* Repeat previous length 3-6 times  (2 extra bits) */
+#define CODELEN_ZEROS_3   17 /* Repeat zero length 3-10 times     (3 extra bits) */
+#define CODELEN_ZEROS_11  18 /* Repeat zero length 11-138 times   (7 extra bits) */
+
+/* Run length encodes the given codeword lengths */
+/* Each symbol is stored as (symbol | extra bits value << 5) */
+static int Deflate_EncodeLengths(const cc_uint8* lens, int count, cc_uint16* syms) {
+	int numSyms = 0, i = 0, run, len;
+
+	while (i < count) {
+		len = lens[i];
+		for (run = 1; i + run < count && lens[i + run] == len; run++);
+
+		if (len == 0 && run >= 11) {
+			run = min(run, 138);
+			syms[numSyms++] = CODELEN_ZEROS_11 | ((run - 11) << 5);
+		} else if (len == 0 && run >= 3) {
+			syms[numSyms++] = CODELEN_ZEROS_3  | ((run - 3)  << 5);
+		} else if (len != 0 && run >= 4) {
+			/* First length has to be written out normally */
+			run = min(run, 7);
+			syms[numSyms++] = len;
+			syms[numSyms++] = CODELEN_COPY_PREV | ((run - 4) << 5);
+		} else {
+			run = 1;
+			syms[numSyms++] = len;
+		}
+		i += run;
+	}
+	return numSyms;
+}
+
+static const cc_uint8 codelens_extra[3] = { 2, 3, 7 };
+
+/* Returns the number of bits needed to write out the given symbols using the given codeword lengths */
+static cc_uint32 Deflate_CodeCost(const cc_uint32* freqs, const cc_uint8* lens, int count) {
+	cc_uint32 bits = 0;
+	int i;
+	for (i = 0; i < count; i++) { bits += freqs[i] * lens[i]; }
+	return bits;
+}
+
+/* Writes the symbols (and length-distance pairs) in block using the huffman codewords in state and block */
+static cc_result Deflate_WriteSymbols(struct DeflateState* state, struct DeflateBlock* block, int numSyms) {
+	int i, sym, len, dist, code;
+	int numDists = 0;
+	cc_result res;
+
+	for (i = 0; i < numSyms; i++) {
+		sym = block->Syms[i];
+
+		if (sym < 256) {
+			Deflate_PushLit(state, sym);
+			Deflate_FlushBits(state);
+		} else {
+			len  = sym - 256;
+			code = Deflate_LenCode(len);
+			Deflate_PushLit(state, code + 257);
+			if (len_bits[code]) { Deflate_PushBits(state, len - deflate_len[code], len_bits[code]); }
+			Deflate_FlushBits(state);
+
+			dist = block->Dists[numDists++];
+			code = Deflate_DistCode(dist);
+			Deflate_PushBits(state, block->DistsCodewords[code], block->DistsLens[code]);
+			/* Codeword (up to 15 bits) + extra bits (up to 13 bits) + pending bits might not fit in Bits */
+			Deflate_FlushBits(state);
+			if (dist_bits[code]) { Deflate_PushBits(state, dist - deflate_dist[code], dist_bits[code]); }
+			Deflate_FlushBits(state);
+		}
+
+		/* leave room for a few bytes and literals at end */
+		if (state->AvailOut < 20 && (res = Deflate_ReserveOut(state, 20))) return res;
+	}
+
+	/* Write huffman encoded "literal 256" to terminate block */
+	Deflate_PushLit(state, 256);
+	Deflate_FlushBits(state);
+	return 0;
+}
+
+/* Compresses current block of data */
+static cc_result Deflate_CompressBlock(struct DeflateState* state, struct DeflateBlock* block, int level, int len) {
+	const struct DeflateConfig* cfg = &deflate_configs[level];
+	cc_uint32 litFreqs[INFLATE_MAX_LITS]   = { 0 };
+	cc_uint32 distFreqs[INFLATE_MAX_DISTS] = { 0 };
+	cc_uint32 codeFreqs[INFLATE_MAX_CODELENS] = { 0 };
+	cc_uint8 lens[INFLATE_MAX_LITS_DISTS];
+	cc_uint8 codeLens[INFLATE_MAX_CODELENS];
+	cc_uint16 codeSyms[INFLATE_MAX_LITS_DISTS];
+	cc_uint32 fixedCost, dynamicCost;
+	int numLits, numDists, numCodes, numCodeSyms;
+	int i, sym, dist, numSyms, numMatches = 0;
+	cc_result res;
+
+	numSyms = Deflate_FindSymbols(state, block, cfg, len);
+	for (i = 0; i < numSyms; i++) {
+		sym = block->Syms[i];
+		if (sym < 256) { litFreqs[sym]++; continue; }
+
+		dist = block->Dists[numMatches++];
+		litFreqs[Deflate_LenCode(sym - 256) + 257]++;
+		distFreqs[Deflate_DistCode(dist)]++;
+	}
+	litFreqs[256] = 1;
+
+	if ((res = Deflate_ReserveOut(state, 1024))) return res;
+	dynamicCost = 0xFFFFFFFFUL;
+	fixedCost   = Deflate_CodeCost(litFreqs,  fixed_lits,  INFLATE_MAX_LITS) 
+				+ Deflate_CodeCost(distFreqs, fixed_dists, INFLATE_MAX_DISTS);
+
+	if (cfg->dynamic) {
+		Deflate_BuildLengths(litFreqs,  286, DEFLATE_MAX_CODE_BITS, lens);
+		Deflate_BuildLengths(distFreqs, 30,  DEFLATE_MAX_CODE_BITS, lens + 286);
+		/* Always need at least one distance code */
+		if (!numMatches) lens[286] = 1;
+
+		for (numLits  = 286; numLits  > 257 && !lens[numLits - 1];        numLits--);
+		for (numDists = 30;  numDists > 1   && !lens[286 + numDists - 1]; numDists--);
+		/* Distance lengths immediately follow literal lengths when encoded */
+		Mem_Move(lens + numLits, lens + 286, numDists);
+		numCodeSyms = Deflate_EncodeLengths(lens, numLits + numDists, codeSyms);
+
+		for (i = 0; i < numCodeSyms; i++) { codeFreqs[codeSyms[i] & 0x1F]++; }
+		Deflate_BuildLengths(codeFreqs, INFLATE_MAX_CODELENS, DEFLATE_MAX_CODELEN_BITS, codeLens);
+		for (numCodes = INFLATE_MAX_CODELENS; numCodes > 4 && !codeLens[codelens_order[numCodes - 1]]; numCodes--);
+
+		dynamicCost = 5 + 5 + 4 + numCodes * 3;
+		for (i = 0; i < numCodeSyms; i++) {
+			sym = codeSyms[i] & 0x1F;
+			dynamicCost += codeLens[sym] + (sym >= CODELEN_COPY_PREV ? codelens_extra[sym - CODELEN_COPY_PREV] : 0);
+		}
+		dynamicCost += Deflate_CodeCost(litFreqs,  lens, numLits) 
+					 + Deflate_CodeCost(distFreqs, lens + numLits, numDists);
+	}
+
+	if (dynamicCost < fixedCost) {
+		Deflate_PushBits(state, 2 << 1, 3); /* final block FALSE, block type DYNAMIC */
+		Deflate_PushBits(state, numLits  - 257, 5);
+		Deflate_PushBits(state, numDists - 1,   5);
+		Deflate_PushBits(state, numCodes - 4,   4);
+		Deflate_FlushBits(state);
+
+		for (i = 0; i < numCodes; i++) {
+			Deflate_PushBits(state, codeLens[codelens_order[i]], 3);
+			Deflate_FlushBits(state);
+		}
+
+		Deflate_BuildTable(codeLens, INFLATE_MAX_CODELENS, state->LitsCodewords, state->LitsLens);
+		for (i = 0; i < numCodeSyms; i++) {
+			sym = codeSyms[i] & 0x1F;
+			Deflate_PushLit(state, sym);
+			if (sym >= CODELEN_COPY_PREV) { Deflate_PushBits(state, codeSyms[i] >> 5, codelens_extra[sym - CODELEN_COPY_PREV]); }
+			Deflate_FlushBits(state);
+		}
+
+		Deflate_BuildTable(lens,           numLits,  state->LitsCodewords,  state->LitsLens);
+		Deflate_BuildTable(lens + numLits, numDists, block->DistsCodewords, block->DistsLens);
+	} else {
+		Deflate_PushBits(state, 1 << 1, 3); /* final block FALSE, block type FIXED */
+		Deflate_FlushBits(state);
+
+		Deflate_BuildTable(fixed_lits,  INFLATE_MAX_LITS,  state->LitsCodewords,  state->LitsLens);
+		Deflate_BuildTable(fixed_dists, INFLATE_MAX_DISTS, block->DistsCodewords, block->DistsLens);
+	}
+
+	if ((res = Deflate_WriteSymbols(state, block, numSyms))) return res;
 	res = Stream_Write(state->Dest, state->Output, DEFLATE_OUT_SIZE - state->AvailOut);
 	state->NextOut  = state->Output;
 	state->AvailOut = DEFLATE_OUT_SIZE;
@@ -944,12 +1462,26 @@ static cc_result Deflate_FlushBlock(struct DeflateState* state, int len) {
 	return res;
 }
 
+static cc_result Deflate_FlushBlock(struct Stream* stream, int len) {
+	struct DeflateState* state = (struct DeflateState*)stream->meta.deflate.state;
+	struct DeflateBlock* block;
+	cc_result res;
+	if (len <= 0) return 0;
+
+	block = (struct DeflateBlock*)Mem_TryAlloc(1, sizeof(struct DeflateBlock));
+	if (!block) return ERR_OUT_OF_MEMORY;
+
+	res = Deflate_CompressBlock(state, block, stream->meta.deflate.level, len);
+	Mem_Free(block);
+	return res;
+}
+
 /* Adds data to buffered output data, flushing if needed */
 static cc_result Deflate_StreamWrite(struct Stream* stream, const cc_uint8* data, cc_uint32 total, cc_uint32* modified) {
 	struct DeflateState* state;
 	cc_result res;
 
-	state = (struct DeflateState*)stream->meta.inflate;
+	state = (struct DeflateState*)stream->meta.deflate.state;
 	*modified = 0;
 
 	while (total > 0) {
@@ -966,7 +1498,7 @@ static cc_result Deflate_StreamWrite(struct Stream* stream, const cc_uint8* data
 		data += len;
 
 		if (state->InputPosition == DEFLATE_BUFFER_SIZE) {
-			res = Deflate_FlushBlock(state, DEFLATE_BLOCK_SIZE);
+			res = Deflate_FlushBlock(stream, DEFLATE_BLOCK_SIZE);
 			if (res) return res;
 		}
 	}
@@ -978,12 +1510,13 @@ static cc_result Deflate_StreamClose(struct Stream* stream) {
 	struct DeflateState* state;
 	cc_result res;
 
-	state = (struct DeflateState*)stream->meta.inflate;
-	res   = Deflate_FlushBlock(state, state->InputPosition - DEFLATE_BLOCK_SIZE);
+	state = (struct DeflateState*)stream->meta.deflate.state;
+	res   = Deflate_FlushBlock(stream, state->InputPosition - DEFLATE_BLOCK_SIZE);
 	if (res) return res;
 
-	/* Write huffman encoded "literal 256" to terminate symbols */
-	Deflate_PushLit(state, 256);
+	/* Write an empty final block, which is just the fixed huffman encoded "literal 256" */
+	Deflate_PushBits(state, 1 | (1 << 1), 3); /* final block TRUE, block type FIXED */
+	Deflate_PushBits(state, 0, 7);
 	Deflate_FlushBits(state);
 
 	/* In case last byte still has a few extra bits */
@@ -995,29 +1528,10 @@ static cc_result Deflate_StreamClose(struct Stream* stream) {
 	return Stream_Write(state->Dest, state->Output, DEFLATE_OUT_SIZE - state->AvailOut);
 }
 
-/* Constructs a huffman encoding table (for values to codewords) */
-static void Deflate_BuildTable(const cc_uint8* lens, int count, cc_uint16* codewords, cc_uint8* bitlens) {
-	int i, j, offset, codeword;
-	struct HuffmanTable table;
-
-	/* NOTE: Can ignore since lens table is not user controlled */
-	(void)Huffman_Build(&table, lens, count);
-	for (i = 0; i < INFLATE_MAX_BITS; i++) {
-		if (!table.endCodewords[i]) continue;
-		count = table.endCodewords[i] - table.firstCodewords[i];
-
-		for (j = 0; j < count; j++) {
-			offset   = table.values[table.firstOffsets[i] + j];
-			codeword = table.firstCodewords[i] + j;
-			bitlens[offset]   = i;
-			codewords[offset] = Huffman_ReverseBits(codeword, i);
-		}
-	}
-}
-
 void Deflate_MakeStream(struct Stream* stream, struct DeflateState* state, struct Stream* underlying) {
 	Stream_Init(stream);
-	stream->meta.inflate = state;
+	stream->meta.deflate.state = state;
+	stream->meta.deflate.level = DEFLATE_LEVEL_NORMAL;
 	stream->Write = Deflate_StreamWrite;
 	stream->Close = Deflate_StreamClose;
 
@@ -1029,11 +1543,14 @@ void Deflate_MakeStream(struct Stream* stream, struct DeflateState* state, struc
 	state->NextOut  = state->Output;
 	state->AvailOut = DEFLATE_OUT_SIZE;
 	state->Dest     = underlying;
-	state->WroteHeader = false;
+	Deflate_InitCodes();
 
 	Mem_Set(state->Head, 0, sizeof(state->Head));
 	Mem_Set(state->Prev, 0, sizeof(state->Prev));
-	Deflate_BuildTable(fixed_lits, INFLATE_MAX_LITS, state->LitsCodewords, state->LitsLens);
+}
+
+void Deflate_SetLevel(struct Stream* stream, int level) {
+	stream->meta.deflate.level = max(DEFLATE_LEVEL_FAST, min(level, DEFLATE_LEVEL_BEST));
 }
 
 
@@ -1041,7 +1558,7 @@ void Deflate_MakeStream(struct Stream* stream, struct DeflateState* state, struc
 *-----------------------------------------------------GZip (compress)-----------------------------------------------------*
 *#########################################################################################################################*/
 static cc_result GZip_StreamClose(struct Stream* stream) {
-	struct GZipState* state = (struct GZipState*)stream->meta.inflate;
+	struct GZipState* state = (struct GZipState*)stream->meta.deflate.state;
 	cc_uint8 data[8];
 	cc_result res;
 
@@ -1052,7 +1569,7 @@ static cc_result GZip_StreamClose(struct Stream* stream) {
 }
 
 static cc_result GZip_StreamWrite(struct Stream* stream, const cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
-	struct GZipState* state = (struct GZipState*)stream->meta.inflate;
+	struct GZipState* state = (struct GZipState*)stream->meta.deflate.state;
 	cc_uint32 i, crc32 = state->Crc32;
 	state->Size += count;
 
@@ -1067,7 +1584,7 @@ static cc_result GZip_StreamWrite(struct Stream* stream, const cc_uint8* data, c
 
 static cc_result GZip_StreamWriteFirst(struct Stream* stream, const cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
 	static cc_uint8 header[10] = { 0x1F, 0x8B, 0x08 }; /* GZip header */
-	struct GZipState* state = (struct GZipState*)stream->meta.inflate;
+	struct GZipState* state = (struct GZipState*)stream->meta.deflate.state;
 	cc_result res;
 
 	if ((res = Stream_Write(state->Base.Dest, header, sizeof(header)))) return res;
@@ -1088,7 +1605,7 @@ void GZip_MakeStream(struct Stream* stream, struct GZipState* state, struct Stre
 *-----------------------------------------------------ZLib (compress)-----------------------------------------------------*
 *#########################################################################################################################*/
 static cc_result ZLib_StreamClose(struct Stream* stream) {
-	struct ZLibState* state = (struct ZLibState*)stream->meta.inflate;
+	struct ZLibState* state = (struct ZLibState*)stream->meta.deflate.state;
 	cc_uint8 data[4];
 	cc_result res;
 
@@ -1098,7 +1615,7 @@ static cc_result ZLib_StreamClose(struct Stream* stream) {
 }
 
 static cc_result ZLib_StreamWrite(struct Stream* stream, const cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
-	struct ZLibState* state = (struct ZLibState*)stream->meta.inflate;
+	struct ZLibState* state = (struct ZLibState*)stream->meta.deflate.state;
 	cc_uint32 i, adler32 = state->Adler32;
 	cc_uint32 s1 = adler32 & 0xFFFF, s2 = (adler32 >> 16) & 0xFFFF;
 
@@ -1115,7 +1632,7 @@ static cc_result ZLib_StreamWrite(struct Stream* stream, const cc_uint8* data, c
 
 static cc_result ZLib_StreamWriteFirst(struct Stream* stream, const cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
 	static cc_uint8 header[2] = { 0x78, 0x9C }; /* ZLib header */
-	struct ZLibState* state = (struct ZLibState*)stream->meta.inflate;
+	struct ZLibState* state = (struct ZLibState*)stream->meta.deflate.state;
 	cc_result res;
 
 	if ((res = Stream_Write(state->Base.Dest, header, sizeof(header)))) return res;
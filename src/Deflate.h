@@ -85,6 +85,16 @@ CC_API void Inflate_MakeStream2(struct Stream* stream, struct InflateState* stat
 #define DEFLATE_OUT_SIZE 8192
 #define DEFLATE_HASH_SIZE 0x1000UL
 #define DEFLATE_HASH_MASK 0x0FFFUL
+/* Max number of length-distance pairs in a block (each match is at least 3 bytes long) */
+#define DEFLATE_MAX_MATCHES (DEFLATE_BLOCK_SIZE / 3 + 1)
+
+/* Compression levels, trading off speed for smaller compressed output */
+enum DeflateLevel {
+	DEFLATE_LEVEL_FAST,   /* Only checks most recent match, fixed huffman codes */
+	DEFLATE_LEVEL_NORMAL, /* Checks a few matches, dynamic huffman codes */
+	DEFLATE_LEVEL_BEST    /* Checks many matches, dynamic huffman codes */
+};
+
 struct DeflateState {
 	cc_uint32 Bits;         /* Holds bits across byte boundaries */
 	cc_uint32 NumBits;      /* Number of bits in Bits buffer */
@@ -107,7 +117,11 @@ struct DeflateState {
 };
 /* Compresses input data using DEFLATE, then writes compressed output to another stream. Write only stream. */
 /* DEFLATE compression is pure compressed data, there is no header or footer. */
+/* NOTE: Compression level defaults to DEFLATE_LEVEL_NORMAL */
 CC_API void Deflate_MakeStream(struct Stream* stream, struct DeflateState* state, struct Stream* underlying);
+/* Sets how much effort is spent compressing data written to the given DEFLATE, GZIP or ZLIB stream. */
+/* (see enum DeflateLevel) NOTE: Must be called before any data is written to the stream */
+CC_API void Deflate_SetLevel(struct Stream* stream, int level);
 
 struct GZipState { struct DeflateState Base; cc_uint32 Crc32, Size; };
 /* Compresses input data using GZIP, then writes compressed output to another stream. Write only stream. */
@@ -204,15 +204,326 @@ cc_bool Entity_TouchesAnyWater(struct Entity* e) {
 }
 
 
+/*########################################################################################################################*
+*-------------------------------------------------------Skin cache--------------------------------------------------------*
+*#########################################################################################################################*/
+/* Skins with identical pixels (e.g. many players using the same default skin) share the same texture */
+/* Standard size skins are also packed into a few large atlas textures, so that the batched */
+/*  model renderer can draw many players with different skins using just one texture bind */
+#if !defined CC_BUILD_CONSOLE && !defined CC_BUILD_LOWMEM
+	#define SKINS_ATLASING
+#endif
+#define SKIN_CACHE_MAX_ENTRIES ENTITIES_MAX_COUNT
+#define SKIN_ATLAS_SIZE      512
+#define SKIN_ATLAS_SLOT_SIZE 64
+#define SKIN_ATLAS_ROW_SLOTS (SKIN_ATLAS_SIZE / SKIN_ATLAS_SLOT_SIZE)
+#define SKIN_ATLAS_SLOTS     (SKIN_ATLAS_ROW_SLOTS * SKIN_ATLAS_ROW_SLOTS)
+#define SKIN_ATLAS_MAX_PAGES (SKIN_CACHE_MAX_ENTRIES / SKIN_ATLAS_SLOTS)
+
+static struct SkinCacheEntry {
+	cc_uint64 hash;
+	GfxResourceID tex; /* Either an atlas page, or a texture containing only this skin */
+	float uScale, vScale, uOffset, vOffset;
+	cc_int8 page; /* Atlas page the skin is packed into, or -1 if not packed */
+	cc_uint8 slot;
+	cc_bool used;
+} skinCache[SKIN_CACHE_MAX_ENTRIES];
+
+/* Cached atlas skin used by each entity that has ENTITY_FLAG_SKIN_ATLAS set */
+/* NOTE: This is deliberately not stored in struct Entity, as plugins may allocate */
+/*  entities using an older definition of struct Entity that is smaller */
+static struct SkinAtlasUser {
+	struct Entity* e;
+	struct SkinCacheEntry* entry;
+} skinUsers[ENTITIES_MAX_COUNT + 1]; /* +1 for held block renderer's entity */
+
+static struct SkinAtlasUser* SkinAtlas_FindUser(struct Entity* e) {
+	int i;
+	for (i = 0; i < Array_Elems(skinUsers); i++)
+	{
+		if (skinUsers[i].e == e) return &skinUsers[i];
+	}
+	return NULL;
+}
+
+/* Returns the cached atlas skin the given entity uses, or NULL if not using an atlas skin */
+static struct SkinCacheEntry* SkinAtlas_GetEntry(struct Entity* e) {
+	struct SkinAtlasUser* user;
+	if (!(e->Flags & ENTITY_FLAG_SKIN_ATLAS)) return NULL;
+
+	user = SkinAtlas_FindUser(e);
+	return user ? user->entry : NULL;
+}
+
+/* Sets the cached atlas skin the given entity uses (NULL for none) */
+/* Returns false if there is no space left to track which atlas skin the entity uses */
+static cc_bool SkinAtlas_SetEntry(struct Entity* e, struct SkinCacheEntry* entry) {
+	struct SkinAtlasUser* user = SkinAtlas_FindUser(e);
+	e->Flags &= ~ENTITY_FLAG_SKIN_ATLAS;
+
+	if (!entry) {
+		if (user) user->e = NULL;
+		return true;
+	}
+
+	if (!user) user = SkinAtlas_FindUser(NULL);
+	if (!user) return false;
+
+	user->e     = e;
+	user->entry = entry;
+	e->Flags   |= ENTITY_FLAG_SKIN_ATLAS;
+	return true;
+}
+
+static void SkinAtlas_RemoveEntry(struct SkinCacheEntry* entry) {
+	int i;
+	for (i = 0; i < Array_Elems(skinUsers); i++)
+	{
+		if (skinUsers[i].entry == entry) skinUsers[i].e = NULL;
+	}
+}
+
+#ifdef SKINS_ATLASING
+static struct SkinAtlasPage {
+	GfxResourceID tex;
+	int count;
+	cc_bool slots[SKIN_ATLAS_SLOTS];
+} skinPages[SKIN_ATLAS_MAX_PAGES];
+
+static cc_bool SkinAtlas_CreatePage(struct SkinAtlasPage* page) {
+	struct Bitmap bmp;
+	if (!Gfx_CheckTextureSize(SKIN_ATLAS_SIZE, SKIN_ATLAS_SIZE, 0)) return false;
+
+	bmp.scan0 = (BitmapCol*)Mem_TryAllocCleared(SKIN_ATLAS_SIZE * SKIN_ATLAS_SIZE, BITMAPCOLOR_SIZE);
+	if (!bmp.scan0) return false;
+	bmp.width  = SKIN_ATLAS_SIZE;
+	bmp.height = SKIN_ATLAS_SIZE;
+
+	page->tex = Gfx_CreateTexture(&bmp, TEXTURE_FLAG_MANAGED | TEXTURE_FLAG_DYNAMIC, false);
+	Mem_Free(bmp.scan0);
+	return page->tex != 0;
+}
+
+/* Attempts to pack the given skin into a free slot in one of the atlas pages */
+static cc_bool SkinAtlas_Add(struct SkinCacheEntry* entry, struct Bitmap* bmp) {
+	struct SkinAtlasPage* page;
+	int i, slot, x, y;
+	if (bmp->width != SKIN_ATLAS_SLOT_SIZE || bmp->height > SKIN_ATLAS_SLOT_SIZE) return false;
+
+	for (i = 0; i < SKIN_ATLAS_MAX_PAGES; i++)
+	{
+		page = &skinPages[i];
+		if (page->count == SKIN_ATLAS_SLOTS) continue;
+		if (!page->tex && !SkinAtlas_CreatePage(page)) return false;
+		break;
+	}
+	if (i == SKIN_ATLAS_MAX_PAGES) return false;
+
+	for (slot = 0; page->slots[slot]; slot++) { }
+	x = (slot % SKIN_ATLAS_ROW_SLOTS) * SKIN_ATLAS_SLOT_SIZE;
+	y = (slot / SKIN_ATLAS_ROW_SLOTS) * SKIN_ATLAS_SLOT_SIZE;
+
+	Gfx_UpdateTexturePart(page->tex, x, y, bmp, false);
+	page->slots[slot] = true;
+	page->count++;
+
+	entry->tex     = page->tex;
+	entry->page    = i;
+	entry->slot    = slot;
+	entry->uOffset = (float)x / SKIN_ATLAS_SIZE;
+	entry->vOffset = (float)y / SKIN_ATLAS_SIZE;
+	/* Skin only covers a small part of the atlas texture */
+	entry->uScale *= (float)bmp->width  / SKIN_ATLAS_SIZE;
+	entry->vScale *= (float)bmp->height / SKIN_ATLAS_SIZE;
+	return true;
+}
+
+static void SkinAtlas_Remove(struct SkinCacheEntry* entry) {
+	struct SkinAtlasPage* page = &skinPages[entry->page];
+	page->slots[entry->slot] = false;
+	entry->tex = 0;
+
+	/* Free the atlas page entirely once no skins are using it */
+	if (--page->count) return;
+	Gfx_DeleteTexture(&page->tex);
+}
+#else
+static cc_bool SkinAtlas_Add(struct SkinCacheEntry* entry, struct Bitmap* bmp) { return false; }
+static void SkinAtlas_Remove(struct SkinCacheEntry* entry) { }
+#endif
+
+/* Hashes the pixels of the given skin, along with its original dimensions (before being resized to power of two) */
+static cc_uint64 SkinCache_Hash(struct Entity* e, struct Bitmap* bmp) {
+	cc_uint64 hash = 0xCBF29CE484222325ULL; /* 64 bit FNV-1a */
+	int i, count   = bmp->width * bmp->height;
+
+	hash = (hash ^ (cc_uint32)(bmp->width  * e->uScale)) * 0x100000001B3ULL;
+	hash = (hash ^ (cc_uint32)(bmp->height * e->vScale)) * 0x100000001B3ULL;
+
+	for (i = 0; i < count; i++)
+	{
+		hash = (hash ^ bmp->scan0[i]) * 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+/* Returns whether the given entity's skin refers to the given cached skin */
+static cc_bool SkinCache_Matches(struct Entity* e, struct SkinCacheEntry* entry) {
+	if (!entry->tex || e->TextureId != entry->tex) return false;
+	if (entry->page < 0) return true;
+
+	return SkinAtlas_GetEntry(e) == entry;
+}
+
+/* Returns whether any entity (other than except) is still using the given cached skin */
+static cc_bool SkinCache_InUse(struct SkinCacheEntry* entry, struct Entity* except) {
+	int i;
+	for (i = 0; i < ENTITIES_MAX_COUNT; i++)
+	{
+		if (!Entities.List[i] || Entities.List[i] == except) continue;
+		if (SkinCache_Matches(Entities.List[i], entry)) return true;
+	}
+	return false;
+}
+
+static void SkinCache_Free(struct SkinCacheEntry* entry) {
+	if (entry->page >= 0) {
+		SkinAtlas_Remove(entry);
+		SkinAtlas_RemoveEntry(entry);
+	} else {
+		Gfx_DeleteTexture(&entry->tex);
+	}
+	entry->used = false;
+}
+
+static struct SkinCacheEntry* SkinCache_Alloc(void) {
+	int i;
+	for (i = 0; i < SKIN_CACHE_MAX_ENTRIES; i++)
+	{
+		if (!skinCache[i].used) return &skinCache[i];
+	}
+
+	/* Skins reset without being deleted first (e.g. when download of a skin fails) */
+	/*  are not released, so reclaim any cached skins no longer used by any entity */
+	for (i = 0; i < SKIN_CACHE_MAX_ENTRIES; i++)
+	{
+		if (SkinCache_InUse(&skinCache[i], NULL)) continue;
+		SkinCache_Free(&skinCache[i]);
+		return &skinCache[i];
+	}
+	return NULL;
+}
+
+/* Sets the given entity's skin to a new texture containing only the given skin, bypassing the skin cache */
+static void SkinCache_AcquireUncached(struct Entity* e, struct Bitmap* bmp) {
+	SkinAtlas_SetEntry(e, NULL);
+	e->TextureId = Gfx_CreateTexture(bmp, TEXTURE_FLAG_MANAGED, false);
+}
+
+/* Sets the given entity's skin to a cached texture containing the given skin, uploading it if necessary */
+static void SkinCache_Acquire(struct Entity* e, struct Bitmap* bmp) {
+	cc_uint64 hash = SkinCache_Hash(e, bmp);
+	struct SkinCacheEntry* entry = NULL;
+	int i;
+
+	for (i = 0; i < SKIN_CACHE_MAX_ENTRIES; i++)
+	{
+		if (!skinCache[i].used || skinCache[i].hash != hash) continue;
+		entry = &skinCache[i]; break;
+	}
+
+	if (!entry) {
+		/* Should never happen, as there can't be more distinct skins than entities */
+		if (!(entry = SkinCache_Alloc())) {
+			SkinCache_AcquireUncached(e, bmp); return;
+		}
+
+		entry->hash    = hash;
+		entry->used    = true;
+		entry->page    = -1;
+		entry->uScale  = e->uScale;
+		entry->vScale  = e->vScale;
+		entry->uOffset = 0.0f;
+		entry->vOffset = 0.0f;
+
+		if (!SkinAtlas_Add(entry, bmp))
+			entry->tex = Gfx_CreateTexture(bmp, TEXTURE_FLAG_MANAGED, false);
+	}
+
+	/* Should never happen, as every entity in the world can be tracked */
+	if (!SkinAtlas_SetEntry(e, entry->page >= 0 ? entry : NULL)) {
+		SkinCache_AcquireUncached(e, bmp); return;
+	}
+
+	e->TextureId = entry->tex;
+	e->uScale    = entry->uScale;
+	e->vScale    = entry->vScale;
+}
+
+/* Returns true if no other entities are sharing this skin texture */
+static cc_bool CanDeleteTexture(struct Entity* except) {
+	int i;
+	if (!except->TextureId) return false;
+
+	for (i = 0; i < ENTITIES_MAX_COUNT; i++)
+	{
+		if (!Entities.List[i] || Entities.List[i] == except)  continue;
+		if (Entities.List[i]->TextureId == except->TextureId) return false;
+	}
+	return true;
+}
+
+/* Releases the given entity's skin texture (deleting it if no other entities are using it), then sets it to 0 */
+static void SkinCache_Release(struct Entity* e) {
+	int i;
+	if (!e->TextureId) return;
+
+	for (i = 0; i < SKIN_CACHE_MAX_ENTRIES; i++)
+	{
+		if (!skinCache[i].used || !SkinCache_Matches(e, &skinCache[i])) continue;
+
+		if (!SkinCache_InUse(&skinCache[i], e)) SkinCache_Free(&skinCache[i]);
+		e->TextureId = 0;
+		return;
+	}
+
+	/* Texture not from the skin cache */
+	if (CanDeleteTexture(e)) Gfx_DeleteTexture(&e->TextureId);
+	e->TextureId = 0;
+}
+
+/* Deletes all cached skin textures */
+static void SkinCache_Clear(void) {
+	int i;
+	for (i = 0; i < SKIN_CACHE_MAX_ENTRIES; i++)
+	{
+		if (skinCache[i].used) SkinCache_Free(&skinCache[i]);
+	}
+}
+
+
 /*########################################################################################################################*
 *------------------------------------------------------Entity skins-------------------------------------------------------*
 *#########################################################################################################################*/
+void Entity_GetSkinOffset(struct Entity* e, float* uOffset, float* vOffset) {
+	struct SkinCacheEntry* entry = SkinAtlas_GetEntry(e);
+	*uOffset = entry ? entry->uOffset : 0.0f;
+	*vOffset = entry ? entry->vOffset : 0.0f;
+}
+
+void Entity_CopySkinOffset(struct Entity* dst, struct Entity* src) {
+	if (SkinAtlas_SetEntry(dst, SkinAtlas_GetEntry(src))) return;
+	/* Should never happen, but fallback to default skin rather than drawing whole atlas */
+	dst->TextureId = 0;
+}
+
 /* Copies skin data from another entity */
 static void Entity_CopySkin(struct Entity* dst, struct Entity* src) {
 	dst->TextureId	= src->TextureId;	
 	dst->SkinType	= src->SkinType;
 	dst->uScale		= src->uScale;
 	dst->vScale		= src->vScale;
+	Entity_CopySkinOffset(dst, src);
 }
 
 /* Resets skin data for the given entity */
@@ -220,6 +531,7 @@ static void Entity_ResetSkin(struct Entity* e) {
 	e->TextureId    = 0;
 	e->uScale 		= 1.0f; 
 	e->vScale 		= 1.0f;
+	SkinAtlas_SetEntry(e, NULL);
 }
 
 static void CheckSkin_Unchecked(struct Entity* e) {
@@ -228,6 +540,11 @@ static void CheckSkin_Unchecked(struct Entity* e) {
 	cc_uint8 flags;
 	int i;
 
+#ifdef CC_BUILD_BENCHMARK
+	/* Benchmark results must not depend on the network, so keep default skin */
+	e->SkinFetchState = SKIN_FETCH_COMPLETED; return;
+#endif
+
 	skin = String_FromRawArray(e->SkinRaw);
 	for (i = 0; i < ENTITIES_MAX_COUNT; i++) 
 	{
@@ -340,7 +657,7 @@ static cc_result ApplySkin(struct Entity* e, struct Bitmap* bmp, struct Stream*
 	cc_result res;
 	if ((res = Png_Decode(bmp, src))) return res;
 
-	Gfx_DeleteTexture(&e->TextureId);
+	SkinCache_Release(e);
 	if ((res = EnsurePow2Skin(e, bmp))) return res;
 	e->SkinType = Utils_CalcSkinType(bmp);
 
@@ -350,7 +667,7 @@ static cc_result ApplySkin(struct Entity* e, struct Bitmap* bmp, struct Stream*
 		if (e->Model->flags & MODEL_FLAG_CLEAR_HAT)
 			Entity_ClearHat(bmp, e->SkinType);
 
-		e->TextureId = Gfx_CreateTexture(bmp, TEXTURE_FLAG_MANAGED, false);
+		SkinCache_Acquire(e, bmp);
 		Entity_SetSkinAll(e, false);
 	}
 	return 0;
@@ -444,21 +761,8 @@ static void DerefDownloadingSkin(struct Entity* src) {
 	Http_TryCancel(src->_skinReqID);
 }
 
-/* Returns true if no other entities are sharing this skin texture */
-static cc_bool CanDeleteTexture(struct Entity* except) {
-	int i;
-	if (!except->TextureId) return false;
-
-	for (i = 0; i < ENTITIES_MAX_COUNT; i++)
-	{
-		if (!Entities.List[i] || Entities.List[i] == except)  continue;
-		if (Entities.List[i]->TextureId == except->TextureId) return false;
-	}
-	return true;
-}
-
 CC_NOINLINE static void DeleteSkin(struct Entity* e) {
-	if (CanDeleteTexture(e)) Gfx_DeleteTexture(&e->TextureId);
+	SkinCache_Release(e);
 	if (e->SkinFetchState == SKIN_FETCH_DOWNLOADING) DerefDownloadingSkin(e);
 
 	Entity_ResetSkin(e);
@@ -508,15 +812,35 @@ static cc_bool Entities_Tick(struct ScheduledTask2* task) {
 	return true;
 }
 
+/* Whether the given entity is inside the view frustum and close enough to the camera to be drawn */
+static cc_bool Entity_IsVisible(struct Entity* e) {
+	float dist, maxDist = (float)Entities.MaxDistance;
+	if (!Model_ShouldRender(e)) return false;
+	if (!maxDist && !Game_ClassicMode) return true;
+
+	dist = Model_RenderDistance(e);
+	/* Original classic only shows players up to 64 blocks away */
+	if (Game_ClassicMode && dist > 64 * 64) return false;
+	return !maxDist || dist <= maxDist * maxDist;
+}
+
 void Entities_RenderModels(float delta, float t) {
+	struct Entity* e;
 	int i;
 	Gfx_SetAlphaTest(true);
+	Models_BeginBatch();
+	Entities.VisibleCount = 0;
 	
 	for (i = 0; i < ENTITIES_MAX_COUNT; i++)
 	{
-		if (!Entities.List[i]) continue;
-		Entities.List[i]->VTABLE->RenderModel(Entities.List[i], delta, t);
+		e = Entities.List[i];
+		if (!e) continue;
+
+		e->VTABLE->RenderModel(e, delta, t);
+		if (e->ShouldRender) Entities.Visible[Entities.VisibleCount++] = i;
 	}
+
+	Models_EndBatch();
 	Gfx_SetAlphaTest(false);
 }
 
@@ -535,6 +859,7 @@ static void Entities_ContextLost(void* obj) {
 		if (!Gfx.ManagedTextures)
 			DeleteSkin(entity);
 	}
+	if (!Gfx.ManagedTextures) SkinCache_Clear();
 }
 /* No OnContextCreated, skin textures remade when needed */
 
@@ -728,6 +1053,8 @@ static void LocalPlayer_Tick(struct Entity* e, float delta) {
 	Vec3 headingVelocity;
 
 	if (!World.Loaded) return;
+	/* Blocks below the player may not have been received yet */
+	if (World.LoadedHeight < World.Height) return;
 	p->Collisions.StepSize = hacks->FullBlockStep && hacks->Enabled && hacks->CanSpeed ? 1.0f : 0.5f;
 	p->OldVelocity = e->Velocity;
 	wasOnGround    = e->OnGround;
@@ -761,8 +1088,8 @@ static void LocalPlayer_RenderModel(struct Entity* e, float delta, float t) {
 	struct LocalPlayer* p = (struct LocalPlayer*)e;
 	AnimatedComp_GetCurrent(e, t);
 
-	if (!Camera.Active->isThirdPerson && p == Entities.CurPlayer) return;
-	Model_Render(e->Model, e);
+	e->ShouldRender = (Camera.Active->isThirdPerson || p != Entities.CurPlayer) && Entity_IsVisible(e);
+	if (e->ShouldRender) Model_Render(e->Model, e);
 }
 
 static cc_bool LocalPlayer_ShouldRenderName(struct Entity* e) {
@@ -1146,10 +1473,7 @@ static void NetPlayer_RenderModel(struct Entity* e, float delta, float t) {
 	Entity_LerpAngles(e, t);
 
 	AnimatedComp_GetCurrent(e, t);
-	e->ShouldRender = Model_ShouldRender(e);
-	/* Original classic only shows players up to 64 blocks away */
-	if (Game_ClassicMode) e->ShouldRender &= Model_RenderDistance(e) <= 64 * 64;
-
+	e->ShouldRender = Entity_IsVisible(e);
 	if (e->ShouldRender) Model_Render(e->Model, e);
 }
 
@@ -1190,6 +1514,9 @@ static void Entities_Init(void) {
 		ShadowMode_Names, Array_Elems(ShadowMode_Names));
 	if (Game_ClassicMode) Entities.ShadowsMode = SHADOW_MODE_NONE;
 
+	Entities.MaxDistance = Options_GetInt(OPT_ENTITY_DISTANCE,     0, 4096, 0);
+	Entities.LodDistance = Options_GetInt(OPT_ENTITY_LOD_DISTANCE, 0, 4096, 0);
+
 	for (i = 0; i < Game_NumStates; i++)
 	{
 		LocalPlayer_Init(&LocalPlayer_Instances[i], i);
@@ -1213,6 +1540,7 @@ static void Entities_Free(void) {
 	{
 		Entities_Remove(i);
 	}
+	SkinCache_Clear();
 	sources_head = NULL;
 }
 
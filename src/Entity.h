@@ -105,6 +105,8 @@ struct EntityVTABLE {
 /* Whether in classic mode, to slightly adjust this entity downwards when rendering it */
 /*  to replicate the behaviour of the original vanilla classic client */
 #define ENTITY_FLAG_CLASSIC_ADJUST 0x04
+/* Whether TextureId is a shared skin atlas texture (see Entity_GetSkinOffset for where the skin is within it) */
+#define ENTITY_FLAG_SKIN_ATLAS 0x08
 
 /* Contains a model, along with position, velocity, and rotation. May also contain other fields and properties. */
 struct Entity {
@@ -173,6 +175,10 @@ cc_bool Entity_TouchesAnyWater(struct Entity* e);
 void Entity_SetName(struct Entity* e, const cc_string* name);
 /* Sets the skin name of the given entity. */
 void Entity_SetSkin(struct Entity* e, const cc_string* skin);
+/* Gets where the given entity's skin is within TextureId (0 unless ENTITY_FLAG_SKIN_ATLAS is set) */
+void Entity_GetSkinOffset(struct Entity* e, float* uOffset, float* vOffset);
+/* Makes the given entity use the same skin atlas location as another entity */
+void Entity_CopySkinOffset(struct Entity* dst, struct Entity* src);
 void Entity_LerpAngles(struct Entity* e, float t);
 
 /* Global data for all entities */
@@ -181,9 +187,15 @@ CC_VAR extern struct _EntitiesData {
 	struct Entity* List[ENTITIES_MAX_COUNT];
 	cc_uint8 NamesMode, ShadowsMode;
 	struct LocalPlayer* CurPlayer;
+	/* IDs of the entities which passed culling when last rendered */
+	/* NOTE: Shared by model, name and shadow rendering, so culling is only done once per frame */
+	cc_uint16 Visible[ENTITIES_MAX_COUNT];
+	int VisibleCount;
+	/* Distance beyond which entities are not drawn at all, or drawn with less detail (0 = no limit) */
+	int MaxDistance, LodDistance;
 } Entities;
 
-/* Renders all entities */
+/* Renders all entities, and updates the list of visible entities */
 void Entities_RenderModels(float delta, float t);
 /* Removes the given entity, raising EntityEvents.Removed event */
 void Entities_Remove(int id);
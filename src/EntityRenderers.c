@@ -270,10 +270,10 @@ void EntityShadows_Render(void) {
 	EntityShadow_Draw(&Entities.CurPlayer->Base);
 
 	if (Entities.ShadowsMode == SHADOW_MODE_CIRCLE_ALL) {	
-		for (i = 0; i < ENTITIES_MAX_COUNT; i++) 
+		for (i = 0; i < Entities.VisibleCount; i++) 
 		{
-			e = Entities.List[i];
-			if (!e || !e->ShouldRender || e == &Entities.CurPlayer->Base) continue;
+			e = Entities.List[Entities.Visible[i]];
+			if (!e || e == &Entities.CurPlayer->Base) continue;
 			EntityShadow_Draw(e);
 		}
 	}
@@ -391,7 +391,7 @@ static int closestEntityId;
 void EntityNames_Render(void) {
 	struct LocalPlayer* p = Entities.CurPlayer;
 	cc_bool hadFog;
-	int i;
+	int i, id;
 
 	if (Entities.NamesMode == NAME_MODE_NONE) return;
 	if (Server.IsSinglePlayer && Game_NumStates == 1) return;
@@ -403,10 +403,11 @@ void EntityNames_Render(void) {
 	hadFog = Gfx_GetFog();
 	if (hadFog) Gfx_SetFog(false);
 
-	for (i = 0; i < ENTITIES_MAX_COUNT; i++) 
+	for (i = 0; i < Entities.VisibleCount; i++) 
 	{
-		if (!Entities.List[i]) continue;
-		if (i != closestEntityId) DrawName(Entities.List[i]);
+		id = Entities.Visible[i];
+		if (!Entities.List[id]) continue;
+		if (id != closestEntityId) DrawName(Entities.List[id]);
 	}
 
 	Gfx_SetAlphaTest(false);
@@ -418,7 +419,7 @@ void EntityNames_RenderHovered(void) {
 	struct Entity* e;
 	cc_bool allNames, hadFog;
 	cc_bool setupState = false;
-	int i;
+	int i, id;
 
 	if (Entities.NamesMode == NAME_MODE_NONE) return;
 	if (Server.IsSinglePlayer && Game_NumStates == 1) return;
@@ -426,11 +427,12 @@ void EntityNames_RenderHovered(void) {
 	allNames = !(Entities.NamesMode == NAME_MODE_HOVERED || Entities.NamesMode == NAME_MODE_ALL) 
 		&& p->Hacks.CanSeeAllNames;
 
-	for (i = 0; i < ENTITIES_MAX_COUNT; i++) 
+	for (i = 0; i < Entities.VisibleCount; i++) 
 	{
-		e = Entities.List[i];
+		id = Entities.Visible[i];
+		e  = Entities.List[id];
 		if (!e || e == &p->Base) continue;
-		if (!allNames && i != closestEntityId) continue;
+		if (!allNames && id != closestEntityId) continue;
 
 		/* Only alter the GPU state when actually necessary */
 		if (!setupState) {
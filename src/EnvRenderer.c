@@ -387,9 +387,14 @@ static IVec3 lastPos;
 #define Weather_Pack(x, z) ((x) * World.Length + (z))
 
 static void InitWeatherHeightmap(void) {
-	int i;
 	Weather_Heightmap = (cc_int16*)Mem_Alloc(World.Width * World.Length, 2, "weather heightmap");
-	
+	EnvRenderer_RefreshWeather();
+}
+
+void EnvRenderer_RefreshWeather(void) {
+	int i;
+	if (!Weather_Heightmap) return;
+
 	for (i = 0; i < World.Width * World.Length; i++) {
 		Weather_Heightmap[i] = Int16_MaxValue;
 	}
@@ -409,7 +414,9 @@ static int CalcRainHeightAt(int x, int maxY, int z, int hIndex) {
 	int i = World_Pack(x, maxY, z), y;
 	cc_uint8 draw;
 
-#ifndef EXTENDED_BLOCKS
+#if defined CC_BUILD_COMPACTWORLD
+	RainCalcBody(World_GetBlock(x, y, z));
+#elif !defined EXTENDED_BLOCKS
 	RainCalcBody(World.Blocks[i]);
 #else
 	if (World.IDMask <= 0xFF) {
@@ -32,6 +32,8 @@ cc_bool EnvRenderer_ShouldRenderSkybox(void);
 extern cc_int16* Weather_Heightmap;
 /* Called when a block is changed to update internal weather state. */
 void EnvRenderer_OnBlockChanged(int x, int y, int z, BlockID oldBlock, BlockID newBlock);
+/* Marks the rain heights of all columns of the map as needing to be recalculated. */
+void EnvRenderer_RefreshWeather(void);
 /* Renders rainfall/snowfall weather. */
 void EnvRenderer_RenderWeather(float delta);
 
@@ -1,6 +1,7 @@
 #include "ExtMath.h"
 #include "Platform.h"
 #include "Utils.h"
+#include "Benchmark.h"
 
 #define PI 3.141592653589793238462643383279502884197169399
 
@@ -121,8 +122,13 @@ float sqrtf(float x) {
 #define RND_MASK ((1ULL << 48) - 1)
 
 void Random_SeedFromCurrentTime(RNGState* rnd) {
+#ifdef CC_BUILD_BENCHMARK
+	/* Benchmark must behave the same every run (e.g. physics random block ticks) */
+	Random_Seed(rnd, BENCHMARK_MAP_SEED);
+#else
 	cc_uint64 now = Stopwatch_Measure();
 	Random_Seed(rnd, (int)now);
+#endif
 }
 
 void Random_Seed(RNGState* seed, int seedInit) {
@@ -12,6 +12,7 @@
 #include "ExtMath.h"
 #include "Options.h"
 #include "Queue.h"
+#include "Builder.h"
 
 struct LightNode {
 	IVec3 coords; /* 12 bytes */
@@ -21,12 +22,70 @@ struct LightNode {
 
 static struct Queue lightQueue;
 static struct Queue unlightQueue;
+static struct Queue relightQueue;
+
+/* Packed world indices of cells that still need to be lit to a particular light level */
+struct LightBucket {
+	cc_uint32* entries;
+	int count, capacity;
+};
+/* Light from lava, lamps, and the sky is calculated and stored separately */
+#define LIGHT_CHANNEL_LAVA 0
+#define LIGHT_CHANNEL_LAMP 1
+#define LIGHT_CHANNEL_SUN  2
+#define LIGHT_CHANNELS     3
+/* One set of buckets for each light channel */
+static struct LightBucket lightBuckets[LIGHT_CHANNELS][FANCY_LIGHTING_LEVELS];
+
+static void LightBucket_Resize(struct LightBucket* bucket) {
+	int capacity;
+	if (bucket->capacity >= (Int32_MaxValue / 4)) {
+		Chat_AddRaw("&cToo many light entries, clearing");
+		bucket->count = 0;
+		return;
+	}
+
+	capacity = bucket->capacity * 2;
+	if (capacity < 256) capacity = 256;
+
+	bucket->entries  = (cc_uint32*)Mem_Realloc(bucket->entries, capacity, 4, "light bucket");
+	bucket->capacity = capacity;
+}
+
+static CC_INLINE void LightBucket_Add(struct LightBucket* bucket, cc_uint32 index) {
+	if (bucket->count == bucket->capacity) LightBucket_Resize(bucket);
+	bucket->entries[bucket->count++] = index;
+}
+
+static void FreeLightBuckets(void) {
+	int i, j;
+	for (i = 0; i < LIGHT_CHANNELS; i++) {
+		for (j = 0; j < FANCY_LIGHTING_LEVELS; j++) {
+			Mem_Free(lightBuckets[i][j].entries);
+			lightBuckets[i][j].entries  = NULL;
+			lightBuckets[i][j].count    = 0;
+			lightBuckets[i][j].capacity = 0;
+		}
+	}
+}
+
+#if !defined CC_BUILD_COOPTHREADED && !defined CC_BUILD_LOWMEM && !defined CC_BUILD_PSP && !defined CC_BUILD_NDS && !defined CC_BUILD_COMPACTWORLD
+	/* NOTE: Compact world sections can be reallocated when a block changes, so can't be read from other threads */
+	#define LIGHTING_THREADED
+#endif
+/* Whether light is calculated and spread on a background thread (see Background lighting section) */
+static cc_bool lightAsync;
+/* Indices of chunks whose light has changed and so need to be rebuilt (only used by background thread) */
+static struct LightBucket changedChunks;
+static cc_uint8* chunkLightChanged;
+/* Whether background thread has been asked to calculate lighting of each chunk, and that lighting */
+/*  has not been published yet (only used by main thread) */
+static cc_uint8* chunkLightRequested;
 
 /* Top face, X face, Z face, bottomY face*/
 #define PALETTE_SHADES 4
-/* One palette-group for sunlight, one palette-group for shadow */
-#define PALLETE_GROUP_COUNT 2
-#define PALETTE_COUNT (PALETTE_SHADES * PALLETE_GROUP_COUNT)
+/* One palette-group for each level of sunlight, from full shadow (0) to full sunlight */
+#define PALETTE_COUNT (PALETTE_SHADES * FANCY_LIGHTING_LEVELS)
 
 #define PALETTE_YMAX_INDEX  0
 #define PALETTE_XSIDE_INDEX 1
@@ -34,7 +93,7 @@ static struct Queue unlightQueue;
 #define PALETTE_YMIN_INDEX  3
 
 /* Index into palettes of light colors. */
-/* There are 8 different palettes: Four block-face shades for shadowed areas and four block-face shades for sunlit areas. */
+/* There are four block-face shades for each level of sunlight, from fully shadowed areas to fully sunlit areas. */
 /* A palette is a 16x16 color array indexed by a byte where the leftmost 4 bits represent lamplight level and the rightmost 4 bits represent lavalight level */
 /* E.G. myPalette[0b_0010_0001] will give us the color for lamp level 2 and lava level 1 (lowest level is 0) */
 static PackedCol* palettes[PALETTE_COUNT];
@@ -45,13 +104,50 @@ static cc_uint8* chunkLightingDataFlags;
 #define CHUNK_SELF_CALCULATED 1
 #define CHUNK_ALL_CALCULATED 2
 static LightingChunk* chunkLightingData;
+/* Light data of each chunk that chunk meshes are built from */
+/* NOTE: When lighting is calculated on the background thread, chunkLightingData is only ever accessed by */
+/*  that thread, and is instead copied into these once a request has finished (see PublishChangedChunks) */
+/*  Otherwise, this is just the same as chunkLightingData */
+static LightingChunk* chunkLightingPublished;
+/* Copies of the light data of chunks changed by finished requests, waiting to be published */
+static LightingChunk* chunkLightingPending;
+/* Lava and lamp light levels are stored in one byte per cell, followed by sun light levels in 4 bits per cell */
+#define LIGHT_DATA_SIZE (CHUNK_SIZE_3 + CHUNK_SIZE_3 / 2)
+#define SunDataIndex(localIndex) (CHUNK_SIZE_3 + ((localIndex) >> 1))
+#define SunDataShift(localIndex) (((localIndex) & 1) << 2)
+#define ChannelShift(channel) ((channel) == LIGHT_CHANNEL_LAMP ? FANCY_LIGHTING_LAMP_SHIFT : 0)
+
+static CC_INLINE cc_uint8 LightData_Get(cc_uint8* data, int localIndex, int channel) {
+	if (channel == LIGHT_CHANNEL_SUN) {
+		return (data[SunDataIndex(localIndex)] >> SunDataShift(localIndex)) & FANCY_LIGHTING_MAX_LEVEL;
+	}
+	return (data[localIndex] >> ChannelShift(channel)) & FANCY_LIGHTING_MAX_LEVEL;
+}
+
+static CC_INLINE void LightData_Set(cc_uint8* data, int localIndex, int channel, cc_uint8 level) {
+	int index = localIndex, shift = ChannelShift(channel);
+	if (channel == LIGHT_CHANNEL_SUN) {
+		index = SunDataIndex(localIndex); shift = SunDataShift(localIndex);
+	}
+	data[index] = (data[index] & ~(FANCY_LIGHTING_MAX_LEVEL << shift)) | (level << shift);
+}
+
+/* Cells above the light height of their column are always fully lit by the sky, and so aren't stored */
+/* NOTE: Background thread must never calculate light heights itself (see ClassicLighting_PeekLightHeight) */
+#define GetSunHeight(x, z) (lightAsync ? ClassicLighting_PeekLightHeight(x, z) : ClassicLighting_GetLightHeight(x, z))
 
 #define MakePaletteIndex(lampLevel, lavaLevel) ((lampLevel << FANCY_LIGHTING_LAMP_SHIFT) | lavaLevel)
+/* Returns how strongly light of the given level is blended in, from 0 (not at all) to 1 (fully) */
+static float LightLevelStrength(int level) {
+	float curLerp = level / (float)(FANCY_LIGHTING_LEVELS - 1);
+	curLerp *= (MATH_PI / 2);
+	return 1 - Math_CosF(curLerp);
+}
+
 /* Fill in a palette with values based on the current light colors, shaded by the given shade value and lightened by the given ambientColor */
 static void InitPalette(PackedCol* palette, float shaded, PackedCol ambientColor) {
 	PackedCol lavaColor, lampColor;
 	int lampLevel, lavaLevel;
-	float curLerp;
 
 	for (lampLevel = 0; lampLevel < FANCY_LIGHTING_LEVELS; lampLevel++) {
 		for (lavaLevel = 0; lavaLevel < FANCY_LIGHTING_LEVELS; lavaLevel++) {
@@ -59,17 +155,9 @@ static void InitPalette(PackedCol* palette, float shaded, PackedCol ambientColor
 				lampColor = Env.LampLightCol;
 			}
 			else {
-				curLerp = lampLevel / (float)(FANCY_LIGHTING_LEVELS - 1);
-				curLerp *= (MATH_PI / 2);
-				curLerp = Math_CosF(curLerp);
-				lampColor = PackedCol_Lerp(0, Env.LampLightCol, 1 - curLerp);
+				lampColor = PackedCol_Lerp(0, Env.LampLightCol, LightLevelStrength(lampLevel));
 			}
-
-			curLerp = lavaLevel / (float)(FANCY_LIGHTING_LEVELS - 1);
-			curLerp *= (MATH_PI / 2);
-			curLerp = Math_CosF(curLerp);
-
-			lavaColor = PackedCol_Lerp(0, Env.LavaLightCol, 1 - curLerp);
+			lavaColor = PackedCol_Lerp(0, Env.LavaLightCol, LightLevelStrength(lavaLevel));
 
 			/* Blend the two light colors together, then blend that with the ambient color, then shade that by the face darkness */
 			palette[MakePaletteIndex(lampLevel, lavaLevel)] =
@@ -78,25 +166,29 @@ static void InitPalette(PackedCol* palette, float shaded, PackedCol ambientColor
 	}
 }
 static void InitPalettes(void) {
-	int i;
+	PackedCol ambientColor;
+	int i, sunLevel;
 	for (i = 0; i < PALETTE_COUNT; i++) {
+		/* Palettes are also reinitialised when environment colors change */
+		if (palettes[i]) continue;
 		palettes[i] = (PackedCol*)Mem_Alloc(FANCY_LIGHTING_LEVELS * FANCY_LIGHTING_LEVELS, sizeof(PackedCol), "light color palette");
 	}
-	i = 0;
-	InitPalette(palettes[i + PALETTE_YMAX_INDEX],  1,                    Env.ShadowCol);
-	InitPalette(palettes[i + PALETTE_XSIDE_INDEX], PACKEDCOL_SHADE_X,    Env.ShadowCol);
-	InitPalette(palettes[i + PALETTE_ZSIDE_INDEX], PACKEDCOL_SHADE_Z,    Env.ShadowCol);
-	InitPalette(palettes[i + PALETTE_YMIN_INDEX],  PACKEDCOL_SHADE_YMIN, Env.ShadowCol);
-	i += PALETTE_SHADES;
-	InitPalette(palettes[i + PALETTE_YMAX_INDEX],  1,                    Env.SunCol);
-	InitPalette(palettes[i + PALETTE_XSIDE_INDEX], PACKEDCOL_SHADE_X,    Env.SunCol);
-	InitPalette(palettes[i + PALETTE_ZSIDE_INDEX], PACKEDCOL_SHADE_Z,    Env.SunCol);
-	InitPalette(palettes[i + PALETTE_YMIN_INDEX],  PACKEDCOL_SHADE_YMIN, Env.SunCol);
+
+	for (sunLevel = 0; sunLevel < FANCY_LIGHTING_LEVELS; sunLevel++) {
+		ambientColor = PackedCol_Lerp(Env.ShadowCol, Env.SunCol, LightLevelStrength(sunLevel));
+		i = sunLevel * PALETTE_SHADES;
+
+		InitPalette(palettes[i + PALETTE_YMAX_INDEX],  1,                    ambientColor);
+		InitPalette(palettes[i + PALETTE_XSIDE_INDEX], PACKEDCOL_SHADE_X,    ambientColor);
+		InitPalette(palettes[i + PALETTE_ZSIDE_INDEX], PACKEDCOL_SHADE_Z,    ambientColor);
+		InitPalette(palettes[i + PALETTE_YMIN_INDEX],  PACKEDCOL_SHADE_YMIN, ambientColor);
+	}
 }
 static void FreePalettes(void) {
 	int i;
 	for (i = 0; i < PALETTE_COUNT; i++) {
 		Mem_Free(palettes[i]);
+		palettes[i] = NULL;
 	}
 }
 
@@ -108,12 +200,21 @@ static void AllocState(void) {
 
 	chunkLightingDataFlags = (cc_uint8*)Mem_AllocCleared(chunksCount, sizeof(cc_uint8), "light flags");
 	chunkLightingData = (LightingChunk*)Mem_AllocCleared(chunksCount, sizeof(LightingChunk), "light chunks");
+	chunkLightingPublished = chunkLightingData;
 	Queue_Init(&lightQueue, sizeof(struct LightNode));
 	Queue_Init(&unlightQueue, sizeof(struct LightNode));
+	Queue_Init(&relightQueue, sizeof(struct LightNode));
+	if (!lightAsync) return;
+
+	chunkLightingPublished = (LightingChunk*)Mem_AllocCleared(chunksCount, sizeof(LightingChunk), "published light chunks");
+	chunkLightingPending   = (LightingChunk*)Mem_AllocCleared(chunksCount, sizeof(LightingChunk), "pending light chunks");
+	chunkLightChanged   = (cc_uint8*)Mem_AllocCleared(chunksCount, sizeof(cc_uint8), "light changed");
+	chunkLightRequested = (cc_uint8*)Mem_AllocCleared(chunksCount, sizeof(cc_uint8), "light requested");
 }
 
 static void FreeState(void) {
 	int i;
+	FancyLighting_CancelAll();
 	ClassicLighting_FreeState();
 	
 	/* This function can be called multiple times without calling AllocState, so... */
@@ -125,12 +226,35 @@ static void FreeState(void) {
 		Mem_Free(chunkLightingData[i]);
 	}
 
+	if (chunkLightingPublished != chunkLightingData) {
+		for (i = 0; i < chunksCount; i++) {
+			Mem_Free(chunkLightingPublished[i]);
+			Mem_Free(chunkLightingPending[i]);
+		}
+		Mem_Free(chunkLightingPublished);
+		Mem_Free(chunkLightingPending);
+	}
+
 	Mem_Free(chunkLightingDataFlags);
 	Mem_Free(chunkLightingData);
 	chunkLightingDataFlags = NULL;
 	chunkLightingData = NULL;
+	chunkLightingPublished = NULL;
+	chunkLightingPending   = NULL;
 	Queue_Clear(&lightQueue);
 	Queue_Clear(&unlightQueue);
+	Queue_Clear(&relightQueue);
+	FreeLightBuckets();
+
+	Mem_Free(changedChunks.entries);
+	changedChunks.entries  = NULL;
+	changedChunks.count    = 0;
+	changedChunks.capacity = 0;
+
+	Mem_Free(chunkLightChanged);
+	Mem_Free(chunkLightRequested);
+	chunkLightChanged   = NULL;
+	chunkLightRequested = NULL;
 }
 
 /* Converts chunk x/y/z coordinates to the corresponding index in chunks array/list */
@@ -140,9 +264,38 @@ static void FreeState(void) {
 /* Converts global x/y/z coordinates to the corresponding index in a chunk */
 #define GlobalCoordsToChunkCoordsIndex(x, y, z) (LocalCoordsToIndex(x & CHUNK_MASK, y & CHUNK_MASK, z & CHUNK_MASK))
 
+static void MarkChunkChanged(int cx, int cy, int cz) {
+	int chunkIndex;
+	if (!lightAsync) { MapRenderer_RefreshChunk(cx, cy, cz); return; }
+
+	if (cx < 0 || cy < 0 || cz < 0 || cx >= World.ChunksX || cy >= World.ChunksY || cz >= World.ChunksZ) return;
+	chunkIndex = ChunkCoordsToIndex(cx, cy, cz);
+	if (chunkLightChanged[chunkIndex]) return;
+
+	/* Chunk is only refreshed later on the main thread, see PublishChangedChunks */
+	chunkLightChanged[chunkIndex] = true;
+	LightBucket_Add(&changedChunks, chunkIndex);
+}
+
+/* Marks the chunk containing this cell as needing to be rebuilt, along with the neighbouring */
+/*  chunks when the cell is on the edge of the chunk (as their meshes also sample light from it) */
+static void MarkLightChanged(int x, int y, int z) {
+	int cx = x >> CHUNK_SHIFT, lx = x & CHUNK_MASK;
+	int cy = y >> CHUNK_SHIFT, ly = y & CHUNK_MASK;
+	int cz = z >> CHUNK_SHIFT, lz = z & CHUNK_MASK;
+
+	MarkChunkChanged(cx, cy, cz);
+	if (lx == CHUNK_MAX) MarkChunkChanged(cx + 1, cy, cz);
+	if (lx == 0)         MarkChunkChanged(cx - 1, cy, cz);
+	if (ly == CHUNK_MAX) MarkChunkChanged(cx, cy + 1, cz);
+	if (ly == 0)         MarkChunkChanged(cx, cy - 1, cz);
+	if (lz == CHUNK_MAX) MarkChunkChanged(cx, cy, cz + 1);
+	if (lz == 0)         MarkChunkChanged(cx, cy, cz - 1);
+}
+
 /* Sets the light level at this cell. Does NOT check that the cell is in bounds. */
-static void SetBrightness(cc_uint8 brightness, int x, int y, int z, cc_bool isLamp, cc_bool refreshChunk) {
-	cc_uint8 clearMask, shift = isLamp ? FANCY_LIGHTING_LAMP_SHIFT : 0, prevValue;
+static void SetBrightness(cc_uint8 brightness, int x, int y, int z, int channel, cc_bool refreshChunk) {
+	cc_uint8 prevValue;
 	int cx = x >> CHUNK_SHIFT, lx = x & CHUNK_MASK;
 	int cy = y >> CHUNK_SHIFT, ly = y & CHUNK_MASK;
 	int cz = z >> CHUNK_SHIFT, lz = z & CHUNK_MASK;
@@ -150,46 +303,33 @@ static void SetBrightness(cc_uint8 brightness, int x, int y, int z, cc_bool isLa
 	int localIndex = LocalCoordsToIndex(lx, ly, lz);
 
 	if (chunkLightingData[chunkIndex] == NULL) {
-		chunkLightingData[chunkIndex] = (cc_uint8*)Mem_TryAllocCleared(CHUNK_SIZE_3, sizeof(cc_uint8));
+		chunkLightingData[chunkIndex] = (cc_uint8*)Mem_TryAllocCleared(LIGHT_DATA_SIZE, sizeof(cc_uint8));
+		if (!chunkLightingData[chunkIndex]) return;
 	}
 
-	/* 00001111 if lamp, otherwise 11110000*/
-	clearMask = ~(FANCY_LIGHTING_MAX_LEVEL << shift);
-
 	if (refreshChunk) {
-		prevValue = chunkLightingData[chunkIndex][localIndex];
-
-		chunkLightingData[chunkIndex][localIndex] &= clearMask;
-		chunkLightingData[chunkIndex][localIndex] |= brightness << shift;
-
-		/* There is no reason to refresh current chunk as the builder does that automatically */
-		if (prevValue != chunkLightingData[chunkIndex][localIndex]) {
-			if (lx == CHUNK_MAX) MapRenderer_RefreshChunk(cx + 1, cy, cz);
-			if (lx == 0)         MapRenderer_RefreshChunk(cx - 1, cy, cz);
-			if (ly == CHUNK_MAX) MapRenderer_RefreshChunk(cx, cy + 1, cz);
-			if (ly == 0)         MapRenderer_RefreshChunk(cx, cy - 1, cz);
-			if (lz == CHUNK_MAX) MapRenderer_RefreshChunk(cx, cy, cz + 1);
-			if (lz == 0)         MapRenderer_RefreshChunk(cx, cy, cz - 1);
-		}
+		prevValue = LightData_Get(chunkLightingData[chunkIndex], localIndex, channel);
+		LightData_Set(chunkLightingData[chunkIndex], localIndex, channel, brightness);
+
+		/* Light may have spread into the middle of a chunk other than the one containing the changed block */
+		if (prevValue != brightness) MarkLightChanged(x, y, z);
 	}
 	else {
-		chunkLightingData[chunkIndex][localIndex] &= clearMask;
-		chunkLightingData[chunkIndex][localIndex] |= brightness << shift;
+		LightData_Set(chunkLightingData[chunkIndex], localIndex, channel, brightness);
 	}
 }
 /* Returns the light level at this cell. Does NOT check that the cell is in bounds. */
-static cc_uint8 GetBrightness(int x, int y, int z, cc_bool isLamp) {
+static cc_uint8 GetBrightness(int x, int y, int z, int channel) {
 	int cx = x >> CHUNK_SHIFT, lx = x & CHUNK_MASK;
 	int cy = y >> CHUNK_SHIFT, ly = y & CHUNK_MASK;
 	int cz = z >> CHUNK_SHIFT, lz = z & CHUNK_MASK;
 	int chunkIndex = ChunkCoordsToIndex(cx, cy, cz), localIndex;
 
+	if (channel == LIGHT_CHANNEL_SUN && y > GetSunHeight(x, z)) return FANCY_LIGHTING_MAX_LEVEL;
 	if (chunkLightingData[chunkIndex] == NULL) { return 0; }
 	localIndex = LocalCoordsToIndex(lx, ly, lz);
 
-	return isLamp ?
-		chunkLightingData[chunkIndex][localIndex] >> FANCY_LIGHTING_LAMP_SHIFT :
-		chunkLightingData[chunkIndex][localIndex] & FANCY_LIGHTING_MAX_LEVEL;
+	return LightData_Get(chunkLightingData[chunkIndex], localIndex, channel);
 }
 
 
@@ -214,15 +354,36 @@ static cc_bool CanLightPass(BlockID thisBlock, Face face) {
 	return !Block_IsFaceHidden(BLOCK_STONE, thisBlock, face);
 }
 
-#define Light_TrySpreadInto(axis, AXIS, dir, limit, isLamp, thisFace, thatFace) \
+#define Light_TrySpreadInto(axis, AXIS, dir, limit, channel, thisFace, thatFace) \
 	if (ln.coords.axis dir ## = limit && \
 		CanLightPass(thisBlock, FACE_ ## AXIS ## thisFace) && \
 		CanLightPass(World_GetBlock(ln.coords.x, ln.coords.y, ln.coords.z), FACE_ ## AXIS ## thatFace) && \
-		GetBrightness(ln.coords.x, ln.coords.y, ln.coords.z, isLamp) < ln.brightness) { \
+		GetBrightness(ln.coords.x, ln.coords.y, ln.coords.z, channel) < ln.brightness) { \
 		Queue_Enqueue(&lightQueue, &ln); \
 	} \
 
-static void FlushLightQueue(cc_bool isLamp, cc_bool refreshChunk) {
+/* Queues the neighbours of the given cell that are darker than the given light level, */
+/*  and that light can spread into from the given cell */
+static void QueueNeighbours(struct LightNode ln, BlockID thisBlock, int channel) {
+	ln.coords.x--;
+	Light_TrySpreadInto(x, X, > , 0, channel, MAX, MIN)
+	ln.coords.x += 2;
+	Light_TrySpreadInto(x, X, < , World.MaxX, channel, MIN, MAX)
+	ln.coords.x--;
+
+	ln.coords.y--;
+	Light_TrySpreadInto(y, Y, >, 0, channel, MAX, MIN)
+	ln.coords.y += 2;
+	Light_TrySpreadInto(y, Y, <, World.MaxY, channel, MIN, MAX)
+	ln.coords.y--;
+
+	ln.coords.z--;
+	Light_TrySpreadInto(z, Z, > , 0, channel, MAX, MIN)
+	ln.coords.z += 2;
+	Light_TrySpreadInto(z, Z, < , World.MaxZ, channel, MIN, MAX)
+}
+
+static void FlushLightQueue(int channel, cc_bool refreshChunk) {
 	struct LightNode ln;
 	cc_uint8 brightnessHere;
 	BlockID thisBlock;
@@ -230,52 +391,134 @@ static void FlushLightQueue(cc_bool isLamp, cc_bool refreshChunk) {
 	while (lightQueue.count > 0) {
 		ln = *(struct LightNode*)(Queue_Dequeue(&lightQueue));
 
-		brightnessHere = GetBrightness(ln.coords.x, ln.coords.y, ln.coords.z, isLamp);
+		brightnessHere = GetBrightness(ln.coords.x, ln.coords.y, ln.coords.z, channel);
 
 		/* If this cell is already more lit, we can assume this cell and its neighbors have been accounted for */
 		if (brightnessHere >= ln.brightness) { continue; }
 		if (ln.brightness == 0) { continue; }
 
-		SetBrightness(ln.brightness, ln.coords.x, ln.coords.y, ln.coords.z, isLamp, refreshChunk);
+		SetBrightness(ln.brightness, ln.coords.x, ln.coords.y, ln.coords.z, channel, refreshChunk);
 
 		thisBlock = World_GetBlock(ln.coords.x, ln.coords.y, ln.coords.z);
 		ln.brightness--;
 		if (ln.brightness == 0) continue;
 
-		ln.coords.x--;
-		Light_TrySpreadInto(x, X, > , 0, isLamp, MAX, MIN)
-		ln.coords.x += 2;
-		Light_TrySpreadInto(x, X, < , World.MaxX, isLamp, MIN, MAX)
-		ln.coords.x--;
-
-		ln.coords.y--;
-		Light_TrySpreadInto(y, Y, >, 0, isLamp, MAX, MIN)
-		ln.coords.y += 2;
-		Light_TrySpreadInto(y, Y, <, World.MaxY, isLamp, MIN, MAX)
-		ln.coords.y--;
-
-		ln.coords.z--;
-		Light_TrySpreadInto(z, Z, > , 0, isLamp, MAX, MIN)
-		ln.coords.z += 2;
-		Light_TrySpreadInto(z, Z, < , World.MaxZ, isLamp, MIN, MAX)
+		QueueNeighbours(ln, thisBlock, channel);
 	}
 }
 
-cc_uint8 GetBlockBrightness(BlockID curBlock, cc_bool isLamp) {
-	if (isLamp) return Blocks.Brightness[curBlock] >> FANCY_LIGHTING_LAMP_SHIFT;
-	return Blocks.Brightness[curBlock] & FANCY_LIGHTING_MAX_LEVEL;
+static cc_uint8 GetBlockBrightness(BlockID curBlock, int channel) {
+	if (channel == LIGHT_CHANNEL_LAMP) return Blocks.Brightness[curBlock] >> FANCY_LIGHTING_LAMP_SHIFT;
+	if (channel == LIGHT_CHANNEL_LAVA) return Blocks.Brightness[curBlock] & FANCY_LIGHTING_MAX_LEVEL;
+	/* Sun light only comes from the sky, never from blocks */
+	return 0;
 }
 
 #define LightNode_Init(node, X, Y, Z, bright) \
 	node.coords.x = X; node.coords.y = Y; node.coords.z = Z; node.brightness = bright;
 
+
+/*########################################################################################################################*
+*-----------------------------------------------------Chunk flood fill----------------------------------------------------*
+*#########################################################################################################################*/
+/* Light from all the sources in a chunk is spread at once, rather than flood filling each source separately. */
+/* Cells are processed brightest first (using one bucket of packed world indices per light level), */
+/*  so each cell is only lit once, even when the light from many sources overlaps (e.g. lava lakes) */
+
+/* Neighbours in the same chunk can read light directly, without recalculating chunk and cell indices */
+/* (except for sun light, as whether a neighbour is exposed to the sky also needs to be checked) */
+#define Light_TrySpreadBucket(nx, ny, nz, inWorld, inChunk, localDelta, indexDelta, thisFace, thatFace) \
+	if ((inWorld) && CanLightPass(thisBlock, thisFace) && CanLightPass(World_GetBlock(nx, ny, nz), thatFace)) { \
+		neighbor = ((inChunk) && channel != LIGHT_CHANNEL_SUN) ? LightData_Get(data, localIndex + (localDelta), channel) \
+							 : GetBrightness(nx, ny, nz, channel); \
+		if (neighbor < level - 1) LightBucket_Add(&buckets[level - 1], index + (indexDelta)); \
+	}
+
+static void FlushLightBuckets(int channel) {
+	struct LightBucket* buckets = lightBuckets[channel];
+	int oneY = World.Width * World.Length;
+	int x, y, z, lx, ly, lz, level, index;
+	int chunkIndex, localIndex;
+	cc_uint8 neighbor, * data;
+	BlockID thisBlock;
+
+	for (level = FANCY_LIGHTING_MAX_LEVEL; level > 0; level--) 
+	{
+		while (buckets[level].count > 0) 
+		{
+			index = buckets[level].entries[--buckets[level].count];
+			World_Unpack(index, x, y, z);
+			lx = x & CHUNK_MASK; ly = y & CHUNK_MASK; lz = z & CHUNK_MASK;
+
+			chunkIndex = ChunkCoordsToIndex(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT);
+			localIndex = LocalCoordsToIndex(lx, ly, lz);
+
+			data = chunkLightingData[chunkIndex];
+			if (!data) {
+				data = (cc_uint8*)Mem_TryAllocCleared(LIGHT_DATA_SIZE, sizeof(cc_uint8));
+				if (!data) continue;
+				chunkLightingData[chunkIndex] = data;
+			}
+
+			/* If this cell is already as bright, then it and its neighbours have already been accounted for */
+			if (LightData_Get(data, localIndex, channel) >= level) continue;
+			LightData_Set(data, localIndex, channel, level);
+			/* Chunks may have already been built before this light was calculated */
+			if (lightAsync) MarkLightChanged(x, y, z);
+			if (level == 1) continue;
+
+			thisBlock = World_GetBlock(x, y, z);
+			Light_TrySpreadBucket(x - 1, y, z, x > 0,          lx > 0,         -1,           -1,            FACE_XMAX, FACE_XMIN)
+			Light_TrySpreadBucket(x + 1, y, z, x < World.MaxX, lx < CHUNK_MAX,  1,            1,            FACE_XMIN, FACE_XMAX)
+			Light_TrySpreadBucket(x, y - 1, z, y > 0,          ly > 0,         -CHUNK_SIZE_2, -oneY,        FACE_YMAX, FACE_YMIN)
+			Light_TrySpreadBucket(x, y + 1, z, y < World.MaxY, ly < CHUNK_MAX,  CHUNK_SIZE_2,  oneY,        FACE_YMIN, FACE_YMAX)
+			Light_TrySpreadBucket(x, y, z - 1, z > 0,          lz > 0,         -CHUNK_SIZE,   -World.Width, FACE_ZMAX, FACE_ZMIN)
+			Light_TrySpreadBucket(x, y, z + 1, z < World.MaxZ, lz < CHUNK_MAX,  CHUNK_SIZE,    World.Width, FACE_ZMIN, FACE_ZMAX)
+		}
+	}
+}
+
+/* Cells exposed to the sky are always fully lit, so sun light only needs to be spread */
+/*  into the neighbouring cells that aren't exposed to the sky (e.g. under overhangs or in caves) */
+#define Sun_TrySeed(nx, ny, nz, thisFace, thatFace) \
+	if (CanLightPass(World_GetBlock(x, y, z), thisFace) && CanLightPass(World_GetBlock(nx, ny, nz), thatFace)) { \
+		LightBucket_Add(&lightBuckets[LIGHT_CHANNEL_SUN][FANCY_LIGHTING_MAX_LEVEL - 1], World_Pack(nx, ny, nz)); \
+	}
+
+/* Neighbouring cell is only not exposed to the sky if it is at or below the light height of its column */
+#define Sun_TrySeedSide(nx, nz, inWorld, thisFace, thatFace) \
+	if (inWorld) { \
+		maxY = min(GetSunHeight(nx, nz), endY - 1); \
+		for (y = minY; y <= maxY; y++) { Sun_TrySeed(nx, y, nz, thisFace, thatFace) } \
+	}
+
+static void SeedChunkSunLight(int startX, int startY, int startZ, int endX, int endY, int endZ) {
+	int x, y, z, height, minY, maxY;
+
+	for (z = startZ; z < endZ; z++) {
+		for (x = startX; x < endX; x++) {
+			height = GetSunHeight(x, z);
+			/* Lowest cell in this column of the chunk that is exposed to the sky */
+			minY = max(height + 1, startY);
+			if (minY >= endY) continue;
+
+			if (minY == height + 1 && height >= 0) {
+				y = minY; Sun_TrySeed(x, height, z, FACE_YMAX, FACE_YMIN)
+			}
+			Sun_TrySeedSide(x - 1, z, x > 0,          FACE_XMAX, FACE_XMIN)
+			Sun_TrySeedSide(x + 1, z, x < World.MaxX, FACE_XMIN, FACE_XMAX)
+			Sun_TrySeedSide(x, z - 1, z > 0,          FACE_ZMAX, FACE_ZMIN)
+			Sun_TrySeedSide(x, z + 1, z < World.MaxZ, FACE_ZMIN, FACE_ZMAX)
+		}
+	}
+}
+
 static void CalculateChunkLightingSelf(int chunkIndex, int cx, int cy, int cz) {
 	int x, y, z;
 	/* Block coordinates */
 	int chunkStartX, chunkStartY, chunkStartZ, chunkEndX, chunkEndY, chunkEndZ;
 	cc_uint8 brightness;
 	BlockID curBlock;
-	struct LightNode entry;
 
 	chunkStartX = cx * CHUNK_SIZE;
 	chunkStartY = cy * CHUNK_SIZE;
@@ -296,29 +539,30 @@ static void CalculateChunkLightingSelf(int chunkIndex, int cx, int cy, int cz) {
 				
 				if (Blocks.Brightness[curBlock] > 0) {
 
-					brightness = GetBlockBrightness(curBlock, false);
+					brightness = GetBlockBrightness(curBlock, LIGHT_CHANNEL_LAVA);
 
 					if (brightness > 0) {
-						LightNode_Init(entry, x, y, z, brightness);
-						Queue_Enqueue(&lightQueue, &entry);
-						FlushLightQueue(false, false);
+						LightBucket_Add(&lightBuckets[LIGHT_CHANNEL_LAVA][brightness], World_Pack(x, y, z));
 					}
 					else {
 						/* If no lava brightness, it must use lamp brightness */
-						brightness = Blocks.Brightness[curBlock] >> FANCY_LIGHTING_LAMP_SHIFT;
-						LightNode_Init(entry, x, y, z, brightness);
-						Queue_Enqueue(&lightQueue, &entry);
-						FlushLightQueue(true, false);
+						brightness = GetBlockBrightness(curBlock, LIGHT_CHANNEL_LAMP);
+						LightBucket_Add(&lightBuckets[LIGHT_CHANNEL_LAMP][brightness], World_Pack(x, y, z));
 					}
 				}
 
-				/* Note: This code only deals with generating light from block sources.
-				Regular sun light is added on as a "post process" step when returning light color in the exposed API.
-				This has the added benefit of being able to skip allocating chunk lighting data in regions that have no light-casting blocks*/
+				/* Note: Sun light for cells exposed to the sky is not stored, and is instead added on when */
+				/*  returning light color in the exposed API. This has the added benefit of being able to skip */
+				/*  allocating chunk lighting data in regions that have no light-casting blocks and no caves/overhangs */
 			}
 		}
 	}
 
+	FlushLightBuckets(LIGHT_CHANNEL_LAVA);
+	FlushLightBuckets(LIGHT_CHANNEL_LAMP);
+
+	SeedChunkSunLight(chunkStartX, chunkStartY, chunkStartZ, chunkEndX, chunkEndY, chunkEndZ);
+	FlushLightBuckets(LIGHT_CHANNEL_SUN);
 	chunkLightingDataFlags[chunkIndex] = CHUNK_SELF_CALCULATED;
 }
 
@@ -364,8 +608,8 @@ static void CalculateChunkLightingAll(int chunkIndex, int cx, int cy, int cz) {
 			CanLightPass(World_GetBlock(neighborCoords.x, neighborCoords.y, neighborCoords.z), FACE_ ## AXIS ## thatFace) \
 		) \
 		{ \
-			neighborBrightness = GetBrightness(neighborCoords.x, neighborCoords.y, neighborCoords.z, isLamp); \
-			neighborBlockBrightness = GetBlockBrightness(World_GetBlock(neighborCoords.x, neighborCoords.y, neighborCoords.z), isLamp); \
+			neighborBrightness = GetBrightness(neighborCoords.x, neighborCoords.y, neighborCoords.z, channel); \
+			neighborBlockBrightness = GetBlockBrightness(World_GetBlock(neighborCoords.x, neighborCoords.y, neighborCoords.z), channel); \
 			/* This spot is a light caster, mark this spot as needing to be re-spread */ \
 			if (neighborBlockBrightness > 0) { \
 				LightNode_Init(otherNode, neighborCoords.x, neighborCoords.y, neighborCoords.z, neighborBlockBrightness); \
@@ -374,38 +618,26 @@ static void CalculateChunkLightingAll(int chunkIndex, int cx, int cy, int cz) {
 			if (neighborBrightness > 0) { \
 				/* This neighbor is darker than cur spot, darken it*/ \
 				if (neighborBrightness < curNode.brightness) { \
-					SetBrightness(0, neighborCoords.x, neighborCoords.y, neighborCoords.z, isLamp, true); \
+					SetBrightness(0, neighborCoords.x, neighborCoords.y, neighborCoords.z, channel, true); \
 					LightNode_Init(otherNode, neighborCoords.x, neighborCoords.y, neighborCoords.z, neighborBrightness); \
 					Queue_Enqueue(&unlightQueue, &otherNode); \
 				} \
-				/* This neighbor is brighter or same, mark this spot as needing to be re-spread */ \
+				/* This neighbor is brighter or same, mark it as needing to spread its light again */ \
 				else { \
-					/* But only if the neighbor actually *can* spread to this block */ \
-					if ( \
-						CanLightPass(thisBlockTrue, FACE_ ## AXIS ## thisFace) && \
-						CanLightPass(World_GetBlock(neighborCoords.x, neighborCoords.y, neighborCoords.z), FACE_ ## AXIS ## thatFace) \
-					) \
-					{ \
-						otherNode = curNode; \
-						otherNode.brightness = neighborBrightness-1; \
-						Queue_Enqueue(&lightQueue, &otherNode); \
-					} \
+					LightNode_Init(otherNode, neighborCoords.x, neighborCoords.y, neighborCoords.z, neighborBrightness); \
+					Queue_Enqueue(&relightQueue, &otherNode); \
 				} \
 			} \
 		} \
 
-/* Spreads darkness out from this point and relights any necessary areas afterward */
-static void CalcUnlight(int x, int y, int z, cc_uint8 brightness, cc_bool isLamp) {
+/* Spreads darkness out from the cells in the unlight queue and relights any necessary areas afterward */
+static void FlushUnlightQueue(int channel, cc_bool firstIsAir) {
 	int count = 0;
 	struct LightNode curNode, otherNode;
 	cc_uint8 neighborBrightness, neighborBlockBrightness;
 	IVec3 neighborCoords;
 	BlockID thisBlockTrue, thisBlock;
 
-	SetBrightness(0, x, y, z, isLamp, true);
-	LightNode_Init(curNode, x, y, z, brightness);
-	Queue_Enqueue(&unlightQueue, &curNode);
-
 	while (unlightQueue.count > 0) {
 		curNode = *(struct LightNode*)(Queue_Dequeue(&unlightQueue));
 		neighborCoords = curNode.coords;
@@ -413,7 +645,7 @@ static void CalcUnlight(int x, int y, int z, cc_uint8 brightness, cc_bool isLamp
 		thisBlockTrue = World_GetBlock(neighborCoords.x, neighborCoords.y, neighborCoords.z);
 		/* For the original cell in the queue, assume this block is air
 		so that light can unspread "out" of it in the case of a solid blocks. */
-		thisBlock = count == 0 ? BLOCK_AIR : thisBlockTrue;
+		thisBlock = (count == 0 && firstIsAir) ? BLOCK_AIR : thisBlockTrue;
 
 		count++;
 
@@ -435,39 +667,408 @@ static void CalcUnlight(int x, int y, int z, cc_uint8 brightness, cc_bool isLamp
 		Light_TryUnSpreadInto(z, <, World.MaxZ, Z, MIN, MAX)
 	}
 
-	FlushLightQueue(isLamp, true);
+	/* A brighter neighbour may have also been darkened after it was marked for spreading again, */
+	/*  so spread light out from its current light level instead of the light level it used to be */
+	while (relightQueue.count > 0) {
+		otherNode = *(struct LightNode*)(Queue_Dequeue(&relightQueue));
+		otherNode.brightness = GetBrightness(otherNode.coords.x, otherNode.coords.y, otherNode.coords.z, channel);
+		if (otherNode.brightness <= 1) continue;
+
+		otherNode.brightness--;
+		QueueNeighbours(otherNode, World_GetBlock(otherNode.coords.x, otherNode.coords.y, otherNode.coords.z), channel);
+	}
+	FlushLightQueue(channel, true);
 }
-static void CalcBlockChange(int x, int y, int z, BlockID oldBlock, BlockID newBlock, cc_bool isLamp) {
-	cc_uint8 oldBlockLightLevel = GetBlockBrightness(oldBlock, isLamp);
-	cc_uint8 newBlockLightLevel = GetBlockBrightness(newBlock, isLamp);
-	cc_uint8 oldLightLevelHere = GetBrightness(x, y, z, isLamp);
+
+/* Spreads darkness out from this point and relights any necessary areas afterward */
+static void CalcUnlight(int x, int y, int z, cc_uint8 brightness, int channel) {
+	struct LightNode curNode;
+
+	SetBrightness(0, x, y, z, channel, true);
+	LightNode_Init(curNode, x, y, z, brightness);
+	Queue_Enqueue(&unlightQueue, &curNode);
+	FlushUnlightQueue(channel, true);
+}
+
+static void CalcBlockChange(int x, int y, int z, BlockID oldBlock, BlockID newBlock, int channel) {
+	cc_uint8 oldBlockLightLevel = GetBlockBrightness(oldBlock, channel);
+	cc_uint8 newBlockLightLevel = GetBlockBrightness(newBlock, channel);
+	cc_uint8 oldLightLevelHere = GetBrightness(x, y, z, channel);
 	struct LightNode entry;
 
 	/* Cell has no lighting and new block doesn't cast light and blocks all light, no change */
-	if (!oldLightLevelHere && !newBlockLightLevel && IsFullOpaque(newBlock)) return;
+	/* NOTE: Light still passes through water, even though it is full sized and blocks light */
+	if (!oldLightLevelHere && !newBlockLightLevel && IsFullOpaque(newBlock) && !IsFullTransparent(newBlock)) return;
 
 	/* Cell is darker than the new block, only brighter case */
 	if (oldLightLevelHere < newBlockLightLevel) {
 		/* brighten this spot, recalculate lighting */
 		LightNode_Init(entry, x, y, z, newBlockLightLevel);
 		Queue_Enqueue(&lightQueue, &entry);
-		FlushLightQueue(isLamp, true);
+		FlushLightQueue(channel, true);
 		return;
 	}
 
 	/* Light passes through old and new, old block does not cast light, new block does not cast light; no change */
 	if (IsFullTransparent(oldBlock) && IsFullTransparent(newBlock) && !oldBlockLightLevel && !newBlockLightLevel) return;
 
-	CalcUnlight(x, y, z, oldLightLevelHere, isLamp);
+	CalcUnlight(x, y, z, oldLightLevelHere, channel);
 }
+
+/* Darkens a neighbouring cell not exposed to the sky, as it may have been lit through the changed block */
+#define Sun_TryDarken(nx, ny, nz, inWorld) \
+	if ((inWorld) && (level = GetBrightness(nx, ny, nz, LIGHT_CHANNEL_SUN)) > 0 && level < FANCY_LIGHTING_MAX_LEVEL) { \
+		SetBrightness(0, nx, ny, nz, LIGHT_CHANNEL_SUN, true); \
+		LightNode_Init(ln, nx, ny, nz, level); \
+		Queue_Enqueue(&unlightQueue, &ln); \
+	}
+
+/* Updates sun light after a block change, which may have also changed the light height of the column */
+static void CalcSunChange(int x, int y, int z, BlockID oldBlock, BlockID newBlock, int oldHeight, int newHeight) {
+	struct LightNode ln;
+	int curY, level;
+
+	if (newHeight > oldHeight) {
+		/* Cells in the column that were exposed to the sky no longer are, */
+		/*  so darken them and then relight them from any neighbouring light */
+		for (curY = newHeight; curY > oldHeight && curY >= 0; curY--) {
+			SetBrightness(0, x, curY, z, LIGHT_CHANNEL_SUN, true);
+			LightNode_Init(ln, x, curY, z, FANCY_LIGHTING_MAX_LEVEL);
+			Queue_Enqueue(&unlightQueue, &ln);
+		}
+		FlushUnlightQueue(LIGHT_CHANNEL_SUN, newHeight == y);
+	} else if (newHeight < oldHeight) {
+		/* Cells in the column are now exposed to the sky, so spread sun light out from them */
+		for (curY = oldHeight; curY > newHeight && curY >= 0; curY--) {
+			LightNode_Init(ln, x, curY, z, FANCY_LIGHTING_MAX_LEVEL - 1);
+			QueueNeighbours(ln, World_GetBlock(x, curY, z), LIGHT_CHANNEL_SUN);
+		}
+		FlushLightQueue(LIGHT_CHANNEL_SUN, true);
+	}
+
+	if (y <= newHeight) {
+		/* Changes below the light height never change the light height */
+		if (newHeight == oldHeight) CalcBlockChange(x, y, z, oldBlock, newBlock, LIGHT_CHANNEL_SUN);
+		return;
+	}
+
+	/* Changed block is still exposed to the sky (e.g. blocks 'shade from below', so the top block */
+	/*  of a column is always exposed), but may now let more or less sun light into its neighbours */
+	if (!IsFullTransparent(newBlock)) {
+		Sun_TryDarken(x - 1, y, z, x > 0)
+		Sun_TryDarken(x + 1, y, z, x < World.MaxX)
+		Sun_TryDarken(x, y - 1, z, y > 0)
+		Sun_TryDarken(x, y + 1, z, y < World.MaxY)
+		Sun_TryDarken(x, y, z - 1, z > 0)
+		Sun_TryDarken(x, y, z + 1, z < World.MaxZ)
+		FlushUnlightQueue(LIGHT_CHANNEL_SUN, false);
+	}
+
+	/* Partially covered blocks (e.g. slabs) still let sun light through some of their faces */
+	LightNode_Init(ln, x, y, z, FANCY_LIGHTING_MAX_LEVEL - 1);
+	QueueNeighbours(ln, newBlock, LIGHT_CHANNEL_SUN);
+	FlushLightQueue(LIGHT_CHANNEL_SUN, true);
+}
+
+static void CalcAllChannelsChange(int x, int y, int z, BlockID oldBlock, BlockID newBlock, int oldHeight, int newHeight) {
+	CalcBlockChange(x, y, z, oldBlock, newBlock, LIGHT_CHANNEL_LAVA);
+	CalcBlockChange(x, y, z, oldBlock, newBlock, LIGHT_CHANNEL_LAMP);
+	CalcSunChange(x, y, z, oldBlock, newBlock, oldHeight, newHeight);
+}
+
+
+/*########################################################################################################################*
+*---------------------------------------------------Background lighting---------------------------------------------------*
+*#########################################################################################################################*/
+/* Calculating and spreading light can take a long time (e.g. when placing a lamp, or when joining a map */
+/*  with thousands of lamps), so it is done on a background thread instead of blocking the main thread. */
+/* The chunks whose light changed are then refreshed on the main thread, so their meshes get rebuilt */
+#ifdef LIGHTING_THREADED
+#define LIGHT_REQUEST_CHUNK 0
+#define LIGHT_REQUEST_BLOCK 1
+struct LightRequest { int x, y, z, oldHeight, newHeight; BlockID oldBlock, newBlock; cc_uint8 type; };
+
+/* Requests waiting to be processed by the background thread, in the order they were made */
+static struct Queue lightRequests;
+/* Indices of chunks whose light has changed, waiting to be refreshed on the main thread */
+static struct LightBucket publishedChunks;
+/* Indices of chunks whose lighting was requested and has now been calculated */
+static struct LightBucket calculatedChunks;
+static struct ScheduledTask2 publishTask;
+
+static void* lightThread;
+static void* lightMutex;
+static void* lightWaitable;
+/* Signalled whenever the background thread finishes processing a request */
+static void* lightIdleWaitable;
+static volatile cc_bool lightQuit;
+static cc_bool lightBusy;
+
+static void LightRequest_Process(struct LightRequest* req) {
+	int chunkIndex;
+
+	if (req->type == LIGHT_REQUEST_CHUNK) {
+		chunkIndex = ChunkCoordsToIndex(req->x, req->y, req->z);
+		if (chunkLightingDataFlags[chunkIndex] < CHUNK_ALL_CALCULATED) {
+			CalculateChunkLightingAll(chunkIndex, req->x, req->y, req->z);
+		}
+	} else {
+		CalcAllChannelsChange(req->x, req->y, req->z, req->oldBlock, req->newBlock, req->oldHeight, req->newHeight);
+	}
+}
+
+/* Copies the light data of a chunk changed by the just finished request, so it can later be published */
+/* NOTE: Must be called with lightMutex locked */
+static void StageChangedChunk(int chunkIndex) {
+	cc_uint8* data = chunkLightingData[chunkIndex];
+	cc_uint8* copy = chunkLightingPending[chunkIndex];
+	if (!data) return;
+
+	if (!copy) {
+		copy = (cc_uint8*)Mem_TryAlloc(LIGHT_DATA_SIZE, sizeof(cc_uint8));
+		if (!copy) return;
+		chunkLightingPending[chunkIndex] = copy;
+	}
+	Mem_Copy(copy, data, LIGHT_DATA_SIZE);
+}
+
+static void LightWorker_Loop(void) {
+	struct LightRequest req;
+	cc_bool hasRequest;
+	int i, chunkIndex;
+
+	while (!lightQuit) {
+		Mutex_Lock(lightMutex);
+		{
+			hasRequest = lightRequests.count > 0;
+			if (hasRequest) req = *(struct LightRequest*)Queue_Dequeue(&lightRequests);
+			lightBusy = hasRequest;
+		}
+		Mutex_Unlock(lightMutex);
+
+		if (!hasRequest) {
+			/* Block until main thread makes more requests */
+			Waitable_Wait(lightWaitable); continue;
+		}
+		LightRequest_Process(&req);
+
+		Mutex_Lock(lightMutex);
+		{
+			for (i = 0; i < changedChunks.count; i++) 
+			{
+				chunkIndex = changedChunks.entries[i];
+				chunkLightChanged[chunkIndex] = false;
+				StageChangedChunk(chunkIndex);
+				LightBucket_Add(&publishedChunks, chunkIndex);
+			}
+			changedChunks.count = 0;
+			lightBusy = false;
+
+			if (req.type == LIGHT_REQUEST_CHUNK) {
+				LightBucket_Add(&calculatedChunks, ChunkCoordsToIndex(req.x, req.y, req.z));
+			}
+		}
+		Mutex_Unlock(lightMutex);
+		Waitable_Signal(lightIdleWaitable);
+	}
+}
+
+static void LightRequest_Add(int type, int x, int y, int z, BlockID oldBlock, BlockID newBlock, int oldHeight, int newHeight) {
+	struct LightRequest req;
+	req.type = type;
+	req.x = x; req.y = y; req.z = z;
+	req.oldBlock  = oldBlock;  req.newBlock  = newBlock;
+	req.oldHeight = oldHeight; req.newHeight = newHeight;
+
+	Mutex_Lock(lightMutex);
+	{
+		Queue_Enqueue(&lightRequests, &req);
+	}
+	Mutex_Unlock(lightMutex);
+	Waitable_Signal(lightWaitable);
+}
+
+static void RequestChunkLighting(int cx, int cy, int cz) {
+	int chunkIndex = ChunkCoordsToIndex(cx, cy, cz);
+	int x, z;
+	if (chunkLightingDataFlags[chunkIndex] == CHUNK_ALL_CALCULATED || chunkLightRequested[chunkIndex]) return;
+
+	/* Background thread can read the light height of columns up to two chunks away when spreading */
+	/*  sun light, so calculate them here instead of it having to recalculate them every time */
+	for (z = cz - 2; z <= cz + 2; z++) {
+		if (z < 0 || z >= World.ChunksZ) continue;
+		for (x = cx - 2; x <= cx + 2; x++) {
+			if (x < 0 || x >= World.ChunksX) continue;
+			ClassicLighting_LightHint(x * CHUNK_SIZE - 1, 0, z * CHUNK_SIZE - 1);
+		}
+	}
+
+	chunkLightRequested[chunkIndex] = true;
+	LightRequest_Add(LIGHT_REQUEST_CHUNK, cx, cy, cz, 0, 0, 0, 0);
+}
+
+/* Replaces the light data chunk meshes are built from with the light data from the last finished request */
+/* NOTE: Must be called with lightMutex locked */
+static void PublishChunk(int chunkIndex) {
+	cc_uint8* copy = chunkLightingPending[chunkIndex];
+	if (!copy) return;
+	chunkLightingPending[chunkIndex] = NULL;
+
+	if (!chunkLightingPublished[chunkIndex]) {
+		chunkLightingPublished[chunkIndex] = copy; return;
+	}
+	/* Copied instead of swapped, as mesh builder threads may still be reading the old light data */
+	Mem_Copy(chunkLightingPublished[chunkIndex], copy, LIGHT_DATA_SIZE);
+	Mem_Free(copy);
+}
+
+static cc_bool PublishChangedChunks(struct ScheduledTask2* task) {
+	int i, chunkIndex, cx, cy, cz;
+	if (!lightAsync) return true;
+
+	Mutex_Lock(lightMutex);
+	{
+		for (i = 0; i < publishedChunks.count; i++) 
+		{
+			chunkIndex = publishedChunks.entries[i];
+			PublishChunk(chunkIndex);
+			cx =  chunkIndex % World.ChunksX;
+			cz = (chunkIndex / World.ChunksX) % World.ChunksZ;
+			cy = (chunkIndex / World.ChunksX) / World.ChunksZ;
+			MapRenderer_RefreshChunk(cx, cy, cz);
+		}
+		publishedChunks.count = 0;
+
+		/* Meshes of these chunks can now be built, as their light has been published */
+		for (i = 0; i < calculatedChunks.count; i++)
+		{
+			chunkLightRequested[calculatedChunks.entries[i]] = false;
+		}
+		calculatedChunks.count = 0;
+	}
+	Mutex_Unlock(lightMutex);
+	return true;
+}
+
+static cc_bool IsChunkPending(int cx, int cy, int cz) {
+	cc_bool pending = false;
+	int x, y, z;
+
+	/* Chunk mesh may sample lighting from all neighbouring chunks too (see LightHint) */
+	for (y = cy - 1; y <= cy + 1; y++) {
+		if (y < 0 || y >= World.ChunksY) continue;
+		for (z = cz - 1; z <= cz + 1; z++) {
+			if (z < 0 || z >= World.ChunksZ) continue;
+			for (x = cx - 1; x <= cx + 1; x++) {
+				if (x < 0 || x >= World.ChunksX) continue;
+
+				RequestChunkLighting(x, y, z);
+				pending |= chunkLightRequested[ChunkCoordsToIndex(x, y, z)];
+			}
+		}
+	}
+	return pending;
+}
+
+void FancyLighting_CancelAll(void) {
+	cc_bool busy;
+	if (!lightAsync) return;
+
+	Mutex_Lock(lightMutex);
+	{
+		Queue_Clear(&lightRequests);
+	}
+	Mutex_Unlock(lightMutex);
+
+	/* Wait for background thread to finish the request it is currently processing */
+	/*  (lightIdleWaitable may also still be signalled from an earlier request, hence the loop) */
+	for (;;) {
+		Mutex_Lock(lightMutex);
+		busy = lightBusy;
+		Mutex_Unlock(lightMutex);
+
+		if (!busy) break;
+		Waitable_Wait(lightIdleWaitable);
+	}
+
+	Mutex_Lock(lightMutex);
+	{
+		publishedChunks.count  = 0;
+		calculatedChunks.count = 0;
+	}
+	Mutex_Unlock(lightMutex);
+
+	/* Discarded requests have to be made again, otherwise chunks would be pending forever */
+	if (chunkLightRequested) Mem_Set(chunkLightRequested, 0, chunksCount);
+}
+
+static void LightWorker_Init(void) {
+	publishTask.interval = GAME_DEF_TICKS;
+	publishTask.callback = PublishChangedChunks;
+	ScheduledTask2_Add(&publishTask);
+}
+
+static void LightWorker_Start(void) {
+	if (lightAsync) return;
+	Queue_Init(&lightRequests, sizeof(struct LightRequest));
+	lightMutex    = Mutex_Create("Light requests");
+	lightWaitable = Waitable_Create("Light wakeup");
+	lightIdleWaitable = Waitable_Create("Light idle");
+	lightQuit     = false;
+
+	Thread_Run(&lightThread, LightWorker_Loop, 64 * 1024, "Light propagator");
+	lightAsync = true;
+}
+
+static void LightWorker_Stop(void) {
+	if (!lightAsync) return;
+	FancyLighting_CancelAll();
+
+	lightQuit = true;
+	Waitable_Signal(lightWaitable);
+	Thread_Join(lightThread);
+	lightAsync = false;
+
+	Queue_Clear(&lightRequests);
+	Mem_Free(publishedChunks.entries);
+	publishedChunks.entries  = NULL;
+	publishedChunks.count    = 0;
+	publishedChunks.capacity = 0;
+	Mem_Free(calculatedChunks.entries);
+	calculatedChunks.entries  = NULL;
+	calculatedChunks.count    = 0;
+	calculatedChunks.capacity = 0;
+
+	Mutex_Free(lightMutex);
+	Waitable_Free(lightWaitable);
+	Waitable_Free(lightIdleWaitable);
+}
+#else
+#define LIGHT_REQUEST_BLOCK 1
+static void LightRequest_Add(int type, int x, int y, int z, BlockID oldBlock, BlockID newBlock, int oldHeight, int newHeight) { }
+static void RequestChunkLighting(int cx, int cy, int cz) { }
+void FancyLighting_CancelAll(void) { }
+#define IsChunkPending NULL
+
+static void LightWorker_Init(void)  { }
+static void LightWorker_Start(void) { }
+static void LightWorker_Stop(void) { }
+#endif
+
 static void OnBlockChanged(int x, int y, int z, BlockID oldBlock, BlockID newBlock) {
+	int oldHeight, newHeight;
 	/* For some reason this is a possible case */
 	if (oldBlock == newBlock) { return; }
 
+	/* Sun light is only affected by the light height changing if it was calculated before */
+	oldHeight = ClassicLighting_PeekLightHeight(x, z);
 	ClassicLighting_OnBlockChanged(x, y, z, oldBlock, newBlock);
+	newHeight = ClassicLighting_PeekLightHeight(x, z);
 
-	CalcBlockChange(x, y, z, oldBlock, newBlock, false);
-	CalcBlockChange(x, y, z, oldBlock, newBlock, true);
+	if (lightAsync) {
+		LightRequest_Add(LIGHT_REQUEST_BLOCK, x, y, z, oldBlock, newBlock, oldHeight, newHeight); return;
+	}
+	CalcAllChannelsChange(x, y, z, oldBlock, newBlock, oldHeight, newHeight);
 }
 /* Invalidates/Resets lighting state for all of the blocks in the world */
 /*  (e.g. because a block changed whether it is full bright or not) */
@@ -485,7 +1086,7 @@ static cc_bool IsLit_Fast(int x, int y, int z) { return ClassicLighting_IsLit_Fa
 	}
 
 static PackedCol Color_Core(int x, int y, int z, int paletteFace) {
-	cc_uint8 lightData;
+	cc_uint8 lightData, sunLevel, * data;
 	int cx, cy, cz, chunkIndex;
 	int chunkCoordsIndex;
 
@@ -494,23 +1095,25 @@ static PackedCol Color_Core(int x, int y, int z, int paletteFace) {
 	cz = z >> CHUNK_SHIFT;
 
 	chunkIndex = ChunkCoordsToIndex(cx, cy, cz);
-	CalcForChunkIfNeeded(cx, cy, cz, chunkIndex);
+	/* When calculated on the background thread, chunk might not have been calculated yet */
+	if (!lightAsync) {
+		CalcForChunkIfNeeded(cx, cy, cz, chunkIndex);
+	}
 
 	/* There might be no light data in this chunk even after it was calculated */
-	if (chunkLightingData[chunkIndex] == NULL) {
-		lightData = 0;
-	} else {
-		chunkCoordsIndex = GlobalCoordsToChunkCoordsIndex(x, y, z);
-		lightData = chunkLightingData[chunkIndex][chunkCoordsIndex];
-	}
+	chunkCoordsIndex = GlobalCoordsToChunkCoordsIndex(x, y, z);
+	data = chunkLightingPublished[chunkIndex];
+	lightData = data ? data[chunkCoordsIndex] : 0;
 
 	/* This cell is exposed to sunlight */
 	if (y > ClassicLighting_GetLightHeight(x, z)) {
-		/* Push the pointer forward into the sun lit palette section */
-		paletteFace += PALETTE_SHADES;
+		sunLevel = FANCY_LIGHTING_MAX_LEVEL;
+	} else {
+		sunLevel = data ? LightData_Get(data, chunkCoordsIndex, LIGHT_CHANNEL_SUN) : 0;
 	}
 
-	return palettes[paletteFace][lightData];
+	/* Push the pointer forward into the palette section for this level of sun light */
+	return palettes[paletteFace + sunLevel * PALETTE_SHADES][lightData];
 }
 
 #define TRY_OOB_CASE(sun, shadow) if (!World_Contains(x, y, z)) return y >= Env.EdgeHeight ? sun : shadow
@@ -537,6 +1140,7 @@ static PackedCol Color_ZSide(int x, int y, int z) {
 
 static void LightHint(int startX, int startY, int startZ) {
 	int cx, cy, cz, chunkIndex;
+	int x, y, z;
 	ClassicLighting_LightHint(startX, startY, startZ);
 	/* Add 1 to startX/Z, as coordinates are for the extended chunk (18x18x18) */
 	startX++; startY++; startZ++;
@@ -545,8 +1149,30 @@ static void LightHint(int startX, int startY, int startZ) {
 	cy = (startY + HALF_CHUNK_SIZE) >> CHUNK_SHIFT;
 	cz = (startZ + HALF_CHUNK_SIZE) >> CHUNK_SHIFT;
 
-	chunkIndex = ChunkCoordsToIndex(cx, cy, cz);
-	CalcForChunkIfNeeded(cx, cy, cz, chunkIndex);
+	/* Neighbouring chunks are calculated on demand when meshes are built on the main thread */
+	if (!Builder_Workers && !lightAsync) {
+		chunkIndex = ChunkCoordsToIndex(cx, cy, cz);
+		CalcForChunkIfNeeded(cx, cy, cz, chunkIndex);
+		return;
+	}
+
+	/* Chunk mesh may sample lighting from all neighbouring chunks too. Calculate */
+	/*  those here, so that background mesh builders only ever read lighting data */
+	for (y = cy - 1; y <= cy + 1; y++) {
+		if (y < 0 || y >= World.ChunksY) continue;
+		for (z = cz - 1; z <= cz + 1; z++) {
+			if (z < 0 || z >= World.ChunksZ) continue;
+			for (x = cx - 1; x <= cx + 1; x++) {
+				if (x < 0 || x >= World.ChunksX) continue;
+
+				if (lightAsync) {
+					RequestChunkLighting(x, y, z); continue;
+				}
+				chunkIndex = ChunkCoordsToIndex(x, y, z);
+				CalcForChunkIfNeeded(x, y, z, chunkIndex);
+			}
+		}
+	}
 }
 
 void FancyLighting_SetActive(void) {
@@ -566,6 +1192,16 @@ void FancyLighting_SetActive(void) {
 	Lighting.FreeState  = FreeState;
 	Lighting.AllocState = AllocState;
 	Lighting.LightHint  = LightHint;
+	/* Lamp light spreading assumes only one block changed at a time */
+	Lighting.OnBlocksChanged = NULL;
+
+	/* Background thread is only needed while fancy lighting is active */
+	LightWorker_Start();
+	Lighting.IsChunkPending = lightAsync ? IsChunkPending : NULL;
+}
+
+void FancyLighting_SetInactive(void) {
+	LightWorker_Stop();
 }
 
 static void OnEnvVariableChanged(void* obj, int envVar) {
@@ -580,4 +1216,9 @@ static void OnEnvVariableChanged(void* obj, int envVar) {
 
 void FancyLighting_OnInit(void) {
 	Event_Register_(&WorldEvents.EnvVarChanged, NULL, OnEnvVariableChanged);
+	LightWorker_Init();
+}
+
+void FancyLighting_OnFree(void) {
+	LightWorker_Stop();
 }
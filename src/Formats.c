@@ -17,6 +17,7 @@
 #include "TexturePack.h"
 #include "Utils.h"
 #include "Audio.h"
+#include "Options.h"
 
 #ifdef CC_BUILD_FILESYSTEM
 static struct LocationUpdate* spawn_point;
@@ -24,15 +25,256 @@ static struct MapImporter* imp_head;
 static struct MapImporter* imp_tail;
 
 
+/*########################################################################################################################*
+*----------------------------------------------------Pipelined loading----------------------------------------------------*
+*#########################################################################################################################*/
+/* When possible, loading a map is split into a pipeline of three stages:
+     1) File thread     - reads raw data from the file into buffers
+     2) Inflate thread  - decompresses data from the file stage into buffers
+     3) Main thread     - parses decompressed data and then hands blocks off to the world
+   so that decompression overlaps both file IO and parsing of the map */
+#if !defined CC_BUILD_COOPTHREADED && !defined CC_BUILD_LOWMEM && !defined CC_BUILD_PSP && !defined CC_BUILD_NDS
+#define MAP_PIPE_BUFFERS 4
+#define MAP_PIPE_BUFFER_SIZE (256 * 1024)
+
+/* Single producer/single consumer queue of buffers, filled by a background thread */
+struct MapPipe {
+	struct Stream stream;  /* Stream the consumer reads from */
+	struct Stream* source; /* Stream the producer thread reads from */
+	void* thread;
+	void* mutex;
+	void* filled;   /* Signalled when the producer has filled a buffer */
+	void* emptied;  /* Signalled when the consumer has finished with a buffer */
+	cc_uint8* data; /* MAP_PIPE_BUFFERS buffers of MAP_PIPE_BUFFER_SIZE bytes */
+	cc_uint32 lens[MAP_PIPE_BUFFERS];
+	/* Number of buffers produced and consumed so far (protected by mutex) */
+	int head, tail;
+	cc_bool done, aborted;
+	cc_result result;
+	/* Consumer only state */
+	cc_uint8* cur;
+	cc_uint32 left;
+	cc_bool holding;
+};
+
+static struct MapPipe map_filePipe, map_inflatePipe;
+static struct Stream map_inflateStream;
+static struct InflateState* map_inflateState;
+
+/* Reads as much data as possible from the given stream, up to size bytes */
+static cc_result MapPipe_Fill(struct Stream* source, cc_uint8* data, cc_uint32 size, cc_uint32* total) {
+	cc_uint32 read;
+	cc_result res;
+	*total = 0;
+
+	while (*total < size) {
+		res = source->Read(source, data + *total, size - *total, &read);
+		if (res)   return res;
+		if (!read) return 0;
+		*total += read;
+	}
+	return 0;
+}
+
+static void MapPipe_Produce(struct MapPipe* p) {
+	cc_uint8* buffer;
+	cc_uint32 len;
+	cc_result res;
+	cc_bool stop;
+
+	for (;;) {
+		Mutex_Lock(p->mutex);
+		while (p->head - p->tail == MAP_PIPE_BUFFERS && !p->aborted) {
+			Mutex_Unlock(p->mutex);
+			Waitable_Wait(p->emptied);
+			Mutex_Lock(p->mutex);
+		}
+		stop = p->aborted;
+		Mutex_Unlock(p->mutex);
+		if (stop) return;
+
+		/* Consumer never touches buffers at or after head, so safe to fill without holding the mutex */
+		buffer = p->data + (p->head % MAP_PIPE_BUFFERS) * MAP_PIPE_BUFFER_SIZE;
+		res    = MapPipe_Fill(p->source, buffer, MAP_PIPE_BUFFER_SIZE, &len);
+
+		Mutex_Lock(p->mutex);
+		if (len) {
+			p->lens[p->head % MAP_PIPE_BUFFERS] = len;
+			p->head++;
+		}
+		stop = res || len < MAP_PIPE_BUFFER_SIZE;
+		if (stop) { p->done = true; p->result = res; }
+		Mutex_Unlock(p->mutex);
+
+		Waitable_Signal(p->filled);
+		if (stop) return;
+	}
+}
+static void MapPipe_FileMain(void)    { MapPipe_Produce(&map_filePipe); }
+static void MapPipe_InflateMain(void) { MapPipe_Produce(&map_inflatePipe); }
+
+/* Releases the current buffer back to the producer, then waits for the next filled buffer */
+static cc_result MapPipe_Next(struct MapPipe* p) {
+	cc_bool released = p->holding;
+	cc_result res    = 0;
+	int slot;
+
+	Mutex_Lock(p->mutex);
+	if (p->holding) { p->tail++; p->holding = false; }
+
+	while (p->head == p->tail && !p->done && !p->aborted) {
+		Mutex_Unlock(p->mutex);
+		if (released) { Waitable_Signal(p->emptied); released = false; }
+		Waitable_Wait(p->filled);
+		Mutex_Lock(p->mutex);
+	}
+
+	if (p->head != p->tail) {
+		slot       = p->tail % MAP_PIPE_BUFFERS;
+		p->cur     = p->data + slot * MAP_PIPE_BUFFER_SIZE;
+		p->left    = p->lens[slot];
+		p->holding = true;
+	} else {
+		res = p->aborted ? ERR_END_OF_STREAM : p->result;
+	}
+	Mutex_Unlock(p->mutex);
+
+	if (released) Waitable_Signal(p->emptied);
+	return res;
+}
+
+static cc_result MapPipe_Read(struct Stream* s, cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
+	struct MapPipe* p = (struct MapPipe*)s->meta.ptr;
+	cc_result res;
+	*modified = 0;
+
+	if (!p->left) {
+		if ((res = MapPipe_Next(p))) return res;
+		if (!p->left) return 0;
+	}
+
+	count = min(count, p->left);
+	Mem_Copy(data, p->cur, count);
+	p->cur  += count;
+	p->left -= count;
+	*modified = count;
+	return 0;
+}
+
+static cc_result MapPipe_ReadU8(struct Stream* s, cc_uint8* data) {
+	struct MapPipe* p = (struct MapPipe*)s->meta.ptr;
+	cc_result res;
+
+	if (!p->left) {
+		if ((res = MapPipe_Next(p))) return res;
+		if (!p->left) return ERR_END_OF_STREAM;
+	}
+	*data = *p->cur++;
+	p->left--;
+	return 0;
+}
+
+static cc_bool MapPipe_Start(struct MapPipe* p, struct Stream* source, Thread_StartFunc func, const char* name) {
+	p->data = (cc_uint8*)Mem_TryAlloc(MAP_PIPE_BUFFERS, MAP_PIPE_BUFFER_SIZE);
+	if (!p->data) return false;
+
+	Stream_Init(&p->stream);
+	p->stream.Read     = MapPipe_Read;
+	p->stream.ReadU8   = MapPipe_ReadU8;
+	p->stream.meta.ptr = p;
+
+	p->source  = source;
+	p->head    = 0; p->tail = 0;
+	p->done    = false; p->aborted = false;
+	p->result  = 0;
+	p->cur     = NULL; p->left = 0;
+	p->holding = false;
+
+	p->mutex   = Mutex_Create("Map load pipe");
+	p->filled  = Waitable_Create("Map load filled");
+	p->emptied = Waitable_Create("Map load emptied");
+	Thread_Run(&p->thread, func, 64 * 1024, name);
+	return true;
+}
+
+/* Tells the producer thread to stop, then waits for it to finish */
+static void MapPipe_Abort(struct MapPipe* p) {
+	if (!p->data) return;
+	Mutex_Lock(p->mutex);
+	p->aborted = true;
+	Mutex_Unlock(p->mutex);
+
+	Waitable_Signal(p->emptied);
+	Waitable_Signal(p->filled);
+}
+
+static void MapPipe_Free(struct MapPipe* p) {
+	if (!p->data) return;
+	Thread_Join(p->thread);
+
+	Mutex_Free(p->mutex);
+	Waitable_Free(p->filled);
+	Waitable_Free(p->emptied);
+	Mem_Free(p->data);
+	p->data = NULL;
+}
+
+/* Starts reading from the file on a background thread, returning the stream to import from */
+static struct Stream* Map_BeginPipeline(struct Stream* file) {
+	if (!MapPipe_Start(&map_filePipe, file, MapPipe_FileMain, "Map file reader")) return file;
+	return &map_filePipe.stream;
+}
+
+/* Starts decompressing data read from the file stage on a background thread */
+static cc_bool Map_PipelineInflate(struct Stream* compStream, struct Stream* stream) {
+	/* Only pipeline when reading straight from the file stage */
+	if (stream != &map_filePipe.stream || map_inflatePipe.data) return false;
+
+	map_inflateState = (struct InflateState*)Mem_TryAlloc(1, sizeof(struct InflateState));
+	if (!map_inflateState) return false;
+	Inflate_MakeStream2(&map_inflateStream, map_inflateState, stream);
+
+	if (!MapPipe_Start(&map_inflatePipe, &map_inflateStream, MapPipe_InflateMain, "Map inflater")) {
+		Mem_Free(map_inflateState);
+		map_inflateState = NULL;
+		return false;
+	}
+	*compStream = map_inflatePipe.stream;
+	return true;
+}
+
+static void Map_EndPipeline(void) {
+	/* Abort both stages first, in case the inflate thread is waiting on the file thread */
+	MapPipe_Abort(&map_inflatePipe);
+	MapPipe_Abort(&map_filePipe);
+	MapPipe_Free(&map_inflatePipe);
+	MapPipe_Free(&map_filePipe);
+
+	Mem_Free(map_inflateState);
+	map_inflateState = NULL;
+}
+#else
+static struct Stream* Map_BeginPipeline(struct Stream* file) { return file; }
+static cc_bool Map_PipelineInflate(struct Stream* compStream, struct Stream* stream) { return false; }
+static void Map_EndPipeline(void) { }
+#endif
+
+
 /*########################################################################################################################*
 *--------------------------------------------------------General----------------------------------------------------------*
 *#########################################################################################################################*/
 static cc_result Map_ReadBlocks(struct Stream* stream) {
+#ifdef CC_BUILD_COMPACTWORLD
+	cc_result res;
+	if ((res = World_AllocSections())) return res;
+	return World_ReadSections(stream, 0);
+#else
 	World.Volume = World.Width * World.Length * World.Height;
 	World.Blocks = (BlockRaw*)Mem_TryAlloc(World.Volume, 1);
 
 	if (!World.Blocks) return ERR_OUT_OF_MEMORY;
 	return Stream_Read(stream, World.Blocks, World.Volume);
+#endif
 }
 
 static cc_result Map_SkipGZipHeader(struct Stream* stream) {
@@ -46,6 +288,18 @@ static cc_result Map_SkipGZipHeader(struct Stream* stream) {
 	return 0;
 }
 
+/* Skips the GZIP header, then sets up compStream to decompress the rest of the data */
+/* NOTE: When pipelined, decompression is instead performed on a background thread */
+static cc_result Map_BeginInflate(struct Stream* compStream, struct InflateState* state, struct Stream* stream) {
+	cc_result res;
+	if ((res = Map_SkipGZipHeader(stream))) return res;
+
+	if (!Map_PipelineInflate(compStream, stream)) {
+		Inflate_MakeStream2(compStream, state, stream);
+	}
+	return 0;
+}
+
 void MapImporter_Register(struct MapImporter* imp) {
 	LinkedList_Append(imp, imp_head, imp_tail);
 }
@@ -62,9 +316,23 @@ struct MapImporter* MapImporter_Find(const cc_string* path) {
 	return NULL;
 }
 
+struct MapCacheKey;
+static cc_result MapCache_GetKey(struct Stream* file, struct MapImporter* imp, struct MapCacheKey* key);
+static cc_bool   MapCache_Load(struct MapCacheKey* key);
+static void      MapCache_Save(struct MapCacheKey* key);
+
+/* Identifies the source map file that an uncompressed cached copy was created from */
+struct MapCacheKey {
+	cc_bool valid, loaded;
+	cc_uint32 srcLength;
+	cc_uint8 srcTrailer[8]; /* CRC32 and size of the uncompressed data, from end of the GZIP file */
+	cc_uint8 uuid[WORLD_UUID_LEN];
+};
+
 cc_result Map_LoadFrom(const cc_string* path) {
 	cc_string relPath, fileName, fileExt;
 	struct LocationUpdate update = { 0 };
+	struct MapCacheKey cacheKey;
 	struct MapImporter* imp;
 	struct Stream stream;
 	cc_filepath raw_path;
@@ -78,10 +346,20 @@ cc_result Map_LoadFrom(const cc_string* path) {
 	if (res) { Logger_IOWarn2(res, "opening", &raw_path); return res; }
 
 	imp = MapImporter_Find(path);
-	if (!imp) {
+	res = MapCache_GetKey(&stream, imp, &cacheKey);
+
+	if (res) {
+		/* Logged as decoding failure below */
+	} else if (!imp) {
 		res = ERR_NOT_SUPPORTED;
-	} else if ((res = imp->import(&stream))) {
-		World_Reset();
+	} else if (!MapCache_Load(&cacheKey)) {
+		res = imp->import(Map_BeginPipeline(&stream));
+		Map_EndPipeline();
+		if (res) World_Reset();
+
+		/* UUID was found by scanning, so double check it really was the world's UUID */
+		/* NOTE: Must be checked before World_SetNewMap, as that gives the world a new UUID */
+		if (!Mem_Equal(cacheKey.uuid, World.Uuid, WORLD_UUID_LEN)) cacheKey.valid = false;
 	}
 
 	/* No point logging error for closing readonly file */
@@ -91,6 +369,7 @@ cc_result Map_LoadFrom(const cc_string* path) {
 	World_SetNewMap(World.Blocks, World.Width, World.Height, World.Length);
 	if (!spawn_point) LocalPlayer_CalcDefaultSpawn(Entities.CurPlayer, &update);
 	LocalPlayers_MoveToSpawn(&update);
+	if (!res) MapCache_Save(&cacheKey);
 
 	relPath = *path;
 	Utils_UNSAFE_GetFilename(&relPath);
@@ -137,18 +416,67 @@ static const cc_uint8 Lvl_table[256] = {
 	29, 22, 10, 22, 22, 41, 19, 35, 21, 29, 49, 34, 16, 41,  0, 22
 };
 
-static cc_result Lvl_ReadCustomBlocks(struct Stream* stream) {	
-	cc_uint8 chunk[LVL_CHUNKSIZE * LVL_CHUNKSIZE * LVL_CHUNKSIZE];
-	cc_uint8 hasCustom;
-	int baseIndex, index, xx, yy, zz;
-	cc_result res;
-	int x, y, z, i;
+#define LVL_CHUNKVOLUME (LVL_CHUNKSIZE * LVL_CHUNKSIZE * LVL_CHUNKSIZE)
+
+#ifdef CC_BUILD_COMPACTWORLD
+/* Replaces the custom tile placeholder blocks in the given chunk */
+static void Lvl_SetCustomBlocks(const cc_uint8* chunk, int x, int y, int z) {
+	int i, xx, yy, zz;
+
+	for (i = 0; i < LVL_CHUNKVOLUME; i++) {
+		xx = x + (i & 0xF); yy = y + ((i >> 8) & 0xF); zz = z + ((i >> 4) & 0xF);
+		if (!World_Contains(xx, yy, zz)) continue;
+
+		if (World_GetBlock(xx, yy, zz) == LVL_CUSTOMTILE) World_SetBlock(xx, yy, zz, chunk[i]);
+	}
+}
+
+/* Converts MCSharp block IDs as they are read, since there is no flat blocks array to convert afterwards */
+static cc_result Lvl_ConvertRead(struct Stream* s, cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
+	struct Stream* source = (struct Stream*)s->meta.ptr;
+	cc_result res = source->Read(source, data, count, modified);
+	cc_uint32 i;
+	if (res) return res;
+
+	for (i = 0; i < *modified; i++) { data[i] = Lvl_table[data[i]]; }
+	return 0;
+}
+#else
+/* Replaces the custom tile placeholder blocks in the given chunk */
+static void Lvl_SetCustomBlocks(const cc_uint8* chunk, int x, int y, int z) {
+	int baseIndex = World_Pack(x, y, z);
+	int index, xx, yy, zz, i;
 
 	/* skip bounds checks when we know chunk is entirely inside map */
 	int adjWidth  = World.Width  & ~0x0F;
 	int adjHeight = World.Height & ~0x0F;
 	int adjLength = World.Length & ~0x0F;
 
+	if ((x + LVL_CHUNKSIZE) <= adjWidth && (y + LVL_CHUNKSIZE) <= adjHeight && (z + LVL_CHUNKSIZE) <= adjLength) {
+		for (i = 0; i < LVL_CHUNKVOLUME; i++) {
+			xx = i & 0xF; yy = (i >> 8) & 0xF; zz = (i >> 4) & 0xF;
+
+			index = baseIndex + World_Pack(xx, yy, zz);
+			World.Blocks[index] = World.Blocks[index] == LVL_CUSTOMTILE ? chunk[i] : World.Blocks[index];
+		}
+	} else {
+		for (i = 0; i < LVL_CHUNKVOLUME; i++) {
+			xx = i & 0xF; yy = (i >> 8) & 0xF; zz = (i >> 4) & 0xF;
+			if ((x + xx) >= World.Width || (y + yy) >= World.Height || (z + zz) >= World.Length) continue;
+
+			index = baseIndex + World_Pack(xx, yy, zz);
+			World.Blocks[index] = World.Blocks[index] == LVL_CUSTOMTILE ? chunk[i] : World.Blocks[index];
+		}
+	}
+}
+#endif
+
+static cc_result Lvl_ReadCustomBlocks(struct Stream* stream) {	
+	cc_uint8 chunk[LVL_CHUNKVOLUME];
+	cc_uint8 hasCustom;
+	cc_result res;
+	int x, y, z;
+
 	for (y = 0; y < World.Height; y += LVL_CHUNKSIZE) {
 		for (z = 0; z < World.Length; z += LVL_CHUNKSIZE) {
 			for (x = 0; x < World.Width; x += LVL_CHUNKSIZE) {
@@ -156,24 +484,7 @@ static cc_result Lvl_ReadCustomBlocks(struct Stream* stream) {
 				if ((res = stream->ReadU8(stream, &hasCustom))) return res;
 				if (hasCustom != 1) continue;
 				if ((res = Stream_Read(stream, chunk, sizeof(chunk)))) return res;
-				baseIndex = World_Pack(x, y, z);
-
-				if ((x + LVL_CHUNKSIZE) <= adjWidth && (y + LVL_CHUNKSIZE) <= adjHeight && (z + LVL_CHUNKSIZE) <= adjLength) {
-					for (i = 0; i < sizeof(chunk); i++) {
-						xx = i & 0xF; yy = (i >> 8) & 0xF; zz = (i >> 4) & 0xF;
-
-						index = baseIndex + World_Pack(xx, yy, zz);
-						World.Blocks[index] = World.Blocks[index] == LVL_CUSTOMTILE ? chunk[i] : World.Blocks[index];
-					}
-				} else {
-					for (i = 0; i < sizeof(chunk); i++) {
-						xx = i & 0xF; yy = (i >> 8) & 0xF; zz = (i >> 4) & 0xF;
-						if ((x + xx) >= World.Width || (y + yy) >= World.Height || (z + zz) >= World.Length) continue;
-
-						index = baseIndex + World_Pack(xx, yy, zz);
-						World.Blocks[index] = World.Blocks[index] == LVL_CUSTOMTILE ? chunk[i] : World.Blocks[index];
-					}
-				}
+				Lvl_SetCustomBlocks(chunk, x, y, z);
 			}
 		}
 	}
@@ -184,16 +495,19 @@ static cc_result Lvl_ReadCustomBlocks(struct Stream* stream) {
 /* Used by MCSharp/MCLawl/MCForge/MCDzienny/MCGalaxy */
 static cc_result Lvl_Load(struct Stream* stream) {
 	cc_uint8 header[18];
-	cc_uint8* blocks;
 	cc_uint8 section;
 	cc_result res;
+#ifdef CC_BUILD_COMPACTWORLD
+	struct Stream convStream;
+#else
+	cc_uint8* blocks;
 	int i;
+#endif
 
 	struct Stream compStream;
 	struct InflateState state;
-	Inflate_MakeStream2(&compStream, &state, stream);
 	
-	if ((res = Map_SkipGZipHeader(stream)))                       return res;
+	if ((res = Map_BeginInflate(&compStream, &state, stream)))    return res;
 	if ((res = Stream_Read(&compStream, header, sizeof(header)))) return res;
 	if (Mem_ReadU16_LE(&header[0]) != 1874) return LVL_ERR_VERSION;
 
@@ -209,6 +523,12 @@ static cc_result Lvl_Load(struct Stream* stream) {
 	spawn_point->pitch = Math_Packed2Deg(header[15]);
 	/* (2) pervisit, perbuild permissions */
 
+#ifdef CC_BUILD_COMPACTWORLD
+	Stream_Init(&convStream);
+	convStream.Read     = Lvl_ConvertRead;
+	convStream.meta.ptr = &compStream;
+	if ((res = Map_ReadBlocks(&convStream))) return res;
+#else
 	if ((res = Map_ReadBlocks(&compStream))) return res;
 	blocks = World.Blocks;
 	/* Bulk convert 4 blocks at once */
@@ -221,6 +541,7 @@ static cc_result Lvl_Load(struct Stream* stream) {
 	for (; i < World.Volume; i++) {
 		*blocks = Lvl_table[*blocks]; blocks++;
 	}
+#endif
 
 	/* 0xBD section type is not present in older .lvl files */
 	res = compStream.ReadU8(&compStream, &section);
@@ -418,6 +739,31 @@ static cc_result Nbt_ReadString(struct Stream* stream, cc_string* str) {
 }
 
 typedef void (*Nbt_Callback)(struct NbtTag* tag);
+
+#ifdef CC_BUILD_COMPACTWORLD
+/* Returns the shift of the 8 bits of each block stored in the given array tag, or -1 if it doesn't store blocks */
+typedef int (*Nbt_BlocksCallback)(struct NbtTag* tag);
+static Nbt_BlocksCallback nbt_blocksCallback;
+
+/* Reads the given array tag directly into sections if it stores blocks, instead of into a Volume sized array */
+/* Returns false if the tag's data should instead be read as normal */
+static cc_bool Nbt_ReadBlocks(struct NbtTag* tag, struct Stream* stream, cc_result* res) {
+	int shift;
+	if (!nbt_blocksCallback || (shift = nbt_blocksCallback(tag)) < 0) return false;
+	/* Dimensions are almost always before the blocks, so can just fallback to reading into an array otherwise */
+	if ((cc_uint64)World.Width * World.Height * World.Length != tag->dataSize) return false;
+
+	if (!shift) {
+		*res = World_AllocSections();
+	} else if (!World.Sections) {
+		return false;
+	}
+
+	if (!(*res)) *res = World_ReadSections(stream, shift);
+	return true;
+}
+#endif
+
 static cc_result Nbt_ReadTag(cc_uint8 typeId, cc_bool readTagName, struct Stream* stream, 
 							struct NbtTag* parent, Nbt_Callback callback, int listIndex) {
 	struct NbtTag tag;
@@ -457,6 +803,10 @@ static cc_result Nbt_ReadTag(cc_uint8 typeId, cc_bool readTagName, struct Stream
 
 	case NBT_I8S:
 		if ((res = Stream_ReadU32_BE(stream, &tag.dataSize))) break;
+#ifdef CC_BUILD_COMPACTWORLD
+		/* Callback is never given the tag, as its data isn't kept around */
+		if (Nbt_ReadBlocks(&tag, stream, &res)) return res;
+#endif
 
 		if (NbtTag_IsSmall(&tag)) {
 			res = Stream_Read(stream, tag.value.small, tag.dataSize);
@@ -519,18 +869,23 @@ static BlockRaw* Nbt_TakeArray(struct NbtTag* tag, const char* type) {
 	return ptr;
 }
 
+/* Reads the root tag of uncompressed NBT data */
+static cc_result Nbt_ReadRoot(struct Stream* stream, Nbt_Callback callback) {
+	cc_result res;
+	cc_uint8 tag;
+
+	if ((res = stream->ReadU8(stream, &tag))) return res;
+	if (tag != NBT_DICT) return CW_ERR_ROOT_TAG;
+	return Nbt_ReadTag(NBT_DICT, true, stream, NULL, callback, 0);
+}
+
 static cc_result Nbt_Read(struct Stream* stream, Nbt_Callback callback) {
 	struct Stream compStream;
 	struct InflateState state;
 	cc_result res;
-	cc_uint8 tag;
-
-	Inflate_MakeStream2(&compStream, &state, stream);
-	if ((res = Map_SkipGZipHeader(stream))) return res;
-	if ((res = compStream.ReadU8(&compStream, &tag))) return res;
 
-	if (tag != NBT_DICT) return CW_ERR_ROOT_TAG;
-	return Nbt_ReadTag(NBT_DICT, true, &compStream, NULL, callback, 0);
+	if ((res = Map_BeginInflate(&compStream, &state, stream))) return res;
+	return Nbt_ReadRoot(&compStream, callback);
 }
 
 
@@ -877,8 +1232,29 @@ static void Cw_Callback(struct NbtTag* tag) {
 
 /* Imports a world from a .cw ClassicWorld map file */
 /* Used by ClassiCube/ClassicalSharp */
+#ifdef CC_BUILD_COMPACTWORLD
+static int Cw_BlocksCallback(struct NbtTag* tag) {
+	/* ClassicWorld -> BlockArray/BlockArray2 */
+	if (!tag->parent || tag->parent->parent) return -1;
+
+	if (IsTag(tag, "BlockArray"))  return 0;
+#ifdef EXTENDED_BLOCKS
+	if (IsTag(tag, "BlockArray2")) return 8;
+#endif
+	return -1;
+}
+#endif
+
 static cc_result Cw_Load(struct Stream* stream) {
+#ifdef CC_BUILD_COMPACTWORLD
+	cc_result res;
+	nbt_blocksCallback = Cw_BlocksCallback;
+	res = Nbt_Read(stream, Cw_Callback);
+	nbt_blocksCallback = NULL;
+	return res;
+#else
 	return Nbt_Read(stream, Cw_Callback);
+#endif
 }
 
 
@@ -1351,8 +1727,7 @@ static cc_result Dat_Load(struct Stream* stream) {
 
 	struct Stream compStream;
 	struct InflateState state;
-	Inflate_MakeStream2(&compStream, &state, stream);
-	if ((res = Map_SkipGZipHeader(stream)))                       return res;
+	if ((res = Map_BeginInflate(&compStream, &state, stream)))    return res;
 	if ((res = Stream_Read(&compStream, header, sizeof(header)))) return res;
 
 	signature = Mem_ReadU32_BE(header + 0);
@@ -1477,8 +1852,24 @@ static void MCLevel_Callback(struct NbtTag* tag) {
 
 /* Imports a world from a .mclevel NBT map file */
 /* Used by Minecraft Indev client */
+#ifdef CC_BUILD_COMPACTWORLD
+static int MCLevel_BlocksCallback(struct NbtTag* tag) {
+	/* MinecraftLevel -> Map -> Blocks */
+	if (!tag->parent || !tag->parent->parent || tag->parent->parent->parent) return -1;
+
+	return IsTag(tag->parent, "Map") && IsTag(tag, "blocks") ? 0 : -1;
+}
+#endif
+
 static cc_result MCLevel_Load(struct Stream* stream) {
-	cc_result res = Nbt_Read(stream, MCLevel_Callback);
+	cc_result res;
+#ifdef CC_BUILD_COMPACTWORLD
+	nbt_blocksCallback = MCLevel_BlocksCallback;
+	res = Nbt_Read(stream, MCLevel_Callback);
+	nbt_blocksCallback = NULL;
+#else
+	res = Nbt_Read(stream, MCLevel_Callback);
+#endif
 
 	Env.EdgeHeight  = mcl_edgeHeight;
 	Env.SidesOffset = mcl_sidesHeight - mcl_edgeHeight;
@@ -1489,6 +1880,33 @@ static cc_result MCLevel_Load(struct Stream* stream) {
 /*########################################################################################################################*
 *--------------------------------------------------ClassicWorld export----------------------------------------------------*
 *#########################################################################################################################*/
+/* Writes either the lower 8 bits (shift of 0) or upper 8 bits (shift of 8) of every block in the world */
+static cc_result Map_WriteBlocks(struct Stream* stream, int shift) {
+#ifdef CC_BUILD_COMPACTWORLD
+	cc_uint8 buffer[8192];
+	cc_result res;
+	int x, y, z, count = 0;
+
+	/* World has no flat blocks array to write, so blocks are instead written out a row at a time */
+	for (y = 0; y < World.Height; y++) {
+		for (z = 0; z < World.Length; z++) {
+			for (x = 0; x < World.Width; x++) {
+				buffer[count++] = (cc_uint8)(World_GetBlock(x, y, z) >> shift);
+				if (count < (int)sizeof(buffer)) continue;
+
+				if ((res = Stream_Write(stream, buffer, count))) return res;
+				count = 0;
+			}
+		}
+	}
+	return count ? Stream_Write(stream, buffer, count) : 0;
+#elif defined EXTENDED_BLOCKS
+	return Stream_Write(stream, shift ? World.Blocks2 : World.Blocks, World.Volume);
+#else
+	return Stream_Write(stream, World.Blocks, World.Volume);
+#endif
+}
+
 static cc_uint8* Cw_WriteColor(cc_uint8* data, const char* name, PackedCol color) {
 	data = Nbt_WriteDict(data, name);
 	{
@@ -1574,7 +1992,30 @@ static cc_result Cw_WriteBockDef(struct Stream* stream, int b) {
 	return Stream_Write(stream, buffer, (int)(cur - buffer));
 }
 
-cc_result Cw_Save(struct Stream* stream) {
+static cc_result Cw_WriteBlockArrays(struct Stream* stream) {
+	cc_uint8 buffer[64];
+	cc_uint8* cur;
+	cc_result res;
+
+	cur = buffer;
+	cur = Nbt_WriteArray(cur, "BlockArray", World.Volume);
+	if ((res = Stream_Write(stream, buffer, (int)(cur - buffer)))) return res;
+	if ((res = Map_WriteBlocks(stream, 0)))                       return res;
+
+#ifdef EXTENDED_BLOCKS
+	if (World.IDMask > 0xFF) {
+		cur = buffer;
+		cur = Nbt_WriteArray(cur, "BlockArray2", World.Volume);
+
+		if ((res = Stream_Write(stream, buffer, (int)(cur - buffer)))) return res;
+		if ((res = Map_WriteBlocks(stream, 8)))                       return res;
+	}
+#endif
+	return 0;
+}
+
+/* Writes the world in ClassicWorld NBT format, optionally leaving out the blocks */
+static cc_result Cw_Write(struct Stream* stream, cc_bool withBlocks) {
 	struct LocalPlayer* p = Entities.CurPlayer;
 	cc_uint8 buffer[2048];
 	cc_uint8* cur;
@@ -1604,20 +2045,9 @@ cc_result Cw_Save(struct Stream* stream) {
 		cur  = Nbt_WriteUInt8(cur,  "H", Math_Deg2Packed(p->SpawnYaw));
 		cur  = Nbt_WriteUInt8(cur,  "P", Math_Deg2Packed(p->SpawnPitch));
 	} *cur++ = NBT_END;
-	cur = Nbt_WriteArray(cur, "BlockArray", World.Volume);
 
 	if ((res = Stream_Write(stream, buffer, (int)(cur - buffer)))) return res;
-	if ((res = Stream_Write(stream, World.Blocks, World.Volume)))  return res;
-
-#ifdef EXTENDED_BLOCKS
-	if (World.Blocks != World.Blocks2) {
-		cur = buffer;
-		cur = Nbt_WriteArray(cur, "BlockArray2", World.Volume);
-
-		if ((res = Stream_Write(stream, buffer, (int)(cur - buffer)))) return res;
-		if ((res = Stream_Write(stream, World.Blocks2, World.Volume))) return res;
-	}
-#endif
+	if (withBlocks && (res = Cw_WriteBlockArrays(stream)))        return res;
 
 	cur = buffer;
 	cur = Nbt_WriteDict(cur, "Metadata");
@@ -1681,6 +2111,351 @@ cc_result Cw_Save(struct Stream* stream) {
 	return Stream_Write(stream, cw_end, sizeof(cw_end));
 }
 
+cc_result Cw_Save(struct Stream* stream) { return Cw_Write(stream, true); }
+
+
+/*########################################################################################################################*
+*-------------------------------------------------------World cache-------------------------------------------------------*
+*#########################################################################################################################*/
+/* Loading a .cw map is dominated by decompressing the blocks, so optionally an uncompressed copy of each
+   loaded .cw map is kept in the mapcache folder, named after the map's UUID. The cached copy is laid out as:
+     Header   - MAPCACHE_HEADER_SIZE bytes (see MapCache_Write)
+     Metadata - ClassicWorld NBT for everything except the blocks, uncompressed
+     Blocks   - Raw blocks (then raw upper 8 bits of blocks if needed), starting at a page aligned offset
+   The cached copy is only used while size and GZIP trailer (CRC32 of uncompressed data) of the .cw still match
+   mapcache/index.txt lists the size of each cached copy, from least to most recently used, so that the
+   least recently used copies can be evicted whenever the total size exceeds the map-cache-size option */
+#define MAPCACHE_MAGIC 0x43574343UL /* "CCWC" */
+#define MAPCACHE_VERSION 1
+#define MAPCACHE_HEADER_SIZE 64
+#define MAPCACHE_ALIGNMENT 4096
+#define MAPCACHE_PEEK_SIZE 1024
+#define MAPCACHE_INDEX_TXT "mapcache/index.txt"
+
+#if !defined CC_BUILD_COOPTHREADED && !defined CC_BUILD_LOWMEM && !defined CC_BUILD_PSP && !defined CC_BUILD_NDS
+	/* Cached copy is written to disc on a background thread, to avoid stalling the main thread */
+	#define MAPCACHE_THREADED
+#endif
+
+static struct StringsBuffer mapcache_index;
+static cc_bool mapcache_indexLoaded;
+
+static const cc_uint8 mapcache_uuidTag[] = { NBT_I8S, 0,4, 'U','U','I','D', 0,0,0,WORLD_UUID_LEN };
+
+static cc_result MapCache_GetKey(struct Stream* file, struct MapImporter* imp, struct MapCacheKey* key) {
+	cc_uint8 data[MAPCACHE_PEEK_SIZE];
+	struct Stream compStream;
+	struct InflateState state;
+	cc_uint32 i, read;
+
+	key->valid  = false;
+	key->loaded = false;
+	if (!imp || imp->import != Cw_Load) return 0;
+	if (!Options_GetBool(OPT_MAP_CACHE, false)) return 0;
+
+	if (file->Length(file, &key->srcLength) || key->srcLength < 32) return 0;
+	if (file->Seek(file, key->srcLength - 8)) return 0;
+	if (Stream_Read(file, key->srcTrailer, 8)) return file->Seek(file, 0);
+
+	/* UUID is near the start of the root tag, so only need to decompress a little bit */
+	if ((file->Seek(file, 0)) || Map_SkipGZipHeader(file)) return file->Seek(file, 0);
+	Inflate_MakeStream2(&compStream, &state, file);
+	if (compStream.Read(&compStream, data, sizeof(data), &read)) return file->Seek(file, 0);
+
+	for (i = 0; i + sizeof(mapcache_uuidTag) + WORLD_UUID_LEN <= read; i++) 
+	{
+		if (!Mem_Equal(&data[i], mapcache_uuidTag, sizeof(mapcache_uuidTag))) continue;
+
+		Mem_Copy(key->uuid, &data[i + sizeof(mapcache_uuidTag)], WORLD_UUID_LEN);
+		key->valid = true;
+		break;
+	}
+	return file->Seek(file, 0);
+}
+
+static void MapCache_GetName(struct MapCacheKey* key, cc_string* name) {
+	int i;
+	for (i = 0; i < WORLD_UUID_LEN; i++) { String_AppendHex(name, key->uuid[i]); }
+}
+
+static void MapCache_GetPath(struct MapCacheKey* key, cc_string* path) {
+	String_AppendConst(path, "mapcache/");
+	MapCache_GetName(key, path);
+	String_AppendConst(path, ".bin");
+}
+
+/* Maximum total size of all cached copies, in kilobytes */
+static int MapCache_MaxSize(void) {
+	return Options_GetInt(OPT_MAP_CACHE_SIZE, 0, 1024 * 1024, 512) * 1024;
+}
+
+static cc_bool MapCache_IsValid(struct MapCacheKey* key, cc_uint8* header) {
+	return Mem_ReadU32_LE(&header[0]) == MAPCACHE_MAGIC && Mem_ReadU32_LE(&header[4]) == MAPCACHE_VERSION
+		&& Mem_ReadU32_LE(&header[8]) == key->srcLength && Mem_Equal(&header[12], key->srcTrailer, 8)
+		&& Mem_Equal(&header[20], key->uuid, WORLD_UUID_LEN);
+}
+
+static cc_result MapCache_Read(struct Stream* stream, cc_uint8* header) {
+	struct Stream metaStream;
+	cc_uint8* meta;
+	cc_uint32 metaLen;
+	cc_result res;
+
+	metaLen = Mem_ReadU32_LE(&header[44]);
+	meta    = (cc_uint8*)Mem_TryAlloc(metaLen, 1);
+	if (!meta) return ERR_OUT_OF_MEMORY;
+
+	if (!(res = Stream_Read(stream, meta, metaLen))) {
+		Stream_ReadonlyMemory(&metaStream, meta, metaLen);
+		res = Nbt_ReadRoot(&metaStream, Cw_Callback);
+	}
+	Mem_Free(meta);
+	if (res) return res;
+
+	World.Width  = Mem_ReadU16_LE(&header[36]);
+	World.Height = Mem_ReadU16_LE(&header[38]);
+	World.Length = Mem_ReadU16_LE(&header[40]);
+	if ((res = stream->Seek(stream, Mem_ReadU32_LE(&header[48])))) return res;
+	if ((res = Map_ReadBlocks(stream))) return res;
+
+#if defined CC_BUILD_COMPACTWORLD && defined EXTENDED_BLOCKS
+	if (header[42]) return World_ReadSections(stream, 8);
+#elif defined EXTENDED_BLOCKS
+	if (header[42]) {
+		BlockRaw* blocks2 = (BlockRaw*)Mem_TryAlloc(World.Volume, 1);
+		if (!blocks2) return ERR_OUT_OF_MEMORY;
+		World_SetMapUpper(blocks2);
+		return Stream_Read(stream, blocks2, World.Volume);
+	}
+#endif
+	return 0;
+}
+
+static int MapCache_EntrySize(int i) {
+	cc_string entry, key, value;
+	int size;
+
+	StringsBuffer_UNSAFE_GetRaw(&mapcache_index, i, &entry);
+	String_UNSAFE_Separate(&entry, ' ', &key, &value);
+	return Convert_ParseInt(&value, &size) ? size : 0;
+}
+
+/* Empties the least recently used cached copy */
+/* NOTE: There is no API to delete files on every platform, so the file is truncated instead */
+static void MapCache_Evict(void) {
+	cc_string entry, key, value;
+	cc_string path; char pathBuffer[FILENAME_SIZE];
+	cc_filepath raw_path;
+	struct Stream stream;
+
+	StringsBuffer_UNSAFE_GetRaw(&mapcache_index, 0, &entry);
+	String_UNSAFE_Separate(&entry, ' ', &key, &value);
+
+	String_InitArray(path, pathBuffer);
+	String_Format1(&path, "mapcache/%s.bin", &key);
+	Platform_EncodePath(&raw_path, &path);
+
+	if (!Stream_CreatePath(&stream, &raw_path)) (void)stream.Close(&stream);
+	StringsBuffer_Remove(&mapcache_index, 0);
+}
+
+/* Marks the cached copy as the most recently used, evicting other copies if the cache is too large */
+/* NOTE: size is in kilobytes, or -1 to keep the size already in the index */
+static void MapCache_Touch(struct MapCacheKey* key, int size) {
+	cc_string name; char nameBuffer[WORLD_UUID_LEN * 2];
+	cc_string value; char valueBuffer[STRING_INT_CHARS];
+	int i, total, limit;
+
+	if (!mapcache_indexLoaded) {
+		EntryList_UNSAFE_Load(&mapcache_index, MAPCACHE_INDEX_TXT);
+		mapcache_indexLoaded = true;
+	}
+	String_InitArray(name, nameBuffer);
+	MapCache_GetName(key, &name);
+
+	if (size < 0) {
+		value = EntryList_UNSAFE_Get(&mapcache_index, &name, ' ');
+		if (!Convert_ParseInt(&value, &size)) size = 0;
+	}
+	String_InitArray(value, valueBuffer);
+	String_AppendInt(&value, size);
+	EntryList_Set(&mapcache_index, &name, &value, ' ');
+
+	limit = MapCache_MaxSize();
+	for (i = 0, total = 0; i < mapcache_index.count; i++) { total += MapCache_EntrySize(i); }
+
+	/* Least recently used copies are at the start of the index */
+	while (total > limit && mapcache_index.count > 1) {
+		total -= MapCache_EntrySize(0);
+		MapCache_Evict();
+	}
+	EntryList_Save(&mapcache_index, MAPCACHE_INDEX_TXT);
+}
+
+/* Copy of the world's blocks, written to the cache file on a background thread */
+static struct MapCacheWrite {
+	void* thread;
+	struct Stream stream;
+	cc_uint8* blocks;
+	cc_uint32 blocksLen;
+	cc_result result;
+	cc_uint8 header[MAPCACHE_HEADER_SIZE];
+	cc_filepath path;
+} mapcache_write;
+
+static void MapCache_CopyBlocks(cc_uint8* dst, int shift) {
+#ifdef CC_BUILD_COMPACTWORLD
+	int x, y, z;
+	for (y = 0; y < World.Height; y++) {
+		for (z = 0; z < World.Length; z++) {
+			for (x = 0; x < World.Width; x++) {
+				*dst++ = (cc_uint8)(World_GetBlock(x, y, z) >> shift);
+			}
+		}
+	}
+#elif defined EXTENDED_BLOCKS
+	Mem_Copy(dst, shift ? World.Blocks2 : World.Blocks, World.Volume);
+#else
+	Mem_Copy(dst, World.Blocks, World.Volume);
+#endif
+}
+
+/* Writes everything except the blocks, then fills out the header to write once the blocks have been written */
+static cc_result MapCache_WriteMeta(struct Stream* stream, struct MapCacheKey* key, cc_uint8* header) {
+	static const cc_uint8 padding[MAPCACHE_ALIGNMENT];
+	cc_uint32 metaEnd, blocksOffset;
+	cc_result res;
+
+	/* Header is written last, so an incomplete cache file is never treated as valid */
+	if ((res = Stream_Write(stream, header, MAPCACHE_HEADER_SIZE))) return res;
+	if ((res = Cw_Write(stream, false)))                           return res;
+	if ((res = stream->Position(stream, &metaEnd)))                return res;
+
+	blocksOffset = (metaEnd + MAPCACHE_ALIGNMENT - 1) & ~(MAPCACHE_ALIGNMENT - 1);
+	if ((res = Stream_Write(stream, padding, blocksOffset - metaEnd))) return res;
+
+	Mem_WriteU32_LE(&header[0],  MAPCACHE_MAGIC);
+	Mem_WriteU32_LE(&header[4],  MAPCACHE_VERSION);
+	Mem_WriteU32_LE(&header[8],  key->srcLength);
+	Mem_Copy(&header[12], key->srcTrailer, 8);
+	Mem_Copy(&header[20], key->uuid, WORLD_UUID_LEN);
+	Mem_WriteU16_LE(&header[36], World.Width);
+	Mem_WriteU16_LE(&header[38], World.Height);
+	Mem_WriteU16_LE(&header[40], World.Length);
+	Mem_WriteU32_LE(&header[44], metaEnd - MAPCACHE_HEADER_SIZE);
+	Mem_WriteU32_LE(&header[48], blocksOffset);
+	return 0;
+}
+
+static void MapCache_WriteBlocks(void) {
+	struct MapCacheWrite* w = &mapcache_write;
+	struct Stream* stream   = &w->stream;
+	cc_result res;
+
+	if (!(res = Stream_Write(stream, w->blocks, w->blocksLen)) && !(res = stream->Seek(stream, 0))) {
+		res = Stream_Write(stream, w->header, MAPCACHE_HEADER_SIZE);
+	}
+	w->result = res;
+	if ((res = stream->Close(stream)) && !w->result) w->result = res;
+}
+
+/* Waits for the cache file currently being written to be finished */
+static void MapCache_FinishWrite(void) {
+	struct MapCacheWrite* w = &mapcache_write;
+	if (!w->blocks) return;
+
+#ifdef MAPCACHE_THREADED
+	Thread_Join(w->thread);
+#endif
+	if (w->result) Logger_IOWarn2(w->result, "encoding", &w->path);
+	Mem_Free(w->blocks);
+	w->blocks = NULL;
+}
+
+/* Attempts to load the world from the cached uncompressed copy of the source map */
+static cc_bool MapCache_Load(struct MapCacheKey* key) {
+	cc_uint8 header[MAPCACHE_HEADER_SIZE];
+	cc_string path; char pathBuffer[FILENAME_SIZE];
+	cc_filepath raw_path;
+	struct Stream stream;
+	cc_result res;
+
+	MapCache_FinishWrite();
+	if (!key->valid) return false;
+	String_InitArray(path, pathBuffer);
+	MapCache_GetPath(key, &path);
+	Platform_EncodePath(&raw_path, &path);
+
+	/* No point logging error for missing cache file */
+	if (Stream_OpenPath(&stream, &raw_path)) return false;
+	res = Stream_Read(&stream, header, sizeof(header));
+
+	if (!res && MapCache_IsValid(key, header)) {
+		res = MapCache_Read(&stream, header);
+		key->loaded = !res;
+		if (res) { Logger_IOWarn2(res, "decoding", &raw_path); World_Reset(); }
+	}
+	if (key->loaded) MapCache_Touch(key, -1);
+
+	(void)stream.Close(&stream);
+	return key->loaded;
+}
+
+/* Saves an uncompressed copy of the just loaded world, if it wasn't loaded from the cache */
+/* NOTE: The blocks are copied and then written to disc on a background thread where possible */
+static void MapCache_Save(struct MapCacheKey* key) {
+	struct MapCacheWrite* w = &mapcache_write;
+	cc_string path; char pathBuffer[FILENAME_SIZE];
+	cc_uint32 layers;
+	cc_result res;
+
+	MapCache_FinishWrite();
+	if (!key->valid || key->loaded) return;
+
+	layers = 1;
+#ifdef EXTENDED_BLOCKS
+	if (World.IDMask > 0xFF) layers = 2;
+#endif
+	/* Not worth evicting every other cached copy just to cache this one map */
+	if ((cc_uint64)World.Volume * layers > (cc_uint64)MapCache_MaxSize() * 1024) return;
+	if (!Utils_EnsureDirectory("mapcache")) return;
+
+	w->blocksLen = World.Volume * layers;
+	w->blocks    = (cc_uint8*)Mem_TryAlloc(w->blocksLen, 1);
+	if (!w->blocks) return;
+
+	MapCache_CopyBlocks(w->blocks, 0);
+#ifdef EXTENDED_BLOCKS
+	if (layers > 1) MapCache_CopyBlocks(w->blocks + World.Volume, 8);
+#endif
+
+	String_InitArray(path, pathBuffer);
+	MapCache_GetPath(key, &path);
+	Platform_EncodePath(&w->path, &path);
+
+	res = Stream_CreatePath(&w->stream, &w->path);
+	if (res) {
+		Logger_IOWarn2(res, "creating", &w->path);
+		Mem_Free(w->blocks); w->blocks = NULL; return;
+	}
+
+	Mem_Set(w->header, 0, MAPCACHE_HEADER_SIZE);
+	if ((res = MapCache_WriteMeta(&w->stream, key, w->header))) {
+		Logger_IOWarn2(res, "encoding", &w->path);
+		(void)w->stream.Close(&w->stream);
+		Mem_Free(w->blocks); w->blocks = NULL; return;
+	}
+	w->header[42] = layers > 1;
+	MapCache_Touch(key, (Mem_ReadU32_LE(&w->header[48]) + w->blocksLen + 1023) / 1024);
+
+#ifdef MAPCACHE_THREADED
+	Thread_Run(&w->thread, MapCache_WriteBlocks, 64 * 1024, "Map cache writer");
+#else
+	MapCache_WriteBlocks();
+	MapCache_FinishWrite();
+#endif
+}
+
 
 /*########################################################################################################################*
 *---------------------------------------------------Schematic export------------------------------------------------------*
@@ -1715,7 +2490,7 @@ cc_result Schematic_Save(struct Stream* stream) {
 		Mem_WriteU32_BE(&tmp[74], World.Volume);
 	}
 	if ((res = Stream_Write(stream, tmp, sizeof(sc_begin)))) return res;
-	if ((res = Stream_Write(stream, World.Blocks, World.Volume))) return res;
+	if ((res = Map_WriteBlocks(stream, 0)))                  return res;
 
 	Mem_Copy(tmp, sc_data, sizeof(sc_data));
 	{
@@ -41,6 +41,8 @@
 #include "SystemFonts.h"
 #include "Formats.h"
 #include "EntityRenderers.h"
+#include "Profiler.h"
+#include "Benchmark.h"
 
 struct _GameData Game;
 static cc_uint64 frameStart;
@@ -229,6 +231,38 @@ void Game_UpdateBlock(int x, int y, int z, BlockID block) {
 	MapRenderer_OnBlockChanged(x, y, z, block);
 }
 
+void Game_UpdateBlocks(const int* indices, const BlockID* blocks, int count) {
+	struct BlockChange changes[LIGHTING_MAX_BLOCK_CHANGES];
+	struct BlockChange* c;
+	int i, index, x, y, z, numChanges = 0;
+	BlockID old;
+
+	for (i = 0; i < count; i++) {
+		index = indices[i];
+		if (index < 0 || index >= World.Volume) continue;
+		World_Unpack(index, x, y, z);
+
+		if (!Lighting.OnBlocksChanged) { Game_UpdateBlock(x, y, z, blocks[i]); continue; }
+		old = World_GetBlock(x, y, z);
+		if (old == blocks[i]) continue;
+		World_SetBlock(x, y, z, blocks[i]);
+
+		if (Weather_Heightmap) {
+			EnvRenderer_OnBlockChanged(x, y, z, old, blocks[i]);
+		}
+		MapRenderer_OnBlockChanged(x, y, z, blocks[i]);
+
+		c = &changes[numChanges++];
+		c->x = x; c->y = y; c->z = z;
+		c->oldBlock = old; c->newBlock = blocks[i];
+
+		if (numChanges < LIGHTING_MAX_BLOCK_CHANGES) continue;
+		Lighting.OnBlocksChanged(changes, numChanges);
+		numChanges = 0;
+	}
+	if (numChanges) Lighting.OnBlocksChanged(changes, numChanges);
+}
+
 void Game_ChangeBlock(int x, int y, int z, BlockID block) {
 	BlockID old = World_GetBlock(x, y, z);
 	Game_UpdateBlock(x, y, z, block);
@@ -425,6 +459,8 @@ static void Game_Load(void) {
 	Game_AddComponent(&Animations_Component);
 	Game_AddComponent(&Inventory_Component);
 	Game_AddComponent(&Builder_Component);
+	/* Must be after Builder, so chunk builder threads have stopped before profiler is freed */
+	Game_AddComponent(&Profiler_Component);
 	Game_AddComponent(&MapRenderer_Component);
 	Game_AddComponent(&EnvRenderer_Component);
 	Game_AddComponent(&Server_Component);
@@ -489,6 +525,7 @@ void Game_SetMinFrameTime(float frameTimeMS) {
 
 static void Render3DFrame(float delta, float t) {
 	struct Matrix mvp;
+	cc_uint64 beg;
 	Vec3 pos;
 
 	Camera.Active->GetView(&Gfx.View);
@@ -500,15 +537,24 @@ static void Render3DFrame(float delta, float t) {
 
 	if (EnvRenderer_ShouldRenderSkybox()) EnvRenderer_RenderSkybox();
 	AxisLinesRenderer_Render();
+	beg = Profiler_Begin();
 	Entities_RenderModels(delta, t);
+	Profiler_End(PROFILER_ENTITIES, beg);
 	EntityNames_Render();
 
+	beg = Profiler_Begin();
 	Particles_Render(t);
+	Profiler_End(PROFILER_PARTICLES, beg);
 	EnvRenderer_RenderSky();
 	EnvRenderer_RenderClouds();
 
+	beg = Profiler_Begin();
 	MapRenderer_Update(delta);
+	Profiler_End(PROFILER_MAP_UPDATE, beg);
+
+	beg = Profiler_Begin();
 	MapRenderer_RenderNormal(delta);
+	Profiler_End(PROFILER_MAP_NORMAL, beg);
 	EnvRenderer_RenderMapSides();
 
 	EntityShadows_Render();
@@ -519,11 +565,15 @@ static void Render3DFrame(float delta, float t) {
 	/* Render water over translucent blocks when under the water outside the map for proper alpha blending */
 	pos = Camera.CurrentPos;
 	if (pos.y < Env.EdgeHeight && (pos.x < 0 || pos.z < 0 || pos.x > World.Width || pos.z > World.Length)) {
+		beg = Profiler_Begin();
 		MapRenderer_RenderTranslucent(delta);
+		Profiler_End(PROFILER_MAP_TRANSLUCENT, beg);
 		EnvRenderer_RenderMapEdges();
 	} else {
 		EnvRenderer_RenderMapEdges();
+		beg = Profiler_Begin();
 		MapRenderer_RenderTranslucent(delta);
+		Profiler_End(PROFILER_MAP_TRANSLUCENT, beg);
 	}
 
 	/* Need to render again over top of translucent block, as the selection outline */
@@ -553,13 +603,16 @@ static void Render3D_Anaglyph(float delta, float t) {
 static void PerformScheduledTasks(float time) {
 	struct ScheduledTask2* task = tasks_head;
 	struct ScheduledTask2* next;
+	cc_uint64 beg;
 
 	while (task) {
 		task->accumulator += time;
 		next = task->next; /* cache in case callback removes task */
 
 		while (task->accumulator >= task->interval) {
+			beg = Profiler_Begin();
 			task->callback(task);
+			if (task == &Game_Tasks.network) { Profiler_End(PROFILER_NETWORK, beg); }
 			task->accumulator -= task->interval;
 		}
 		task = next;
@@ -656,6 +709,7 @@ static void LimitFPS(void) {
 #endif
 
 static CC_INLINE void Game_DrawFrame(float delta, float t) {
+	cc_uint64 beg;
 	int i;
 
 	if (!Gui_GetBlocksWorld()) {
@@ -673,11 +727,13 @@ static CC_INLINE void Game_DrawFrame(float delta, float t) {
 	}
 
 	Gfx_Begin2D(Game.Width, Game.Height);
+	beg = Profiler_Begin();
 	Gui_RenderGui(delta);
 	for (i = 0; i < Array_Elems(Game.Draw2DHooks); i++)
 	{
 		if (Game.Draw2DHooks[i]) Game.Draw2DHooks[i](delta);
 	}
+	Profiler_End(PROFILER_GUI, beg);
 
 /* TODO find a better solution than this */
 #ifdef CC_BUILD_3DS
@@ -719,11 +775,15 @@ int Game_MapState(int deviceIndex) {
 void Game_RenderFrame(void) {
 	double deltaD;
 	float t, delta;
+	cc_uint64 beg, tasksBeg;
 
 	cc_uint64 render  = Stopwatch_Measure();
 	cc_uint64 elapsed = Stopwatch_ElapsedMicroseconds(frameStart, render);
 	/* avoid large delta with suspended process */
 	if (elapsed > 5000000) elapsed = 5000000;
+#ifdef CC_BUILD_BENCHMARK
+	elapsed = BENCHMARK_FRAME_TIME;
+#endif
 	
 	deltaD = (int)elapsed / (1000.0 * 1000.0);
 	delta  = (float)deltaD;
@@ -747,6 +807,7 @@ void Game_RenderFrame(void) {
 		}
 	}
 
+	beg = Profiler_Begin();
 	Gfx_BeginFrame();
 	Gfx_BindIb(Gfx.DefaultIb);
 	Game.Time += deltaD;
@@ -774,7 +835,9 @@ void Game_RenderFrame(void) {
 		InputHandler_SetFOV(Camera.ZoomFov);
 	}
 
+	tasksBeg = Profiler_Begin();
 	PerformScheduledTasks(delta);
+	Profiler_End(PROFILER_TASKS, tasksBeg);
 	t = (float)(Game_Tasks.entities.accumulator / Game_Tasks.entities.interval);
 	LocalPlayer_SetInterpPosition(Entities.CurPlayer, t);
 
@@ -785,7 +848,7 @@ void Game_RenderFrame(void) {
 
 #if !defined CC_BUILD_SYMBIAN
 	/* TODO: Not calling Gfx_EndFrame doesn't work with Direct3D9 */
-	if (Window_Main.Inactive) return;
+	if (Window_Main.Inactive) { Profiler_End(PROFILER_FRAME, beg); return; }
 #endif
 	Gfx_ClearBuffers(GFX_BUFFER_COLOR | GFX_BUFFER_DEPTH);
 	
@@ -815,6 +878,7 @@ void Game_RenderFrame(void) {
 
 	if (Game_ScreenshotRequested) Game_TakeScreenshot();
 	Gfx_EndFrame();
+	Profiler_End(PROFILER_FRAME, beg);
 	if (gfx_minFrameMs != 0.0f) LimitFPS();
 }
 
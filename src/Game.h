@@ -106,6 +106,10 @@ void Plugins_LoadAll(void);
 /* (updating state means recalculating light, redrawing chunk block is in, etc) */
 /* NOTE: This does NOT notify the server, use Game_ChangeBlock for that. */
 CC_API void Game_UpdateBlock(int x, int y, int z, BlockID block);
+/* Sets multiple blocks in the map at once, then updates state associated with those blocks. */
+/* This is faster than calling Game_UpdateBlock for each block (e.g. lighting is only updated once per column) */
+/* NOTE: Indices outside the map are ignored. This does NOT notify the server. */
+void Game_UpdateBlocks(const int* indices, const BlockID* blocks, int count);
 /* Calls Game_UpdateBlock, then informs server connection of the block change. */
 /* In multiplayer this is sent to the server, in singleplayer just activates physics. */
 CC_API void Game_ChangeBlock(int x, int y, int z, BlockID block);
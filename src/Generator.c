@@ -8,6 +8,7 @@
 #include "Game.h"
 #include "Screens.h"
 #include "Window.h"
+#include "Options.h"
 
 static const struct MapGenerator* gen_active;
 BlockRaw* Gen_Blocks;
@@ -16,6 +17,37 @@ volatile float Gen_CurrentProgress;
 volatile const char* Gen_CurrentState;
 volatile static cc_bool gen_done;
 
+const char* Gen_StepNames[GEN_MAX_STEPS];
+int Gen_StepTimes[GEN_MAX_STEPS];
+int Gen_StepsCount;
+static cc_uint64 stepBeg;
+
+/* Records how long the current step took */
+static void Gen_EndStep(void) {
+	const char* state = (const char*)Gen_CurrentState;
+	if (!state[0] || Gen_StepsCount >= GEN_MAX_STEPS) return;
+
+	Gen_StepNames[Gen_StepsCount] = state;
+	Gen_StepTimes[Gen_StepsCount] = Stopwatch_ElapsedMS(stepBeg, Stopwatch_Measure());
+	Gen_StepsCount++;
+}
+
+static void Gen_SetState(const char* state) {
+	Gen_EndStep();
+	Gen_CurrentState = state;
+	stepBeg = Stopwatch_Measure();
+}
+
+static void Gen_Complete(void) {
+	int i;
+	Gen_EndStep();
+
+	for (i = 0; i < Gen_StepsCount; i++) {
+		Platform_Log2("Map gen: %c took %i ms", Gen_StepNames[i], &Gen_StepTimes[i]);
+	}
+	gen_done = true;
+}
+
 /* There are two main types of multitasking: */
 /*  - Pre-emptive multitasking (system automatically switches between threads) */
 /*  - Cooperative multitasking (threads must be manually switched by the app) */
@@ -77,9 +109,96 @@ static void Gen_Run(void) {
 cc_bool Gen_IsDone(void) { return gen_done; }
 #endif
 
+
+/*########################################################################################################################*
+*--------------------------------------------------Parallel generation----------------------------------------------------*
+*#########################################################################################################################*/
+/* Steps that process the map column by column are split into bands of rows along the Z axis. */
+/* Each band only ever writes to the columns within it, so the generated map is identical */
+/*  regardless of how many threads (if any) the bands are processed by. */
+#define GEN_BAND_ROWS 16
+#define Gen_BandsCount() ((World.Length + (GEN_BAND_ROWS - 1)) / GEN_BAND_ROWS)
+typedef void (*Gen_RowsFunc)(int zBeg, int zEnd);
+
+#if !defined CC_BUILD_COOPTHREADED && !defined CC_BUILD_LOWMEM && !defined CC_BUILD_PSP && !defined CC_BUILD_NDS
+#define GEN_MAX_WORKERS 8
+#ifdef CC_BUILD_CONSOLE
+	#define GEN_DEFAULT_WORKERS 0
+#else
+	#define GEN_DEFAULT_WORKERS 3
+#endif
+
+static void* gen_workers[GEN_MAX_WORKERS];
+static int gen_workersCount;
+static void* gen_bandsMutex;
+static Gen_RowsFunc gen_rowsFunc;
+static int gen_nextRow, gen_rowsDone;
+static cc_bool gen_trackRows;
+
+static void Gen_ProcessBands(void) {
+	int zBeg, zEnd;
+
+	for (;;) {
+		Mutex_Lock(gen_bandsMutex);
+		{
+			zBeg = gen_nextRow;
+			zEnd = min(zBeg + GEN_BAND_ROWS, World.Length);
+			gen_nextRow = zEnd;
+		}
+		Mutex_Unlock(gen_bandsMutex);
+		if (zBeg >= zEnd) return;
+
+		gen_rowsFunc(zBeg, zEnd);
+
+		Mutex_Lock(gen_bandsMutex);
+		{
+			gen_rowsDone += zEnd - zBeg;
+			if (gen_trackRows) Gen_CurrentProgress = (float)gen_rowsDone / World.Length;
+		}
+		Mutex_Unlock(gen_bandsMutex);
+	}
+}
+
+/* Calls the given function for every band of rows in the map, using worker threads if possible */
+static void Gen_ForEachBand(Gen_RowsFunc func, cc_bool trackProgress) {
+	int i;
+	gen_rowsFunc  = func;
+	gen_trackRows = trackProgress;
+	gen_nextRow   = 0;
+	gen_rowsDone  = 0;
+	gen_bandsMutex = Mutex_Create("Map gen bands");
+
+	for (i = 0; i < gen_workersCount; i++) {
+		Thread_Run(&gen_workers[i], Gen_ProcessBands, 64 * 1024, "Map gen worker");
+	}
+	/* Map gen thread also processes bands, instead of just idly waiting */
+	Gen_ProcessBands();
+
+	for (i = 0; i < gen_workersCount; i++) {
+		Thread_Join(gen_workers[i]);
+	}
+	Mutex_Free(gen_bandsMutex);
+}
+#else
+#define GEN_MAX_WORKERS     0
+#define GEN_DEFAULT_WORKERS 0
+static int gen_workersCount;
+
+static void Gen_ForEachBand(Gen_RowsFunc func, cc_bool trackProgress) {
+	int z, zEnd;
+
+	for (z = 0; z < World.Length; z += GEN_BAND_ROWS) {
+		zEnd = min(z + GEN_BAND_ROWS, World.Length);
+		func(z, zEnd);
+		if (trackProgress) Gen_CurrentProgress = (float)zEnd / World.Length;
+	}
+}
+#endif
+
 static void Gen_Reset(void) {
 	Gen_CurrentProgress = 0.0f;
 	Gen_CurrentState    = "";
+	Gen_StepsCount      = 0;
 	gen_done = false;
 }
 
@@ -91,6 +210,7 @@ void Gen_Start(const struct MapGenerator* gen, int seed,
 
 	gen_active = gen;
 	Gen_Reset();
+	gen_workersCount = Options_GetInt(OPT_GEN_THREADS, 0, GEN_MAX_WORKERS, GEN_DEFAULT_WORKERS);
 	Gen_Blocks = (BlockRaw*)Mem_TryAlloc(World.Volume, 1);
 
 	if (!Gen_Blocks || !gen->Prepare(seed)) {
@@ -127,16 +247,16 @@ static cc_bool FlatgrassGen_Prepare(int seed) {
 }
 
 static void FlatgrassGen_Generate(void) {
-	Gen_CurrentState = "Setting air blocks";
+	Gen_SetState("Setting air blocks");
 	FlatgrassGen_MapSet(World.Height / 2, World.MaxY, BLOCK_AIR);
 
-	Gen_CurrentState = "Setting dirt blocks";
+	Gen_SetState("Setting dirt blocks");
 	FlatgrassGen_MapSet(0, World.Height / 2 - 2, BLOCK_DIRT);
 
-	Gen_CurrentState = "Setting grass blocks";
+	Gen_SetState("Setting grass blocks");
 	FlatgrassGen_MapSet(World.Height / 2 - 1, World.Height / 2 - 1, BLOCK_GRASS);
 
-	gen_done = true;
+	Gen_Complete();
 }
 
 const struct MapGenerator FlatgrassGen = {
@@ -203,6 +323,65 @@ static float ImprovedNoise_Calc(const cc_uint8* p, float x, float y) {
 	return c1 + v * (c2 - c1);
 }
 
+/* Number of samples calculated at once by the batched noise functions */
+#define NOISE_BATCH_SIZE 8
+/* Same values as X_FLAGS/Y_FLAGS, but directly as floats so Grad can be vectorised */
+static const float gradX[16] = { 1,-1, 1,-1, 1,-1, 1,-1, 0, 0, 0, 0, 1, 0,-1, 0 };
+static const float gradY[16] = { 1, 1,-1,-1, 0, 0, 0, 0, 1,-1, 1,-1, 1,-1, 1,-1 };
+
+/* Calculates noise for several samples that all have the same Y coordinate */
+/* Results are exactly the same as calling ImprovedNoise_Calc for each sample, however */
+/*  the arithmetic is performed in simple per sample loops that compilers can vectorise, */
+/*  and the values derived from Y only need to be calculated once */
+static void ImprovedNoise_CalcBatch(const cc_uint8* p, const float* xs, float y, float* out) {
+	int xFloor[NOISE_BATCH_SIZE];
+	float fx[NOISE_BATCH_SIZE], u[NOISE_BATCH_SIZE];
+	float gx[4][NOISE_BATCH_SIZE], gy[4][NOISE_BATCH_SIZE];
+	int yFloor, X, Y, A, B, hash;
+	float x, v;
+	float g22, g12, c1;
+	float g21, g11, c2;
+	int i;
+
+	yFloor = y >= 0 ? (int)y : (int)y - 1;
+	Y = yFloor & 0xFF;
+	y -= yFloor;
+	v = y * y * y * (y * (y * 6 - 15) + 10); /* Fade(y) */
+
+	for (i = 0; i < NOISE_BATCH_SIZE; i++) {
+		x = xs[i];
+		xFloor[i] = x >= 0 ? (int)x : (int)x - 1;
+		x -= xFloor[i];
+
+		fx[i] = x;
+		u[i]  = x * x * x * (x * (x * 6 - 15) + 10); /* Fade(x) */
+	}
+
+	/* Permutation table lookups can't really be vectorised */
+	for (i = 0; i < NOISE_BATCH_SIZE; i++) {
+		X = xFloor[i] & 0xFF;
+		A = p[X] + Y; B = p[X + 1] + Y;
+
+		hash = p[p[A]]     & 0xF; gx[0][i] = gradX[hash]; gy[0][i] = gradY[hash];
+		hash = p[p[B]]     & 0xF; gx[1][i] = gradX[hash]; gy[1][i] = gradY[hash];
+		hash = p[p[A + 1]] & 0xF; gx[2][i] = gradX[hash]; gy[2][i] = gradY[hash];
+		hash = p[p[B + 1]] & 0xF; gx[3][i] = gradX[hash]; gy[3][i] = gradY[hash];
+	}
+
+	for (i = 0; i < NOISE_BATCH_SIZE; i++) {
+		x = fx[i];
+		g22 = gx[0][i] * x       + gy[0][i] * y;       /* Grad(p[p[A],     x,     y) */
+		g12 = gx[1][i] * (x - 1) + gy[1][i] * y;       /* Grad(p[p[B],     x - 1, y) */
+		c1  = g22 + u[i] * (g12 - g22);
+
+		g21 = gx[2][i] * x       + gy[2][i] * (y - 1); /* Grad(p[p[A + 1], x,     y - 1) */
+		g11 = gx[3][i] * (x - 1) + gy[3][i] * (y - 1); /* Grad(p[p[B + 1], x - 1, y - 1) */
+		c2  = g21 + u[i] * (g11 - g21);
+
+		out[i] = c1 + v * (c2 - c1);
+	}
+}
+
 
 struct OctaveNoise { cc_uint8 p[8][NOISE_TABLE_SIZE]; int octaves; };
 static void OctaveNoise_Init(struct OctaveNoise* n, RNGState* rnd, int octaves) {
@@ -227,6 +406,23 @@ static float OctaveNoise_Calc(const struct OctaveNoise* n, float x, float y) {
 	return sum;
 }
 
+static void OctaveNoise_CalcBatch(const struct OctaveNoise* n, const float* xs, float y, float* out) {
+	float amplitude = 1, freq = 1;
+	float scaled[NOISE_BATCH_SIZE], noise[NOISE_BATCH_SIZE];
+	int i, j;
+
+	for (j = 0; j < NOISE_BATCH_SIZE; j++) { out[j] = 0; }
+
+	for (i = 0; i < n->octaves; i++) {
+		for (j = 0; j < NOISE_BATCH_SIZE; j++) { scaled[j] = xs[j] * freq; }
+		ImprovedNoise_CalcBatch(n->p[i], scaled, y * freq, noise);
+
+		for (j = 0; j < NOISE_BATCH_SIZE; j++) { out[j] += noise[j] * amplitude; }
+		amplitude *= 2.0f;
+		freq *= 0.5f;
+	}
+}
+
 
 struct CombinedNoise { struct OctaveNoise noise1, noise2; };
 static void CombinedNoise_Init(struct CombinedNoise* n, RNGState* rnd, int octaves1, int octaves2) {
@@ -234,9 +430,13 @@ static void CombinedNoise_Init(struct CombinedNoise* n, RNGState* rnd, int octav
 	OctaveNoise_Init(&n->noise2, rnd, octaves2);
 }
 
-static float CombinedNoise_Calc(const struct CombinedNoise* n, float x, float y) {
-	float offset = OctaveNoise_Calc(&n->noise2, x, y);
-	return OctaveNoise_Calc(&n->noise1, x + offset, y);
+static void CombinedNoise_CalcBatch(const struct CombinedNoise* n, const float* xs, float y, float* out) {
+	float offset[NOISE_BATCH_SIZE];
+	int i;
+	OctaveNoise_CalcBatch(&n->noise2, xs, y, offset);
+
+	for (i = 0; i < NOISE_BATCH_SIZE; i++) { offset[i] += xs[i]; }
+	OctaveNoise_CalcBatch(&n->noise1, offset, y, out);
 }
 
 
@@ -314,10 +514,53 @@ static void NotchyGen_FloodFill(int index, BlockRaw block) {
 }
 
 
-static void NotchyGen_CreateHeightmap(void) {
+static const struct CombinedNoise* heightNoise1;
+static const struct CombinedNoise* heightNoise2;
+static const struct OctaveNoise*   heightNoise3;
+
+static void NotchyGen_HeightmapRows(int zBeg, int zEnd) {
+	float xs[NOISE_BATCH_SIZE], xsScaled[NOISE_BATCH_SIZE];
+	float lows[NOISE_BATCH_SIZE], highs[NOISE_BATCH_SIZE], sel[NOISE_BATCH_SIZE];
 	float hLow, hHigh, height;
-	int hIndex = 0, adjHeight;
-	int x, z;
+	int hIndex = zBeg * World.Width;
+	int x, z, i, count;
+	cc_bool anyHigh;
+
+	for (z = zBeg; z < zEnd; z++) {
+		/* Noise for columns past the end of the row is calculated too, but then just ignored */
+		for (x = 0; x < World.Width; x += NOISE_BATCH_SIZE) {
+			for (i = 0; i < NOISE_BATCH_SIZE; i++) {
+				xs[i]       = (float)(x + i);
+				xsScaled[i] = (x + i) * 1.3f;
+			}
+
+			CombinedNoise_CalcBatch(heightNoise1, xsScaled, z * 1.3f, lows);
+			OctaveNoise_CalcBatch(heightNoise3,   xs, (float)z,       sel);
+
+			anyHigh = false;
+			for (i = 0; i < NOISE_BATCH_SIZE; i++) { anyHigh |= sel[i] <= 0; }
+			if (anyHigh) CombinedNoise_CalcBatch(heightNoise2, xsScaled, z * 1.3f, highs);
+
+			count = min(NOISE_BATCH_SIZE, World.Width - x);
+			for (i = 0; i < count; i++) {
+				hLow   = lows[i] / 6 - 4;
+				height = hLow;
+
+				if (sel[i] <= 0) {
+					hHigh  = highs[i] / 5 + 6;
+					height = max(hLow, hHigh);
+				}
+
+				height *= 0.5f;
+				if (height < 0) height *= 0.8f;
+				heightmap[hIndex++] = (int)(height + waterLevel);
+			}
+		}
+	}
+}
+
+static void NotchyGen_CreateHeightmap(void) {
+	int i, count;
 
 #if CC_BUILD_MAXSTACK <= (16 * 1024)
 	struct NoiseBuffer { 
@@ -340,26 +583,15 @@ static void NotchyGen_CreateHeightmap(void) {
 	CombinedNoise_Init(n2, &rnd, 8, 8);	
 	OctaveNoise_Init(n3,   &rnd, 6);
 
-	Gen_CurrentState = "Building heightmap";
-	for (z = 0; z < World.Length; z++) {
-		Gen_CurrentProgress = (float)z / World.Length;
+	heightNoise1 = n1; heightNoise2 = n2; heightNoise3 = n3;
 
-		for (x = 0; x < World.Width; x++) {
-			hLow   = CombinedNoise_Calc(n1, x * 1.3f, z * 1.3f) / 6 - 4;
-			height = hLow;
+	Gen_SetState("Building heightmap");
+	Gen_ForEachBand(NotchyGen_HeightmapRows, true);
 
-			if (OctaveNoise_Calc(n3, (float)x, (float)z) <= 0) {
-				hHigh = CombinedNoise_Calc(n2, x * 1.3f, z * 1.3f) / 5 + 6;
-				height = max(hLow, hHigh);
-			}
-
-			height *= 0.5f;
-			if (height < 0) height *= 0.8f;
-
-			adjHeight = (int)(height + waterLevel);
-			minHeight = min(adjHeight, minHeight);
-			heightmap[hIndex++] = adjHeight;
-		}
+	/* Calculated afterwards, so bands don't have to share a minimum */
+	count = World.Width * World.Length;
+	for (i = 0; i < count; i++) {
+		minHeight = min(heightmap[i], minHeight);
 	}
 }
 
@@ -369,7 +601,7 @@ static int NotchyGen_CreateStrataFast(void) {
 	int y;
 
 	Gen_CurrentProgress = 0.0f;
-	Gen_CurrentState    = "Filling map";
+	Gen_SetState("Filling map");
 	/* Make lava layer at bottom */
 	Mem_Set(Gen_Blocks, BLOCK_STILL_LAVA, oneY);
 
@@ -392,23 +624,18 @@ static int NotchyGen_CreateStrataFast(void) {
 	return max(stoneHeight, 1);
 }
 
-static void NotchyGen_CreateStrata(void) {
+static const struct OctaveNoise* strataNoise;
+static int strataMinY;
+
+static void NotchyGen_StrataRows(int zBeg, int zEnd) {
 	int dirtThickness, dirtHeight;
-	int minStoneY, stoneHeight;
-	int hIndex = 0, maxY = World.MaxY, index = 0;
+	int minStoneY = strataMinY, stoneHeight;
+	int hIndex = zBeg * World.Width, maxY = World.MaxY, index = 0;
 	int x, y, z;
-	struct OctaveNoise n;
-
-	/* Try to bulk fill bottom of the map if possible */
-	minStoneY = NotchyGen_CreateStrataFast();
-	OctaveNoise_Init(&n, &rnd, 8);
-
-	Gen_CurrentState = "Creating strata";
-	for (z = 0; z < World.Length; z++) {
-		Gen_CurrentProgress = (float)z / World.Length;
 
+	for (z = zBeg; z < zEnd; z++) {
 		for (x = 0; x < World.Width; x++) {
-			dirtThickness = (int)(OctaveNoise_Calc(&n, (float)x, (float)z) / 24 - 4);
+			dirtThickness = (int)(OctaveNoise_Calc(strataNoise, (float)x, (float)z) / 24 - 4);
 			dirtHeight    = heightmap[hIndex++];
 			stoneHeight   = dirtHeight + dirtThickness;
 
@@ -429,6 +656,18 @@ static void NotchyGen_CreateStrata(void) {
 	}
 }
 
+static void NotchyGen_CreateStrata(void) {
+	struct OctaveNoise n;
+
+	/* Try to bulk fill bottom of the map if possible */
+	strataMinY = NotchyGen_CreateStrataFast();
+	OctaveNoise_Init(&n, &rnd, 8);
+	strataNoise = &n;
+
+	Gen_SetState("Creating strata");
+	Gen_ForEachBand(NotchyGen_StrataRows, true);
+}
+
 static void NotchyGen_CarveCaves(void) {
 	int cavesCount, caveLen;
 	float caveX, caveY, caveZ;
@@ -438,7 +677,7 @@ static void NotchyGen_CarveCaves(void) {
 	int i, j;
 
 	cavesCount       = World.Volume / 8192;
-	Gen_CurrentState = "Carving caves";
+	Gen_SetState("Carving caves");
 	for (i = 0; i < cavesCount; i++) {
 		Gen_CurrentProgress = (float)i / cavesCount;
 
@@ -482,7 +721,7 @@ static void NotchyGen_CarveOreVeins(float abundance, const char* state, BlockRaw
 	int i, j;
 
 	numVeins         = (int)(World.Volume * abundance / 16384);
-	Gen_CurrentState = state;
+	Gen_SetState(state);
 	for (i = 0; i < numVeins; i++) {
 		Gen_CurrentProgress = (float)i / numVeins;
 
@@ -514,7 +753,7 @@ static void NotchyGen_FloodFillWaterBorders(void) {
 	int waterY = waterLevel - 1;
 	int index1, index2;
 	int x, z;
-	Gen_CurrentState = "Flooding edge water";
+	Gen_SetState("Flooding edge water");
 
 	index1 = World_Pack(0, waterY, 0);
 	index2 = World_Pack(0, waterY, World.Length - 1);
@@ -542,7 +781,7 @@ static void NotchyGen_FloodFillWater(void) {
 	int i, x, y, z;
 
 	numSources       = World.Width * World.Length / 8000;
-	Gen_CurrentState = "Flooding water";
+	Gen_SetState("Flooding water");
 	for (i = 0; i < numSources; i++) {
 		Gen_CurrentProgress = (float)i / numSources;
 
@@ -558,7 +797,7 @@ static void NotchyGen_FloodFillLava(void) {
 	int i, x, y, z;
 
 	numSources       = World.Width * World.Height * World.Length / 20000;
-	Gen_CurrentState = "Flooding lava";
+	Gen_SetState("Flooding lava");
 	for (i = 0; i < numSources; i++) {
 		Gen_CurrentProgress = (float)i / numSources;
 
@@ -569,10 +808,33 @@ static void NotchyGen_FloodFillLava(void) {
 	}
 }
 
-static void NotchyGen_CreateSurfaceLayer(void) {	
-	int hIndex = 0, index;
+static const struct OctaveNoise* sandNoise;
+static const struct OctaveNoise* gravelNoise;
+
+static void NotchyGen_SurfaceRows(int zBeg, int zEnd) {
+	int hIndex = zBeg * World.Width, index;
 	BlockRaw above;
 	int x, y, z;
+
+	for (z = zBeg; z < zEnd; z++) {
+		for (x = 0; x < World.Width; x++) {
+			y = heightmap[hIndex++];
+			if (y < 0 || y >= World.Height) continue;
+
+			index = World_Pack(x, y, z);
+			above = y >= World.MaxY ? BLOCK_AIR : Gen_Blocks[index + World.OneY];
+
+			/* TODO: update heightmap */
+			if (above == BLOCK_STILL_WATER && (OctaveNoise_Calc(gravelNoise, (float)x, (float)z) > 12)) {
+				Gen_Blocks[index] = BLOCK_GRAVEL;
+			} else if (above == BLOCK_AIR) {
+				Gen_Blocks[index] = (y <= waterLevel && (OctaveNoise_Calc(sandNoise, (float)x, (float)z) > 8)) ? BLOCK_SAND : BLOCK_GRASS;
+			}
+		}
+	}
+}
+
+static void NotchyGen_CreateSurfaceLayer(void) {
 #if CC_BUILD_MAXSTACK <= (16 * 1024)
 	struct NoiseBuffer { 
 		struct OctaveNoise n1, n2;
@@ -588,26 +850,95 @@ static void NotchyGen_CreateSurfaceLayer(void) {
 
 	OctaveNoise_Init(n1, &rnd, 8);
 	OctaveNoise_Init(n2, &rnd, 8);
+	sandNoise = n1; gravelNoise = n2;
 
-	Gen_CurrentState = "Creating surface";
-	for (z = 0; z < World.Length; z++) {
-		Gen_CurrentProgress = (float)z / World.Length;
+	Gen_SetState("Creating surface");
+	Gen_ForEachBand(NotchyGen_SurfaceRows, true);
+}
 
-		for (x = 0; x < World.Width; x++) {
-			y = heightmap[hIndex++];
-			if (y < 0 || y >= World.Height) continue;
+/* Working out where plants may go consumes random numbers, so has to be done serially. */
+/* However, whether a plant is then actually placed only depends on the blocks in its column, */
+/*  so candidates are collected into a batch, grouped by band, and then placed per band. */
+/* (As candidates within a band are still placed in order, the result is the same as placing serially) */
+#define PLANT_BATCH_SIZE (64 * 1024)
+struct PlantCandidate { int index; BlockRaw block; };
+
+static struct PlantCandidate* plants;       /* Candidates in the order they were generated in */
+static struct PlantCandidate* plantsSorted; /* Candidates grouped by band */
+static int* plantBandStarts;
+static int plantsCount;
+static BlockRaw plantGround;
+
+static void NotchyGen_PlacePlant(int index, BlockRaw block) {
+	if (Gen_Blocks[index] == BLOCK_AIR && Gen_Blocks[index - World.OneY] == plantGround)
+		Gen_Blocks[index] = block;
+}
 
-			index = World_Pack(x, y, z);
-			above = y >= World.MaxY ? BLOCK_AIR : Gen_Blocks[index + World.OneY];
+static void NotchyGen_PlantRows(int zBeg, int zEnd) {
+	int band  = zBeg / GEN_BAND_ROWS;
+	int end   = band + 1 < Gen_BandsCount() ? plantBandStarts[band + 1] : plantsCount;
+	int i;
 
-			/* TODO: update heightmap */
-			if (above == BLOCK_STILL_WATER && (OctaveNoise_Calc(n2, (float)x, (float)z) > 12)) {
-				Gen_Blocks[index] = BLOCK_GRAVEL;
-			} else if (above == BLOCK_AIR) {
-				Gen_Blocks[index] = (y <= waterLevel && (OctaveNoise_Calc(n1, (float)x, (float)z) > 8)) ? BLOCK_SAND : BLOCK_GRASS;
-			}
-		}
+	for (i = plantBandStarts[band]; i < end; i++) {
+		NotchyGen_PlacePlant(plantsSorted[i].index, plantsSorted[i].block);
+	}
+}
+
+static void NotchyGen_FlushPlants(void) {
+	int bands = Gen_BandsCount();
+	int i, band, pos;
+	if (!plantsCount) return;
+
+	/* Stable counting sort by band (bands are filled in from their end) */
+	Mem_Set(plantBandStarts, 0, bands * sizeof(int));
+	for (i = 0; i < plantsCount; i++) {
+		band = (plants[i].index / World.Width) % World.Length / GEN_BAND_ROWS;
+		plantBandStarts[band]++;
+	}
+	for (i = 1; i < bands; i++) {
+		plantBandStarts[i] += plantBandStarts[i - 1];
+	}
+
+	for (i = plantsCount - 1; i >= 0; i--) {
+		band = (plants[i].index / World.Width) % World.Length / GEN_BAND_ROWS;
+		pos  = --plantBandStarts[band];
+		plantsSorted[pos] = plants[i];
 	}
+
+	Gen_ForEachBand(NotchyGen_PlantRows, false);
+	plantsCount = 0;
+}
+
+static void NotchyGen_BeginPlants(BlockRaw ground) {
+	plantGround = ground;
+	plantsCount = 0;
+	/* No point batching when plants are only placed by the map gen thread anyways */
+	if (!gen_workersCount) return;
+
+	plants          = (struct PlantCandidate*)Mem_TryAlloc(PLANT_BATCH_SIZE * 2, sizeof(struct PlantCandidate));
+	plantBandStarts = (int*)Mem_TryAlloc(Gen_BandsCount(), sizeof(int));
+	plantsSorted    = plants ? plants + PLANT_BATCH_SIZE : NULL;
+
+	if (!plantBandStarts) { Mem_Free(plants); plants = NULL; }
+}
+
+static void NotchyGen_AddPlant(int index, BlockRaw block) {
+	if (!plants) { NotchyGen_PlacePlant(index, block); return; }
+
+	plants[plantsCount].index = index;
+	plants[plantsCount].block = block;
+	if (++plantsCount == PLANT_BATCH_SIZE) NotchyGen_FlushPlants();
+}
+
+static void NotchyGen_EndPlants(void) {
+	if (!plants) return;
+	NotchyGen_FlushPlants();
+
+	Mem_Free(plants);
+	Mem_Free(plantBandStarts);
+	plants          = NULL;
+	plantsSorted    = NULL;
+	plantBandStarts = NULL;
 }
 
 static void NotchyGen_PlantFlowers(void) {
@@ -619,7 +950,8 @@ static void NotchyGen_PlantFlowers(void) {
 
 	if (Game_Version.Version < VERSION_0023) return;
 	numPatches       = World.Width * World.Length / 3000;
-	Gen_CurrentState = "Planting flowers";
+	Gen_SetState("Planting flowers");
+	NotchyGen_BeginPlants(BLOCK_GRASS);
 
 	for (i = 0; i < numPatches; i++) {
 		Gen_CurrentProgress = (float)i / numPatches;
@@ -639,11 +971,11 @@ static void NotchyGen_PlantFlowers(void) {
 				if (flowerY <= 0 || flowerY >= World.Height) continue;
 
 				index = World_Pack(flowerX, flowerY, flowerZ);
-				if (Gen_Blocks[index] == BLOCK_AIR && Gen_Blocks[index - World.OneY] == BLOCK_GRASS)
-					Gen_Blocks[index] = block;
+				NotchyGen_AddPlant(index, block);
 			}
 		}
 	}
+	NotchyGen_EndPlants();
 }
 
 static void NotchyGen_PlantMushrooms(void) {
@@ -655,7 +987,8 @@ static void NotchyGen_PlantMushrooms(void) {
 
 	if (Game_Version.Version < VERSION_0023) return;
 	numPatches       = World.Volume / 2000;
-	Gen_CurrentState = "Planting mushrooms";
+	Gen_SetState("Planting mushrooms");
+	NotchyGen_BeginPlants(BLOCK_STONE);
 
 	for (i = 0; i < numPatches; i++) {
 		Gen_CurrentProgress = (float)i / numPatches;
@@ -677,11 +1010,11 @@ static void NotchyGen_PlantMushrooms(void) {
 				if (mushY <= 0 || mushY >= (groundHeight - 1)) continue;
 
 				index = World_Pack(mushX, mushY, mushZ);
-				if (Gen_Blocks[index] == BLOCK_AIR && Gen_Blocks[index - World.OneY] == BLOCK_STONE)
-					Gen_Blocks[index] = block;
+				NotchyGen_AddPlant(index, block);
 			}
 		}
 	}
+	NotchyGen_EndPlants();
 }
 
 static void NotchyGen_PlantTrees(void) {
@@ -699,7 +1032,7 @@ static void NotchyGen_PlantTrees(void) {
 	Tree_Rnd    = &rnd;
 
 	numPatches       = World.Width * World.Length / 4000;
-	Gen_CurrentState = "Planting trees";
+	Gen_SetState("Planting trees");
 	for (i = 0; i < numPatches; i++) {
 		Gen_CurrentProgress = (float)i / numPatches;
 
@@ -763,7 +1096,7 @@ static void NotchyGen_Generate(void) {
 
 	Mem_Free(heightmap);
 	heightmap = NULL;
-	gen_done  = true;
+	Gen_Complete();
 }
 
 const struct MapGenerator NotchyGen = {
@@ -778,9 +1111,15 @@ const struct MapGenerator NotchyGen = {
 BlockRaw* Tree_Blocks;
 RNGState* Tree_Rnd;
 
+#ifdef CC_BUILD_COMPACTWORLD
+/* Tree_Blocks is NULL when growing trees in the world, as the world has no flat blocks array then */
+#define TreeGen_GetBlock(x, y, z) (Tree_Blocks ? Tree_Blocks[World_Pack(x, y, z)] : World_GetBlock(x, y, z))
+#else
+#define TreeGen_GetBlock(x, y, z) Tree_Blocks[World_Pack(x, y, z)]
+#endif
+
 cc_bool TreeGen_CanGrow(int treeX, int treeY, int treeZ, int treeHeight) {
 	int baseHeight = treeHeight - 4;
-	int index;
 	int x, y, z;
 
 	/* check tree base */
@@ -789,8 +1128,7 @@ cc_bool TreeGen_CanGrow(int treeX, int treeY, int treeZ, int treeHeight) {
 			for (x = treeX - 1; x <= treeX + 1; x++) {
 
 				if (!World_Contains(x, y, z)) return false;
-				index = World_Pack(x, y, z);
-				if (Tree_Blocks[index] != BLOCK_AIR) return false;
+				if (TreeGen_GetBlock(x, y, z) != BLOCK_AIR) return false;
 			}
 		}
 	}
@@ -801,8 +1139,7 @@ cc_bool TreeGen_CanGrow(int treeX, int treeY, int treeZ, int treeHeight) {
 			for (x = treeX - 2; x <= treeX + 2; x++) {
 
 				if (!World_Contains(x, y, z)) return false;
-				index = World_Pack(x, y, z);
-				if (Tree_Blocks[index] != BLOCK_AIR) return false;
+				if (TreeGen_GetBlock(x, y, z) != BLOCK_AIR) return false;
 			}
 		}
 	}
@@ -16,6 +16,14 @@ extern volatile float Gen_CurrentProgress;
 extern volatile const char* Gen_CurrentState;
 extern BlockRaw* Gen_Blocks;
 
+/* Maximum number of steps that timings are recorded for */
+#define GEN_MAX_STEPS 16
+/* Name (i.e. Gen_CurrentState) of and time taken in milliseconds by each step performed so far */
+/* NOTE: A step's time is only recorded once the next step starts or generation completes */
+extern const char* Gen_StepNames[GEN_MAX_STEPS];
+extern int Gen_StepTimes[GEN_MAX_STEPS];
+extern int Gen_StepsCount;
+
 struct MapGenerator {
 	cc_bool (*Prepare)(int seed);
 	void   (*Generate)(void);
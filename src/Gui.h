@@ -244,6 +244,7 @@ enum GuiPriority {
 	GUI_PRIORITY_TABLIST    = 17,
 	GUI_PRIORITY_CHAT       = 15,
 	GUI_PRIORITY_SPECIALTEXT= 13,
+	GUI_PRIORITY_PROFILER   = 11,
 	GUI_PRIORITY_HUD        = 10,
 	GUI_PRIORITY_LOADING    =  5
 };
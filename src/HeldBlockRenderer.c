@@ -91,6 +91,7 @@ static void ResetHeldState(void) {
 	held_entity.NonHumanSkin = p->NonHumanSkin;
 	held_entity.uScale       = p->uScale;
 	held_entity.vScale       = p->vScale;
+	Entity_CopySkinOffset(&held_entity, p);
 }
 
 static void SetBaseOffset(void) {
@@ -52,7 +52,9 @@ static int ClassicLighting_CalcHeightAt(int x, int maxY, int z, int hIndex) {
 	BlockID block;
 	int y, offset;
 
-#ifndef EXTENDED_BLOCKS
+#if defined CC_BUILD_COMPACTWORLD
+	ClassicLighting_CalcBody(World_GetBlock(x, y, z));
+#elif !defined EXTENDED_BLOCKS
 	ClassicLighting_CalcBody(World.Blocks[i]);
 #else
 	if (World.IDMask <= 0xFF) {
@@ -72,6 +74,19 @@ int ClassicLighting_GetLightHeight(int x, int z) {
 	return lightH == HEIGHT_UNCALCULATED ? ClassicLighting_CalcHeightAt(x, World.Height - 1, z, hIndex) : lightH;
 }
 
+int ClassicLighting_PeekLightHeight(int x, int z) {
+	int lightH = classic_heightmap[Lighting_Pack(x, z)];
+	BlockID block;
+	int y;
+	if (lightH != HEIGHT_UNCALCULATED) return lightH;
+
+	for (y = World.Height - 1; y >= 0; y--) {
+		block = World_GetBlock(x, y, z);
+		if (Blocks.BlocksLight[block]) return y - ((Blocks.LightOffset[block] >> LIGHT_FLAG_SHADES_FROM_BELOW) & 1);
+	}
+	return -10;
+}
+
 /* Outside color is same as sunlight color, so we reuse when possible */
 cc_bool ClassicLighting_IsLit(int x, int y, int z) {
 	return y > ClassicLighting_GetLightHeight(x, z);
@@ -119,6 +134,8 @@ static PackedCol ClassicLighting_Color_ZSide_Fast(int x, int y, int z) {
 
 void ClassicLighting_Refresh(void) {
 	int i;
+	/* Background mesh builders may still be reading the heightmap */
+	Builder_CancelAll();
 	for (i = 0; i < World.Width * World.Length; i++) {
 		classic_heightmap[i] = HEIGHT_UNCALCULATED;
 	}
@@ -179,7 +196,9 @@ static cc_bool ClassicLighting_NeedsNeighour(BlockID block, int i, int minY, int
 	BlockID other;
 	cc_bool affected;
 
-#ifndef EXTENDED_BLOCKS
+#if defined CC_BUILD_COMPACTWORLD
+	ClassicLighting_NeedsNeighourBody(World_GetRawBlock(i));
+#elif !defined EXTENDED_BLOCKS
 	ClassicLighting_NeedsNeighourBody(World.Blocks[i]);
 #else
 	if (World.IDMask <= 0xFF) {
@@ -223,17 +242,17 @@ static void ClassicLighting_ResetColumn(int cx, int cy, int cz, int minCy, int m
 	}
 }
 
-static void ClassicLighting_RefreshAffected(int x, int y, int z, BlockID block, int oldHeight, int newHeight) {
+/* NOTE: much faster to only update the chunks that are affected by the change in shadows, rather than the entire column. */
+#define ClassicLighting_AffectedRange(oldHeight, newHeight) \
+	newCy = (newHeight) < 0 ? 0 : (newHeight) >> 4;\
+	oldCy = (oldHeight) < 0 ? 0 : (oldHeight) >> 4;\
+	minCy = min(oldCy, newCy); maxCy = max(oldCy, newCy);
+
+static void ClassicLighting_RefreshNeighbours(int x, int y, int z, BlockID block, int minCy, int maxCy) {
 	int cx = x >> CHUNK_SHIFT, bX = x & CHUNK_MASK;
 	int cy = y >> CHUNK_SHIFT, bY = y & CHUNK_MASK;
 	int cz = z >> CHUNK_SHIFT, bZ = z & CHUNK_MASK;
 
-	/* NOTE: much faster to only update the chunks that are affected by the change in shadows, rather than the entire column. */
-	int newCy = newHeight < 0 ? 0 : newHeight >> 4;
-	int oldCy = oldHeight < 0 ? 0 : oldHeight >> 4;
-	int minCy = min(oldCy, newCy), maxCy = max(oldCy, newCy);
-	ClassicLighting_ResetColumn(cx, cy, cz, minCy, maxCy);
-
 	if (bX == 0 && cx > 0) {
 		ClassicLighting_ResetNeighbour(x - 1, y, z, block, cx - 1, cy, cz, minCy, maxCy);
 	}
@@ -255,6 +274,14 @@ static void ClassicLighting_RefreshAffected(int x, int y, int z, BlockID block,
 	}
 }
 
+static void ClassicLighting_RefreshAffected(int x, int y, int z, BlockID block, int oldHeight, int newHeight) {
+	int newCy, oldCy, minCy, maxCy;
+	ClassicLighting_AffectedRange(oldHeight, newHeight);
+
+	ClassicLighting_ResetColumn(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT, minCy, maxCy);
+	ClassicLighting_RefreshNeighbours(x, y, z, block, minCy, maxCy);
+}
+
 void ClassicLighting_OnBlockChanged(int x, int y, int z, BlockID oldBlock, BlockID newBlock) {
 	int hIndex = Lighting_Pack(x, z);
 	int lightH = classic_heightmap[hIndex];
@@ -269,6 +296,71 @@ void ClassicLighting_OnBlockChanged(int x, int y, int z, BlockID oldBlock, Block
 	ClassicLighting_RefreshAffected(x, y, z, newBlock, lightH + 1, newHeight);
 }
 
+/* Column whose light height may be affected by a batch of block changes */
+struct LightColumn { int hIndex, x, z, maxY, oldHeight; };
+
+void ClassicLighting_OnBlocksChanged(const struct BlockChange* changes, int count) {
+	struct LightColumn columns[LIGHTING_MAX_BLOCK_CHANGES];
+	cc_int16 changeColumn[LIGHTING_MAX_BLOCK_CHANGES];
+	const struct BlockChange* c;
+	struct LightColumn* col;
+	int newCy, oldCy, minCy, maxCy;
+	int i, j, hIndex, lightH, maxY, numColumns = 0;
+
+	for (i = 0; i < count; i++) {
+		c      = &changes[i];
+		hIndex = Lighting_Pack(c->x, c->z);
+		lightH = classic_heightmap[hIndex];
+
+		/* Column never had meshes for any of its chunks built, see ClassicLighting_OnBlockChanged */
+		changeColumn[i] = -1;
+		if (lightH == HEIGHT_UNCALCULATED) continue;
+
+		/* Changes are usually clustered together, so search most recently added columns first */
+		for (j = numColumns - 1; j >= 0; j--) {
+			if (columns[j].hIndex == hIndex) break;
+		}
+
+		if (j < 0) {
+			j   = numColumns++;
+			col = &columns[j];
+			col->hIndex = hIndex; col->oldHeight = lightH;
+			col->x = c->x; col->z = c->z; col->maxY = c->y;
+		} else {
+			columns[j].maxY = max(columns[j].maxY, c->y);
+		}
+		changeColumn[i] = j;
+	}
+
+	/* Recalculate light height once per column, rather than once per block */
+	for (j = 0; j < numColumns; j++) {
+		col = &columns[j];
+		/* Light height is determined by the highest light blocking block, which is either at */
+		/*  light height or one above it. So only changes at or above light height can affect it. */
+		if (col->maxY < col->oldHeight) continue;
+
+		maxY = max(col->maxY, col->oldHeight + 1);
+		maxY = min(maxY, World.MaxY);
+		ClassicLighting_CalcHeightAt(col->x, maxY, col->z, col->hIndex);
+	}
+
+	for (j = 0; j < numColumns; j++) {
+		col = &columns[j];
+		ClassicLighting_AffectedRange(col->oldHeight + 1, classic_heightmap[col->hIndex] + 1);
+		if (minCy != maxCy) ClassicLighting_ResetColumn(col->x >> CHUNK_SHIFT, 0, col->z >> CHUNK_SHIFT, minCy, maxCy);
+	}
+
+	for (i = 0; i < count; i++) {
+		if (changeColumn[i] < 0) continue;
+		c   = &changes[i];
+		col = &columns[changeColumn[i]];
+
+		ClassicLighting_AffectedRange(col->oldHeight + 1, classic_heightmap[col->hIndex] + 1);
+		if (minCy == maxCy) MapRenderer_RefreshChunk(c->x >> CHUNK_SHIFT, c->y >> CHUNK_SHIFT, c->z >> CHUNK_SHIFT);
+		ClassicLighting_RefreshNeighbours(c->x, c->y, c->z, c->newBlock, minCy, maxCy);
+	}
+}
+
 
 /*########################################################################################################################*
 *---------------------------------------------------Lighting heightmap----------------------------------------------------*
@@ -346,7 +438,9 @@ static cc_bool Heightmap_CalculateCoverage(int x1, int z1, int xCount, int zCoun
 	int mapIndex, hIndex, baseIndex, index;
 	int x, y, z;
 
-#ifndef EXTENDED_BLOCKS
+#if defined CC_BUILD_COMPACTWORLD
+	Heightmap_CalculateBody(World_GetBlock(x1 + x, y, z1 + z));
+#elif !defined EXTENDED_BLOCKS
 	Heightmap_CalculateBody(World.Blocks[mapIndex]);
 #else
 	if (World.IDMask <= 0xFF) {
@@ -387,6 +481,7 @@ void ClassicLighting_LightHint(int startX, int startY, int startZ) {
 }
 
 void ClassicLighting_FreeState(void) {
+	Builder_CancelAll();
 	Mem_Free(classic_heightmap);
 	classic_heightmap = NULL;
 }
@@ -420,6 +515,8 @@ static void ClassicLighting_SetActive(void) {
 	Lighting.FreeState  = ClassicLighting_FreeState;
 	Lighting.AllocState = ClassicLighting_AllocState;
 	Lighting.LightHint  = ClassicLighting_LightHint;
+	Lighting.OnBlocksChanged = ClassicLighting_OnBlocksChanged;
+	Lighting.IsChunkPending  = NULL;
 }
 
 
@@ -430,6 +527,7 @@ static void Lighting_ApplyActive(void) {
 	if (Lighting_Mode != LIGHTING_MODE_CLASSIC) {
 		FancyLighting_SetActive();
 	} else {
+		FancyLighting_SetInactive();
 		ClassicLighting_SetActive();
 	}
 }
@@ -466,9 +564,14 @@ static void OnInit(void) {
 static void OnReset(void)        { Lighting.FreeState(); }
 static void OnNewMapLoaded(void) { Lighting.AllocState(); }
 
+static void OnFree(void) {
+	Lighting.FreeState();
+	FancyLighting_OnFree();
+}
+
 struct IGameComponent Lighting_Component = {
 	OnInit,  /* Init  */
-	OnReset, /* Free  */
+	OnFree,  /* Free  */
 	OnReset, /* Reset */
 	OnReset, /* OnNewMap */
 	OnNewMapLoaded /* OnNewMapLoaded */
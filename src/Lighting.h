@@ -37,6 +37,10 @@ void Lighting_SetMode(cc_uint8 mode, cc_bool fromServer);
 /* A byte that fills the lamp level area with ones. Equivalent to 0b_1111_0000 */
 #define FANCY_LIGHTING_LAMP_MASK 0xF0
 
+/* Maximum number of block changes passed to Lighting.OnBlocksChanged at once */
+#define LIGHTING_MAX_BLOCK_CHANGES 256
+struct BlockChange { int x, y, z; BlockID oldBlock, newBlock; };
+
 CC_VAR extern struct _Lighting {
 	/* Releases/Frees the per-level lighting state */
 	void (*FreeState)(void);
@@ -72,20 +76,41 @@ CC_VAR extern struct _Lighting {
 	PackedCol (*Color_YMin_Fast)(int x, int y, int z);
 	PackedCol (*Color_XSide_Fast)(int x, int y, int z);
 	PackedCol (*Color_ZSide_Fast)(int x, int y, int z);
+
+	/* Called after multiple blocks were changed at once to update internal lighting state. */
+	/* NOTE: Unlike OnBlockChanged, the world already contains the new blocks of all the changes. */
+	/* NOTE: Implementations ***MUST*** mark all chunks affected by these lighting changes as needing to be refreshed. */
+	/* NOTE: If NULL, each block is instead changed and passed to OnBlockChanged one at a time. */
+	void (*OnBlocksChanged)(const struct BlockChange* changes, int count);
+	/* Returns whether the lighting of the given chunk (or the chunks around it) is still being calculated, */
+	/*  in which case the chunk's mesh should not be built yet, as it would only need rebuilding afterwards */
+	/* NOTE: If NULL, lighting is always calculated when building chunk meshes (see LightHint) */
+	cc_bool (*IsChunkPending)(int cx, int cy, int cz);
 } Lighting;
 
 void FancyLighting_SetActive(void);
+/* Stops the background lighting thread, as it is only used while fancy lighting is active */
+void FancyLighting_SetInactive(void);
 void FancyLighting_OnInit(void);
+void FancyLighting_OnFree(void);
+/* Discards all lighting changes waiting to be calculated on the background thread, */
+/*  and waits until the background thread is no longer reading any world state */
+/* NOTE: Must be called before freeing any state that the background thread reads from */
+void FancyLighting_CancelAll(void);
 
 /* Expose ClassicLighting functions for reuse in Fancy lighting */
 void ClassicLighting_Refresh(void);
 void ClassicLighting_FreeState(void);
 void ClassicLighting_AllocState(void);
 int ClassicLighting_GetLightHeight(int x, int z);
+/* Returns the light height of the given column, without storing it if it needed to be calculated */
+/* NOTE: Unlike ClassicLighting_GetLightHeight, this is safe to call from other threads */
+int ClassicLighting_PeekLightHeight(int x, int z);
 void ClassicLighting_LightHint(int startX, int startY, int startZ);
 cc_bool ClassicLighting_IsLit(int x, int y, int z);
 cc_bool ClassicLighting_IsLit_Fast(int x, int y, int z);
 void ClassicLighting_OnBlockChanged(int x, int y, int z, BlockID oldBlock, BlockID newBlock);
+void ClassicLighting_OnBlocksChanged(const struct BlockChange* changes, int count);
 
 CC_END_HEADER
 #endif
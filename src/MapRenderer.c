@@ -9,11 +9,13 @@
 #include "Funcs.h"
 #include "Game.h"
 #include "Graphics.h"
+#include "Lighting.h"
 #include "Platform.h"
 #include "TexturePack.h"
 #include "Utils.h"
 #include "World.h"
 #include "Options.h"
+#include "Profiler.h"
 
 int MapRenderer_1DUsedCount;
 struct ChunkPartInfo* MapRenderer_PartsNormal;
@@ -46,6 +48,14 @@ static cc_uint32* distances;
 static int maxChunkUpdates;
 /* Cached number of chunks in the world */
 static int chunksCount;
+/* Whether chunks hidden behind other chunks are skipped, and whether that needs recalculating */
+static cc_bool occlusionCulling, occlusionChanged;
+/* Face each chunk was entered through and directions travelled to reach it, in the visibility walk */
+static cc_uint8* visitFaces;
+static cc_uint8* visitDirs;
+/* Queue of chunks still to be walked through in the visibility walk */
+static int* visitQueue;
+static int visitHead, visitTail;
 
 static void ChunkInfo_Init(struct ChunkInfo* chunk, int x, int y, int z) {
 	chunk->centreX = x + HALF_CHUNK_SIZE; chunk->centreY = y + HALF_CHUNK_SIZE; 
@@ -60,6 +70,11 @@ static void ChunkInfo_Init(struct ChunkInfo* chunk, int x, int y, int z) {
 	chunk->noData   = true;
 	chunk->dirty    = true;
 	chunk->skipClip = false;
+	chunk->building = false;
+	chunk->occluded = false;
+	chunk->lod      = 0;
+	chunk->buildTime    = 0;
+	chunk->connectivity = CHUNK_ALL_CONNECTED;
 
 	chunk->drawXMin = false; chunk->drawXMax = false; chunk->drawZMin = false;
 	chunk->drawZMax = false; chunk->drawYMin = false; chunk->drawYMax = false;
@@ -68,6 +83,9 @@ static void ChunkInfo_Init(struct ChunkInfo* chunk, int x, int y, int z) {
 	chunk->translucentParts = NULL;
 }
 
+/* Whether all the blocks needed to build the chunk (including the layer above it) have been received */
+#define ChunkInfo_HasData(chunk) ((chunk)->centreY + HALF_CHUNK_SIZE < World.LoadedHeight || World.LoadedHeight == World.Height)
+
 static CC_INLINE void ChunkInfo_Refresh(struct ChunkInfo* chunk) {
 	if (chunk->allAir) return; /* do not recreate chunks completely air */
 
@@ -222,9 +240,6 @@ void MapRenderer_RenderNormal(float delta) {
 
 	CheckWeather(delta);
 	Gfx_SetAlphaTest(false);
-#if DEBUG_OCCLUSION
-	DebugPickedPos();
-#endif
 }
 
 #define DrawTranslucentFaces(minFace, maxFace) \
@@ -340,11 +355,6 @@ static void DeleteChunk(struct ChunkInfo* chunk) {
 	chunk->noData = true;
 	chunk->dirty  = true;
 
-#ifdef OCCLUSION
-	chunk.OcclusionFlags = 0;
-	chunk.OccludedFlags = 0;
-#endif
-
 	if (chunk->normalParts) {
 		ptr = chunk->normalParts;
 		for (i = 0; i < MapRenderer_1DUsedCount; i++, ptr += chunksCount) {
@@ -370,15 +380,11 @@ static void DeleteChunk(struct ChunkInfo* chunk) {
 	}
 }
 
-/* Builds the mesh (hence vertex buffer) for the given chunk, and updates internal state */
-static void BuildChunk(struct ChunkInfo* chunk, int* chunkUpdates) {
+/* Updates internal state after the mesh (hence vertex buffer) for the given chunk has been created */
+static void FinishChunk(struct ChunkInfo* chunk) {
 	struct ChunkPartInfo* ptr;
 	int i;
 
-	Game.ChunkUpdates++;
-	(*chunkUpdates)++;
-	if (!Builder_MakeChunk(chunk)) return;
-
 	chunk->dirty  = false;
 	chunk->noData = !chunk->normalParts && !chunk->translucentParts;
 	chunk->empty  = chunk->noData;
@@ -399,6 +405,18 @@ static void BuildChunk(struct ChunkInfo* chunk, int* chunkUpdates) {
 	}
 }
 
+/* Builds the mesh (hence vertex buffer) for the given chunk, and updates internal state */
+static void BuildChunk(struct ChunkInfo* chunk, int* chunkUpdates) {
+	int connectivity = chunk->connectivity;
+	cc_uint64 beg;
+	Game.ChunkUpdates++;
+	(*chunkUpdates)++;
+
+	beg = Profiler_Begin();
+	if (Builder_MakeChunk(chunk)) FinishChunk(chunk);
+	Profiler_End(PROFILER_CHUNK_BUILD, beg);
+	if (chunk->connectivity != connectivity) occlusionChanged = true;
+}
 
 /*########################################################################################################################*
 *----------------------------------------------------Chunks mangagement---------------------------------------------------*
@@ -414,11 +432,17 @@ static void FreeChunks(void) {
 	Mem_Free(sortedChunks);
 	Mem_Free(renderChunks);
 	Mem_Free(distances);
+	Mem_Free(visitFaces);
+	Mem_Free(visitDirs);
+	Mem_Free(visitQueue);
 
 	mapChunks    = NULL;
 	sortedChunks = NULL;
 	renderChunks = NULL;
 	distances    = NULL;
+	visitFaces   = NULL;
+	visitDirs    = NULL;
+	visitQueue   = NULL;
 }
 
 static void AllocateParts(void) {
@@ -435,6 +459,9 @@ static void AllocateChunks(void) {
 	sortedChunks = (struct ChunkInfo**)Mem_Alloc(chunksCount, sizeof(struct ChunkInfo*), "sorted chunk info");
 	renderChunks = (struct ChunkInfo**)Mem_Alloc(chunksCount, sizeof(struct ChunkInfo*), "render chunk info");
 	distances    = (cc_uint32*)Mem_Alloc(chunksCount, 4, "chunk distances");
+	visitFaces   = (cc_uint8*) Mem_Alloc(chunksCount, 1, "chunk visit faces");
+	visitDirs    = (cc_uint8*) Mem_Alloc(chunksCount, 1, "chunk visit dirs");
+	visitQueue   = (int*)      Mem_Alloc(chunksCount, 4, "chunk visit queue");
 }
 
 static void ResetPartFlags(void) {
@@ -483,11 +510,15 @@ static void RefreshChunks(void) {
 static void DeleteChunks(void) {
 	int i;
 	if (!mapChunks) return;
+	Builder_CancelAll();
 
 	for (i = 0; i < chunksCount; i++) 
 	{
 		DeleteChunk(&mapChunks[i]);
+		/* Blocks may have changed to/from opaque (e.g. block definitions changed) */
+		mapChunks[i].connectivity = CHUNK_ALL_CONNECTED;
 	}
+	occlusionChanged = true;
 	ResetPartCounts();
 }
 
@@ -495,7 +526,7 @@ void MapRenderer_Refresh(void) {
 	int oldCount;
 	chunkPos = IVec3_MaxValue();
 
-	if (mapChunks && World.Blocks) {
+	if (mapChunks && World_HasBlocks()) {
 		DeleteChunks();
 
 		oldCount = MapRenderer_1DUsedCount;
@@ -515,7 +546,7 @@ static void RefreshBorderChunks(int maxHeight) {
 	cc_bool onBorder;
 
 	chunkPos = IVec3_MaxValue();
-	if (!mapChunks || !World.Blocks) return;
+	if (!mapChunks || !World_HasBlocks()) return;
 
 	for (cz = 0; cz < World.ChunksZ; cz++) {
 		for (cy = 0; cy < World.ChunksY; cy++) {
@@ -535,6 +566,9 @@ static void RefreshBorderChunks(int maxHeight) {
 *--------------------------------------------------Chunks updating/sorting------------------------------------------------*
 *#########################################################################################################################*/
 #define CHUNK_TARGET_TIME ((1.0f/30) + 0.01f)
+/* Minimum time between rebuilds of a chunk that already has a mesh */
+/*  (e.g. so a chunk isn't rebuilt every single frame while the server is continually changing blocks in it) */
+#define CHUNK_REBUILD_INTERVAL 0.1
 static int chunksTarget = 12;
 static Vec3 lastCamPos;
 static float lastYaw, lastPitch;
@@ -544,6 +578,15 @@ static int renderDistSquared;
 /* Max distance from camera that chunks are built within */
 /* Chunks past this distance are automatically unloaded */
 static int buildDistSquared;
+/* Number of coarser levels of detail that far away chunks can be built at */
+#define MAX_CHUNK_LOD 2
+/* Distance from camera past which chunks are built at a coarser level of detail (0 if disabled) */
+/* Each further level of detail starts at twice the distance of the previous level */
+static int lodDistance;
+/* Max distance from camera that chunks are built within, for each level of detail */
+/* Chunks switching back to a finer level of detail must be slightly closer than this, */
+/*  so that chunks right on the boundary aren't constantly rebuilt as the camera moves back and forth */
+static int lodDistSquared[MAX_CHUNK_LOD], lodFinerDistSquared[MAX_CHUNK_LOD];
 
 static int AdjustDist(int dist) {
 	if (dist < CHUNK_SIZE) dist = CHUNK_SIZE;
@@ -552,8 +595,171 @@ static int AdjustDist(int dist) {
 }
 
 static void CalcViewDists(void) {
+	int i, dist;
 	buildDistSquared  = AdjustDist(Game_UserViewDistance);
 	renderDistSquared = AdjustDist(Game_ViewDistance);
+
+	for (i = 0; i < MAX_CHUNK_LOD; i++) {
+		dist = lodDistance << i;
+		lodDistSquared[i] = lodDistance ? dist * dist : Int32_MaxValue;
+
+		dist = max(0, dist - CHUNK_SIZE);
+		lodFinerDistSquared[i] = dist * dist;
+	}
+}
+
+/* Marks the given chunk as needing to be rebuilt, if it should now be built at a different level of detail */
+static void UpdateChunkLod(struct ChunkInfo* chunk, int distSqr) {
+	int lod = chunk->lod;
+	while (lod < MAX_CHUNK_LOD && distSqr > lodDistSquared[lod]) lod++;
+	while (lod > 0 && distSqr < lodFinerDistSquared[lod - 1])     lod--;
+	if (lod == chunk->lod) return;
+
+	/* Existing mesh is still drawn until the mesh at the new level of detail has been built */
+	chunk->lod   = lod;
+	chunk->dirty = true;
+}
+
+/* Offsets to the neighbouring chunk through each face of a chunk */
+static const cc_int8 faceOffsetX[FACE_COUNT] = { -1, 1,  0, 0,  0, 0 };
+static const cc_int8 faceOffsetY[FACE_COUNT] = {  0, 0,  0, 0, -1, 1 };
+static const cc_int8 faceOffsetZ[FACE_COUNT] = {  0, 0, -1, 1,  0, 0 };
+
+static cc_bool Occlusion_CanVisit(struct ChunkInfo* chunk) {
+	int dx, dy, dz;
+	if (!chunk->occluded) return false; /* already visited */
+
+	dx = chunk->centreX - chunkPos.x; dy = chunk->centreY - chunkPos.y; dz = chunk->centreZ - chunkPos.z;
+	return dx * dx + dy * dy + dz * dz <= buildDistSquared;
+}
+
+static void Occlusion_Visit(int index, int face, int dirs) {
+	mapChunks[index].occluded = false;
+	visitFaces[index] = face;
+	visitDirs[index]  = dirs;
+	visitQueue[visitTail++] = index;
+}
+
+/* Whether the visibility walk can leave through the given face of the given chunk */
+static cc_bool Occlusion_CanLeave(int index, int face) {
+	int entered = visitFaces[index];
+	int bit;
+	/* Never walk back towards the camera */
+	if (visitDirs[index] & (1 << (face ^ 1))) return false;
+	if (entered == FACE_COUNT) return true;
+
+	bit = entered < face ? ChunkInfo_FacesBit(entered, face) : ChunkInfo_FacesBit(face, entered);
+	return mapChunks[index].connectivity & bit;
+}
+
+/* Starts the visibility walk from the outermost chunks, when the camera is outside the map */
+static void Occlusion_VisitOutside(const IVec3* pos) {
+	struct ChunkInfo* chunk;
+	int i, cx, cy, cz;
+	cc_bool facing;
+
+	for (i = 0; i < chunksCount; i++) 
+	{
+		chunk = &mapChunks[i];
+		cx = chunk->centreX >> CHUNK_SHIFT; cy = chunk->centreY >> CHUNK_SHIFT; cz = chunk->centreZ >> CHUNK_SHIFT;
+
+		facing =
+			(pos->x < 0 && cx == 0) || (pos->x >= World.Width  && cx == World.ChunksX - 1) ||
+			(pos->y < 0 && cy == 0) || (pos->y >= World.Height && cy == World.ChunksY - 1) ||
+			(pos->z < 0 && cz == 0) || (pos->z >= World.Length && cz == World.ChunksZ - 1);
+		if (facing && Occlusion_CanVisit(chunk)) Occlusion_Visit(i, FACE_COUNT, 0);
+	}
+}
+
+/* Calculates which chunks can't possibly be seen by the camera, by walking outwards from */
+/*  the chunk the camera is in through the faces of chunks that are connected to each other */
+static void UpdateOcclusion(void) {
+	struct ChunkInfo* chunk;
+	int i, face, index, cx, cy, cz;
+	IVec3 pos;
+
+	occlusionChanged = false;
+	if (!occlusionCulling) return;
+
+	for (i = 0; i < chunksCount; i++) 
+	{
+		mapChunks[i].occluded = true;
+	}
+	visitHead = 0; visitTail = 0;
+
+	IVec3_Floor(&pos, &Camera.CurrentPos);
+	if (World_Contains(pos.x, pos.y, pos.z)) {
+		index = World_ChunkPack(pos.x >> CHUNK_SHIFT, pos.y >> CHUNK_SHIFT, pos.z >> CHUNK_SHIFT);
+		Occlusion_Visit(index, FACE_COUNT, 0);
+	} else {
+		Occlusion_VisitOutside(&pos);
+	}
+
+	while (visitHead < visitTail) 
+	{
+		index = visitQueue[visitHead++];
+		chunk = &mapChunks[index];
+		cx = chunk->centreX >> CHUNK_SHIFT; cy = chunk->centreY >> CHUNK_SHIFT; cz = chunk->centreZ >> CHUNK_SHIFT;
+
+		for (face = 0; face < FACE_COUNT; face++) 
+		{
+			if (!Occlusion_CanLeave(index, face)) continue;
+			pos.x = cx + faceOffsetX[face]; pos.y = cy + faceOffsetY[face]; pos.z = cz + faceOffsetZ[face];
+
+			if (pos.x < 0 || pos.y < 0 || pos.z < 0) continue;
+			if (pos.x >= World.ChunksX || pos.y >= World.ChunksY || pos.z >= World.ChunksZ) continue;
+
+			i = World_ChunkPack(pos.x, pos.y, pos.z);
+			if (!Occlusion_CanVisit(&mapChunks[i])) continue;
+			Occlusion_Visit(i, face ^ 1, visitDirs[index] | (1 << face));
+		}
+	}
+}
+
+/* Uploads the meshes of chunks that have been built on background threads */
+static void UploadBuiltChunks(int* chunkUpdates) {
+	struct ChunkInfo* chunk;
+	int connectivity;
+	cc_bool dirty;
+
+	while (*chunkUpdates < chunksTarget && (chunk = Builder_NextBuiltChunk())) {
+		/* Chunk may have been changed again while its mesh was being built */
+		dirty = chunk->dirty;
+		connectivity = chunk->connectivity;
+		DeleteChunk(chunk);
+
+		Game.ChunkUpdates++;
+		(*chunkUpdates)++;
+		if (Builder_UploadChunk(chunk)) FinishChunk(chunk);
+		/* Blocks changed while building might have connected more faces */
+		if (dirty) chunk->connectivity |= connectivity;
+
+		chunk->dirty |= dirty;
+		if (chunk->connectivity != connectivity) occlusionChanged = true;
+	}
+}
+
+/* Rebuilds the mesh of the given dirty chunk, either immediately or on a background thread */
+/* Returns whether the chunk's mesh was rebuilt immediately */
+static cc_bool RebuildChunk(struct ChunkInfo* chunk, int* chunkUpdates) {
+	/* Coalesce changes to the chunk until existing mesh is old enough */
+	/* NOTE: Uses Game.Time, as a float accumulator would stop advancing after running for long enough */
+	if (!chunk->noData && Game.Time - chunk->buildTime < CHUNK_REBUILD_INTERVAL) return false;
+	/* Mesh would only need to be rebuilt again once the chunk's light has been calculated */
+	if (Lighting.IsChunkPending && Lighting.IsChunkPending(chunk->centreX >> CHUNK_SHIFT,
+									chunk->centreY >> CHUNK_SHIFT, chunk->centreZ >> CHUNK_SHIFT)) return false;
+
+	/* Existing mesh is still drawn until background thread has built the new mesh */
+	if (Builder_Workers) {
+		if (!chunk->building && Builder_QueueChunk(chunk)) chunk->buildTime = Game.Time;
+		return false;
+	}
+	if (*chunkUpdates >= chunksTarget) return false;
+
+	chunk->buildTime = Game.Time;
+	DeleteChunk(chunk);
+	BuildChunk(chunk, chunkUpdates);
+	return true;
 }
 
 static int UpdateChunksAndVisibility(int* chunkUpdates) {
@@ -573,13 +779,14 @@ static int UpdateChunksAndVisibility(int* chunkUpdates) {
 		if (!chunk->noData && distSqr >= buildDistSqr + 32 * 16) {
 			DeleteChunk(chunk); continue;
 		}
+		UpdateChunkLod(chunk, distSqr);
 
-		if (chunk->dirty && distSqr <= buildDistSqr && *chunkUpdates < chunksTarget) {
-			DeleteChunk(chunk);
-			BuildChunk(chunk, chunkUpdates);
+		/* Chunks hidden behind other chunks are neither drawn nor rebuilt */
+		if (chunk->dirty && distSqr <= buildDistSqr && !chunk->occluded && ChunkInfo_HasData(chunk)) {
+			RebuildChunk(chunk, chunkUpdates);
 		}
 
-		if (distSqr > renderDistSqr) {
+		if (distSqr > renderDistSqr || chunk->occluded) {
 			chunk->visible  = false;
 		} else {
 			res = Frustum_TestSphere(chunk->centreX, chunk->centreY, chunk->centreZ, 14); /* 14 ~ sqrt(3 * 8^2) */
@@ -610,10 +817,8 @@ static int UpdateChunksStill(int* chunkUpdates) {
 			DeleteChunk(chunk); continue;
 		}
 
-		if (chunk->dirty && distSqr <= buildDistSqr && *chunkUpdates < chunksTarget) {
-			DeleteChunk(chunk);
-			BuildChunk(chunk, chunkUpdates);
-
+		if (chunk->dirty && distSqr <= buildDistSqr && !chunk->occluded && ChunkInfo_HasData(chunk) 
+				&& RebuildChunk(chunk, chunkUpdates)) {
 			/* only need to update the visibility of chunks in range. */
 			if (distSqr > renderDistSqr) {
 				chunk->visible  = false;
@@ -640,9 +845,12 @@ static void UpdateChunks(float delta) {
 	chunksTarget += delta < CHUNK_TARGET_TIME ? 1 : -1; 
 	Math_Clamp(chunksTarget, 4, maxChunkUpdates);
 
+	UploadBuiltChunks(&chunkUpdates);
+
 	p = Entities.CurPlayer;
 	samePos = Vec3_Equals(&Camera.CurrentPos, &lastCamPos)
-		&& p->Base.Pitch == lastPitch && p->Base.Yaw == lastYaw;
+		&& p->Base.Pitch == lastPitch && p->Base.Yaw == lastYaw && !occlusionChanged;
+	if (occlusionChanged) UpdateOcclusion();
 
 	renderChunksCount = samePos ?
 		UpdateChunksStill(&chunkUpdates) :
@@ -711,7 +919,7 @@ static void UpdateSortOrder(void) {
 
 	SortMapChunks(0, chunksCount - 1);
 	ResetPartFlags();
-	/*SimpleOcclusionCulling();*/
+	occlusionChanged = true;
 }
 
 void MapRenderer_Update(float delta) {
@@ -732,6 +940,8 @@ void MapRenderer_RefreshChunk(int cx, int cy, int cz) {
 	ChunkInfo_Refresh(chunk);
 }
 
+void MapRenderer_RebuildAll(void) { RefreshChunks(); }
+
 void MapRenderer_OnBlockChanged(int x, int y, int z, BlockID block) {
 	int cx = x >> CHUNK_SHIFT, cy = y >> CHUNK_SHIFT, cz = z >> CHUNK_SHIFT;
 	struct ChunkInfo* chunk;
@@ -740,6 +950,12 @@ void MapRenderer_OnBlockChanged(int x, int y, int z, BlockID block) {
 	chunk->allAir &= Blocks.Draw[block] == DRAW_GAS;
 	/* TODO: Don't lookup twice, refresh directly using chunk pointer */
 	ChunkInfo_Refresh(chunk);
+
+	/* Assume block opened up the chunk, until the chunk is rebuilt */
+	if (!Blocks.FullOpaque[block] && chunk->connectivity != CHUNK_ALL_CONNECTED) {
+		chunk->connectivity = CHUNK_ALL_CONNECTED;
+		occlusionChanged    = true;
+	}
 }
 
 static void OnEnvVariableChanged(void* obj, int envVar) {
@@ -819,6 +1035,8 @@ static void OnInit(void) {
 	MapRenderer_1DUsedCount = 87; /* Atlas1D_UsedAtlasesCount(); */
 	chunkPos   = IVec3_MaxValue();
 	maxChunkUpdates = Options_GetInt(OPT_MAX_CHUNK_UPDATES, 4, 1024, 30);
+	occlusionCulling = Options_GetBool(OPT_OCCLUSION_CULLING, true);
+	lodDistance      = Options_GetInt(OPT_LOD_DISTANCE, 0, 4096, 0);
 	CalcViewDists();
 }
 
@@ -32,6 +32,12 @@ struct ChunkPartInfo {
 	cc_uint16 counts[FACE_COUNT]; /* Counts per face */
 };
 
+/* Returns the bit in ChunkInfo connectivity for whether the given faces are connected */
+/* NOTE: a must be less than b */
+#define ChunkInfo_FacesBit(a, b) (1 << ((a) * (11 - (a)) / 2 + (b) - (a) - 1))
+/* Connectivity of a chunk where every face is connected to every other face */
+#define CHUNK_ALL_CONNECTED 0x7FFF
+
 /* Describes data necessary for rendering a chunk. */
 struct ChunkInfo {	
 	cc_uint16 centreX, centreY, centreZ; /* Centre coordinates of the chunk */
@@ -42,6 +48,8 @@ struct ChunkInfo {
 	cc_uint8 allAir  : 1; /* Whether chunk is completely air */
 	cc_uint8 noData  : 1; /* Whether chunk is currently empty of data, but may have data if built */
 	cc_uint8 skipClip: 1; /* Whether chunk can skip GPU backend clipping (see CC_CLIPPING_FLAGS) */
+	cc_uint8 building: 1; /* Whether chunk's mesh is currently being built on a background thread */
+	cc_uint8 occluded: 1; /* Whether chunk is known to be hidden behind other chunks from the camera */
 	cc_uint8 : 0;         /* pad to next byte*/
 
 	cc_uint8 drawXMin : 1;
@@ -50,11 +58,11 @@ struct ChunkInfo {
 	cc_uint8 drawZMax : 1;
 	cc_uint8 drawYMin : 1;
 	cc_uint8 drawYMax : 1;
+	cc_uint8 lod      : 2; /* Level of detail chunk is built at (0 = full, 1 = 2x2x2 cells, 2 = 4x4x4 cells) */
 	cc_uint8 : 0;          /* pad to next byte */
-#ifdef OCCLUSION
-	public cc_bool Visited = false, Occluded = false;
-	public byte OcclusionFlags, OccludedFlags, DistanceFlags;
-#endif
+	double buildTime;      /* Game.Time at which chunk's mesh was last (re)built */
+	/* Which pairs of faces of the chunk can be seen from each other through non-opaque blocks */
+	cc_uint16 connectivity;
 #if CC_GFX_BACKEND != CC_GFX_BACKEND_GL11
 	GfxResourceID vb;
 #endif
@@ -78,6 +86,8 @@ void MapRenderer_RefreshChunk(int cx, int cy, int cz);
 void MapRenderer_OnBlockChanged(int x, int y, int z, BlockID block);
 /* Deletes all chunks and resets internal state. */
 void MapRenderer_Refresh(void);
+/* Marks all chunks as needing to be rebuilt, while still drawing their existing meshes until then. */
+void MapRenderer_RebuildAll(void);
 
 CC_END_HEADER
 #endif
@@ -1351,6 +1351,8 @@ static void SaveLevelScreen_OnInputTextChanged(void* elem) {
 	SaveLevelScreen_RemoveOverwrites(&SaveLevelScreen);
 }
 
+/* Maps up to this many blocks are saved using DEFLATE_LEVEL_BEST */
+#define MAP_SAVE_BEST_VOLUME (256 * 256 * 256)
 static cc_result DoSaveMap(const cc_string* path, struct GZipState* state) {
 	static const cc_string schematic = String_FromConst(".schematic");
 	static const cc_string mine      = String_FromConst(".mine");
@@ -1363,6 +1365,8 @@ static cc_result DoSaveMap(const cc_string* path, struct GZipState* state) {
 	if (res) { Logger_IOWarn2(res, "creating", &raw_path); return res; }
 
 	GZip_MakeStream(&compStream, state, &stream);
+	/* Saving is rare, so smaller files are worth the slower compression unless the map is huge */
+	Deflate_SetLevel(&compStream, World.Volume <= MAP_SAVE_BEST_VOLUME ? DEFLATE_LEVEL_BEST : DEFLATE_LEVEL_NORMAL);
 
 	if (String_CaselessEnds(path, &schematic)) {
 		res = Schematic_Save(&compStream);
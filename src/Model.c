@@ -24,6 +24,18 @@ struct _ModelsData Models;
 #define AABB_Height(bb) ((bb)->Max.y - (bb)->Min.y)
 #define AABB_Length(bb) ((bb)->Max.z - (bb)->Min.z)
 
+/* Consoles use a separate dynamic VB for each entity instead (see Model_LockVB) */
+#if !defined CC_BUILD_CONSOLE && !defined CC_BUILD_LOWMEM
+	#define MODELS_BATCHING
+#endif
+/* Up to around 55 humanoids with 64x64 skins per draw call */
+#define MODELS_BATCH_MAX_VERTICES 16384
+
+struct ModelBatchEntry { struct Model* model; struct Entity* entity; GfxResourceID tex; };
+static struct ModelBatchEntry batchEntries[ENTITIES_MAX_COUNT];
+static int batchCount;
+static cc_bool batchQueueing, batchDrawing;
+
 
 /*########################################################################################################################*
 *------------------------------------------------------------Model--------------------------------------------------------*
@@ -100,8 +112,25 @@ void Model_GetEntityTransform(struct Model* model, struct Entity* e, struct Matr
 	model->GetTransform(e, pos, transform);
 }
 
+/* Returns the texture that Model_ApplyTexture will bind for the given entity */
+static GfxResourceID Model_GetTexture(struct Model* model, struct Entity* e) {
+	GfxResourceID tex = (model->usesHumanSkin || e->NonHumanSkin) ? e->TextureId : 0;
+	return tex ? tex : model->defaultTex->texID;
+}
+
 void Model_Render(struct Model* model, struct Entity* e) {
+	struct ModelBatchEntry* entry;
 	struct Matrix m, transform;
+
+	/* Drawn later in Models_EndBatch, along with other entities using the same model and texture */
+	if (batchQueueing && (model->flags & MODEL_FLAG_BATCHED) && batchCount < ENTITIES_MAX_COUNT) {
+		entry = &batchEntries[batchCount++];
+		entry->model  = model;
+		entry->entity = e;
+		entry->tex    = Model_GetTexture(model, e);
+		return;
+	}
+
 	Model_SetupState(model, e);
 	Gfx_SetVertexFormat(VERTEX_FORMAT_TEXTURED);
 
@@ -115,7 +144,7 @@ void Model_Render(struct Model* model, struct Entity* e) {
 
 void Model_SetupState(struct Model* model, struct Entity* e) {
 	PackedCol color;
-	float yawDelta;
+	float yawDelta, lodDist;
 
 	model->index = 0;
 	color = e->VTABLE->GetCol(e);
@@ -145,6 +174,9 @@ void Model_SetupState(struct Model* model, struct Entity* e) {
 	Models.cosHead = Math_CosF(yawDelta * MATH_DEG2RAD);
 	Models.sinHead = Math_SinF(yawDelta * MATH_DEG2RAD);
 	Models.Active  = model;
+
+	lodDist = (float)Entities.LodDistance;
+	Models.LowDetail = lodDist && Model_RenderDistance(e) > lodDist * lodDist;
 }
 
 void Model_ApplyTexture(struct Entity* e) {
@@ -156,13 +188,17 @@ void Model_ApplyTexture(struct Entity* e) {
 	tex = (model->usesHumanSkin || e->NonHumanSkin) ? e->TextureId : 0;
 	if (tex) {
 		Models.skinType = e->SkinType;
+		Entity_GetSkinOffset(e, &Models.uOffset, &Models.vOffset);
 	} else {
 		data = model->defaultTex;
 		tex  = data->texID;
 		Models.skinType = data->skinType;
+		Models.uOffset  = 0.0f;
+		Models.vOffset  = 0.0f;
 	}
 
-	Gfx_BindTexture(tex);
+	/* When drawing a batch, the texture is bound once for the whole batch */
+	if (!batchDrawing) Gfx_BindTexture(tex);
 	_64x64 = Models.skinType != SKIN_64x32;
 
 	Models.uScale = e->uScale * 0.015625f;
@@ -184,7 +220,16 @@ void Model_UpdateVB(void) {
 static struct VertexTextured* real_vertices;
 static GfxResourceID modelVB;
 
+static struct VertexTextured* batchVertices;
+
 void Model_LockVB(struct Entity* entity, int verticesCount) {
+	/* Vertices get transformed and then copied into the batch in Model_DrawRange */
+	if (batchDrawing) {
+		real_vertices   = Models.Vertices;
+		Models.Vertices = batchVertices + MODELS_BATCH_MAX_VERTICES;
+		return;
+	}
+
 #ifdef CC_BUILD_CONSOLE
 	if (!entity->ModelVB) {
 		entity->ModelVB = Gfx_CreateDynamicVb(VERTEX_FORMAT_TEXTURED, Models.Active->maxVertices);
@@ -202,7 +247,7 @@ void Model_LockVB(struct Entity* entity, int verticesCount) {
 }
 
 void Model_UnlockVB(void) {
-	Gfx_UnlockDynamicVb(modelVB);
+	if (!batchDrawing) Gfx_UnlockDynamicVb(modelVB);
 	Models.Vertices = real_vertices;
 }
 
@@ -214,8 +259,8 @@ void Model_DrawPart(struct ModelPart* part) {
 
 	struct ModelVertex v;
 	int i, count = part->count;
-	float uScale = Models.uScale;
-	float vScale = Models.vScale;
+	float uScale  = Models.uScale,  vScale  = Models.vScale;
+	float uOffset = Models.uOffset, vOffset = Models.vOffset;
 
 	for (i = 0; i < count; i++) 
 	{
@@ -223,8 +268,8 @@ void Model_DrawPart(struct ModelPart* part) {
 		dst->x = v.x; dst->y = v.y; dst->z = v.z;
 		dst->Col = Models.Cols[i >> 2];
 
-		dst->U = (v.u & UV_POS_MASK) * uScale - (v.u >> UV_MAX_SHIFT) * 0.01f * uScale;
-		dst->V = (v.v & UV_POS_MASK) * vScale - (v.v >> UV_MAX_SHIFT) * 0.01f * vScale;
+		dst->U = (v.u & UV_POS_MASK) * uScale - (v.u >> UV_MAX_SHIFT) * 0.01f * uScale + uOffset;
+		dst->V = (v.v & UV_POS_MASK) * vScale - (v.v >> UV_MAX_SHIFT) * 0.01f * vScale + vOffset;
 		src++; dst++;
 	}
 	model->index += count;
@@ -277,8 +322,8 @@ void Model_DrawRotate(float angleX, float angleY, float angleZ, struct ModelPart
 		dst->x = v.x + x; dst->y = v.y + y; dst->z = v.z + z;
 		dst->Col = Models.Cols[i >> 2];
 
-		dst->U = (v.u & UV_POS_MASK) * Models.uScale - (v.u >> UV_MAX_SHIFT) * 0.01f * Models.uScale;
-		dst->V = (v.v & UV_POS_MASK) * Models.vScale - (v.v >> UV_MAX_SHIFT) * 0.01f * Models.vScale;
+		dst->U = (v.u & UV_POS_MASK) * Models.uScale - (v.u >> UV_MAX_SHIFT) * 0.01f * Models.uScale + Models.uOffset;
+		dst->V = (v.v & UV_POS_MASK) * Models.vScale - (v.v >> UV_MAX_SHIFT) * 0.01f * Models.vScale + Models.vOffset;
 		src++; dst++;
 	}
 	model->index += count;
@@ -327,6 +372,128 @@ void Model_DrawArmPart(struct ModelPart* part) {
 }
 
 
+/*########################################################################################################################*
+*---------------------------------------------------------Batching--------------------------------------------------------*
+*#########################################################################################################################*/
+/* Opaque vertices are stored from the start of batchVertices, alpha tested vertices from the end */
+/* NOTE: batchVertices is followed by MODELS_MAX_VERTICES for the entity currently being drawn */
+static int batchOpaque, batchTested;
+static GfxResourceID batchVb, batchTex;
+static struct Matrix batchTransform;
+
+static void Models_FlushBatch(void) {
+	struct VertexTextured* dst;
+	int count = batchOpaque + batchTested;
+	if (!count) return;
+
+	if (!batchVb) {
+		batchVb = Gfx_CreateDynamicVb(VERTEX_FORMAT_TEXTURED, MODELS_BATCH_MAX_VERTICES);
+	}
+	dst = (struct VertexTextured*)Gfx_LockDynamicVb(batchVb, VERTEX_FORMAT_TEXTURED, count);
+
+	Mem_Copy(dst, batchVertices, batchOpaque * SIZEOF_VERTEX_TEXTURED);
+	Mem_Copy(dst + batchOpaque, batchVertices + (MODELS_BATCH_MAX_VERTICES - batchTested),
+			batchTested * SIZEOF_VERTEX_TEXTURED);
+	Gfx_UnlockDynamicVb(batchVb);
+	Gfx_BindTexture(batchTex);
+
+	if (batchOpaque) {
+		Gfx_SetAlphaTest(false);
+		Gfx_DrawVb_IndexedTris_Range(batchOpaque, 0, DRAW_HINT_NONE);
+		Gfx_SetAlphaTest(true);
+	}
+	if (batchTested) {
+		Gfx_DrawVb_IndexedTris_Range(batchTested, batchOpaque, DRAW_HINT_NONE);
+	}
+	batchOpaque = 0;
+	batchTested = 0;
+}
+
+static void Models_AddToBatch(struct VertexTextured* src, int count, cc_bool opaque) {
+	struct Matrix* m = &batchTransform;
+	struct VertexTextured* dst;
+	float x, y, z;
+	int i;
+
+	if (batchOpaque + batchTested + count > MODELS_BATCH_MAX_VERTICES) Models_FlushBatch();
+	if (opaque) {
+		dst = batchVertices + batchOpaque;
+		batchOpaque += count;
+	} else {
+		batchTested += count;
+		dst = batchVertices + (MODELS_BATCH_MAX_VERTICES - batchTested);
+	}
+
+	/* Inlined Vec3_Transform, so vertices end up in world space */
+	for (i = 0; i < count; i++, src++, dst++)
+	{
+		x = src->x; y = src->y; z = src->z;
+		dst->x = x * m->row1.x + y * m->row2.x + z * m->row3.x + m->row4.x;
+		dst->y = x * m->row1.y + y * m->row2.y + z * m->row3.y + m->row4.y;
+		dst->z = x * m->row1.z + y * m->row2.z + z * m->row3.z + m->row4.z;
+
+		dst->Col = src->Col;
+		dst->U   = src->U; dst->V = src->V;
+	}
+}
+
+void Model_DrawRange(int verticesCount, int startVertex, cc_bool opaque) {
+	/* Model_LockVB wrote the vertices just past the end of the batch */
+	if (batchDrawing) {
+		Models_AddToBatch(batchVertices + MODELS_BATCH_MAX_VERTICES + startVertex, verticesCount, opaque);
+		return;
+	}
+
+	if (opaque) Gfx_SetAlphaTest(false);
+	Gfx_DrawVb_IndexedTris_Range(verticesCount, startVertex, DRAW_HINT_NONE);
+	if (opaque) Gfx_SetAlphaTest(true);
+}
+
+void Models_BeginBatch(void) {
+#ifdef MODELS_BATCHING
+	if (!batchVertices) {
+		batchVertices = (struct VertexTextured*)Mem_TryAlloc(MODELS_BATCH_MAX_VERTICES + MODELS_MAX_VERTICES,
+															SIZEOF_VERTEX_TEXTURED);
+	}
+	batchQueueing = batchVertices != NULL;
+#endif
+}
+
+void Models_EndBatch(void) {
+	struct ModelBatchEntry* entry;
+	struct Model* model;
+	int i, j;
+
+	batchQueueing = false;
+	if (!batchCount) return;
+	batchDrawing  = true;
+	Gfx_SetVertexFormat(VERTEX_FORMAT_TEXTURED);
+
+	for (i = 0; i < batchCount; i++)
+	{
+		model = batchEntries[i].model;
+		if (!model) continue;
+		batchTex = batchEntries[i].tex;
+
+		/* Draw this and all later entities using the same model and texture together */
+		for (j = i; j < batchCount; j++)
+		{
+			entry = &batchEntries[j];
+			if (entry->model != model || entry->tex != batchTex) continue;
+
+			Model_SetupState(model, entry->entity);
+			Model_GetEntityTransform(model, entry->entity, &batchTransform);
+			model->Draw(entry->entity);
+			entry->model = NULL;
+		}
+		Models_FlushBatch();
+	}
+
+	batchDrawing = false;
+	batchCount   = 0;
+}
+
+
 /*########################################################################################################################*
 *----------------------------------------------------------BoxDesc--------------------------------------------------------*
 *#########################################################################################################################*/
@@ -820,7 +987,7 @@ static void CustomModel_Draw(struct Entity* e) {
 	}
 
 	Model_UnlockVB();
-	Gfx_DrawVb_IndexedTris(cm->numParts * MODEL_BOX_VERTICES);
+	Model_DrawRange(cm->numParts * MODEL_BOX_VERTICES, 0, false);
 	Models.Rotation = ROTATE_ORDER_ZYX;
 }
 
@@ -846,8 +1013,8 @@ static void CustomModel_DrawArm(struct Entity* e) {
 	if (!cm->numArmParts) return;
 	Gfx_SetAlphaTest(true);
 
-	Models.uScale = 1.0f / cm->uScale;
-	Models.vScale = 1.0f / cm->vScale;
+	Models.uScale = e->uScale / cm->uScale;
+	Models.vScale = e->vScale / cm->vScale;
 	Model_LockVB(e, cm->numArmParts * MODEL_BOX_VERTICES);
 
 	for (i = 0; i < cm->numParts; i++) 
@@ -878,6 +1045,7 @@ void CustomModel_Register(struct CustomModel* cm) {
 	cm->model.name        = cm->name;
 	cm->model.defaultTex  = &customDefaultTex;
 	cm->model.maxVertices = cm->numParts * MODEL_BOX_VERTICES;
+	cm->model.flags      |= MODEL_FLAG_BATCHED;
 
 	cm->model.MakeParts = Model_NoParts;
 	cm->model.Draw      = CustomModel_Draw;
@@ -945,6 +1113,8 @@ static void HumanModel_DrawCore(struct Entity* e, struct ModelSet* model, cc_boo
 	type = Models.skinType & 0x3;
 	set  = &model->limbs[type];
 	num  = HUMAN_BASE_VERTICES + (type == SKIN_64x32 ? HUMAN_HAT32_VERTICES : HUMAN_HAT64_VERTICES);
+	/* Hat and outer skin layers are barely noticeable far away */
+	if (Models.LowDetail) num = HUMAN_BASE_VERTICES;
 	Model_LockVB(e, num);
 
 	Model_DrawRotate(-e->Pitch * MATH_DEG2RAD, 0, 0, &model->head, true);
@@ -957,7 +1127,7 @@ static void HumanModel_DrawCore(struct Entity* e, struct ModelSet* model, cc_boo
 	Model_DrawRotate(e->Anim.RightArmX, 0, e->Anim.RightArmZ, &set->rightArm, false);
 	Models.Rotation = ROTATE_ORDER_ZYX;
 
-	if (type != SKIN_64x32) {
+	if (type != SKIN_64x32 && !Models.LowDetail) {
 		Model_DrawPart(&model->torsoLayer);
 		Model_DrawRotate(e->Anim.LeftLegX,  0, e->Anim.LeftLegZ,  &set->leftLegLayer,  false);
 		Model_DrawRotate(e->Anim.RightLegX, 0, e->Anim.RightLegZ, &set->rightLegLayer, false);
@@ -967,17 +1137,18 @@ static void HumanModel_DrawCore(struct Entity* e, struct ModelSet* model, cc_boo
 		Model_DrawRotate(e->Anim.RightArmX, 0, e->Anim.RightArmZ, &set->rightArmLayer, false);
 		Models.Rotation = ROTATE_ORDER_ZYX;
 	}
-	Model_DrawRotate(-e->Pitch * MATH_DEG2RAD, 0, 0, &model->hat, true);
+	if (!Models.LowDetail) {
+		Model_DrawRotate(-e->Pitch * MATH_DEG2RAD, 0, 0, &model->hat, true);
+	}
 
 	Model_UnlockVB();
 	if (opaqueBody) {
 		/* human model draws the body opaque so players can't have invisible skins */
-		Gfx_SetAlphaTest(false);
-		Gfx_DrawVb_IndexedTris_Range(HUMAN_BASE_VERTICES, 0, DRAW_HINT_NONE);
-		Gfx_SetAlphaTest(true);
-		Gfx_DrawVb_IndexedTris_Range(num - HUMAN_BASE_VERTICES, HUMAN_BASE_VERTICES, DRAW_HINT_NONE);
+		Model_DrawRange(HUMAN_BASE_VERTICES, 0, true);
+		if (num > HUMAN_BASE_VERTICES)
+			Model_DrawRange(num - HUMAN_BASE_VERTICES, HUMAN_BASE_VERTICES, false);
 	} else {
-		Gfx_DrawVb_IndexedTris(num);
+		Model_DrawRange(num, 0, false);
 	}
 }
 
@@ -1171,7 +1342,7 @@ static void HumanoidModel_Register(void) {
 
 	human_model.calcHumanAnims = true;
 	human_model.usesHumanSkin  = true;
-	human_model.flags |= MODEL_FLAG_CLEAR_HAT;
+	human_model.flags |= MODEL_FLAG_CLEAR_HAT | MODEL_FLAG_BATCHED;
 	human_model.maxVertices    = HUMAN_MAX_VERTICES;
 
 	Model_Register(&human_model);
@@ -1266,7 +1437,7 @@ static void ChibiModel_Register(void) {
 
 	chibi_model.calcHumanAnims = true;
 	chibi_model.usesHumanSkin  = true;
-	chibi_model.flags |= MODEL_FLAG_CLEAR_HAT;
+	chibi_model.flags |= MODEL_FLAG_CLEAR_HAT | MODEL_FLAG_BATCHED;
 	chibi_model.maxVertices    = HUMAN_MAX_VERTICES;
 
 	chibi_model.maxScale    = 3.0f;
@@ -1307,7 +1478,7 @@ static void SittingModel_Register(void) {
 
 	sitting_model.calcHumanAnims = true;
 	sitting_model.usesHumanSkin  = true;
-	sitting_model.flags |= MODEL_FLAG_CLEAR_HAT;
+	sitting_model.flags |= MODEL_FLAG_CLEAR_HAT | MODEL_FLAG_BATCHED;
 	sitting_model.maxVertices    = HUMAN_MAX_VERTICES;
 
 	sitting_model.shadowScale  = 0.5f;
@@ -1359,7 +1530,7 @@ static void HeadModel_Draw(struct Entity* e) {
 	Model_DrawRotate(-e->Pitch * MATH_DEG2RAD, 0, 0, &part, true);
 
 	Model_UnlockVB();
-	Gfx_DrawVb_IndexedTris(HEAD_MAX_VERTICES);
+	Model_DrawRange(HEAD_MAX_VERTICES, 0, false);
 }
 
 static float HeadModel_GetEyeY(struct Entity* e)  { return 6.0f/16.0f; }
@@ -1375,7 +1546,7 @@ static struct Model head_model = { "head", human_vertices, &human_tex,
 static void HeadModel_Register(void) {
 	Model_Init(&head_model);
 	head_model.usesHumanSkin = true;
-	head_model.flags |= MODEL_FLAG_CLEAR_HAT;
+	head_model.flags |= MODEL_FLAG_CLEAR_HAT | MODEL_FLAG_BATCHED;
 
 	head_model.pushes        = false;
 	head_model.GetTransform  = HeadModel_GetTransform;
@@ -1473,7 +1644,7 @@ static void ChickenModel_Draw(struct Entity* e) {
 	Model_DrawRotate(e->Anim.RightLegX, 0, 0, &chicken_rightLeg, false);
 
 	Model_UnlockVB();
-	Gfx_DrawVb_IndexedTris(CHICKEN_MAX_VERTICES);
+	Model_DrawRange(CHICKEN_MAX_VERTICES, 0, false);
 }
 
 static float ChickenModel_GetNameY(struct Entity* e) { return 1.0125f; }
@@ -1491,6 +1662,7 @@ static struct Model chicken_model = { "chicken", chicken_vertices, &chicken_tex,
 
 static void ChickenModel_Register(void) {
 	Model_Init(&chicken_model);
+	chicken_model.flags |= MODEL_FLAG_BATCHED;
 	chicken_model.maxVertices = CHICKEN_MAX_VERTICES;
 	Model_Register(&chicken_model);
 }
@@ -1555,7 +1727,7 @@ static void CreeperModel_Draw(struct Entity* e) {
 	Model_DrawRotate(e->Anim.LeftLegX,  0, 0, &creeper_rightLegBack,  false);
 
 	Model_UnlockVB();
-	Gfx_DrawVb_IndexedTris(CREEPER_MAX_VERTICES);
+	Model_DrawRange(CREEPER_MAX_VERTICES, 0, false);
 }
 
 static float CreeperModel_GetNameY(struct Entity* e) { return 1.7f; }
@@ -1574,6 +1746,7 @@ static struct Model creeper_model  = {
 
 static void CreeperModel_Register(void) {
 	Model_Init(&creeper_model);
+	creeper_model.flags |= MODEL_FLAG_BATCHED;
 	creeper_model.maxVertices = CREEPER_MAX_VERTICES;
 	Model_Register(&creeper_model);
 }
@@ -1638,7 +1811,7 @@ static void PigModel_Draw(struct Entity* e) {
 	Model_DrawRotate(e->Anim.LeftLegX,  0, 0, &pig_rightLegBack,  false);
 
 	Model_UnlockVB();
-	Gfx_DrawVb_IndexedTris(PIG_MAX_VERTICES);
+	Model_DrawRange(PIG_MAX_VERTICES, 0, false);
 }
 
 static float PigModel_GetNameY(struct Entity* e) { return 1.075f; }
@@ -1656,6 +1829,7 @@ static struct Model pig_model  = { "pig", pig_vertices, &pig_tex,
 
 static void PigModel_Register(void) {
 	Model_Init(&pig_model);
+	pig_model.flags |= MODEL_FLAG_BATCHED;
 	pig_model.maxVertices = PIG_MAX_VERTICES;
 	Model_Register(&pig_model);
 }
@@ -1772,7 +1946,7 @@ static void FurlessModel_Draw(struct Entity* e) {
 	SheepModel_DrawBody(e);
 
 	Model_UnlockVB();
-	Gfx_DrawVb_IndexedTris(SHEEP_BODY_VERTICES);
+	Model_DrawRange(SHEEP_BODY_VERTICES, 0, false);
 }
 
 static void SheepModel_Draw(struct Entity* e) {
@@ -1780,6 +1954,11 @@ static void SheepModel_Draw(struct Entity* e) {
 	Model_LockVB(e, SHEEP_BODY_VERTICES + SHEEP_FUR_VERTICES);
 
 	SheepModel_DrawBody(e);
+	/* Fur is always drawn using its own texture, even when the body is using a skin from a skin atlas */
+	Models.uOffset = 0.0f;
+	Models.vOffset = 0.0f;
+	Models.uScale  = 0.015625f;
+	Models.vScale  = fur_tex.skinType == SKIN_64x32 ? 0.03125f : 0.015625f;
 	Model_DrawRotate(-e->Pitch * MATH_DEG2RAD, 0, 0, &fur_head, true);
 	Model_DrawPart(&fur_torso);
 	Model_DrawRotate(e->Anim.LeftLegX,  0, 0, &fur_leftLegFront,  false);
@@ -1819,6 +1998,7 @@ static void SheepModel_Register(void) {
 
 static void NoFurModel_Register(void) {
 	Model_Init(&nofur_model);
+	nofur_model.flags |= MODEL_FLAG_BATCHED;
 	nofur_model.maxVertices = SHEEP_BODY_VERTICES;
 	Model_Register(&nofur_model);
 }
@@ -1883,7 +2063,7 @@ static void SkeletonModel_Draw(struct Entity* e) {
 	Model_DrawRotate(90.0f * MATH_DEG2RAD,   0, e->Anim.RightArmZ, &skeleton_rightArm, false);
 
 	Model_UnlockVB();
-	Gfx_DrawVb_IndexedTris(SKELETON_MAX_VERTICES);
+	Model_DrawRange(SKELETON_MAX_VERTICES, 0, false);
 }
 
 static void SkeletonModel_DrawArm(struct Entity* e) {
@@ -1909,6 +2089,7 @@ static struct Model skeleton_model  = { "skeleton", skeleton_vertices, &skeleton
 
 static void SkeletonModel_Register(void) {
 	Model_Init(&skeleton_model);
+	skeleton_model.flags |= MODEL_FLAG_BATCHED;
 	skeleton_model.DrawArm     = SkeletonModel_DrawArm;
 	skeleton_model.armX        = 5;
 	skeleton_model.maxVertices = SKELETON_MAX_VERTICES;
@@ -1987,7 +2168,7 @@ static void SpiderModel_Draw(struct Entity* e) {
 	Models.Rotation = ROTATE_ORDER_ZYX;
 
 	Model_UnlockVB();
-	Gfx_DrawVb_IndexedTris(SPIDER_MAX_VERTICES);
+	Model_DrawRange(SPIDER_MAX_VERTICES, 0, false);
 }
 
 static float SpiderModel_GetNameY(struct Entity* e) { return 1.0125f; }
@@ -2005,6 +2186,7 @@ static struct Model spider_model  = { "spider", spider_vertices, &spider_tex,
 
 static void SpiderModel_Register(void) {
 	Model_Init(&spider_model);
+	spider_model.flags |= MODEL_FLAG_BATCHED;
 	spider_model.maxVertices = SPIDER_MAX_VERTICES;
 	Model_Register(&spider_model);
 }
@@ -2033,6 +2215,7 @@ static struct Model zombie_model  = { "zombie", human_vertices, &zombie_tex,
 
 static void ZombieModel_Register(void) {
 	Model_Init(&zombie_model);
+	zombie_model.flags |= MODEL_FLAG_BATCHED;
 	zombie_model.DrawArm     = ZombieModel_DrawArm;
 	zombie_model.maxVertices = HUMAN_MAX_VERTICES;
 	Model_Register(&zombie_model);
@@ -2280,7 +2463,7 @@ static void SkinnedCubeModel_Draw(struct Entity* e) {
 	Model_DrawRotate(-e->Pitch * MATH_DEG2RAD, 0, 0, &skinnedCube_head, true);
 
 	Model_UnlockVB();
-	Gfx_DrawVb_IndexedTris(SKINNEDCUBE_MAX_VERTICES);
+	Model_DrawRange(SKINNEDCUBE_MAX_VERTICES, 0, false);
 }
 
 static float SkinnedCubeModel_GetNameY(struct Entity* e) { return 1.075f; }
@@ -2298,6 +2481,7 @@ static struct Model skinnedCube_model = { "skinnedcube", skinnedCube_vertices, &
 
 static void SkinnedCubeModel_Register(void) {
 	Model_Init(&skinnedCube_model);
+	skinnedCube_model.flags |= MODEL_FLAG_BATCHED;
 	skinnedCube_model.usesHumanSkin = true;
 	skinnedCube_model.pushes        = false;
 	skinnedCube_model.maxVertices   = SKINNEDCUBE_MAX_VERTICES;
@@ -2373,6 +2557,8 @@ static void HoldModel_Register(void) {
 	hold_model.MakeParts = Model_NoParts;
 	hold_model.Draw      = HoldModel_Draw;
 	hold_model.GetEyeY   = HoldModel_GetEyeY;
+	/* Held block is drawn using its own view matrix */
+	hold_model.flags    &= ~MODEL_FLAG_BATCHED;
 	Model_Register(&hold_model);
 }
 
@@ -2421,6 +2607,7 @@ static void RegisterDefaultModels(void) {
 static void OnContextLost(void* obj) {
 	struct ModelTex* tex;
 	Gfx_DeleteDynamicVb(&Models.Vb);
+	Gfx_DeleteDynamicVb(&batchVb);
 	if (Gfx.ManagedTextures) return;
 
 	for (tex = textures_head; tex; tex = tex->next) 
@@ -2441,6 +2628,9 @@ static void OnInit(void) {
 static void OnFree(void) {
 	OnContextLost(NULL);
 	CustomModel_FreeAll();
+
+	Mem_Free(batchVertices);
+	batchVertices = NULL;
 }
 
 static void OnReset(void) { CustomModel_FreeAll(); }
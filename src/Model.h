@@ -41,6 +41,8 @@ struct ModelTex { const char* name; cc_uint8 skinType; GfxResourceID texID; stru
 
 #define MODEL_FLAG_INITED    0x01
 #define MODEL_FLAG_CLEAR_HAT 0x02
+/* Model only draws using Model_DrawRange with a single texture, so can be drawn in batches */
+#define MODEL_FLAG_BATCHED   0x04
 
 struct Model;
 /* Contains a set of quads and/or boxes that describe a 3D object as well as
@@ -116,6 +118,11 @@ CC_VAR extern struct _ModelsData {
 	struct Model* Human;
 	/* Pointer to block model */
 	struct Model* Block;
+	/* Whether the entity currently being rendered is far enough away to be drawn with less detail. */
+	/* (e.g. humanoid models skip drawing the hat and outer skin layers) */
+	cc_bool LowDetail;
+	/* Offset added to texture coordinates, when the skin is packed into a skin atlas texture */
+	float uOffset, vOffset;
 } Models;
 
 /* Initialises fields of a model to default. */
@@ -139,6 +146,16 @@ CC_API void Model_ApplyTexture(struct Entity* entity);
 CC_API void Model_UpdateVB(void);
 void Model_LockVB(struct Entity* entity, int verticesCount);
 void Model_UnlockVB(void);
+/* Draws the given range of vertices written since Model_LockVB. */
+/* If opaque is true, the vertices are drawn with alpha testing disabled. */
+/* NOTE: When drawing a batch, the vertices are instead added to the batch and drawn later. */
+void Model_DrawRange(int verticesCount, int startVertex, cc_bool opaque);
+
+/* Starts deferring entities drawn by Model_Render that use a model with MODEL_FLAG_BATCHED, */
+/* so that entities using the same model and texture can all be drawn at once. */
+void Models_BeginBatch(void);
+/* Draws all the entities deferred since Models_BeginBatch. */
+void Models_EndBatch(void);
 
 /* Draws the given part with no part-specific rotation (e.g. torso). */
 CC_API void Model_DrawPart(struct ModelPart* part);
@@ -72,6 +72,16 @@ Copyright 2014-2025 ClassiCube | Licensed under BSD-3
 #define OPT_CLASSIC_CHAT "nostalgia-classicchat"
 #define OPT_CLASSIC_INVENTORY "nostalgia-classicinventory"
 #define OPT_MAX_CHUNK_UPDATES "gfx-maxchunkupdates"
+#define OPT_BUILDER_THREADS "gfx-builderthreads"
+#define OPT_GREEDY_MESHING "gfx-greedymeshing"
+#define OPT_OCCLUSION_CULLING "gfx-occlusionculling"
+#define OPT_LOD_DISTANCE "gfx-loddistance"
+#define OPT_ENTITY_DISTANCE "gfx-entitydistance"
+#define OPT_ENTITY_LOD_DISTANCE "gfx-entityloddistance"
+#define OPT_GEN_THREADS "gen-threads"
+#define OPT_MAP_CACHE "map-cache"
+#define OPT_MAP_CACHE_SIZE "map-cache-size"
+#define OPT_MAP_STREAMING "map-streaming"
 #define OPT_CAMERA_MASS "cameramass"
 #define OPT_CAMERA_SMOOTH "camera-smooth"
 #define OPT_GRAB_CURSOR "win-grab-cursor"
@@ -0,0 +1,265 @@
+#include "Profiler.h"
+#include "Game.h"
+#include "Platform.h"
+#include "Stream.h"
+#include "String_.h"
+#include "Utils.h"
+#include "Chat.h"
+#include "Logger.h"
+#include "Funcs.h"
+
+/* Chunk builds can be recorded from background builder threads */
+#if !defined CC_BUILD_COOPTHREADED && !defined CC_BUILD_LOWMEM && !defined CC_BUILD_PSP && !defined CC_BUILD_NDS
+	#define PROFILER_THREADED
+#endif
+
+const char* const Profiler_StageNames[PROFILER_STAGE_COUNT] = {
+	"Frame", "ScheduledTasks", "NetworkTick", "Entities_RenderModels", "Particles_Render",
+	"MapRenderer_Update", "MapRenderer_RenderNormal", "MapRenderer_RenderTranslucent", "Gui",
+	"ChunkBuild"
+};
+
+cc_bool Profiler_Enabled;
+float Profiler_AvgTimes[PROFILER_STAGE_COUNT];
+float Profiler_MaxTimes[PROFILER_STAGE_COUNT];
+int Profiler_StatsVersion;
+int    Profiler_TotalCounts[PROFILER_STAGE_COUNT];
+double Profiler_TotalTimes[PROFILER_STAGE_COUNT];
+
+struct ProfilerEvent { cc_uint64 beg, end; cc_uint8 stage, thread; };
+/* Enough to store around 10 seconds of events at 60 FPS */
+#define PROFILER_MAX_EVENTS 8192
+#define PROFILER_EVENTS_MASK (PROFILER_MAX_EVENTS - 1)
+
+static struct ProfilerEvent* events;
+static int eventsHead, eventsCount;
+static void* eventsMutex;
+
+/* Total time in microseconds spent in each stage during the current frame */
+static cc_uint32 frameTimes[PROFILER_STAGE_COUNT];
+/* Total and maximum time in microseconds spent in each stage over the current stats window */
+static cc_uint32 windowTimes[PROFILER_STAGE_COUNT];
+static cc_uint32 windowMaxTimes[PROFILER_STAGE_COUNT];
+static int windowFrames;
+static cc_uint64 windowStart;
+
+
+/*########################################################################################################################*
+*-------------------------------------------------------Recording---------------------------------------------------------*
+*#########################################################################################################################*/
+cc_uint64 Profiler_Now(void) { return Stopwatch_Measure(); }
+
+static void Profiler_UpdateStats(cc_uint64 now) {
+	int i;
+	if (Stopwatch_ElapsedMicroseconds(windowStart, now) < 1000 * 1000) return;
+
+	for (i = 0; i < PROFILER_STAGE_COUNT; i++)
+	{
+		Profiler_AvgTimes[i] = windowFrames ? windowTimes[i] / (windowFrames * 1000.0f) : 0.0f;
+		Profiler_MaxTimes[i] = windowMaxTimes[i] / 1000.0f;
+		windowTimes[i]    = 0;
+		windowMaxTimes[i] = 0;
+	}
+	windowFrames = 0;
+	windowStart  = now;
+	Profiler_StatsVersion++;
+}
+
+static void Profiler_EndFrame(cc_uint64 now) {
+	int i;
+	for (i = 0; i < PROFILER_STAGE_COUNT; i++)
+	{
+		windowTimes[i]   += frameTimes[i];
+		windowMaxTimes[i] = max(windowMaxTimes[i], frameTimes[i]);
+		frameTimes[i]     = 0;
+	}
+	windowFrames++;
+	Profiler_UpdateStats(now);
+}
+
+void Profiler_Record(int stage, int thread, cc_uint64 beg) {
+	cc_uint64 end = Stopwatch_Measure();
+	struct ProfilerEvent* e;
+	cc_uint32 elapsed;
+
+#ifdef PROFILER_THREADED
+	Mutex_Lock(eventsMutex);
+#endif
+	/* Profiling may have been stopped while the stage was running */
+	if (Profiler_Enabled) {
+		e = &events[eventsHead];
+		e->beg    = beg;
+		e->end    = end;
+		e->stage  = stage;
+		e->thread = thread;
+
+		eventsHead  = (eventsHead + 1) & PROFILER_EVENTS_MASK;
+		eventsCount = min(eventsCount + 1, PROFILER_MAX_EVENTS);
+
+		elapsed = (cc_uint32)Stopwatch_ElapsedMicroseconds(beg, end);
+		frameTimes[stage] += elapsed;
+		Profiler_TotalCounts[stage]++;
+		Profiler_TotalTimes[stage] += elapsed / 1000.0;
+		if (stage == PROFILER_FRAME) Profiler_EndFrame(end);
+	}
+#ifdef PROFILER_THREADED
+	Mutex_Unlock(eventsMutex);
+#endif
+}
+
+static void Profiler_Reset(void) {
+	int i;
+	eventsHead   = 0;
+	eventsCount  = 0;
+	windowFrames = 0;
+	windowStart  = Stopwatch_Measure();
+
+	for (i = 0; i < PROFILER_STAGE_COUNT; i++)
+	{
+		frameTimes[i]  = 0; windowTimes[i] = 0; windowMaxTimes[i] = 0;
+		Profiler_AvgTimes[i] = 0.0f; Profiler_MaxTimes[i] = 0.0f;
+		Profiler_TotalCounts[i] = 0; Profiler_TotalTimes[i] = 0.0;
+	}
+	Profiler_StatsVersion++;
+}
+
+cc_bool Profiler_SetEnabled(cc_bool enabled) {
+	if (enabled == Profiler_Enabled) return true;
+
+	if (enabled && !events) {
+		events = (struct ProfilerEvent*)Mem_TryAlloc(PROFILER_MAX_EVENTS, sizeof(struct ProfilerEvent));
+		if (!events) return false;
+	}
+
+#ifdef PROFILER_THREADED
+	Mutex_Lock(eventsMutex);
+#endif
+	{
+		/* Keep the events from the last session around, so they can still be exported */
+		if (enabled) Profiler_Reset();
+		Profiler_Enabled = enabled;
+	}
+#ifdef PROFILER_THREADED
+	Mutex_Unlock(eventsMutex);
+#endif
+	return true;
+}
+
+
+/*########################################################################################################################*
+*--------------------------------------------------------Exporting--------------------------------------------------------*
+*#########################################################################################################################*/
+static cc_result Profiler_WriteEvents(struct Stream* s, struct ProfilerEvent* all, int count) {
+	cc_string line; char lineBuffer[256];
+	struct ProfilerEvent* e;
+	cc_uint64 base = all[0].beg;
+	int i, ts, dur, tid;
+	cc_result res;
+
+	String_InitArray(line, lineBuffer);
+	String_AppendConst(&line, "{\"traceEvents\":[");
+	if ((res = Stream_WriteLine(s, &line))) return res;
+
+	for (i = 0; i < count; i++)
+	{
+		e   = &all[i];
+		ts  = (int)Stopwatch_ElapsedMicroseconds(base, e->beg);
+		dur = (int)Stopwatch_ElapsedMicroseconds(e->beg, e->end);
+		tid = e->thread;
+
+		line.length = 0;
+		String_Format3(&line, "{\"name\":\"%c\",\"ph\":\"X\",\"ts\":%i,\"dur\":%i,",
+						Profiler_StageNames[e->stage], &ts, &dur);
+		String_Format2(&line, "\"pid\":1,\"tid\":%i}%c",
+						&tid, i < count - 1 ? "," : "");
+		if ((res = Stream_WriteLine(s, &line))) return res;
+	}
+
+	line.length = 0;
+	String_AppendConst(&line, "]}");
+	return Stream_WriteLine(s, &line);
+}
+
+void Profiler_ExportTrace(void) {
+	cc_string filename; char fileBuffer[STRING_SIZE];
+	cc_string path;     char pathBuffer[FILENAME_SIZE];
+	struct ProfilerEvent* all;
+	struct cc_datetime now;
+	cc_filepath raw_path;
+	struct Stream stream;
+	int i, count, start;
+	cc_result res;
+
+	if (!eventsCount) { Chat_AddRaw("&cNo profiler timings have been recorded yet"); return; }
+	/* Copy events oldest first, so that the file can be written without holding the lock */
+	all = (struct ProfilerEvent*)Mem_TryAlloc(PROFILER_MAX_EVENTS, sizeof(struct ProfilerEvent));
+	if (!all) { Chat_AddRaw("&cOut of memory exporting profiler trace"); return; }
+
+#ifdef PROFILER_THREADED
+	Mutex_Lock(eventsMutex);
+#endif
+	{
+		count = eventsCount;
+		start = (eventsHead - count) & PROFILER_EVENTS_MASK;
+		for (i = 0; i < count; i++)
+		{
+			all[i] = events[(start + i) & PROFILER_EVENTS_MASK];
+		}
+	}
+#ifdef PROFILER_THREADED
+	Mutex_Unlock(eventsMutex);
+#endif
+
+	DateTime_CurrentLocal(&now);
+	String_InitArray(filename, fileBuffer);
+	String_Format3(&filename, "trace_%p4-%p2-%p2", &now.year, &now.month, &now.day);
+	String_Format3(&filename, "-%p2-%p2-%p2.json", &now.hour, &now.minute, &now.second);
+
+	if (!Utils_EnsureDirectory("traces")) goto done;
+	String_InitArray(path, pathBuffer);
+	String_Format1(&path, "traces/%s", &filename);
+
+	Platform_EncodePath(&raw_path, &path);
+	res = Stream_CreatePath(&stream, &raw_path);
+	if (res) { Logger_IOWarn2(res, "creating", &raw_path); goto done; }
+
+	res = Profiler_WriteEvents(&stream, all, count);
+	if (res) {
+		Logger_IOWarn2(res, "writing to", &raw_path); stream.Close(&stream); goto done;
+	}
+
+	res = stream.Close(&stream);
+	if (res) { Logger_IOWarn2(res, "closing", &raw_path); goto done; }
+	Chat_Add1("&eExported profiler trace as: %s", &filename);
+
+done:
+	Mem_Free(all);
+}
+
+
+/*########################################################################################################################*
+*---------------------------------------------------Profiler component----------------------------------------------------*
+*#########################################################################################################################*/
+static void OnInit(void) {
+#ifdef PROFILER_THREADED
+	eventsMutex = Mutex_Create("Profiler events");
+#endif
+}
+
+static void OnFree(void) {
+	Profiler_Enabled = false;
+	Mem_Free(events);
+	events      = NULL;
+	eventsCount = 0;
+	eventsHead  = 0;
+
+#ifdef PROFILER_THREADED
+	Mutex_Free(eventsMutex);
+	eventsMutex = NULL;
+#endif
+}
+
+struct IGameComponent Profiler_Component = {
+	OnInit, /* Init  */
+	OnFree  /* Free  */
+};
@@ -0,0 +1,54 @@
+#ifndef CC_PROFILER_H
+#define CC_PROFILER_H
+#include "Core.h"
+CC_BEGIN_HEADER
+
+/*
+Measures how long the main stages of each frame take (and chunk builds on background threads)
+  Recorded timings are stored in a ring buffer, which can be exported as a Chrome trace JSON file
+  When disabled, measuring a stage only costs checking Profiler_Enabled
+Copyright 2014-2025 ClassiCube | Licensed under BSD-3
+*/
+struct IGameComponent;
+extern struct IGameComponent Profiler_Component;
+
+enum ProfilerStage {
+	PROFILER_FRAME, PROFILER_TASKS, PROFILER_NETWORK, PROFILER_ENTITIES, PROFILER_PARTICLES,
+	PROFILER_MAP_UPDATE, PROFILER_MAP_NORMAL, PROFILER_MAP_TRANSLUCENT, PROFILER_GUI,
+	PROFILER_CHUNK_BUILD, PROFILER_STAGE_COUNT
+};
+extern const char* const Profiler_StageNames[PROFILER_STAGE_COUNT];
+
+/* Whether timings of stages are currently being recorded */
+extern cc_bool Profiler_Enabled;
+/* Average time (in milliseconds) spent per frame in each stage, over the last second */
+extern float Profiler_AvgTimes[PROFILER_STAGE_COUNT];
+/* Longest time (in milliseconds) spent in a single frame in each stage, over the last second */
+extern float Profiler_MaxTimes[PROFILER_STAGE_COUNT];
+/* Incremented whenever Profiler_AvgTimes and Profiler_MaxTimes are recalculated */
+extern int Profiler_StatsVersion;
+/* Number of times each stage was recorded, and total time (in milliseconds) spent in it, since profiling started */
+extern int    Profiler_TotalCounts[PROFILER_STAGE_COUNT];
+extern double Profiler_TotalTimes[PROFILER_STAGE_COUNT];
+
+/* Returns the timestamp at which a stage begins, or 0 if profiling is disabled */
+#define Profiler_Begin() (Profiler_Enabled ? Profiler_Now() : 0)
+
+cc_uint64 Profiler_Now(void);
+/* Records that the given stage (which began at 'beg') on the given thread has just ended */
+/* NOTE: thread is only used to group events in exported traces, 0 is the main thread */
+void Profiler_Record(int stage, int thread, cc_uint64 beg);
+
+/* Records that the given stage (which began at 'beg') on the main thread has just ended */
+static CC_INLINE void Profiler_End(int stage, cc_uint64 beg) {
+	if (beg) Profiler_Record(stage, 0, beg);
+}
+
+/* Starts or stops recording timings */
+cc_bool Profiler_SetEnabled(cc_bool enabled);
+/* Writes all recorded timings to a Chrome trace JSON file in the 'traces' folder */
+/* NOTE: The trace can be viewed using chrome://tracing or https://ui.perfetto.dev */
+void Profiler_ExportTrace(void);
+
+CC_END_HEADER
+#endif
@@ -28,6 +28,8 @@
 #include "Window.h"
 #include "Particle.h"
 #include "Picking.h"
+#include "MapRenderer.h"
+#include "EnvRenderer.h"
 #include "Input.h"
 #include "Utils.h"
 #include "InputHandler.h"
@@ -47,6 +49,13 @@ static cc_uint64 map_receiveBeg;
 static struct Stream map_part;
 static int map_volume;
 
+/* Map streaming state (world is rendered while the rest of the map is still being received) */
+#ifndef CC_BUILD_COMPACTWORLD
+#define MAP_STREAMING
+#endif
+static cc_bool map_streamable, map_streaming;
+static int map_lastWidth, map_lastHeight, map_lastLength;
+
 /*########################################################################################################################*
 *-----------------------------------------------------CPE extensions------------------------------------------------------*
 *#########################################################################################################################*/
@@ -388,8 +397,10 @@ static CC_INLINE void MapState_SkipHeader(struct MapState* m) {
 }
 
 static void FreeMapStates(void) {
-	Mem_Free(map1.blocks);
-	map1.blocks = NULL;
+	/* Blocks of a map being streamed in are owned by the world */
+	if (!map_streaming) Mem_Free(map1.blocks);
+	map1.blocks   = NULL;
+	map_streaming = false;
 #ifdef EXTENDED_BLOCKS
 	Mem_Free(map2.blocks);
 	map2.blocks = NULL;
@@ -415,7 +426,9 @@ static cc_result MapState_Read(struct MapState* m) {
 	if (!map_volume) map_volume = Mem_ReadU32_BE(m->size);
 
 	if (!m->blocks) {
-		m->blocks = (BlockRaw*)Mem_TryAlloc(map_volume, 1);
+		/* Blocks not received yet must be air when streaming */
+		m->blocks = map_streamable ? (BlockRaw*)Mem_TryAllocCleared(map_volume, 1)
+								   : (BlockRaw*)Mem_TryAlloc(map_volume, 1);
 		/* unlikely but possible */
 		if (!m->blocks) {
 			Window_ShowDialog("Out of memory", "Not enough free memory to join that map.\nTry joining a different map.");
@@ -431,6 +444,94 @@ static cc_result MapState_Read(struct MapState* m) {
 	return res;
 }
 
+/*########################################################################################################################*
+*-----------------------------------------------------Map streaming-------------------------------------------------------*
+*#########################################################################################################################*/
+/* Blocks arrive layer by layer from the bottom up, so when the dimensions of the map are known in advance, */
+/*  the world can be set up early and each layer made available for rendering as soon as it has arrived */
+#ifdef MAP_STREAMING
+/* Classic protocol only sends the actual dimensions after all the blocks, so they have to be guessed from the volume */
+static cc_bool MapStream_GuessDimensions(int volume, int* width, int* height, int* length) {
+	cc_uint64 w, h;
+	if (volume <= 0) return false;
+
+	/* Most likely the same dimensions as the previous map (e.g. rejoining, or same size maps on a server) */
+	if ((cc_uint64)map_lastWidth * map_lastHeight * map_lastLength == (cc_uint64)volume
+			&& World_CheckVolume(map_lastWidth, map_lastHeight, map_lastLength)) {
+		*width = map_lastWidth; *height = map_lastHeight; *length = map_lastLength;
+		return true;
+	}
+
+	/* Otherwise assume width equals length, dimensions are all powers of two, */
+	/*  and height is between a quarter of width and width (only one such option can match) */
+	for (h = 1; h <= 1024; h <<= 1) {
+		for (w = h; w <= h * 4; w <<= 1) {
+			if (w * h * w != (cc_uint64)volume) continue;
+
+			*width = (int)w; *height = (int)h; *length = (int)w;
+			return World_CheckVolume(*width, *height, *length);
+		}
+	}
+	return false;
+}
+
+/* Called whenever more of the blocks of the map have been received */
+static void MapStream_Update(void) {
+	struct LocationUpdate update = { 0 };
+	int width, height, length;
+
+	if (!map_streamable || !map1.blocks) return;
+	if (!map_streaming) {
+		if (!MapStream_GuessDimensions(map_volume, &width, &height, &length)) {
+			map_streamable = false; return;
+		}
+
+		map_streaming = true;
+		World_SetStreamedMap(map1.blocks, width, height, length);
+
+		/* Actual spawn isn't known until the map has been fully sent, so temporarily look down */
+		/*  on the map from above its centre (local player is held in place until then anyways) */
+		update.flags = LU_HAS_POS | LU_HAS_PITCH;
+		Vec3_Set(update.pos, width / 2 + 0.5f, height + 2.0f, length / 2 + 0.5f);
+		update.pitch = 45.0f;
+		LocalPlayers_MoveToSpawn(&update);
+	}
+	World_SetLoadedHeight(map1.index / World.OneY);
+}
+
+/* Finishes off the map currently being streamed, returning false if it had to be aborted */
+static cc_bool MapStream_Finish(int width, int height, int length) {
+	cc_bool ok = width == World.Width && height == World.Height && length == World.Length;
+#ifdef EXTENDED_BLOCKS
+	ok &= !map2.allocFailed;
+#endif
+	map_streaming = false;
+
+	if (!ok) {
+		/* Blocks are kept in map1, so can be used to load the map properly with the actual dimensions */
+		World_AbortStreamedMap();
+		return false;
+	}
+
+	World_SetLoadedHeight(height);
+#ifdef EXTENDED_BLOCKS
+	if (IsSupported(extBlocks_Ext) && map2.blocks) {
+		World_SetMapUpper(map2.blocks);
+	}
+	map2.blocks = NULL;
+#endif
+	map1.blocks = NULL;
+
+	/* Lighting, rain heights and chunk meshes may have been calculated from only partially */
+	/*  received columns of blocks, so recalculate them (existing meshes are drawn until rebuilt) */
+	/* NOTE: MapLoaded is deliberately not raised again, as that would discard all chunk meshes */
+	Lighting.Refresh();
+	EnvRenderer_RefreshWeather();
+	MapRenderer_RebuildAll();
+	return true;
+}
+#endif
+
 
 /*########################################################################################################################*
 *----------------------------------------------------Classic protocol-----------------------------------------------------*
@@ -532,6 +633,10 @@ static void Classic_StartLoading(void) {
 	map_begunLoading = true;
 	map_receiveBeg   = Stopwatch_Measure();
 	map_volume       = 0;
+	map_streaming    = false;
+#ifdef MAP_STREAMING
+	map_streamable   = Options_GetBool(OPT_MAP_STREAMING, false);
+#endif
 
 	MapState_Init(&map1);
 #ifdef EXTENDED_BLOCKS
@@ -589,6 +694,9 @@ static void Classic_LevelDataChunk(cc_uint8* data) {
 		res = MapState_Read(m);
 		if (res) { DisconnectInvalidMap(res); return; }
 	}
+#ifdef MAP_STREAMING
+	if (m == &map1) MapStream_Update();
+#endif
 
 	progress = !map_volume ? 0.0f : (float)map1.index / map_volume;
 	Event_RaiseFloat(&WorldEvents.Loading, progress);
@@ -608,14 +716,19 @@ static void Classic_LevelFinalise(cc_uint8* data) {
 	map_begunLoading = false;
 	WoM_CheckSendWomID();
 
-#ifdef EXTENDED_BLOCKS
-	if (map2.allocFailed) FreeMapStates();
-#endif
-
 	width  = Mem_ReadU16_BE(data + 0);
 	height = Mem_ReadU16_BE(data + 2);
 	length = Mem_ReadU16_BE(data + 4);
 	volume = width * height * length;
+	map_lastWidth = width; map_lastHeight = height; map_lastLength = length;
+
+#ifdef MAP_STREAMING
+	/* World already uses the blocks, so nothing else to do if the dimensions were guessed correctly */
+	if (map_streaming && MapStream_Finish(width, height, length)) return;
+#endif
+#ifdef EXTENDED_BLOCKS
+	if (map2.allocFailed) FreeMapStates();
+#endif
 
 	if (map1.allocFailed) {
 		Chat_AddRaw("&cFailed to load map, try joining a different map");
@@ -1283,11 +1396,9 @@ static void CPE_ExtAddEntity2(cc_uint8* data) {
 
 #define BULK_MAX_BLOCKS 256
 static void CPE_BulkBlockUpdate(cc_uint8* data) {
-	cc_int32 indices[BULK_MAX_BLOCKS];
+	int indices[BULK_MAX_BLOCKS];
 	BlockID blocks[BULK_MAX_BLOCKS];
-	int index, i;
-	int x, y, z;
-	int count = 1 + *data++;
+	int i, count = 1 + *data++;
 
 	for (i = 0; i < count; i++) {
 		indices[i] = Mem_ReadU32_BE(data); data += 4;
@@ -1310,17 +1421,12 @@ static void CPE_BulkBlockUpdate(cc_uint8* data) {
 		data += BULK_MAX_BLOCKS / 4;
 	}
 
-	for (i = 0; i < count; i++) {
-		index = indices[i];
-		if (index < 0 || index >= World.Volume) continue;
-		World_Unpack(index, x, y, z);
-
 #ifdef EXTENDED_BLOCKS
-		Game_UpdateBlock(x, y, z, blocks[i] % BLOCK_COUNT);
-#else
-		Game_UpdateBlock(x, y, z, blocks[i]);
-#endif
+	for (i = 0; i < count; i++) {
+		blocks[i] %= BLOCK_COUNT;
 	}
+#endif
+	Game_UpdateBlocks(indices, blocks, count);
 }
 
 static void CPE_SetTextColor(cc_uint8* data) {
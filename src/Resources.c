@@ -222,7 +222,8 @@ static cc_result ZipWriter_WritePng(struct Stream* dst, struct ResourceZipEntry*
 	cc_result res;
 
 	if ((res = ZipWriter_LocalFile(dst, e)))            return res;
-	if ((res = Png_Encode(src, dst, NULL, true, NULL))) return res;
+	/* Only generated once, so worth spending extra time to make default.zip smaller */
+	if ((res = Png_EncodeLevel(src, dst, NULL, true, NULL, DEFLATE_LEVEL_BEST))) return res;
 	return ZipWriter_FixupLocalFile(dst, e);
 }
 
@@ -24,6 +24,7 @@
 #include "Options.h"
 #include "InputHandler.h"
 #include "Protocol.h"
+#include "Profiler.h"
 
 #define CHAT_MAX_STATUS Array_Elems(Chat_Status)
 #define CHAT_MAX_BOTTOMRIGHT Array_Elems(Chat_BottomRight)
@@ -1707,6 +1708,111 @@ void SpecialTextScreen_Show(void) {
 void SpecialTextScreen_Show(void) { }
 #endif
 
+/*########################################################################################################################*
+*---------------------------------------------------ProfilerOverlay-------------------------------------------------------*
+*#########################################################################################################################*/
+static struct ProfilerOverlay {
+	Screen_Body
+	struct FontDesc font;
+	int statsVersion;
+	struct TextWidget title, lines[PROFILER_STAGE_COUNT];
+	struct Widget* __widgets[1 + PROFILER_STAGE_COUNT];
+} ProfilerOverlay_Instance;
+
+static void ProfilerOverlay_RemakeLines(struct ProfilerOverlay* s) {
+	cc_string line; char lineBuffer[STRING_SIZE];
+	int i;
+
+	for (i = 0; i < PROFILER_STAGE_COUNT; i++)
+	{
+		String_InitArray(line, lineBuffer);
+		String_Format3(&line, "%c: &f%f2 &7avg, &f%f2 &7max ms", 
+						Profiler_StageNames[i], &Profiler_AvgTimes[i], &Profiler_MaxTimes[i]);
+		TextWidget_Set(&s->lines[i], &line, &s->font);
+	}
+	s->statsVersion = Profiler_StatsVersion;
+	s->dirty        = true;
+}
+
+static void ProfilerOverlay_ContextLost(void* screen) {
+	struct ProfilerOverlay* s = (struct ProfilerOverlay*)screen;
+	Font_Free(&s->font);
+	Screen_ContextLost(screen);
+}
+
+static void ProfilerOverlay_ContextRecreated(void* screen) {
+	struct ProfilerOverlay* s = (struct ProfilerOverlay*)screen;
+	Screen_UpdateVb(s);
+	Font_Make(&s->font, 16, FONT_FLAGS_PADDING);
+
+	TextWidget_SetConst(&s->title, "&eFrame profiler (per frame, last second)", &s->font);
+	ProfilerOverlay_RemakeLines(s);
+}
+
+static void ProfilerOverlay_Layout(void* screen) {
+	struct ProfilerOverlay* s = (struct ProfilerOverlay*)screen;
+	struct TextWidget* prev;
+	int i;
+
+	Widget_SetLocation(&s->title, ANCHOR_MAX, ANCHOR_MIN, 2, 2);
+	prev = &s->title;
+
+	for (i = 0; i < PROFILER_STAGE_COUNT; i++)
+	{
+		Widget_SetLocation(&s->lines[i], ANCHOR_MAX, ANCHOR_MIN, 2, 0);
+		/* Can't use Widget_SetLocation because it DPI scales input */
+		s->lines[i].yOffset = prev->y + prev->height;
+		Widget_Layout(&s->lines[i]);
+		prev = &s->lines[i];
+	}
+}
+
+static void ProfilerOverlay_Update(void* screen, float delta) {
+	struct ProfilerOverlay* s = (struct ProfilerOverlay*)screen;
+	if (s->statsVersion != Profiler_StatsVersion) ProfilerOverlay_RemakeLines(s);
+}
+
+static void ProfilerOverlay_Render(void* screen, float delta) {
+	if (Game_HideGui) return;
+
+	Gfx_3DS_SetRenderScreen(TOP_SCREEN);
+	Screen_Render2Widgets(screen, delta);
+	Gfx_3DS_SetRenderScreen(BOTTOM_SCREEN);
+}
+
+static void ProfilerOverlay_Init(void* screen) {
+	struct ProfilerOverlay* s = (struct ProfilerOverlay*)screen;
+	int i;
+
+	s->widgets     = s->__widgets;
+	s->numWidgets  = 0;
+	s->maxWidgets  = Array_Elems(s->__widgets);
+
+	TextWidget_Add(s, &s->title);
+	for (i = 0; i < PROFILER_STAGE_COUNT; i++)
+	{
+		TextWidget_Add(s, &s->lines[i]);
+	}
+	s->maxVertices = Screen_CalcDefaultMaxVertices(s);
+}
+
+static const struct ScreenVTABLE ProfilerOverlay_VTABLE = {
+	ProfilerOverlay_Init,   ProfilerOverlay_Update, Screen_NullFunc,
+	ProfilerOverlay_Render, Screen_BuildMesh,
+	Screen_FInput,          Screen_InputUp,    Screen_FKeyPress,   Screen_FText,
+	Screen_FPointer,        Screen_PointerUp,  Screen_FPointer,    Screen_FMouseScroll,
+	ProfilerOverlay_Layout, ProfilerOverlay_ContextLost, ProfilerOverlay_ContextRecreated
+};
+void ProfilerOverlay_Show(void) {
+	struct ProfilerOverlay* s = &ProfilerOverlay_Instance;
+	s->VTABLE = &ProfilerOverlay_VTABLE;
+	Gui_Add((struct Screen*)s, GUI_PRIORITY_PROFILER);
+}
+
+void ProfilerOverlay_Hide(void) {
+	Gui_Remove((struct Screen*)&ProfilerOverlay_Instance);
+}
+
 
 /*########################################################################################################################*
 *-----------------------------------------------------InventoryScreen-----------------------------------------------------*
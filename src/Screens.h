@@ -41,6 +41,8 @@ void TouchScreen_Show(void);
 
 int HUDScreen_LayoutHotbar(void);
 void TabListOverlay_Show(cc_bool staysOpen);
+void ProfilerOverlay_Show(void);
+void ProfilerOverlay_Hide(void);
 
 /* Opens chat input for the HUD with the given initial text. */
 void ChatScreen_OpenInput(const cc_string* text);
@@ -25,6 +25,7 @@
 #include "Input.h"
 #include "Errors.h"
 #include "Options.h"
+#include "Benchmark.h"
 
 static char nameBuffer[STRING_SIZE];
 static char motdBuffer[STRING_SIZE];
@@ -151,6 +152,13 @@ static void SPConnection_BeginConnect(void) {
 	Random_SeedFromCurrentTime(&rnd);
 	seed = Random_Next(&rnd, Int32_MaxValue);
 
+#ifdef CC_BUILD_BENCHMARK
+	/* Benchmark must always generate exactly the same map */
+	gen     = &NotchyGen;
+	seed    = BENCHMARK_MAP_SEED;
+	horSize = BENCHMARK_MAP_SIZE;
+	verSize = BENCHMARK_MAP_HEIGHT;
+#endif
 	Gen_Start(gen, seed, horSize, verSize, horSize);
 }
 
@@ -16,6 +16,7 @@
 #include "Utils.h"
 #include "Chat.h" /* TODO avoid this include */
 #include "Errors.h"
+#include "Builder.h"
 
 /* Simple fallback terrain for when no texture packs are available at all */
 static BitmapCol fallback_terrain[16 * 8] = {
@@ -83,7 +84,8 @@ TextureRec Atlas1D_TexRec(TextureLoc texLoc, int uCount, int* index) {
 static void Atlas1D_Load(int index, struct Bitmap* atlas1D) {
 	int tileSize      = Atlas2D.TileSize;
 	int tilesPerAtlas = Atlas1D.TilesPerAtlas;
-	int y, tile = index * tilesPerAtlas;
+	int tileRepeats   = Atlas1D.TileRepeats;
+	int y, r, tile = index * tilesPerAtlas;
 	int atlasX, atlasY;
 	
 	for (y = 0; y < tilesPerAtlas; y++, tile++) 
@@ -91,8 +93,11 @@ static void Atlas1D_Load(int index, struct Bitmap* atlas1D) {
 		atlasX = Atlas2D_TileX(tile) * tileSize;
 		atlasY = Atlas2D_TileY(tile) * tileSize;
 
-		Bitmap_UNSAFE_CopyBlock(atlasX, atlasY, 0, y * tileSize,
-							&Atlas2D.Bmp, atlas1D, tileSize);
+		for (r = 0; r < tileRepeats; r++)
+		{
+			Bitmap_UNSAFE_CopyBlock(atlasX, atlasY, 0, (y * tileRepeats + r) * tileSize,
+								&Atlas2D.Bmp, atlas1D, tileSize);
+		}
 	}
 	Gfx_RecreateTexture(&Atlas1D.TexIds[index], atlas1D, TEXTURE_FLAG_MANAGED | TEXTURE_FLAG_DYNAMIC, Gfx.Mipmaps);
 }
@@ -105,7 +110,7 @@ static void Atlas1D_LoadBlock(int index) {
 	struct Bitmap atlas1D;
 
 	Platform_Log2("Lazy load atlas #%i (%i per bmp)", &index, &tilesPerAtlas);
-	Bitmap_Allocate(&atlas1D, tileSize, tilesPerAtlas * tileSize);
+	Bitmap_Allocate(&atlas1D, tileSize, tilesPerAtlas * Atlas1D.TileRepeats * tileSize);
 	
 	Atlas1D_Load(index, &atlas1D);
 	Mem_Free(atlas1D.scan0);
@@ -135,7 +140,7 @@ static void Atlas_Convert2DTo1D(void) {
 	int i;
 
 	Platform_Log2("Loaded terrain atlas: %i bmps, %i per bmp", &atlasesCount, &tilesPerAtlas);
-	Bitmap_Allocate(&atlas1D, tileSize, tilesPerAtlas * tileSize);
+	Bitmap_Allocate(&atlas1D, tileSize, tilesPerAtlas * Atlas1D.TileRepeats * tileSize);
 	
 	for (i = 0; i < atlasesCount; i++) 
 	{
@@ -146,7 +151,7 @@ static void Atlas_Convert2DTo1D(void) {
 #endif
 
 static void Atlas_Update1D(void) {
-	int maxAtlasHeight, maxTilesPerAtlas, maxTiles;
+	int maxAtlasHeight, maxTilesPerAtlas, maxTiles, tileRepeats;
 	int maxTexHeight = Gfx.MaxTexHeight;
 
 	/* E.g. a graphics backend may support textures up to 256 x 256 */
@@ -160,12 +165,20 @@ static void Atlas_Update1D(void) {
 	maxTilesPerAtlas = maxAtlasHeight / Atlas2D.TileSize;
 	maxTiles         = Atlas2D.RowsCount * ATLAS2D_TILES_PER_ROW;
 
+	/* Greedy mesh builder needs textures to also repeat along V axis, */
+	/*  so each tile is stored as a strip of a few copies of itself */
+	tileRepeats       = Builder_GreedyMeshing ? ATLAS1D_GREEDY_REPEATS : 1;
+	tileRepeats       = min(tileRepeats, maxTilesPerAtlas);
+	maxTilesPerAtlas /= tileRepeats;
+
 	Atlas1D.TilesPerAtlas = min(maxTilesPerAtlas, maxTiles);
 	Atlas1D.Count = Math_CeilDiv(maxTiles, Atlas1D.TilesPerAtlas);
+	Atlas1D.TileRepeats = tileRepeats;
 
-	Atlas1D.InvTileSize = 1.0f / Atlas1D.TilesPerAtlas;
+	Atlas1D.InvTileSize = 1.0f / (Atlas1D.TilesPerAtlas * tileRepeats);
 	Atlas1D.Mask  = Atlas1D.TilesPerAtlas - 1;
 	Atlas1D.Shift = Math_ilog2(Atlas1D.TilesPerAtlas);
+	Atlas1D.RepeatShift = Math_ilog2(tileRepeats);
 }
 
 /* Loads the given atlas and converts it into an array of 1D atlases. */
@@ -30,6 +30,8 @@ extern struct IGameComponent Textures_Component;
 #endif
 /* Maximum possible number of 1D terrain atlases. (worst case, each 1D atlas only has 1 tile) */
 #define ATLAS1D_MAX_ATLASES (ATLAS2D_TILES_PER_ROW * ATLAS2D_MAX_ROWS_COUNT)
+/* Number of copies of each tile stored in a 1D atlas when greedy meshing is enabled */
+#define ATLAS1D_GREEDY_REPEATS 8
 
 CC_VAR extern struct _Atlas2DData {
 	/* Bitmap that contains the textures of all tiles. */
@@ -48,7 +50,10 @@ CC_VAR extern struct _Atlas1DData {
 	int TilesPerAtlas;
 	/* Converts a tile id into 1D atlas index, and index within that atlas. */
 	int Mask, Shift;
-	/* Texture V coord that equals the size of one tile. (i.e. 1/Atlas1D.TilesPerAtlas) */
+	/* Number of times each tile is repeated vertically in a 1D atlas. (usually 1) */
+	/* NOTE: Lets greedy meshing merge faces along V axis by up to this many rows */
+	int TileRepeats, RepeatShift;
+	/* Texture V coord that equals the size of one tile. (i.e. 1/(TilesPerAtlas * TileRepeats)) */
 	/* NOTE: The texture U coord that equals the size of one tile is 1. */
 	float InvTileSize;
 	/* Textures for each 1D atlas. Only Atlas1D_Count of these are valid. */
@@ -64,8 +69,8 @@ extern cc_bool TexturePack_DefaultMissing;
 
 #define Atlas2D_TileX(texLoc) ((texLoc) &  ATLAS2D_MASK)  /* texLoc % ATLAS2D_TILES_PER_ROW */
 #define Atlas2D_TileY(texLoc) ((texLoc) >> ATLAS2D_SHIFT) /* texLoc / ATLAS2D_TILES_PER_ROW */
-/* Returns the index of the given tile id within a 1D atlas */
-#define Atlas1D_RowId(texLoc) ((texLoc)  & Atlas1D.Mask)  /* texLoc % Atlas1D_TilesPerAtlas */
+/* Returns the row of the first copy of the given tile id within a 1D atlas */
+#define Atlas1D_RowId(texLoc) (((texLoc) & Atlas1D.Mask) << Atlas1D.RepeatShift) /* (texLoc % Atlas1D_TilesPerAtlas) * Atlas1D_TileRepeats */
 /* Returns the index of the 1D atlas within the array of 1D atlases that contains the given tile id */
 #define Atlas1D_Index(texLoc) ((texLoc) >> Atlas1D.Shift) /* texLoc / Atlas1D_TilesPerAtlas */
 
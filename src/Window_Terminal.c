@@ -26,6 +26,14 @@
 #include <linux/keyboard.h>
 #endif
 
+/* Benchmark builds never read input from or draw to the terminal, */
+/* so that they can be run without a terminal and so output is only the results */
+#ifdef CC_BUILD_BENCHMARK
+	#define TERMINAL_HEADLESS
+	#define HEADLESS_WIDTH  640
+	#define HEADLESS_HEIGHT 360
+#endif
+
 
 /*########################################################################################################################*
 *------------------------------------------------------Console output-----------------------------------------------------*
@@ -414,16 +422,25 @@ void Window_Init(void) {
 	DisplayInfo.ScaleX = 0.5f;
 	DisplayInfo.ScaleY = 0.5f;
 	
+#ifdef TERMINAL_HEADLESS
+	DisplayInfo.Width  = HEADLESS_WIDTH;
+	DisplayInfo.Height = HEADLESS_HEIGHT;
+	Window_Main.Width  = HEADLESS_WIDTH;
+	Window_Main.Height = HEADLESS_HEIGHT;
+#else
 	//ioctl(STDIN_FILENO , KDGKBMODE, &orig_KB);
 	//ioctl(STDIN_FILENO,  KDSKBMODE, K_MEDIUMRAW);
 	HookTerminal();
 	UpdateDimensions();
 	HookSignals();
+#endif
 	Platform_Flags |= PLAT_FLAG_SINGLE_PROCESS;
 }
 
 void Window_Free(void) {
+#ifndef TERMINAL_HEADLESS
 	UnhookTerminal();
+#endif
 }
 
 static void DoCreateWindow(int width, int height) {
@@ -436,7 +453,7 @@ static void DoCreateWindow(int width, int height) {
 void Window_Create2D(int width, int height) { DoCreateWindow(width, height); }
 void Window_Create3D(int width, int height) { DoCreateWindow(width, height); }
 
-void Window_Destroy(void) { }
+void Window_Destroy(void) { Window_Main.Exists = false; }
 
 void Window_SetTitle(const cc_string* title) {
 	// TODO
@@ -486,8 +503,10 @@ void Window_ProcessEvents(float delta) {
 		Event_RaiseVoid(&WindowEvents.Closing);
 		return;
 	}
-	
+
+#ifndef TERMINAL_HEADLESS
 	ProcessConsoleEvents(delta);
+#endif
 }
 
 void Gamepads_PreInit(void) { }
@@ -591,6 +610,9 @@ void Window_DrawFramebuffer(Rect2D r, struct Bitmap* bmp) {
 	cc_string str;
 	int len;
 	String_InitArray(str, buf);
+#ifdef TERMINAL_HEADLESS
+	return;
+#endif
 	
 	for (int y = r.y & ~0x01; y < r.y + r.height; y += 2)
 	{
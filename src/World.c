@@ -10,6 +10,11 @@
 #include "Game.h"
 #include "TexturePack.h"
 #include "Window.h"
+#include "Builder.h"
+#include "Lighting.h"
+#include "Funcs.h"
+#include "Errors.h"
+#include "Stream.h"
 
 struct _WorldData World;
 static char nameBuffer[STRING_SIZE];
@@ -37,14 +42,286 @@ static void GenerateNewUuid(void) {
 	World.Uuid[8] |= 0x80; /* variant 2*/
 }
 
-void World_Reset(void) {
+#ifdef EXTENDED_BLOCKS
+#define World_IsRawAir(i)   (!(World.Blocks[i] | World.Blocks2[i]))
+#define World_FlatBlock(i)  ((World.Blocks[i] | (World.Blocks2[i] << 8)) & World.IDMask)
+#else
+#define World_IsRawAir(i)   (!World.Blocks[i])
+#define World_FlatBlock(i)  World.Blocks[i]
+#endif
+
+static void FreeBlocks(void) {
 #ifdef EXTENDED_BLOCKS
 	if (World.Blocks != World.Blocks2) Mem_Free(World.Blocks2);
 	World.Blocks2 = NULL;
-	World.IDMask  = 0xFF;
 #endif
 	Mem_Free(World.Blocks);
 	World.Blocks = NULL;
+}
+
+
+#ifdef CC_BUILD_COMPACTWORLD
+/*########################################################################################################################*
+*-----------------------------------------------------World sections------------------------------------------------------*
+*#########################################################################################################################*/
+/* Index + 1 of each block in the palette of the section currently being stored (0 if not in palette) */
+static cc_uint16 paletteLookup[BLOCK_COUNT];
+/* Blocks of the section currently being changed or stored */
+/* NOTE: Not on the stack, as 8 KB is too much stack for some of the platforms this is used on */
+static BlockID sectionBlocks[CHUNK_SIZE_3];
+
+static void WorldSection_Free(struct WorldSection* s) {
+	Mem_Free(s->palette);
+	Mem_Free(s->data);
+	s->palette = NULL;
+	s->data    = NULL;
+	s->bits    = 0;
+	s->paletteCount = 0;
+}
+
+static void WorldSection_SetIndex(struct WorldSection* s, int index, int value) {
+	int bit = index * s->bits, shift = bit & 7;
+	cc_uint8* ptr = &((cc_uint8*)s->data)[bit >> 3];
+	int mask = ((1 << s->bits) - 1) << shift;
+
+	*ptr = (cc_uint8)((*ptr & ~mask) | (value << shift));
+}
+
+/* Stores the given blocks in the section, using the fewest bits per block possible */
+/* Returns false if out of memory */
+static cc_bool WorldSection_Store(struct WorldSection* s, const BlockID* blocks) {
+	BlockID palette[256];
+	int i, count = 0, bits;
+	BlockID b;
+
+	for (i = 0; i < CHUNK_SIZE_3; i++) {
+		b = blocks[i];
+		if (paletteLookup[b]) continue;
+
+		if (count < 256) palette[count] = b;
+		paletteLookup[b] = ++count;
+	}
+
+	if (count == 1)        { bits = 0; }
+	else if (count <= 2)   { bits = 1; }
+	else if (count <= 4)   { bits = 2; }
+	else if (count <= 16)  { bits = 4; }
+	else if (count <= 256) { bits = 8; }
+	else                   { bits = 16; }
+
+	s->bits  = bits;
+	s->value = blocks[0];
+
+	if (bits == 16) {
+		s->data = Mem_TryAlloc(CHUNK_SIZE_3, sizeof(BlockID));
+		if (s->data) Mem_Copy(s->data, blocks, CHUNK_SIZE_3 * sizeof(BlockID));
+	} else if (bits) {
+		s->data    = Mem_TryAllocCleared(CHUNK_SIZE_3 * bits / 8, 1);
+		s->palette = (BlockID*)Mem_TryAlloc(1 << bits, sizeof(BlockID));
+		s->paletteCount = count;
+
+		if (s->data && s->palette) {
+			Mem_Copy(s->palette, palette, count * sizeof(BlockID));
+			for (i = 0; i < CHUNK_SIZE_3; i++) {
+				WorldSection_SetIndex(s, i, paletteLookup[blocks[i]] - 1);
+			}
+		}
+	}
+
+	for (i = 0; i < CHUNK_SIZE_3; i++) {
+		paletteLookup[blocks[i]] = 0;
+	}
+	return !bits || (s->data && (bits == 16 || s->palette));
+}
+
+static void WorldSection_Set(struct WorldSection* s, int index, BlockID block) {
+	int i;
+
+	if (s->bits == 16) {
+		((BlockID*)s->data)[index] = block; return;
+	}
+
+	if (s->bits) {
+		for (i = 0; i < s->paletteCount; i++) {
+			if (s->palette[i] == block) break;
+		}
+
+		/* Block is already in palette, or there is still room for it in the palette */
+		if (i < (1 << s->bits)) {
+			if (i == s->paletteCount) s->palette[s->paletteCount++] = block;
+			WorldSection_SetIndex(s, index, i); return;
+		}
+	} else if (s->value == block) {
+		return;
+	}
+
+	/* Otherwise the section needs more bits per block */
+	/* (this also removes any blocks no longer used from the palette) */
+	for (i = 0; i < CHUNK_SIZE_3; i++) {
+		sectionBlocks[i] = WorldSection_Get(s, i);
+	}
+	sectionBlocks[index] = block;
+
+	WorldSection_Free(s);
+	if (!WorldSection_Store(s, sectionBlocks)) World_OutOfMemory();
+}
+
+static void FreeSections(void) {
+	int i;
+	if (!World.Sections) return;
+
+	for (i = 0; i < World.ChunksCount; i++) {
+		WorldSection_Free(&World.Sections[i]);
+	}
+	Mem_Free(World.Sections);
+	World.Sections = NULL;
+}
+
+/* Moves the blocks from World.Blocks/World.Blocks2 into sections */
+/* Returns false if out of memory */
+static cc_bool InitSections(void) {
+	BlockID* blocks = sectionBlocks;
+	int cx, cy, cz, x1, y1, z1;
+	int xCount, yCount, zCount;
+	int xx, yy, zz, i;
+
+	World.Sections = (struct WorldSection*)Mem_TryAllocCleared(World.ChunksCount, sizeof(struct WorldSection));
+	if (!World.Sections) return false;
+
+	for (cz = 0, z1 = 0; cz < World.ChunksZ; cz++, z1 += CHUNK_SIZE) {
+		for (cy = 0, y1 = 0; cy < World.ChunksY; cy++, y1 += CHUNK_SIZE) {
+			for (cx = 0, x1 = 0; cx < World.ChunksX; cx++, x1 += CHUNK_SIZE) {
+				xCount = min(CHUNK_SIZE, World.Width  - x1);
+				yCount = min(CHUNK_SIZE, World.Height - y1);
+				zCount = min(CHUNK_SIZE, World.Length - z1);
+				/* Parts of sections outside the map are treated as air */
+				Mem_Set(blocks, BLOCK_AIR, sizeof(sectionBlocks));
+
+				for (yy = 0; yy < yCount; yy++) {
+					for (zz = 0; zz < zCount; zz++) {
+						i = World_Pack(x1, y1 + yy, z1 + zz);
+
+						for (xx = 0; xx < xCount; xx++, i++) {
+							blocks[WorldSection_Pack(xx, yy, zz)] = World_FlatBlock(i);
+						}
+					}
+				}
+				if (!WorldSection_Store(&World.Sections[World_ChunkPack(cx, cy, cz)], blocks)) return false;
+			}
+		}
+	}
+
+	FreeBlocks();
+	return true;
+}
+
+cc_result World_AllocSections(void) {
+	if (!World_CheckVolume(World.Width, World.Height, World.Length)) return ERR_OUT_OF_MEMORY;
+	FreeSections();
+	World_SetDimensions(World.Width, World.Height, World.Length);
+
+	World.Sections = (struct WorldSection*)Mem_TryAllocCleared(World.ChunksCount, sizeof(struct WorldSection));
+	return World.Sections ? 0 : ERR_OUT_OF_MEMORY;
+}
+
+/* Merges the given layers of blocks into the sections at the given section Y coordinate */
+/* Returns false if out of memory */
+static cc_bool StoreSectionLayers(const BlockRaw* layers, int cy, int shift) {
+	struct WorldSection* s;
+	int cx, cz, x1, z1, y1 = cy << CHUNK_SHIFT;
+	int xCount, yCount, zCount;
+	int xx, yy, zz, i, j;
+
+	for (cz = 0, z1 = 0; cz < World.ChunksZ; cz++, z1 += CHUNK_SIZE) {
+		for (cx = 0, x1 = 0; cx < World.ChunksX; cx++, x1 += CHUNK_SIZE) {
+			s = &World.Sections[World_ChunkPack(cx, cy, cz)];
+			xCount = min(CHUNK_SIZE, World.Width  - x1);
+			yCount = min(CHUNK_SIZE, World.Height - y1);
+			zCount = min(CHUNK_SIZE, World.Length - z1);
+
+			for (j = 0; j < CHUNK_SIZE_3; j++) {
+				sectionBlocks[j] = WorldSection_Get(s, j);
+			}
+
+			for (yy = 0; yy < yCount; yy++) {
+				for (zz = 0; zz < zCount; zz++) {
+					i = (yy * World.Length + (z1 + zz)) * World.Width + x1;
+					j = WorldSection_Pack(0, yy, zz);
+
+					for (xx = 0; xx < xCount; xx++, i++, j++) {
+#ifdef EXTENDED_BLOCKS
+						sectionBlocks[j] = ((sectionBlocks[j] & ~(0xFF << shift)) | (layers[i] << shift)) & World.IDMask;
+#else
+						sectionBlocks[j] = layers[i];
+#endif
+					}
+				}
+			}
+
+			WorldSection_Free(s);
+			if (!WorldSection_Store(s, sectionBlocks)) return false;
+		}
+	}
+	return true;
+}
+
+cc_result World_ReadSections(struct Stream* stream, int shift) {
+	int layerSize = World.Width * World.Length;
+	int cy, yCount;
+	BlockRaw* layers;
+	cc_result res = 0;
+
+#ifdef EXTENDED_BLOCKS
+	if (shift) World.IDMask = 0x3FF;
+#endif
+	/* Only one section's worth of layers is ever kept in memory, instead of a Volume sized array */
+	layers = (BlockRaw*)Mem_TryAlloc(layerSize, CHUNK_SIZE);
+	if (!layers) return ERR_OUT_OF_MEMORY;
+
+	for (cy = 0; cy < World.ChunksY; cy++) {
+		yCount = min(CHUNK_SIZE, World.Height - (cy << CHUNK_SHIFT));
+
+		if ((res = Stream_Read(stream, layers, layerSize * yCount))) break;
+		if (!StoreSectionLayers(layers, cy, shift)) { res = ERR_OUT_OF_MEMORY; break; }
+	}
+
+	Mem_Free(layers);
+	return res;
+}
+
+/* Counts the number of non-air blocks in each section */
+static void CountSectionBlocks(void) {
+	cc_uint16* counts = World.ChunkBlockCounts;
+	struct WorldSection* s;
+	int i, j, count;
+	if (!counts) return;
+
+	for (i = 0; i < World.ChunksCount; i++) {
+		s = &World.Sections[i];
+		if (!s->bits) { counts[i] = s->value == BLOCK_AIR ? 0 : CHUNK_SIZE_3; continue; }
+
+		for (j = 0, count = 0; j < CHUNK_SIZE_3; j++) {
+			if (WorldSection_Get(s, j) != BLOCK_AIR) count++;
+		}
+		counts[i] = count;
+	}
+}
+#endif
+
+
+void World_Reset(void) {
+	/* Background mesh builders and lighting may still be reading the old blocks */
+	Builder_CancelAll();
+	FancyLighting_CancelAll();
+	FreeBlocks();
+#ifdef CC_BUILD_COMPACTWORLD
+	FreeSections();
+#endif
+#ifdef EXTENDED_BLOCKS
+	World.IDMask = 0xFF;
+#endif
+	Mem_Free(World.ChunkBlockCounts);
+	World.ChunkBlockCounts = NULL;
 	String_InitArray(World.Name, nameBuffer);
 
 	World_SetDimensions(0, 0, 0);
@@ -59,23 +336,76 @@ void World_NewMap(void) {
 	Event_RaiseVoid(&WorldEvents.NewMap);
 }
 
-void World_SetNewMap(BlockRaw* blocks, int width, int height, int length) {
+#ifndef CC_BUILD_COMPACTWORLD
+/* Adds the non-air blocks in the given layers of the world to the number of non-air blocks in each chunk */
+static void CountChunkBlocks(int yBeg, int yEnd) {
+	cc_uint16* counts = World.ChunkBlockCounts;
+	int x, y, z, i, xEnd, chunk;
+	if (!counts) return;
+
+	for (y = yBeg; y < yEnd; y++) {
+		for (z = 0; z < World.Length; z++) {
+			i = World_Pack(0, y, z);
+
+			for (x = 0; x < World.Width; x = xEnd) {
+				xEnd  = min(x + CHUNK_SIZE, World.Width);
+				chunk = World_ChunkPack(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT);
+
+				for (; x < xEnd; x++, i++) {
+					if (!World_IsRawAir(i)) counts[chunk]++;
+				}
+			}
+		}
+	}
+}
+#endif
+
+/* Updates the number of non-air blocks in the chunk containing the given block, before the block is changed */
+static CC_INLINE void UpdateChunkBlockCount(int x, int y, int z, cc_bool wasAir, BlockID block) {
+	cc_uint16* count;
+	if (!World.ChunkBlockCounts || wasAir == (block == BLOCK_AIR)) return;
+
+	count = &World.ChunkBlockCounts[World_ChunkPack(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT)];
+	if (block == BLOCK_AIR) { (*count)--; } else { (*count)++; }
+}
+
+static void SetNewMap(BlockRaw* blocks, int width, int height, int length, int loadedHeight) {
+	cc_bool hasBlocks = blocks != NULL;
+#ifdef CC_BUILD_COMPACTWORLD
+	/* Map importers usually read blocks directly into sections instead */
+	hasBlocks |= World.Sections != NULL;
+#endif
 	/* TODO: TEMP HACK */
-	if (!blocks) { width = 0; height = 0; length = 0; }
+	if (!hasBlocks) { width = 0; height = 0; length = 0; loadedHeight = 0; }
 
 	World_SetDimensions(width, height, length);
-	World.Blocks      = blocks;
-	World.Name.length = 0;
+	World.LoadedHeight = loadedHeight;
+	World.Blocks       = blocks;
+	World.Name.length  = 0;
 
 	if (!World.Volume) World.Blocks = NULL;
 #ifdef EXTENDED_BLOCKS
 	/* .cw maps may have set this to a non-NULL when importing */
-	if (!World.Blocks2) {
+	if (World.Blocks && !World.Blocks2) {
 		World.Blocks2 = World.Blocks;
 		World.IDMask  = 0xFF;
 	}
 #endif
 
+#ifdef CC_BUILD_COMPACTWORLD
+	if (World.Blocks && !InitSections()) World_OutOfMemory();
+
+	if (World.Sections) {
+		World.ChunkBlockCounts = (cc_uint16*)Mem_TryAllocCleared(World.ChunksCount, sizeof(cc_uint16));
+		CountSectionBlocks();
+	}
+#else
+	if (World.Blocks) {
+		World.ChunkBlockCounts = (cc_uint16*)Mem_TryAllocCleared(World.ChunksCount, sizeof(cc_uint16));
+		CountChunkBlocks(0, loadedHeight);
+	}
+#endif
+
 	if (Env.EdgeHeight == -1)   { Env.EdgeHeight   = height / 2; }
 	if (Env.CloudsHeight == -1) { Env.CloudsHeight = height + 2; }
 
@@ -84,9 +414,39 @@ void World_SetNewMap(BlockRaw* blocks, int width, int height, int length) {
 	Event_RaiseVoid(&WorldEvents.MapLoaded);
 }
 
+void World_SetNewMap(BlockRaw* blocks, int width, int height, int length) {
+	SetNewMap(blocks, width, height, length, height);
+}
+
+#ifndef CC_BUILD_COMPACTWORLD
+void World_SetStreamedMap(BlockRaw* blocks, int width, int height, int length) {
+	SetNewMap(blocks, width, height, length, 0);
+}
+
+void World_SetLoadedHeight(int height) {
+	height = min(height, World.Height);
+	if (height <= World.LoadedHeight) return;
+
+	CountChunkBlocks(World.LoadedHeight, height);
+	World.LoadedHeight = height;
+}
+
+void World_AbortStreamedMap(void) {
+	/* Background mesh builders and lighting may still be reading the blocks */
+	Builder_CancelAll();
+	FancyLighting_CancelAll();
+	World.Blocks  = NULL;
+#ifdef EXTENDED_BLOCKS
+	World.Blocks2 = NULL;
+#endif
+	World_NewMap();
+}
+#endif
+
 CC_NOINLINE void World_SetDimensions(int width, int height, int length) {
 	World.Width  = width; World.Height = height; World.Length = length;
 	World.Volume = width * height * length;
+	World.LoadedHeight = height;
 
 	World.OneY = width * length;
 	World.MaxX = width  - 1;
@@ -113,7 +473,24 @@ void World_OutOfMemory(void) {
 }
 
 
+#if defined CC_BUILD_COMPACTWORLD
+void World_SetBlock(int x, int y, int z, BlockID block) {
+	struct WorldSection* s = &World.Sections[World_ChunkPack(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT)];
+	int index = WorldSection_Pack(x, y, z);
+
+	UpdateChunkBlockCount(x, y, z, WorldSection_Get(s, index) == BLOCK_AIR, block);
+	WorldSection_Set(s, index, block);
 #ifdef EXTENDED_BLOCKS
+	if (block > 0xFF) World.IDMask = 0x3FF;
+#endif
+}
+
+BlockID World_GetRawBlock(int idx) {
+	int x, y, z;
+	World_Unpack(idx, x, y, z);
+	return World_GetBlock(x, y, z);
+}
+#elif defined EXTENDED_BLOCKS
 static CC_NOINLINE void LazyInitUpper(int i, BlockID block) {
 	BlockRaw* data = (BlockRaw*)Mem_TryAllocCleared(World.Volume, 1);
 	if (!data) { World_OutOfMemory(); return; }
@@ -124,6 +501,7 @@ static CC_NOINLINE void LazyInitUpper(int i, BlockID block) {
 
 void World_SetBlock(int x, int y, int z, BlockID block) {
 	int i = World_Pack(x, y, z);
+	UpdateChunkBlockCount(x, y, z, World_IsRawAir(i), block);
 	World.Blocks[i] = (BlockRaw)block;
 
 	/* defer allocation of second map array if possible */
@@ -136,7 +514,9 @@ void World_SetBlock(int x, int y, int z, BlockID block) {
 }
 #else
 void World_SetBlock(int x, int y, int z, BlockID block) {
-	World.Blocks[World_Pack(x, y, z)] = block; 
+	int i = World_Pack(x, y, z);
+	UpdateChunkBlockCount(x, y, z, World_IsRawAir(i), block);
+	World.Blocks[i] = block; 
 }
 #endif
 
@@ -2,10 +2,15 @@
 #define CC_WORLD_H
 #include "Vectors.h"
 #include "PackedCol.h"
+#include "Constants.h"
 CC_BEGIN_HEADER
 
 /* 
 Represents a fixed size 3D array of blocks and associated metadata
+  When CC_BUILD_COMPACTWORLD is defined, blocks are instead stored in 16x16x16 sections
+  (each section either being a single block, or having a palette of blocks with bit-packed indices)
+  Map importers then read blocks directly into sections, while World.Blocks/World.Blocks2 are only
+  used when a flat blocks array is given to World_SetNewMap, and are NULL afterwards
 Copyright 2014-2025 ClassiCube | Licensed under BSD-3
 */
 struct AABB;
@@ -20,6 +25,22 @@ extern struct IGameComponent World_Component;
 #define World_ChunkPack(cx, cy, cz) (((cz) * World.ChunksY + (cy)) * World.ChunksX + (cx))
 /* TODO: Swap Y and Z? Make sure to update MapRenderer's ResetChunkCache and ClearChunkCache methods! */
 
+#ifdef CC_BUILD_COMPACTWORLD
+/* Packs the coordinates of a block into an index within its section */
+#define WorldSection_Pack(x, y, z) ((((y) & CHUNK_MASK) << 8) | (((z) & CHUNK_MASK) << 4) | ((x) & CHUNK_MASK))
+
+/* Stores the blocks of a 16x16x16 section of the world */
+struct WorldSection {
+	/* Number of bits per block index into the palette (1, 2, 4 or 8) */
+	/* 0 when every block in the section is 'value', 16 when blocks are stored directly without a palette */
+	cc_uint8 bits;
+	cc_uint16 paletteCount;
+	BlockID value;
+	BlockID* palette;
+	void* data;
+};
+#endif
+
 
 CC_VAR extern struct _WorldData {
 	/* The blocks in the world. */
@@ -60,6 +81,16 @@ CC_VAR extern struct _WorldData {
 	int ChunksCount;
 	/* Seed world was generated with. May be 0 (unknown) */
 	int Seed;
+	/* Number of non-air blocks in each chunk (indexed by World_ChunkPack) */
+	/* NOTE: May be NULL (e.g. not enough memory), and is only kept up to date by World_SetBlock */
+	cc_uint16* ChunkBlockCounts;
+	/* Number of layers of blocks (from the bottom up) that have been received so far */
+	/* NOTE: Only less than Height while the map is still being streamed in (see World_SetStreamedMap) */
+	int LoadedHeight;
+#ifdef CC_BUILD_COMPACTWORLD
+	/* Blocks of the world in 16x16x16 sections (indexed by World_ChunkPack) */
+	struct WorldSection* Sections;
+#endif
 } World;
 
 /* Frees the blocks array, sets dimensions to 0, resets environment to default. */
@@ -70,6 +101,17 @@ CC_API void World_NewMap(void);
 /* Sets blocks array/dimensions of the map and raises WorldEvents.MapLoaded event */
 /* May also sets some environment settings like border/clouds height, if they are -1 */
 CC_API void World_SetNewMap(BlockRaw* blocks, int width, int height, int length);
+#ifndef CC_BUILD_COMPACTWORLD
+/* Same as World_SetNewMap, except that blocks are still being received layer by layer from the bottom up */
+/*  (so that the already received parts of the map can be rendered while the rest is still loading) */
+/* NOTE: blocks must initially be all air, with World_SetLoadedHeight called as more layers are received */
+void World_SetStreamedMap(BlockRaw* blocks, int width, int height, int length);
+/* Marks all layers of blocks below the given height as having been received */
+void World_SetLoadedHeight(int height);
+/* Resets the world without freeing the blocks array of the map currently being streamed in */
+/* NOTE: Used when a streamed map turns out to have different dimensions to what was expected */
+void World_AbortStreamedMap(void);
+#endif
 /* Sets the various dimension and max coordinate related variables. */
 /* NOTE: This is an internal API. Use World_SetNewMap instead. */
 CC_NOINLINE void World_SetDimensions(int width, int height, int length);
@@ -78,7 +120,40 @@ void World_OutOfMemory(void);
 #ifdef EXTENDED_BLOCKS
 /* Sets World.Blocks2 and updates internal state for more than 256 blocks. */
 void World_SetMapUpper(BlockRaw* blocks);
+#endif
+
+#ifdef CC_BUILD_COMPACTWORLD
+struct Stream;
+/* Allocates sections (all air) for a map with dimensions of World.Width, World.Height and World.Length */
+/* NOTE: World_SetNewMap should then be called with NULL blocks once the map has been read */
+cc_result World_AllocSections(void);
+/* Reads the lower 8 bits (shift of 0) or upper 8 bits (shift of 8) of every block directly into sections */
+/* NOTE: Blocks must be in World_Pack order, and only 16 layers of blocks are ever kept in memory at once */
+cc_result World_ReadSections(struct Stream* stream, int shift);
+#endif
+
+#if defined CC_BUILD_COMPACTWORLD
+static CC_INLINE BlockID WorldSection_Get(const struct WorldSection* s, int index) {
+	int bit;
+	if (s->bits == 0)  return s->value;
+	if (s->bits == 16) return ((BlockID*)s->data)[index];
 
+	bit = index * s->bits;
+	return s->palette[(((cc_uint8*)s->data)[bit >> 3] >> (bit & 7)) & ((1 << s->bits) - 1)];
+}
+
+/* Gets the block at the given coordinates. */
+/* NOTE: Does NOT check that the coordinates are inside the map. */
+static CC_INLINE BlockID World_GetBlock(int x, int y, int z) {
+	const struct WorldSection* s = &World.Sections[World_ChunkPack(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT)];
+	return WorldSection_Get(s, WorldSection_Pack(x, y, z));
+}
+/* Gets the block at the given packed index. */
+/* NOTE: This is much slower than World_GetBlock, as the index has to be unpacked */
+BlockID World_GetRawBlock(int idx);
+/* Whether the world currently has any blocks */
+#define World_HasBlocks() (World.Sections != NULL)
+#elif defined EXTENDED_BLOCKS
 #define World_GetRawBlock(idx) ((World.Blocks[idx] | (World.Blocks2[idx] << 8)) & World.IDMask)
 
 /* Gets the block at the given coordinates. */
@@ -92,6 +167,11 @@ static CC_INLINE BlockID World_GetBlock(int x, int y, int z) {
 #define World_GetRawBlock(idx)  World.Blocks[idx]
 #endif
 
+#ifndef CC_BUILD_COMPACTWORLD
+/* Whether the world currently has any blocks */
+#define World_HasBlocks() (World.Blocks != NULL)
+#endif
+
 /* If Y is above the map, returns BLOCK_AIR. */
 /* If coordinates are outside the map, returns BLOCK_AIR. */
 /* Otherwise returns the block at the given coordinates. */
@@ -103,6 +183,12 @@ void World_SetBlock(int x, int y, int z, BlockID block);
 /* Otherwise returns the block at the given coordinates. */
 BlockID World_SafeGetBlock(int x, int y, int z);
 
+/* Whether the given chunk is known to only contain air blocks. */
+/* NOTE: Does NOT check that the chunk coordinates are inside the map. */
+static CC_INLINE cc_bool World_IsAirChunk(int cx, int cy, int cz) {
+	return World.ChunkBlockCounts && !World.ChunkBlockCounts[World_ChunkPack(cx, cy, cz)];
+}
+
 /* Whether the given coordinates lie inside the map. */
 static CC_INLINE cc_bool World_Contains(int x, int y, int z) {
 	return (unsigned)x < (unsigned)World.Width
@@ -115,6 +201,7 @@ static CC_INLINE cc_bool World_ContainsXZ(int x, int z) {
 		&& (unsigned)z < (unsigned)World.Length;
 }
 
+/* NOTE: Block indices are int throughout, so maximum volume is the same even with CC_BUILD_COMPACTWORLD */
 static CC_INLINE cc_bool World_CheckVolume(int width, int height, int length) {
 	cc_uint64 volume = (cc_uint64)width * height * length;
 	return volume <= Int32_MaxValue;
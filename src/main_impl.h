@@ -19,6 +19,7 @@ Eg. the webclient 'main' function loads IndexedDB, and when that has asynchronou
 #include "Server.h"
 #include "Options.h"
 #include "main.h"
+#include "Benchmark.h"
 
 
 /*########################################################################################################################*
@@ -165,6 +166,7 @@ static int ParseMPArgs(const cc_string* user, const cc_string* mppass, const cc_
 #define ARG_RESULT_RUN_LAUNCHER 1
 #define ARG_RESULT_RUN_GAME     2
 #define ARG_RESULT_INVALID_ARGS 3
+#define ARG_RESULT_RUN_BENCHMARK 4
 
 static int ProcessProgramArgs(int argc, char** argv) {
 cc_string args[GAME_MAX_CMDARGS];
@@ -182,6 +184,14 @@ cc_string args[GAME_MAX_CMDARGS];
 	if (argsCount == 0)
 		return ARG_RESULT_RUN_LAUNCHER;
 
+#ifdef CC_BUILD_BENCHMARK
+	/* --benchmark - run headless benchmark in singleplayer */
+	if (argsCount == 1 && String_CaselessEqualsConst(&args[0], BENCHMARK_ARG)) {
+		Options_Get(LOPT_USERNAME, &Game_Username, DEFAULT_USERNAME);
+		return ARG_RESULT_RUN_BENCHMARK;
+	}
+#endif
+
 #ifndef CC_BUILD_WEB
 	/* :[hash] - auto join server with the given hash */
 	if (argsCount == 1 && args[0].buffer[0] == ':') {
@@ -252,6 +262,11 @@ static int RunProgram(int argc, char** argv) {
 	case ARG_RESULT_RUN_GAME:
 		RunGame();
 		return 0;
+#ifdef CC_BUILD_BENCHMARK
+	case ARG_RESULT_RUN_BENCHMARK:
+		Benchmark_Run();
+		return 0;
+#endif
 	default:
 		return 1;
 	}